@@ -19,29 +19,32 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
             }
         }
 
-        // 处理target list，再target list中添加上表名，例如 a.id
-        for (auto &sv_sel_col : x->cols) {
-            TabCol sel_col = {.tab_name = sv_sel_col->tab_name, .col_name = sv_sel_col->col_name};
-            query->cols.push_back(sel_col);
-        }
         // auto all_cols = get_all_cols(query->tables);
         std::vector<ColMeta> all_cols;
         get_all_cols(query->tables, all_cols);
+        // 处理target list，再target list中添加上表名，例如 a.id；聚集函数的输出列只有列名，例如 MAX(id)
+        for (auto &sv_sel_col : x->cols) {
+            if (sv_sel_col->agg_type != ast::SV_AGG_NONE) {
+                query->cols.push_back({.tab_name = "", .col_name = get_agg_name(sv_sel_col)});
+                continue;
+            }
+            TabCol sel_col = {.tab_name = sv_sel_col->tab_name, .col_name = sv_sel_col->col_name};
+            query->cols.push_back(check_column(all_cols, sel_col));  // 列元数据校验
+        }
         if (query->cols.empty()) {
             // select all columns
             for (auto &col : all_cols) {
                 TabCol sel_col = {.tab_name = col.tab_name, .col_name = col.name};
                 query->cols.push_back(sel_col);
             }
-        } else {
-            // infer table name from column name
-            for (auto &sel_col : query->cols) {
-                sel_col = check_column(all_cols, sel_col);  // 列元数据校验
-            }
         }
+        check_aggregate(x, all_cols, query);
         //处理where条件
         get_clause(x->conds, query->conds);
         check_clause(query->tables, query->conds);
+        if (x->limit != nullptr && (x->limit->count < 0 || x->limit->offset < 0)) {
+            throw InternalError("LIMIT and OFFSET must not be negative");
+        }
     } else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(parse)) {
         // 处理 update 的set 值
         for (auto &sv_set_clause : x->set_clauses) {
@@ -66,8 +69,12 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         check_clause({x->tab_name}, query->conds);        
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(parse)) {
         // 处理insert 的values值
-        for (auto &sv_val : x->vals) {
-            query->values.push_back(convert_sv_value(sv_val));
+        for (auto &row : x->rows) {
+            std::vector<Value> values;
+            for (auto &sv_val : row) {
+                values.push_back(convert_sv_value(sv_val));
+            }
+            query->values.push_back(std::move(values));
         }
     } else {
         // do nothing
@@ -103,6 +110,60 @@ TabCol Analyze::check_column(const std::vector<ColMeta> &all_cols, TabCol target
     return target;
 }
 
+/**
+ * @brief 处理聚集函数和GROUP BY：聚集的字段和分组字段补上表名。
+ * 有聚集或分组时，选择的普通字段和ORDER BY的字段都必须是分组字段
+ */
+void Analyze::check_aggregate(const std::shared_ptr<ast::SelectStmt> &x, const std::vector<ColMeta> &all_cols,
+                              std::shared_ptr<Query> query) {
+    for (auto &sv_col : x->group_by) {
+        TabCol group_col = {.tab_name = sv_col->tab_name, .col_name = sv_col->col_name};
+        query->group_cols.push_back(check_column(all_cols, group_col));
+    }
+    for (auto &sv_sel_col : x->cols) {
+        if (sv_sel_col->agg_type == ast::SV_AGG_NONE) {
+            continue;
+        }
+        AggExpr agg = {.type = convert_sv_agg_type(sv_sel_col->agg_type),
+                       .col = {.tab_name = "", .col_name = "*"},
+                       .name = get_agg_name(sv_sel_col)};
+        // 相同的聚集函数只计算一次
+        if (std::any_of(query->aggs.begin(), query->aggs.end(),
+                        [&](const AggExpr &other) { return other.name == agg.name; })) {
+            continue;
+        }
+        if (sv_sel_col->col_name != "*") {
+            agg.col = check_column(all_cols, {.tab_name = sv_sel_col->tab_name, .col_name = sv_sel_col->col_name});
+            auto col = sm_manager_->db_.get_table(agg.col.tab_name).get_col(agg.col.col_name);
+            if ((agg.type == AGG_SUM || agg.type == AGG_AVG) && col->type == TYPE_STRING) {
+                throw IncompatibleTypeError(coltype2str(col->type), "INT or FLOAT");
+            }
+        }
+        query->aggs.push_back(std::move(agg));
+    }
+    if (query->aggs.empty() && query->group_cols.empty()) {
+        return;
+    }
+    auto is_group_col = [&](const TabCol &col) {
+        return std::any_of(query->group_cols.begin(), query->group_cols.end(), [&](const TabCol &group_col) {
+            return group_col.tab_name == col.tab_name && group_col.col_name == col.col_name;
+        });
+    };
+    for (auto &sel_col : query->cols) {
+        // 聚集函数的输出列表名为空
+        if (!sel_col.tab_name.empty() && !is_group_col(sel_col)) {
+            throw InternalError("Column " + sel_col.col_name + " must appear in GROUP BY or an aggregate function");
+        }
+    }
+    for (auto &order : x->orders) {
+        TabCol order_col = {.tab_name = order->cols->tab_name, .col_name = order->cols->col_name};
+        order_col = check_column(all_cols, order_col);
+        if (!is_group_col(order_col)) {
+            throw InternalError("ORDER BY column " + order_col.col_name + " must appear in GROUP BY");
+        }
+    }
+}
+
 void Analyze::get_all_cols(const std::vector<std::string> &tab_names, std::vector<ColMeta> &all_cols) {
     for (auto &sel_tab_name : tab_names) {
         // 这里db_不能写成get_db(), 注意要传指针
@@ -179,3 +240,21 @@ CompOp Analyze::convert_sv_comp_op(ast::SvCompOp op) {
     };
     return m.at(op);
 }
+
+AggType Analyze::convert_sv_agg_type(ast::SvAggType agg_type) {
+    std::map<ast::SvAggType, AggType> m = {
+        {ast::SV_AGG_COUNT, AGG_COUNT}, {ast::SV_AGG_SUM, AGG_SUM}, {ast::SV_AGG_MIN, AGG_MIN},
+        {ast::SV_AGG_MAX, AGG_MAX},     {ast::SV_AGG_AVG, AGG_AVG},
+    };
+    return m.at(agg_type);
+}
+
+// 聚集函数输出列的名称，按照语句中的写法，例如 COUNT(*)、MAX(t.id)
+std::string Analyze::get_agg_name(const std::shared_ptr<ast::Col> &sv_col) {
+    std::map<ast::SvAggType, std::string> m = {
+        {ast::SV_AGG_COUNT, "COUNT"}, {ast::SV_AGG_SUM, "SUM"}, {ast::SV_AGG_MIN, "MIN"},
+        {ast::SV_AGG_MAX, "MAX"},     {ast::SV_AGG_AVG, "AVG"},
+    };
+    std::string arg = sv_col->tab_name.empty() ? sv_col->col_name : sv_col->tab_name + '.' + sv_col->col_name;
+    return m.at(sv_col->agg_type) + '(' + arg + ')';
+}
@@ -26,14 +26,18 @@ class Query{
     // TODO jointree
     // where条件
     std::vector<Condition> conds;
-    // 投影列
+    // 投影列，聚集函数的输出列表名为空，列名为AggExpr::name
     std::vector<TabCol> cols;
+    // 聚集函数
+    std::vector<AggExpr> aggs;
+    // group by的字段
+    std::vector<TabCol> group_cols;
     // 表名
     std::vector<std::string> tables;
     // update 的set 值
     std::vector<SetClause> set_clauses;
-    //insert 的values值
-    std::vector<Value> values;
+    //insert 的values值，每行一组
+    std::vector<std::vector<Value>> values;
 
     Query(){}
 
@@ -53,8 +57,12 @@ private:
     TabCol check_column(const std::vector<ColMeta> &all_cols, TabCol target);
     void get_all_cols(const std::vector<std::string> &tab_names, std::vector<ColMeta> &all_cols);
     void get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv_conds, std::vector<Condition> &conds);
+    void check_aggregate(const std::shared_ptr<ast::SelectStmt> &x, const std::vector<ColMeta> &all_cols,
+                         std::shared_ptr<Query> query);
     void check_clause(const std::vector<std::string> &tab_names, std::vector<Condition> &conds);
     Value convert_sv_value(const std::shared_ptr<ast::Value> &sv_val);
     CompOp convert_sv_comp_op(ast::SvCompOp op);
+    AggType convert_sv_agg_type(ast::SvAggType agg_type);
+    std::string get_agg_name(const std::shared_ptr<ast::Col> &sv_col);
 };
 
@@ -81,6 +81,14 @@ struct Condition {
     Value rhs_val;    // right-hand side value
 };
 
+enum AggType { AGG_COUNT, AGG_SUM, AGG_MIN, AGG_MAX, AGG_AVG };
+
+struct AggExpr {
+    AggType type;
+    TabCol col;        // 聚集的字段，COUNT(*)的col_name为"*"
+    std::string name;  // 输出字段的名称，例如MAX(id)
+};
+
 struct SetClause {
     TabCol lhs;
     Value rhs;
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 
 #define BUFFER_LENGTH 8192
@@ -36,6 +37,9 @@ static constexpr int BUFFER_POOL_SIZE = 65536;                                //
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr size_t QUERY_MEMORY_BUDGET = 64 << 20;                       // memory budget of one operator 64MB
+static constexpr int MORSEL_PAGES = 16;                                       // data pages in one morsel of a parallel scan
+static constexpr int PARALLEL_SCAN_MIN_PAGES = 256;                           // smaller tables are scanned serially 1MB
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
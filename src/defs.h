@@ -61,6 +61,20 @@ inline std::string coltype2str(ColType type) {
     return m.at(type);
 }
 
+// 索引的实现方式，在CREATE INDEX ... USING <type>时指定
+enum IndexType {
+    INDEX_BTREE, INDEX_BLINK, INDEX_HASH
+};
+
+inline std::string indextype2str(IndexType type) {
+    std::map<IndexType, std::string> m = {
+            {INDEX_BTREE, "BTREE"},
+            {INDEX_BLINK, "BLINK"},
+            {INDEX_HASH,  "HASH"}
+    };
+    return m.at(type);
+}
+
 class RecScan {
 public:
     virtual ~RecScan() = default;
@@ -82,6 +82,11 @@ class IndexEntryNotFoundError : public RMDBError {
     IndexEntryNotFoundError() : RMDBError("Index entry not found") {}
 };
 
+class DuplicateKeyError : public RMDBError {
+   public:
+    DuplicateKeyError() : RMDBError("Duplicate key violates unique index") {}
+};
+
 // SM errors
 class DatabaseNotFoundError : public RMDBError {
    public:
@@ -136,6 +141,11 @@ class IndexExistsError : public RMDBError {
     }
 };
 
+class IndexTypeNotSupportedError : public RMDBError {
+   public:
+    IndexTypeNotSupportedError(const std::string &type) : RMDBError("Index type not supported: " + type) {}
+};
+
 // QL errors
 class InvalidValueCountError : public RMDBError {
    public:
@@ -0,0 +1,91 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "defs.h"
+
+constexpr size_t CHUNK_CAPACITY = 1024;  // 一个DataChunk最多容纳的元组数
+
+/**
+ * 批量执行时算子之间传递的一批元组（行存格式）
+ * 所有元组等长，连续存放在data_中；选择向量sel_记录仍然有效的元组下标，
+ * 过滤只缩小选择向量，不移动元组数据。对外按选择向量的顺序访问：row(i)是第i个有效元组
+ */
+class DataChunk {
+   private:
+    size_t tuple_len_ = 0;       // 每个元组的长度
+    size_t size_ = 0;            // 已经写入的元组个数（含已被过滤掉的）
+    std::vector<char> data_;     // CHUNK_CAPACITY个元组的存储空间
+    std::vector<Rid> rids_;      // 每个元组的rid，不是直接来自表的元组为默认值
+    std::vector<uint16_t> sel_;  // 选择向量，有效元组在data_中的下标，递增
+
+   public:
+    DataChunk() = default;
+
+    explicit DataChunk(size_t tuple_len) { init(tuple_len); }
+
+    // 设置元组长度并分配空间，清空chunk
+    void init(size_t tuple_len) {
+        tuple_len_ = tuple_len;
+        data_.resize(tuple_len_ * CHUNK_CAPACITY);
+        rids_.resize(CHUNK_CAPACITY);
+        sel_.reserve(CHUNK_CAPACITY);
+        reset();
+    }
+
+    void reset() {
+        size_ = 0;
+        sel_.clear();
+    }
+
+    size_t tuple_len() const { return tuple_len_; }
+
+    bool is_full() const { return size_ == CHUNK_CAPACITY; }
+
+    // 有效元组的个数
+    size_t count() const { return sel_.size(); }
+
+    /**
+     * @brief 追加一个元组并返回它的存储位置，由调用者写入数据；新元组默认有效
+     */
+    char *append(const Rid &rid = Rid{-1, -1}) {
+        assert(size_ < CHUNK_CAPACITY);
+        rids_[size_] = rid;
+        sel_.push_back(static_cast<uint16_t>(size_));
+        return data_.data() + tuple_len_ * size_++;
+    }
+
+    char *row(size_t i) { return data_.data() + tuple_len_ * sel_[i]; }
+
+    const char *row(size_t i) const { return data_.data() + tuple_len_ * sel_[i]; }
+
+    const Rid &rid(size_t i) const { return rids_[sel_[i]]; }
+
+    /**
+     * @brief 只保留pred返回true的有效元组
+     * 无条件写入下标、按结果前进，循环内没有依赖数据的分支，选择率居中时不会频繁地分支预测失败
+     * @param pred 参数为元组数据的指针
+     */
+    template <typename F>
+    void filter(F &&pred) {
+        size_t n = 0;
+        const char *data = data_.data();
+        for (uint16_t idx : sel_) {
+            sel_[n] = idx;
+            n += pred(data + tuple_len_ * idx) ? 1 : 0;
+        }
+        sel_.resize(n);
+    }
+};
@@ -0,0 +1,177 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/common.h"
+#include "index/ix.h"
+#include "system/sm_meta.h"
+
+/**
+ * 一组聚集函数的计算，供各种聚集算子共用
+ * 每组的状态是一段连续的state_len()字节，依次存放各个聚集函数的状态：
+ * COUNT为int64计数；SUM为int64或double的和；AVG为double的和加int64计数；MIN/MAX为一字节的标记加字段值。
+ * 状态不保证对齐，统一用memcpy读写。
+ * 输出字段：COUNT为int，SUM与输入字段类型相同，AVG为float，MIN/MAX与输入字段相同
+ */
+class AggregateFunctions {
+   private:
+    /* 一个聚集函数 */
+    struct Func {
+        AggType type;
+        ColType in_type;    // 输入字段的类型，COUNT(*)时不使用
+        int in_offset;      // 输入字段在元组中的偏移
+        int in_len;
+        int state_offset;   // 状态在一组状态中的偏移
+        ColMeta out;        // 输出字段
+    };
+
+    std::vector<Func> funcs_;
+    std::vector<ColMeta> cols_;  // 输出字段
+    size_t state_len_ = 0;
+
+   public:
+    AggregateFunctions() = default;
+
+    /**
+     * @param in_cols 输入元组的字段
+     * @param out_offset 第一个输出字段在输出元组中的偏移，之后的输出字段依次紧接着存放
+     */
+    AggregateFunctions(const std::vector<AggExpr> &aggs, const std::vector<ColMeta> &in_cols, int out_offset) {
+        for (const auto &agg : aggs) {
+            Func func = {.type = agg.type, .in_type = TYPE_INT, .in_offset = 0, .in_len = 0,
+                         .state_offset = static_cast<int>(state_len_), .out = ColMeta()};
+            if (agg.col.col_name != "*") {
+                auto in_col = std::find_if(in_cols.begin(), in_cols.end(), [&](const ColMeta &col) {
+                    return col.tab_name == agg.col.tab_name && col.name == agg.col.col_name;
+                });
+                if (in_col == in_cols.end()) {
+                    throw ColumnNotFoundError(agg.col.tab_name + '.' + agg.col.col_name);
+                }
+                func.in_type = in_col->type;
+                func.in_offset = in_col->offset;
+                func.in_len = in_col->len;
+            }
+            ColType out_type = func.in_type;
+            int out_len = func.in_len;
+            switch (agg.type) {
+                case AGG_COUNT:
+                    state_len_ += sizeof(int64_t);
+                    out_type = TYPE_INT;
+                    out_len = sizeof(int);
+                    break;
+                case AGG_SUM:
+                    state_len_ += sizeof(int64_t);
+                    break;
+                case AGG_AVG:
+                    state_len_ += sizeof(double) + sizeof(int64_t);
+                    out_type = TYPE_FLOAT;
+                    out_len = sizeof(float);
+                    break;
+                case AGG_MIN:
+                case AGG_MAX:
+                    state_len_ += 1 + func.in_len;
+                    break;
+            }
+            func.out = {.tab_name = "", .name = agg.name, .type = out_type, .len = out_len, .offset = out_offset,
+                        .index = false};
+            out_offset += out_len;
+            cols_.push_back(func.out);
+            funcs_.push_back(func);
+        }
+    }
+
+    size_t state_len() const { return state_len_; }
+
+    const std::vector<ColMeta> &cols() const { return cols_; }
+
+    // 初始化一组的状态，对应没有任何输入元组
+    void init(char *state) const { memset(state, 0, state_len_); }
+
+    // 把一个输入元组累加到一组的状态上
+    void update(char *state, const char *rec) const {
+        for (const auto &func : funcs_) {
+            char *s = state + func.state_offset;
+            const char *val = rec + func.in_offset;
+            switch (func.type) {
+                case AGG_COUNT:
+                    store<int64_t>(s, load<int64_t>(s) + 1);
+                    break;
+                case AGG_SUM:
+                    if (func.in_type == TYPE_INT) {
+                        store<int64_t>(s, load<int64_t>(s) + load<int>(val));
+                    } else {
+                        store<double>(s, load<double>(s) + load<float>(val));
+                    }
+                    break;
+                case AGG_AVG:
+                    store<double>(s, load<double>(s) + as_double(val, func.in_type));
+                    store<int64_t>(s + sizeof(double), load<int64_t>(s + sizeof(double)) + 1);
+                    break;
+                case AGG_MIN:
+                case AGG_MAX: {
+                    int cmp = s[0] == 0 ? 0 : ix_compare(val, s + 1, func.in_type, func.in_len);
+                    if (s[0] == 0 || (func.type == AGG_MIN ? cmp < 0 : cmp > 0)) {
+                        s[0] = 1;
+                        memcpy(s + 1, val, func.in_len);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // 把一组的状态转换成输出字段，写到输出元组out中各个输出字段的偏移处
+    void finalize(const char *state, char *out) const {
+        for (const auto &func : funcs_) {
+            const char *s = state + func.state_offset;
+            char *dest = out + func.out.offset;
+            switch (func.type) {
+                case AGG_COUNT:
+                    store<int>(dest, static_cast<int>(load<int64_t>(s)));
+                    break;
+                case AGG_SUM:
+                    if (func.in_type == TYPE_INT) {
+                        store<int>(dest, static_cast<int>(load<int64_t>(s)));
+                    } else {
+                        store<float>(dest, static_cast<float>(load<double>(s)));
+                    }
+                    break;
+                case AGG_AVG: {
+                    int64_t count = load<int64_t>(s + sizeof(double));
+                    store<float>(dest, count == 0 ? 0.0f : static_cast<float>(load<double>(s) / count));
+                    break;
+                }
+                case AGG_MIN:
+                case AGG_MAX:
+                    // 没有输入元组时输出0或空字符串
+                    memcpy(dest, s + 1, func.in_len);
+                    break;
+            }
+        }
+    }
+
+   private:
+    template <typename T>
+    static T load(const char *src) {
+        T val;
+        memcpy(&val, src, sizeof(T));
+        return val;
+    }
+
+    template <typename T>
+    static void store(char *dest, T val) {
+        memcpy(dest, &val, sizeof(T));
+    }
+
+    static double as_double(const char *val, ColType type) {
+        return type == TYPE_INT ? load<int>(val) : load<float>(val);
+    }
+};
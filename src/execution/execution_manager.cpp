@@ -25,8 +25,10 @@ const char *help_info = "Supported SQL syntax:\n"
                    "command:\n"
                    "  CREATE TABLE table_name (column_name type [, column_name type ...])\n"
                    "  DROP TABLE table_name\n"
-                   "  CREATE INDEX table_name (column_name)\n"
+                   "  CREATE [UNIQUE] INDEX table_name (column_name) [USING {BTREE | BLINK}]\n"
                    "  DROP INDEX table_name (column_name)\n"
+                   "  ALTER INDEX table_name (column_name) REBUILD\n"
+                   "  ALTER INDEX table_name (column_name) SET BLOOM {ON | OFF}\n"
                    "  INSERT INTO table_name VALUES (value [, value ...])\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
@@ -63,7 +65,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
             }
             case T_CreateIndex:
             {
-                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context);
+                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, x->index_type_, x->unique_);
                 context->lock_mgr_->lock_exclusive_on_table(context->txn_, sm_manager_->fhs_[x->tab_name_]->GetFd());
                 break;
             }
@@ -73,6 +75,36 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
                 sm_manager_->drop_index(x->tab_name_, x->tab_col_names_, context);
                 break;
             }
+            case T_AnalyzeIndex:
+            {
+                // 采样时只持有结点的读锁，不阻塞表上的读写，意向锁只用来防止索引在此期间被删除
+                if (!sm_manager_->db_.is_table(x->tab_name_)) {
+                    throw TableNotFoundError(x->tab_name_);
+                }
+                context->lock_mgr_->lock_IS_on_table(context->txn_, sm_manager_->fhs_[x->tab_name_]->GetFd());
+                sm_manager_->analyze_index(x->tab_name_, x->tab_col_names_, context);
+                break;
+            }
+            case T_RebuildIndex:
+            {
+                // 装载期间只持有意向锁，替换索引之前在rebuild_index中升级为排他锁
+                if (!sm_manager_->db_.is_table(x->tab_name_)) {
+                    throw TableNotFoundError(x->tab_name_);
+                }
+                context->lock_mgr_->lock_IS_on_table(context->txn_, sm_manager_->fhs_[x->tab_name_]->GetFd());
+                sm_manager_->rebuild_index(x->tab_name_, x->tab_col_names_, context);
+                break;
+            }
+            case T_SetIndexBloom:
+            {
+                // 只修改索引文件头中的设置，filter在内存中构建，意向锁只用来防止索引在此期间被删除
+                if (!sm_manager_->db_.is_table(x->tab_name_)) {
+                    throw TableNotFoundError(x->tab_name_);
+                }
+                context->lock_mgr_->lock_IS_on_table(context->txn_, sm_manager_->fhs_[x->tab_name_]->GetFd());
+                sm_manager_->set_index_bloom(x->tab_name_, x->tab_col_names_, x->enabled_, context);
+                break;
+            }
             default:
                 throw InternalError("Unexpected field type");
                 break;  
@@ -100,6 +132,16 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->desc_table(x->tab_name_, context);
                 break;
             }
+            case T_ShowIndexStats:
+            {
+                sm_manager_->show_index_stats(x->tab_name_, context);
+                break;
+            }
+            case T_ShowBloomStats:
+            {
+                sm_manager_->show_bloom_stats(x->tab_name_, context);
+                break;
+            }
             case T_Transaction_begin:
             {
                 // 显示开启一个事务
@@ -157,32 +199,36 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
 
     // Print records
     size_t num_rec = 0;
-    // 执行query_plan
-    for (executorTreeRoot->beginTuple(); !executorTreeRoot->is_end(); executorTreeRoot->nextTuple()) {
-        auto Tuple = executorTreeRoot->Next();
-        std::vector<std::string> columns;
-        for (auto &col : executorTreeRoot->cols()) {
-            std::string col_str;
-            char *rec_buf = Tuple->data + col.offset;
-            if (col.type == TYPE_INT) {
-                col_str = std::to_string(*(int *)rec_buf);
-            } else if (col.type == TYPE_FLOAT) {
-                col_str = std::to_string(*(float *)rec_buf);
-            } else if (col.type == TYPE_STRING) {
-                col_str = std::string((char *)rec_buf, col.len);
-                col_str.resize(strlen(col_str.c_str()));
+    // 执行query_plan，按批取出结果
+    DataChunk chunk;
+    auto &cols = executorTreeRoot->cols();
+    for (executorTreeRoot->beginBatch(); executorTreeRoot->NextBatch(chunk);) {
+        for (size_t i = 0; i < chunk.count(); i++) {
+            const char *tuple = chunk.row(i);
+            std::vector<std::string> columns;
+            for (auto &col : cols) {
+                std::string col_str;
+                const char *rec_buf = tuple + col.offset;
+                if (col.type == TYPE_INT) {
+                    col_str = std::to_string(*(int *)rec_buf);
+                } else if (col.type == TYPE_FLOAT) {
+                    col_str = std::to_string(*(float *)rec_buf);
+                } else if (col.type == TYPE_STRING) {
+                    col_str = std::string(rec_buf, col.len);
+                    col_str.resize(strlen(col_str.c_str()));
+                }
+                columns.push_back(col_str);
             }
-            columns.push_back(col_str);
-        }
-        // print record into buffer
-        rec_printer.print_record(columns, context);
-        // print record into file
-        outfile << "|";
-        for(size_t i = 0; i < columns.size(); ++i) {
-            outfile << " " << columns[i] << " |";
+            // print record into buffer
+            rec_printer.print_record(columns, context);
+            // print record into file
+            outfile << "|";
+            for(size_t j = 0; j < columns.size(); ++j) {
+                outfile << " " << columns[j] << " |";
+            }
+            outfile << "\n";
+            num_rec++;
         }
-        outfile << "\n";
-        num_rec++;
     }
     outfile.close();
     // Print footer into buffer
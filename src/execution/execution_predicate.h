@@ -0,0 +1,227 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "common/common.h"
+#include "data_chunk.h"
+#include "errors.h"
+#include "system/sm_meta.h"
+
+/**
+ * 编译后的谓词（若干条件的合取）
+ * 构造时把条件中的字段名解析成元组内的偏移，并按字段类型和比较运算符选定比较函数，
+ * 之后每个元组的求值只剩按偏移取值和一次比较，不再按名字查找字段，也不再按类型分支。
+ * 连接算子的元组由左右两部分组成：偏移不小于split的字段属于右边的元组，求值时分别传入左右元组
+ */
+class CompiledPredicate {
+   private:
+    using CmpFunc = bool (*)(const char *lhs, const char *rhs, int len);
+
+    struct Term;
+    using FilterFunc = void (*)(const Term &term, DataChunk &chunk);
+
+    struct Term {
+        int lhs_side;         // 左边字段所在的元组，0为左边，1为右边
+        int lhs_offset;       // 左边字段在所在元组中的偏移
+        int rhs_side;         // 右边是字段时，该字段所在的元组
+        int rhs_offset;       // 右边是字段时，该字段在所在元组中的偏移
+        const char *rhs_val;  // 右边是常量时指向常量的数据，否则为nullptr
+        int len;              // 比较的长度，只对字符串有意义
+        CmpFunc cmp;          // 按字段类型和运算符选定的比较函数
+        FilterFunc filter;    // 批量过滤一个chunk的函数
+    };
+
+    std::vector<Term> terms_;
+    std::vector<std::shared_ptr<RmRecord>> consts_;  // 持有常量的数据，保证rhs_val一直有效
+
+   public:
+    CompiledPredicate() = default;
+
+    /**
+     * @param conds 条件，条件之间是合取关系
+     * @param cols 元组的字段，条件中的字段都必须在其中
+     * @param split 连接时左边元组的长度，偏移不小于split的字段来自右边的元组；单个元组时使用默认值
+     */
+    CompiledPredicate(const std::vector<Condition> &conds, const std::vector<ColMeta> &cols, int split = INT_MAX) {
+        for (auto &cond : conds) {
+            auto lhs_col = find_col(cols, cond.lhs_col);
+            Term term{};
+            std::tie(term.lhs_side, term.lhs_offset) = locate(lhs_col->offset, split);
+            if (cond.is_rhs_val) {
+                term.rhs_val = cond.rhs_val.raw->data;
+                consts_.push_back(cond.rhs_val.raw);
+            } else {
+                std::tie(term.rhs_side, term.rhs_offset) = locate(find_col(cols, cond.rhs_col)->offset, split);
+            }
+            term.len = lhs_col->len;
+            switch (lhs_col->type) {
+                case TYPE_INT:
+                    std::tie(term.cmp, term.filter) = select<int>(cond.op);
+                    break;
+                case TYPE_FLOAT:
+                    std::tie(term.cmp, term.filter) = select<float>(cond.op);
+                    break;
+                case TYPE_STRING:
+                    term.cmp = select_string(cond.op);
+                    term.filter = filter_generic;
+                    break;
+                default:
+                    throw InternalError("Unexpected data type");
+            }
+            if (!cond.is_rhs_val) {
+                term.filter = filter_generic;
+            }
+            terms_.push_back(term);
+        }
+    }
+
+    bool empty() const { return terms_.empty(); }
+
+    // 判断单个元组是否满足所有条件
+    bool eval(const char *rec) const { return eval(rec, nullptr); }
+
+    // 判断由left和right拼接成的元组是否满足所有条件
+    bool eval(const char *left, const char *right) const {
+        const char *recs[2] = {left, right};
+        for (auto &term : terms_) {
+            const char *rhs = term.rhs_val != nullptr ? term.rhs_val : recs[term.rhs_side] + term.rhs_offset;
+            if (!term.cmp(recs[term.lhs_side] + term.lhs_offset, rhs, term.len)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 批量过滤：逐个条件地在chunk的所有有效元组上求值，缩小选择向量。
+     * 数值字段与常量比较时，常量、偏移和运算符都是编译期确定的，内层循环没有间接调用和分支
+     */
+    void filter(DataChunk &chunk) const {
+        for (auto &term : terms_) {
+            if (chunk.count() == 0) {
+                return;
+            }
+            term.filter(term, chunk);
+        }
+    }
+
+   private:
+    static std::vector<ColMeta>::const_iterator find_col(const std::vector<ColMeta> &cols, const TabCol &target) {
+        auto pos = std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) {
+            return col.tab_name == target.tab_name && col.name == target.col_name;
+        });
+        if (pos == cols.end()) {
+            throw ColumnNotFoundError(target.tab_name + '.' + target.col_name);
+        }
+        return pos;
+    }
+
+    static std::pair<int, int> locate(int offset, int split) {
+        return offset < split ? std::make_pair(0, offset) : std::make_pair(1, offset - split);
+    }
+
+    template <CompOp op, typename T>
+    static bool compare(T a, T b) {
+        if constexpr (op == OP_EQ) {
+            return a == b;
+        } else if constexpr (op == OP_NE) {
+            return a != b;
+        } else if constexpr (op == OP_LT) {
+            return a < b;
+        } else if constexpr (op == OP_GT) {
+            return a > b;
+        } else if constexpr (op == OP_LE) {
+            return a <= b;
+        } else {
+            return a >= b;
+        }
+    }
+
+    template <typename T>
+    static T load(const char *data) {
+        T val;
+        memcpy(&val, data, sizeof(T));
+        return val;
+    }
+
+    template <typename T, CompOp op>
+    static bool cmp_value(const char *lhs, const char *rhs, int) {
+        return compare<op>(load<T>(lhs), load<T>(rhs));
+    }
+
+    template <CompOp op>
+    static bool cmp_string(const char *lhs, const char *rhs, int len) {
+        return compare<op>(memcmp(lhs, rhs, len), 0);
+    }
+
+    // 数值字段与常量比较的过滤函数，常量先取出来，循环内只按偏移读字段
+    template <typename T, CompOp op>
+    static void filter_const(const Term &term, DataChunk &chunk) {
+        T val = load<T>(term.rhs_val);
+        int offset = term.lhs_offset;
+        chunk.filter([val, offset](const char *rec) { return compare<op>(load<T>(rec + offset), val); });
+    }
+
+    // 其余情况（字符串、字段与字段比较）通过比较函数过滤，批量过滤只用于单个元组，字段都在左边
+    static void filter_generic(const Term &term, DataChunk &chunk) {
+        chunk.filter([&term](const char *rec) {
+            const char *rhs = term.rhs_val != nullptr ? term.rhs_val : rec + term.rhs_offset;
+            return term.cmp(rec + term.lhs_offset, rhs, term.len);
+        });
+    }
+
+    template <typename T>
+    static std::pair<CmpFunc, FilterFunc> select(CompOp op) {
+        switch (op) {
+            case OP_EQ:
+                return {cmp_value<T, OP_EQ>, filter_const<T, OP_EQ>};
+            case OP_NE:
+                return {cmp_value<T, OP_NE>, filter_const<T, OP_NE>};
+            case OP_LT:
+                return {cmp_value<T, OP_LT>, filter_const<T, OP_LT>};
+            case OP_GT:
+                return {cmp_value<T, OP_GT>, filter_const<T, OP_GT>};
+            case OP_LE:
+                return {cmp_value<T, OP_LE>, filter_const<T, OP_LE>};
+            case OP_GE:
+                return {cmp_value<T, OP_GE>, filter_const<T, OP_GE>};
+            default:
+                throw InternalError("Unexpected op type");
+        }
+    }
+
+    static CmpFunc select_string(CompOp op) {
+        switch (op) {
+            case OP_EQ:
+                return cmp_string<OP_EQ>;
+            case OP_NE:
+                return cmp_string<OP_NE>;
+            case OP_LT:
+                return cmp_string<OP_LT>;
+            case OP_GT:
+                return cmp_string<OP_GT>;
+            case OP_LE:
+                return cmp_string<OP_LE>;
+            case OP_GE:
+                return cmp_string<OP_GE>;
+            default:
+                throw InternalError("Unexpected op type");
+        }
+    }
+};
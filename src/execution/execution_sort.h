@@ -9,41 +9,453 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+
+#include <deque>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
 #include "index/ix.h"
+#include "spill_file.h"
 #include "system/sm.h"
 
-class SortExecutor : public AbstractExecutor {
+/**
+ * 排序key的规范化编码：整数和浮点数转成大端序的无符号数，字符串保持原样，DESC的字段按位取反，
+ * 多个字段依次拼接之后，按排序字段的比较就是一次memcmp
+ */
+class SortKeyEncoder {
+   private:
+    /* 一个排序字段 */
+    struct KeyCol {
+        int offset;  // 字段在元组中的偏移
+        ColType type;
+        int len;
+        bool is_desc;
+    };
+
+    std::vector<KeyCol> keys_;
+    size_t key_len_ = 0;
+
+   public:
+    SortKeyEncoder() = default;
+
+    /**
+     * @param key_cols 排序字段，依次比较
+     * @param is_descs 每个排序字段是否降序
+     */
+    SortKeyEncoder(const std::vector<ColMeta> &key_cols, const std::vector<bool> &is_descs) {
+        for (size_t i = 0; i < key_cols.size(); i++) {
+            keys_.push_back({key_cols[i].offset, key_cols[i].type, key_cols[i].len, is_descs[i]});
+            key_len_ += key_cols[i].len;
+        }
+    }
+
+    size_t key_len() const { return key_len_; }
+
+    // 把元组的排序key编码到dest，dest的长度为key_len()
+    void encode(const char *tuple, char *dest) const {
+        unsigned char *key = reinterpret_cast<unsigned char *>(dest);
+        for (const auto &col : keys_) {
+            const char *val = tuple + col.offset;
+            switch (col.type) {
+                case TYPE_INT: {
+                    uint32_t bits = static_cast<uint32_t>(*reinterpret_cast<const int *>(val)) ^ 0x80000000u;
+                    store_big_endian(key, bits);
+                    break;
+                }
+                case TYPE_FLOAT: {
+                    float f = *reinterpret_cast<const float *>(val);
+                    uint32_t bits = 0;
+                    if (f != 0) {  // +0和-0相等
+                        memcpy(&bits, &f, sizeof(bits));
+                        bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+                    } else {
+                        bits = 0x80000000u;
+                    }
+                    store_big_endian(key, bits);
+                    break;
+                }
+                case TYPE_STRING:
+                    memcpy(key, val, col.len);
+                    break;
+            }
+            if (col.is_desc) {
+                for (int i = 0; i < col.len; i++) {
+                    key[i] = ~key[i];
+                }
+            }
+            key += col.len;
+        }
+    }
+
+   private:
+    static void store_big_endian(unsigned char *dest, uint32_t bits) {
+        dest[0] = static_cast<unsigned char>(bits >> 24);
+        dest[1] = static_cast<unsigned char>(bits >> 16);
+        dest[2] = static_cast<unsigned char>(bits >> 8);
+        dest[3] = static_cast<unsigned char>(bits);
+    }
+};
+
+/**
+ * 用败者树对若干个有序的run做k路归并
+ * run中的每一行是规范化的排序key加上元组，key可以直接用memcmp比较
+ */
+class SortMerger {
    private:
+    /* 一个run的读取位置 */
+    struct Source {
+        std::shared_ptr<SpillFile> file;
+        DataChunk chunk;
+        size_t pos = 0;
+        bool done = false;
+
+        const char *row() const { return chunk.row(pos); }
+    };
+
+    size_t key_len_;
+    std::vector<Source> sources_;
+    std::vector<int> tree_;  // tree_[0]为当前最小的run，tree_[1..k-1]为每个内部结点上的败者
+
+   public:
+    SortMerger(std::vector<std::shared_ptr<SpillFile>> runs, size_t key_len) : key_len_(key_len) {
+        sources_.resize(runs.size());
+        for (size_t i = 0; i < runs.size(); i++) {
+            sources_[i].file = std::move(runs[i]);
+            sources_[i].done = !sources_[i].file->read(sources_[i].chunk);
+        }
+        // 从后往前依次加入每个run，先到达内部结点的一方停在结点上，后到达的一方与它比较，胜者继续向上
+        int k = static_cast<int>(sources_.size());
+        tree_.assign(std::max(k, 1), -1);
+        for (int i = k - 1; i >= 0; i--) {
+            adjust(i);
+        }
+    }
+
+    // 当前最小的一行，所有run都读完时返回nullptr
+    const char *top() const {
+        const Source &source = sources_[tree_[0]];
+        return source.done ? nullptr : source.row();
+    }
+
+    // 取走当前最小的一行
+    void pop() {
+        int s = tree_[0];
+        Source &source = sources_[s];
+        if (++source.pos == source.chunk.count()) {
+            source.pos = 0;
+            source.done = !source.file->read(source.chunk);
+            if (source.done) {
+                source.file.reset();  // 读完的run立即删除临时文件
+            }
+        }
+        adjust(s);
+    }
+
+   private:
+    // run a的当前行是否小于run b的当前行，读完的run最大，相等时按编号保证结果确定
+    bool less(int a, int b) const {
+        const Source &x = sources_[a];
+        const Source &y = sources_[b];
+        if (x.done || y.done) {
+            return !x.done && y.done ? true : (x.done == y.done && a < b);
+        }
+        int cmp = memcmp(x.row(), y.row(), key_len_);
+        return cmp != 0 ? cmp < 0 : a < b;
+    }
+
+    // run s的当前行变化之后，从叶子到根重新比较
+    void adjust(int s) {
+        int k = static_cast<int>(sources_.size());
+        for (int t = (s + k) / 2; t > 0; t /= 2) {
+            if (tree_[t] == -1) {
+                tree_[t] = s;
+                return;
+            }
+            if (less(tree_[t], s)) {
+                std::swap(s, tree_[t]);
+            }
+        }
+        tree_[0] = s;
+    }
+};
+
+/**
+ * 外部归并排序，支持多个排序字段，每个字段可以分别指定ASC或DESC
+ * 每个元组前面加上规范化的排序key（见SortKeyEncoder）。内存中排序的是(key的前8个字节, 行指针)，
+ * 大多数比较只比较整数而不访问行。
+ * 输入超过内存上限时把已经排好序的一批写到临时文件中作为一个run，最后用败者树k路归并所有run；
+ * run太多、归并时每个run的缓冲区放不进内存时先归并一部分，直到剩下的run可以一次归并完
+ */
+class SortExecutor : public BatchExecutor {
+   private:
+    /* 内存中排序的一行 */
+    struct SortEntry {
+        uint64_t prefix;  // key的前8个字节按大端序组成的整数
+        const char *row;  // 行在arena_中的位置
+    };
+
     std::unique_ptr<AbstractExecutor> prev_;
-    ColMeta cols_;                              // 框架中只支持一个键排序，需要自行修改数据结构支持多个键排序
-    size_t tuple_num;
-    bool is_desc_;
-    std::vector<size_t> used_tuple;
-    std::unique_ptr<RmRecord> current_tuple;
+    DiskManager *disk_manager_;  // 用于读写临时文件
+    size_t mem_budget_;          // 排序在内存中最多占用的字节数
+    SortKeyEncoder encoder_;
+    size_t tuple_len_;
+    size_t key_len_;             // 规范化的排序key的长度
+    size_t row_len_;             // 一行的长度，key在前，元组在后
+    size_t run_capacity_;        // 内存中一次最多排序的行数
+
+    std::vector<char> arena_;                       // 内存中的行
+    size_t num_rows_ = 0;                           // arena_中的行数
+    std::vector<SortEntry> entries_;                // 排好序的行
+    size_t entry_pos_ = 0;                          // 全部在内存中排序时下一个输出的行
+    std::deque<std::shared_ptr<SpillFile>> runs_;   // 写到磁盘上的run
+    std::unique_ptr<SortMerger> merger_;            // 有run时归并输出
 
    public:
-    SortExecutor(std::unique_ptr<AbstractExecutor> prev, TabCol sel_cols, bool is_desc) {
+    /**
+     * @param sel_cols 排序字段，依次比较
+     * @param is_descs 每个排序字段是否降序
+     * @param mem_budget 排序在内存中最多占用的字节数，超过时把排好序的run写到磁盘上
+     */
+    SortExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols,
+                 const std::vector<bool> &is_descs, size_t mem_budget = QUERY_MEMORY_BUDGET) {
+        disk_manager_ = sm_manager->get_disk_manager();
+        mem_budget_ = mem_budget;
         prev_ = std::move(prev);
-        cols_ = prev_->get_col_offset(sel_cols);
-        is_desc_ = is_desc;
-        tuple_num = 0;
-        used_tuple.clear();
+        tuple_len_ = prev_->tupleLen();
+        std::vector<ColMeta> key_cols;
+        for (const auto &sel_col : sel_cols) {
+            key_cols.push_back(*get_col(prev_->cols(), sel_col));
+        }
+        encoder_ = SortKeyEncoder(key_cols, is_descs);
+        key_len_ = encoder_.key_len();
+        row_len_ = key_len_ + tuple_len_;
+        run_capacity_ = std::max(mem_budget_ / (row_len_ + sizeof(SortEntry)), CHUNK_CAPACITY);
     }
 
-    void beginTuple() override { 
-        
+    /**
+     * @brief 读完儿子节点的全部元组：每次内存满时排序并写出一个run，最后剩下的行放不下时同样写出
+     */
+    void beginBatch() override {
+        num_rows_ = 0;
+        entries_.clear();
+        entry_pos_ = 0;
+        runs_.clear();
+        merger_.reset();
+
+        DataChunk chunk;
+        for (prev_->beginBatch(); prev_->NextBatch(chunk);) {
+            for (size_t i = 0; i < chunk.count(); i++) {
+                if (num_rows_ == run_capacity_) {
+                    sort_rows();
+                    spill_run();
+                }
+                append_row(chunk.row(i));
+            }
+        }
+        sort_rows();
+        if (runs_.empty()) {
+            return;
+        }
+        spill_run();
+        arena_.clear();
+        arena_.shrink_to_fit();
+        entries_.clear();
+        entries_.shrink_to_fit();
+
+        // 归并时每个run需要一块读缓冲区和一个chunk
+        size_t run_mem = 16 * PAGE_SIZE + CHUNK_CAPACITY * row_len_;
+        size_t max_fanin = std::max<size_t>(mem_budget_ / run_mem, 2);
+        while (runs_.size() > max_fanin) {
+            std::vector<std::shared_ptr<SpillFile>> group(runs_.begin(), runs_.begin() + max_fanin);
+            runs_.erase(runs_.begin(), runs_.begin() + max_fanin);
+            SortMerger merger(std::move(group), key_len_);
+            auto run = std::make_shared<SpillFile>(disk_manager_, row_len_);
+            for (const char *row; (row = merger.top()) != nullptr; merger.pop()) {
+                run->append(row);
+            }
+            run->finish();
+            runs_.push_back(std::move(run));
+        }
+        merger_ = std::make_unique<SortMerger>(std::vector<std::shared_ptr<SpillFile>>(runs_.begin(), runs_.end()),
+                                               key_len_);
+        runs_.clear();
     }
 
-    void nextTuple() override {
-        
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(tuple_len_);
+        if (merger_ != nullptr) {
+            for (const char *row; !chunk.is_full() && (row = merger_->top()) != nullptr; merger_->pop()) {
+                memcpy(chunk.append(), row + key_len_, tuple_len_);
+            }
+        } else {
+            for (; !chunk.is_full() && entry_pos_ < entries_.size(); entry_pos_++) {
+                memcpy(chunk.append(), entries_[entry_pos_].row + key_len_, tuple_len_);
+            }
+        }
+        return chunk.count() > 0;
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+    size_t tupleLen() const override { return tuple_len_; }
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
+
+   private:
+    // 在arena_末尾加入一行：先写规范化的key，再复制元组
+    void append_row(const char *tuple) {
+        if (arena_.size() < (num_rows_ + 1) * row_len_) {
+            size_t rows = std::min(run_capacity_, std::max(num_rows_ * 2, CHUNK_CAPACITY));
+            arena_.resize(rows * row_len_);
+        }
+        char *row = arena_.data() + num_rows_++ * row_len_;
+        encoder_.encode(tuple, row);
+        memcpy(row + key_len_, tuple, tuple_len_);
     }
 
-    Rid &rid() override { return _abstract_rid; }
-};
\ No newline at end of file
+    // 对arena_中的行排序，结果放在entries_中
+    void sort_rows() {
+        entries_.resize(num_rows_);
+        size_t prefix_len = std::min<size_t>(key_len_, sizeof(uint64_t));
+        for (size_t i = 0; i < num_rows_; i++) {
+            const char *row = arena_.data() + i * row_len_;
+            uint64_t prefix = 0;
+            for (size_t j = 0; j < prefix_len; j++) {
+                prefix = prefix << 8 | static_cast<unsigned char>(row[j]);
+            }
+            entries_[i] = {prefix << (sizeof(uint64_t) - prefix_len) * 8, row};
+        }
+        if (key_len_ <= sizeof(uint64_t)) {
+            std::sort(entries_.begin(), entries_.end(),
+                      [](const SortEntry &a, const SortEntry &b) { return a.prefix < b.prefix; });
+        } else {
+            size_t rest_len = key_len_ - sizeof(uint64_t);
+            std::sort(entries_.begin(), entries_.end(), [rest_len](const SortEntry &a, const SortEntry &b) {
+                if (a.prefix != b.prefix) {
+                    return a.prefix < b.prefix;
+                }
+                return memcmp(a.row + sizeof(uint64_t), b.row + sizeof(uint64_t), rest_len) < 0;
+            });
+        }
+        entry_pos_ = 0;
+    }
+
+    // 把排好序的行写到一个新的run，清空内存中的行
+    void spill_run() {
+        auto run = std::make_shared<SpillFile>(disk_manager_, row_len_);
+        for (const auto &entry : entries_) {
+            run->append(entry.row);
+        }
+        run->finish();
+        runs_.push_back(std::move(run));
+        num_rows_ = 0;
+        entries_.clear();
+    }
+};
+
+/**
+ * ORDER BY ... LIMIT的Top-N排序：只保留排在最前面的offset + limit个元组
+ * 用最大堆维护目前为止最小的N行（按规范化的key比较），新元组的key小于堆顶时替换堆顶，否则只编码key就丢弃；
+ * 输入读完之后对这N行排序，跳过前offset行输出。占用的内存只与N有关，与输入的元组数无关
+ */
+class TopNExecutor : public BatchExecutor {
+   private:
+    std::unique_ptr<AbstractExecutor> prev_;
+    SortKeyEncoder encoder_;
+    size_t tuple_len_;
+    size_t key_len_;              // 规范化的排序key的长度
+    size_t row_len_;              // 一行的长度，key在前，元组在后
+    size_t limit_;
+    size_t offset_;
+
+    std::vector<char> rows_;      // 保留的行
+    std::vector<uint32_t> heap_;  // rows_中行的下标，按key组成最大堆；输入读完后按key升序排列
+    std::vector<char> key_buf_;   // 正在处理的元组的key
+    size_t out_pos_ = 0;          // heap_中下一个输出的行
+
+   public:
+    /**
+     * @param sel_cols 排序字段，依次比较
+     * @param is_descs 每个排序字段是否降序
+     * @param limit 最多输出的元组数
+     * @param offset 输出之前跳过的元组数
+     */
+    TopNExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols,
+                 const std::vector<bool> &is_descs, size_t limit, size_t offset) {
+        prev_ = std::move(prev);
+        tuple_len_ = prev_->tupleLen();
+        std::vector<ColMeta> key_cols;
+        for (const auto &sel_col : sel_cols) {
+            key_cols.push_back(*get_col(prev_->cols(), sel_col));
+        }
+        encoder_ = SortKeyEncoder(key_cols, is_descs);
+        key_len_ = encoder_.key_len();
+        row_len_ = key_len_ + tuple_len_;
+        limit_ = limit;
+        offset_ = offset;
+        key_buf_.resize(key_len_);
+    }
+
+    /**
+     * @brief 保留n个元组时占用的内存是否在上限之内，key不会比元组长
+     */
+    static bool fits_in_memory(size_t n, size_t tuple_len) {
+        return n <= QUERY_MEMORY_BUDGET / (2 * tuple_len + sizeof(uint32_t));
+    }
+
+    /**
+     * @brief 读完儿子节点的全部元组，只在堆中保留最小的offset + limit行，最后排序
+     */
+    void beginBatch() override {
+        heap_.clear();
+        out_pos_ = 0;
+        size_t n = limit_ == 0 ? 0 : limit_ + offset_;
+        if (n == 0) {
+            return;
+        }
+        auto row_less = [this](uint32_t a, uint32_t b) { return memcmp(row(a), row(b), key_len_) < 0; };
+        DataChunk chunk;
+        for (prev_->beginBatch(); prev_->NextBatch(chunk);) {
+            for (size_t i = 0; i < chunk.count(); i++) {
+                const char *tuple = chunk.row(i);
+                if (heap_.size() < n) {
+                    uint32_t idx = static_cast<uint32_t>(heap_.size());
+                    if (rows_.size() < (idx + 1) * row_len_) {
+                        rows_.resize(std::min(n, std::max<size_t>(idx * 2, CHUNK_CAPACITY)) * row_len_);
+                    }
+                    encoder_.encode(tuple, row(idx));
+                    memcpy(row(idx) + key_len_, tuple, tuple_len_);
+                    heap_.push_back(idx);
+                    std::push_heap(heap_.begin(), heap_.end(), row_less);
+                    continue;
+                }
+                // 不小于堆顶的元组不会进入前n行，相等时保留先到的元组
+                encoder_.encode(tuple, key_buf_.data());
+                if (memcmp(key_buf_.data(), row(heap_.front()), key_len_) >= 0) {
+                    continue;
+                }
+                std::pop_heap(heap_.begin(), heap_.end(), row_less);
+                uint32_t idx = heap_.back();
+                memcpy(row(idx), key_buf_.data(), key_len_);
+                memcpy(row(idx) + key_len_, tuple, tuple_len_);
+                std::push_heap(heap_.begin(), heap_.end(), row_less);
+            }
+        }
+        std::sort_heap(heap_.begin(), heap_.end(), row_less);
+        out_pos_ = std::min(offset_, heap_.size());
+    }
+
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(tuple_len_);
+        for (; !chunk.is_full() && out_pos_ < heap_.size(); out_pos_++) {
+            memcpy(chunk.append(), row(heap_[out_pos_]) + key_len_, tuple_len_);
+        }
+        return chunk.count() > 0;
+    }
+
+    size_t tupleLen() const override { return tuple_len_; }
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
+
+   private:
+    char *row(uint32_t idx) { return rows_.data() + idx * row_len_; }
+};
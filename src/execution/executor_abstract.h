@@ -10,7 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 #include "common/common.h"
+#include "data_chunk.h"
 #include "execution_defs.h"
+#include "execution_predicate.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
@@ -41,6 +43,24 @@ class AbstractExecutor {
 
     virtual std::unique_ptr<RmRecord> Next() = 0;
 
+    /**
+     * @brief 批量接口：开始执行，之后反复调用NextBatch直到返回false；同一次执行不能混用批量接口和逐元组接口
+     * 默认实现适配逐元组接口，没有原生批量实现的算子也能作为批量算子的儿子节点
+     */
+    virtual void beginBatch() { beginTuple(); }
+
+    /**
+     * @brief 清空chunk并放入下一批元组，返回true时chunk中至少有一个有效元组，返回false表示已经没有元组
+     */
+    virtual bool NextBatch(DataChunk &chunk) {
+        chunk.init(tupleLen());
+        for (; !is_end() && !chunk.is_full(); nextTuple()) {
+            auto rec = Next();
+            memcpy(chunk.append(rid()), rec->data, tupleLen());
+        }
+        return chunk.count() > 0;
+    }
+
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta(); };
 
     std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
@@ -52,42 +72,48 @@ class AbstractExecutor {
         }
         return pos;
     }
+};
+
+/**
+ * 有原生批量实现的算子的基类：逐元组接口通过批量接口实现，每次取出一个chunk，在chunk中逐个移动
+ * 子类只需要实现beginBatch和NextBatch
+ */
+class BatchExecutor : public AbstractExecutor {
+   private:
+    DataChunk tuple_chunk_;  // 逐元组接口正在输出的chunk
+    size_t tuple_pos_ = 0;   // tuple_chunk_中当前的元组
+    bool tuple_end_ = true;
+    Rid tuple_rid_;
+
+   public:
+    void beginBatch() override = 0;
+
+    bool NextBatch(DataChunk &chunk) override = 0;
+
+    void beginTuple() override {
+        beginBatch();
+        tuple_end_ = !NextBatch(tuple_chunk_);
+        tuple_pos_ = 0;
+    }
 
-   protected:
-    template <typename F>
-    bool eval_conds(const std::vector<Condition> &conds, F &&get_values) {
-        for (auto &cond : conds) {
-            auto [lhs, rhs, type, len] = std::forward<F>(get_values)(cond);
-            if (!eval_cond(lhs, rhs, type, len, cond.op)) {
-                return false;
-            }
+    void nextTuple() override {
+        if (tuple_end_) {
+            return;
+        }
+        if (++tuple_pos_ == tuple_chunk_.count()) {
+            tuple_end_ = !NextBatch(tuple_chunk_);
+            tuple_pos_ = 0;
         }
-        return true;
     }
 
-    char *get_value(const std::vector<ColMeta> &rec_cols, const TabCol &target, const RmRecord *rec) {
-        auto pos = get_col(rec_cols, target);
-        return rec->data + pos->offset;
+    std::unique_ptr<RmRecord> Next() override {
+        return std::make_unique<RmRecord>(static_cast<int>(tupleLen()), tuple_chunk_.row(tuple_pos_));
     }
 
-   private:
-    bool eval_cond(const char *lhs, const char *rhs, ColType type, int len, const CompOp op) {
-        int cmp = ix_compare(lhs, rhs, type, len);
-        switch (op) {
-            case OP_EQ:
-                return cmp == 0;
-            case OP_NE:
-                return cmp != 0;
-            case OP_LT:
-                return cmp < 0;
-            case OP_GT:
-                return cmp > 0;
-            case OP_LE:
-                return cmp <= 0;
-            case OP_GE:
-                return cmp >= 0;
-            default:
-                throw InternalError("Unexpected op type");
-        }
+    bool is_end() const override { return tuple_end_; }
+
+    Rid &rid() override {
+        tuple_rid_ = tuple_chunk_.rid(tuple_pos_);
+        return tuple_rid_;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,155 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 块嵌套循环连接，用于不能hash的非等值连接
+ * 从左儿子取出不超过内存上限的一块元组，连续存放在block_中，然后把右儿子完整地扫描一遍，
+ * 右儿子的每个chunk与整块中的所有元组对计算连接条件；一块处理完再取左儿子的下一块。
+ * 右儿子扫描的次数是左儿子元组数除以块的大小，而不是左儿子的元组数
+ */
+class BlockNestedLoopJoinExecutor : public BatchExecutor {
+   private:
+    std::unique_ptr<AbstractExecutor> left_;   // 左儿子节点
+    std::unique_ptr<AbstractExecutor> right_;  // 右儿子节点
+    size_t left_len_;
+    size_t right_len_;
+    size_t len_;                               // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                // join后获得的记录的字段
+    std::vector<Condition> fed_conds_;         // join条件
+    CompiledPredicate pred_;                   // 由fed_conds_编译得到的谓词
+    size_t block_capacity_;                    // 一块最多容纳的左儿子元组数
+
+    std::vector<char> block_;      // 当前块中的左儿子元组
+    size_t block_rows_ = 0;        // 当前块中的元组数
+    DataChunk left_chunk_;         // 左儿子的chunk，一块装不下时剩下的元组留给下一块
+    size_t left_pos_ = 0;          // left_chunk_中下一个要放进块的元组
+    bool left_done_ = true;        // 左儿子已经取完
+    DataChunk right_chunk_;        // 正在与当前块连接的右儿子chunk
+    bool right_valid_ = false;     // right_chunk_中有未处理完的元组对
+    bool right_empty_ = false;     // 右儿子为空，不必再取左儿子
+    size_t pair_pos_ = 0;          // 下一个要检查的元组对，块中元组下标 * 右chunk元组数 + 右chunk元组下标
+
+   public:
+    /**
+     * @param mem_budget 一块左儿子元组最多占用的字节数，至少容纳一个chunk
+     */
+    BlockNestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                                std::vector<Condition> conds, size_t mem_budget = QUERY_MEMORY_BUDGET) {
+        left_ = std::move(left);
+        right_ = std::move(right);
+        left_len_ = left_->tupleLen();
+        right_len_ = right_->tupleLen();
+        len_ = left_len_ + right_len_;
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_len_;
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_, left_len_);
+        block_capacity_ = std::max(mem_budget / left_len_, CHUNK_CAPACITY);
+    }
+
+    void beginBatch() override {
+        left_->beginBatch();
+        left_chunk_.init(left_len_);
+        left_pos_ = 0;
+        left_done_ = false;
+        right_empty_ = false;
+        right_valid_ = false;
+        block_rows_ = 0;
+        pair_pos_ = 0;
+    }
+
+    /**
+     * @brief 当前块与右儿子的chunk逐对计算连接条件，满足条件的元组对拼接后写入chunk；
+     * 右儿子扫描完一遍之后取下一块。chunk写满时记住pair_pos_，下一次从这里继续
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        while (!chunk.is_full()) {
+            if (!right_valid_) {
+                // 右儿子扫描完一遍（或还没有开始扫描），换下一块
+                if (!fill_block()) {
+                    break;
+                }
+                right_->beginBatch();
+                right_valid_ = right_->NextBatch(right_chunk_);
+                if (!right_valid_) {
+                    right_empty_ = true;
+                    break;
+                }
+                pair_pos_ = 0;
+            }
+            size_t right_count = right_chunk_.count();
+            size_t pair_count = block_rows_ * right_count;
+            // 右chunk常驻缓存，块中的元组顺序地读一遍
+            for (; pair_pos_ < pair_count && !chunk.is_full(); pair_pos_++) {
+                const char *left_rec = block_.data() + left_len_ * (pair_pos_ / right_count);
+                const char *right_rec = right_chunk_.row(pair_pos_ % right_count);
+                if (pred_.eval(left_rec, right_rec)) {
+                    char *join_rec = chunk.append();
+                    memcpy(join_rec, left_rec, left_len_);
+                    memcpy(join_rec + left_len_, right_rec, right_len_);
+                }
+            }
+            if (pair_pos_ < pair_count) {
+                break;
+            }
+            pair_pos_ = 0;
+            right_valid_ = right_->NextBatch(right_chunk_);
+        }
+        return chunk.count() > 0;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+   private:
+    /**
+     * @brief 从左儿子取出下一块元组放进block_，左儿子已经取完或右儿子为空时返回false
+     */
+    bool fill_block() {
+        block_rows_ = 0;
+        if (right_empty_) {
+            return false;
+        }
+        while (block_rows_ < block_capacity_) {
+            if (left_pos_ == left_chunk_.count()) {
+                if (left_done_ || !left_->NextBatch(left_chunk_)) {
+                    left_done_ = true;
+                    left_pos_ = 0;
+                    left_chunk_.reset();
+                    break;
+                }
+                left_pos_ = 0;
+            }
+            size_t num = std::min(left_chunk_.count() - left_pos_, block_capacity_ - block_rows_);
+            if (block_.size() < (block_rows_ + num) * left_len_) {
+                block_.resize(std::min(block_capacity_, std::max(block_.size() / left_len_ * 2, block_rows_ + num)) *
+                              left_len_);
+            }
+            for (size_t i = 0; i < num; i++) {
+                memcpy(block_.data() + left_len_ * block_rows_++, left_chunk_.row(left_pos_++), left_len_);
+            }
+        }
+        return block_rows_ > 0;
+    }
+};
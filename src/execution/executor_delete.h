@@ -38,30 +38,31 @@ class DeleteExecutor : public AbstractExecutor {
     }
 
     std::unique_ptr<RmRecord> Next() override {
+        std::vector<RmRecord> recs;
+        recs.reserve(rids_.size());
         for (auto &rid : rids_) {
             context_->lock_mgr_->lock_exclusive_on_record(context_->txn_, rid, fh_->GetFd());
 
             auto rec = fh_->get_record(rid, context_);
             context_->txn_->append_write_record(new WriteRecord(WType::DELETE_TUPLE, tab_name_, rid, *rec));
             context_->lock_mgr_->check_gap_conflict(context_->txn_, fh_->GetFd(), rid);
-            // Delete from index files first
-            for (size_t i = 0; i < tab_.indexes.size(); ++i) {
-                auto &index = tab_.indexes[i];
-                auto ih =
-                    sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-
-                // Construct index key from record
-                std::vector<char> key(index.col_tot_len);
-                int offset = 0;
-                for (size_t j = 0; j < index.col_num; ++j) {
-                    memcpy(key.data() + offset, rec->data + index.cols[j].offset, index.cols[j].len);
-                    offset += index.cols[j].len;
-                }
+            recs.push_back(*rec);
+        }
 
-                ih->delete_entry(key.data(), context_->txn_);
+        // Delete from index files first，每个索引的所有键值对一起排序后批量删除
+        for (auto &index : tab_.indexes) {
+            auto ih = sm_manager_->get_index_handle(tab_name_, index.cols);
+            // 非唯一索引中可能有多条相同key的索引项，需要按(key, rid)删除本条记录对应的那一项
+            std::vector<std::pair<std::vector<char>, Rid>> entries;
+            entries.reserve(recs.size());
+            for (size_t i = 0; i < recs.size(); i++) {
+                entries.emplace_back(index.get_key(recs[i].data), rids_[i]);
             }
+            ih->delete_entries(entries, context_->txn_);
+        }
 
-            // Delete the record from table file
+        // Delete the records from table file
+        for (auto &rid : rids_) {
             fh_->delete_record(rid, context_);
         }
 
@@ -0,0 +1,254 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_aggregate.h"
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "hash_partition.h"
+#include "system/sm.h"
+
+/**
+ * 哈希聚集
+ * 每组的分组key和聚集状态连续存放在arena groups_中，哈希表是开放定址的，槽中只存组的下标。
+ * 读完全部输入之后逐组输出：先是分组字段，然后是各个聚集函数的结果。没有分组字段时恰好输出一行
+ *
+ * 组太多、内存放不下时，已经在内存中的组继续在内存中聚集，新的组的输入元组按分组key哈希值的高位
+ * 写入SPILL_FANOUT个分区的临时文件；内存中的组输出之后再逐个聚集磁盘上的分区，分区仍然放不下时用哈希值的下一段
+ * 继续分区，最多分SPILL_MAX_LEVEL层，再往下的分区直接全部放进内存
+ */
+class HashAggregateExecutor : public BatchExecutor {
+   private:
+    static constexpr uint32_t NO_GROUP = UINT32_MAX;
+    // 每组除key和状态之外占用的空间：哈希值以及平均不超过4个槽
+    static constexpr size_t ENTRY_SIZE = sizeof(uint64_t) + sizeof(uint32_t) * 4;
+
+    /* 一个分组字段 */
+    struct KeyCol {
+        int in_offset;   // 字段在输入元组中的偏移
+        int key_offset;  // 字段在分组key中的偏移，也是在输出元组中的偏移
+        ColType type;
+        int len;
+    };
+
+    /* 写到磁盘上、等待聚集的一个分区 */
+    struct Partition {
+        std::shared_ptr<SpillFile> file;
+        int level;  // 继续分区时使用的层数
+    };
+
+    std::unique_ptr<AbstractExecutor> prev_;
+    size_t prev_len_;
+    std::vector<KeyCol> keys_;       // 分组字段
+    size_t key_len_ = 0;             // 分组key的长度
+    AggregateFunctions funcs_;
+    size_t group_len_;               // 一组在arena中的长度，key在前，聚集状态在后
+    size_t len_;                     // 输出元组的长度
+    std::vector<ColMeta> cols_;      // 输出元组的字段
+    DiskManager *disk_manager_;      // 用于读写临时文件
+    size_t mem_budget_;              // 组在内存中最多占用的字节数
+
+    std::vector<char> groups_;            // 内存中的组
+    std::vector<uint64_t> group_hashes_;  // 每组key的哈希值
+    std::vector<uint32_t> slots_;         // 开放定址的槽，组的下标，空槽为NO_GROUP
+    uint64_t slot_mask_ = 0;
+
+    int level_ = 0;                                   // 当前这一轮的层数，决定用哈希值的哪一段分区
+    SpillPartitions parts_;                           // 当前这一轮每个分区的文件
+    std::vector<Partition> spilled_;                  // 等待聚集的分区
+    size_t emit_pos_ = 0;                             // 下一个要输出的组
+
+   public:
+    /**
+     * @param group_cols 分组字段
+     * @param aggs 聚集函数
+     * @param mem_budget 组在内存中最多占用的字节数，超过时把新的组的输入元组写到磁盘上
+     */
+    HashAggregateExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> prev,
+                          const std::vector<TabCol> &group_cols, const std::vector<AggExpr> &aggs,
+                          size_t mem_budget = QUERY_MEMORY_BUDGET) {
+        disk_manager_ = sm_manager->get_disk_manager();
+        mem_budget_ = mem_budget;
+        prev_ = std::move(prev);
+        prev_len_ = prev_->tupleLen();
+        for (const auto &group_col : group_cols) {
+            ColMeta col = *get_col(prev_->cols(), group_col);
+            keys_.push_back({col.offset, static_cast<int>(key_len_), col.type, col.len});
+            col.offset = static_cast<int>(key_len_);
+            cols_.push_back(col);
+            key_len_ += col.len;
+        }
+        funcs_ = AggregateFunctions(aggs, prev_->cols(), static_cast<int>(key_len_));
+        cols_.insert(cols_.end(), funcs_.cols().begin(), funcs_.cols().end());
+        group_len_ = key_len_ + funcs_.state_len();
+        len_ = cols_.empty() ? 0 : cols_.back().offset + cols_.back().len;
+    }
+
+    /**
+     * @brief 读完儿子节点的全部元组，在内存中聚集第一轮
+     */
+    void beginBatch() override {
+        spilled_.clear();
+        prev_->beginBatch();
+        aggregate([this](DataChunk &chunk) { return prev_->NextBatch(chunk); }, 0);
+        if (keys_.empty() && group_hashes_.empty()) {
+            // 没有分组字段时，即使输入为空也输出一行
+            new_group(0, nullptr);
+        }
+    }
+
+    /**
+     * @brief 输出内存中的组，输出完之后聚集下一个磁盘上的分区
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        while (!chunk.is_full()) {
+            if (emit_pos_ == group_hashes_.size()) {
+                if (spilled_.empty()) {
+                    break;
+                }
+                Partition part = std::move(spilled_.back());
+                spilled_.pop_back();
+                aggregate([file = part.file](DataChunk &in) { return file->read(in); }, part.level);
+                continue;
+            }
+            const char *group = groups_.data() + emit_pos_++ * group_len_;
+            char *out = chunk.append();
+            memcpy(out, group, key_len_);
+            funcs_.finalize(group + key_len_, out);
+        }
+        return chunk.count() > 0;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+   private:
+    /**
+     * @brief 聚集一轮输入：内存中已有的组或内存放得下的新组在内存中聚集，其余元组写入分区文件。
+     * 开始时清空上一轮的组，结束时把这一轮写出的分区加入等待聚集的分区
+     */
+    void aggregate(const ChunkSource &source, int level) {
+        level_ = level;
+        groups_.clear();
+        groups_.shrink_to_fit();
+        group_hashes_.clear();
+        group_hashes_.shrink_to_fit();
+        slots_.assign(16, NO_GROUP);
+        slot_mask_ = slots_.size() - 1;
+        emit_pos_ = 0;
+        parts_ = SpillPartitions(disk_manager_, prev_len_);
+
+        DataChunk chunk;
+        while (source(chunk)) {
+            for (size_t i = 0; i < chunk.count(); i++) {
+                const char *rec = chunk.row(i);
+                uint64_t hash = hash_key(rec);
+                uint64_t slot = find_slot(hash, rec);
+                uint32_t group = slots_[slot];
+                if (group == NO_GROUP) {
+                    // 没有分组字段时只有一组，总是留在内存中
+                    bool full = (group_hashes_.size() + 1) * (group_len_ + ENTRY_SIZE) > mem_budget_;
+                    if (full && level_ < SPILL_MAX_LEVEL && !keys_.empty()) {
+                        parts_.append(spill_partition_of(hash, level_), rec);
+                        continue;
+                    }
+                    group = new_group(hash, rec);
+                    if (slots_.size() < group_hashes_.size() * 2) {
+                        grow_table();
+                    } else {
+                        slots_[slot] = group;
+                    }
+                }
+                funcs_.update(groups_.data() + group * group_len_ + key_len_, rec);
+            }
+        }
+        for (int part = 0; part < SPILL_FANOUT; part++) {
+            if (parts_.has(part)) {
+                spilled_.push_back({parts_.finish(part), level_ + 1});
+            }
+        }
+        parts_.clear();
+    }
+
+    /**
+     * @brief 在arena末尾加入一组：复制分组key，浮点数的-0按+0保存，并初始化聚集状态
+     * @param rec 组的第一个输入元组，没有分组字段时可以为nullptr
+     */
+    uint32_t new_group(uint64_t hash, const char *rec) {
+        size_t num_groups = group_hashes_.size();
+        if (groups_.size() < (num_groups + 1) * group_len_) {
+            size_t rows = std::max(num_groups * 2, static_cast<size_t>(16));
+            if (level_ < SPILL_MAX_LEVEL) {
+                // 会分区时arena不超过内存上限
+                rows = std::min(rows, std::max(mem_budget_ / (group_len_ + ENTRY_SIZE), num_groups + 1));
+            }
+            groups_.resize(rows * group_len_);
+        }
+        char *group = groups_.data() + num_groups * group_len_;
+        for (auto &key : keys_) {
+            memcpy(group + key.key_offset, rec + key.in_offset, key.len);
+            if (key.type == TYPE_FLOAT && *reinterpret_cast<float *>(group + key.key_offset) == 0.0f) {
+                *reinterpret_cast<float *>(group + key.key_offset) = 0.0f;
+            }
+        }
+        funcs_.init(group + key_len_);
+        group_hashes_.push_back(hash);
+        return static_cast<uint32_t>(num_groups);
+    }
+
+    // 槽的个数保持在组数的两倍以上，按保存的哈希值重新放入所有的组
+    void grow_table() {
+        slots_.assign(slots_.size() * 2, NO_GROUP);
+        slot_mask_ = slots_.size() - 1;
+        for (uint32_t group = 0; group < group_hashes_.size(); group++) {
+            uint64_t slot = group_hashes_[group] & slot_mask_;
+            while (slots_[slot] != NO_GROUP) {
+                slot = (slot + 1) & slot_mask_;
+            }
+            slots_[slot] = group;
+        }
+    }
+
+    // 计算输入元组的分组key的哈希值
+    uint64_t hash_key(const char *rec) const {
+        KeyHasher hasher;
+        for (auto &key : keys_) {
+            hasher.add(rec + key.in_offset, key.type, key.len);
+        }
+        return hasher.finish();
+    }
+
+    /**
+     * @brief 找到输入元组rec所在的组的槽，没有这样的组时返回遇到的第一个空槽
+     */
+    uint64_t find_slot(uint64_t hash, const char *rec) const {
+        for (uint64_t slot = hash & slot_mask_;; slot = (slot + 1) & slot_mask_) {
+            uint32_t group = slots_[slot];
+            if (group == NO_GROUP || (group_hashes_[group] == hash && key_equal(group, rec))) {
+                return slot;
+            }
+        }
+    }
+
+    bool key_equal(uint32_t group, const char *rec) const {
+        const char *group_key = groups_.data() + group * group_len_;
+        for (auto &key : keys_) {
+            if (ix_compare(group_key + key.key_offset, rec + key.in_offset, key.type, key.len) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
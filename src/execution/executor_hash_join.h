@@ -0,0 +1,428 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <deque>
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "hash_partition.h"
+#include "system/sm.h"
+
+/**
+ * 等值连接的hash join（hybrid hash join）
+ * 开始执行时交替地从左右儿子各取一个chunk，先取完的一边输入较小，作为build端放进哈希表，
+ * 另一边作为probe端：先探测已经取出的chunk，再继续流式地读取剩下的元组。
+ * 两边取出的数据超过内存上限时仍然没有一边取完，就选已经取出的数据较少的一边作为build端。
+ * 哈希表是开放定址的：槽中只存连接key相同的一组元组中第一个元组的下标，同一组的元组通过next_串起来，
+ * build端的元组连续存放在rows_中。key相同只是候选，输出前仍然用全部连接条件检查
+ *
+ * build端超过内存上限时按key的哈希值把两边都分成SPILL_FANOUT个分区：分区0留在内存中建哈希表，
+ * probe端属于分区0的元组直接探测，其余分区的元组写入临时文件；分区0也放不下时同样写出。
+ * probe端取完后逐对连接写到磁盘上的分区，分区的build端仍然放不下时用哈希值的下一段继续分区，
+ * 最多分SPILL_MAX_LEVEL层，再往下的分区（通常是大量重复的key，无法再拆分）直接全部放进内存
+ */
+class HashJoinExecutor : public BatchExecutor {
+   private:
+    static constexpr uint32_t NO_ROW = UINT32_MAX;
+    // 哈希表中每个元组除数据之外占用的空间：哈希值、next_以及平均不超过4个槽
+    static constexpr size_t ENTRY_SIZE = sizeof(uint64_t) + sizeof(uint32_t) * 5;
+
+    /* 一个等值连接条件对应的key字段，offset是字段在各自元组中的偏移 */
+    struct KeyCol {
+        int left_offset;
+        int right_offset;
+        ColType type;
+        int len;
+    };
+
+    /* 写到磁盘上、等待连接的一对分区 */
+    struct Partition {
+        std::shared_ptr<SpillFile> build;
+        std::shared_ptr<SpillFile> probe;
+        int level;  // 继续分区时使用的层数
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;   // 左儿子节点
+    std::unique_ptr<AbstractExecutor> right_;  // 右儿子节点
+    size_t left_len_;
+    size_t right_len_;
+    size_t len_;                               // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                // join后获得的记录的字段
+    std::vector<Condition> fed_conds_;         // join条件
+    CompiledPredicate pred_;                   // 由fed_conds_编译得到的谓词
+    std::vector<KeyCol> keys_;                 // 等值连接条件中的字段
+    DiskManager *disk_manager_;                // 用于读写临时文件
+    size_t mem_budget_;                        // build端在内存中最多占用的字节数
+
+    bool build_left_ = false;           // build端是否为左儿子
+    size_t build_len_ = 0;              // build端元组的长度
+    std::vector<char> rows_;            // 内存中的build端元组
+    std::vector<uint64_t> row_hashes_;  // build端每个元组的key的哈希值
+    std::vector<uint32_t> next_;        // 同一组中下一个元组的下标
+    std::vector<uint32_t> slots_;       // 开放定址的槽，每组第一个元组的下标，空槽为NO_ROW
+    uint64_t slot_mask_ = 0;
+
+    // 第一轮连接的输入来自儿子节点，之后每一轮的输入是磁盘上的一对分区
+    std::deque<DataChunk> build_pending_;  // 选择build端时已经取出的build端chunk
+    std::deque<DataChunk> probe_pending_;  // 选择build端时已经取出的probe端chunk
+    bool build_done_ = true;               // build端儿子节点已经取完
+    bool probe_done_ = true;               // probe端儿子节点已经取完
+    int level_ = 0;                        // 当前这一轮的层数，决定用哈希值的哪一段分区
+    bool partitioned_ = false;             // 当前这一轮是否已经分区
+    bool mem_spilled_ = false;             // 分区0是否也已经写出
+    std::vector<size_t> build_counts_;     // 当前这一轮每个分区的build端元组数
+    SpillPartitions build_parts_;          // 当前这一轮每个分区的文件
+    SpillPartitions probe_parts_;
+    ChunkSource probe_source_;             // 当前这一轮probe端的输入
+    std::vector<Partition> spilled_;       // 等待连接的分区
+
+    DataChunk probe_chunk_;    // 正在探测的chunk
+    size_t probe_pos_ = 0;     // probe_chunk_中正在探测的元组
+    uint32_t match_ = NO_ROW;  // 当前probe元组下一个要检查的build元组
+
+   public:
+    /**
+     * @param mem_budget build端在内存中最多占用的字节数，超过时把输入分区写到磁盘上
+     */
+    HashJoinExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> left,
+                     std::unique_ptr<AbstractExecutor> right, std::vector<Condition> conds,
+                     size_t mem_budget = QUERY_MEMORY_BUDGET) {
+        disk_manager_ = sm_manager->get_disk_manager();
+        mem_budget_ = mem_budget;
+        left_ = std::move(left);
+        right_ = std::move(right);
+        left_len_ = left_->tupleLen();
+        right_len_ = right_->tupleLen();
+        len_ = left_len_ + right_len_;
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_len_;
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_, left_len_);
+
+        // 找出两边各有一个字段的等值条件作为key
+        for (auto &cond : fed_conds_) {
+            if (cond.is_rhs_val || cond.op != OP_EQ) {
+                continue;
+            }
+            auto lhs_col = get_col(cols_, cond.lhs_col);
+            auto rhs_col = get_col(cols_, cond.rhs_col);
+            bool lhs_left = lhs_col->offset < static_cast<int>(left_len_);
+            bool rhs_left = rhs_col->offset < static_cast<int>(left_len_);
+            if (lhs_left == rhs_left) {
+                continue;
+            }
+            auto left_col = lhs_left ? lhs_col : rhs_col;
+            auto right_col = lhs_left ? rhs_col : lhs_col;
+            keys_.push_back({left_col->offset, right_col->offset - static_cast<int>(left_len_), left_col->type,
+                             left_col->len});
+        }
+        if (keys_.empty()) {
+            throw InternalError("Hash join requires an equality condition between its inputs");
+        }
+    }
+
+    /**
+     * @brief 选择build端，读入build端并建立哈希表
+     */
+    void beginBatch() override {
+        spilled_.clear();
+        probe_chunk_.init(0);
+        probe_pos_ = 0;
+        match_ = NO_ROW;
+
+        // 交替读取，直到有一边取完或者超过内存上限
+        std::deque<DataChunk> left_chunks;
+        std::deque<DataChunk> right_chunks;
+        size_t left_rows = 0;
+        size_t right_rows = 0;
+        bool left_done = false;
+        bool right_done = false;
+        left_->beginBatch();
+        right_->beginBatch();
+        while (!left_done && !right_done && left_rows * left_len_ + right_rows * right_len_ <= mem_budget_) {
+            left_done = !read_chunk(left_.get(), left_chunks, left_rows);
+            right_done = !read_chunk(right_.get(), right_chunks, right_rows);
+        }
+        if (left_done == right_done) {
+            // 两边都取完或者都没有取完，选数据较少的一边
+            build_left_ = left_rows * left_len_ <= right_rows * right_len_;
+        } else {
+            build_left_ = left_done;
+        }
+        build_len_ = build_left_ ? left_len_ : right_len_;
+        build_pending_ = std::move(build_left_ ? left_chunks : right_chunks);
+        probe_pending_ = std::move(build_left_ ? right_chunks : left_chunks);
+        build_done_ = build_left_ ? left_done : right_done;
+        probe_done_ = build_left_ ? right_done : left_done;
+
+        AbstractExecutor *build = build_left_ ? left_.get() : right_.get();
+        AbstractExecutor *probe = build_left_ ? right_.get() : left_.get();
+        start_run([this, build](DataChunk &chunk) { return pull(build_pending_, build, build_done_, chunk); },
+                  [this, probe](DataChunk &chunk) { return pull(probe_pending_, probe, probe_done_, chunk); }, 0);
+    }
+
+    /**
+     * @brief 用probe端的元组逐个探测哈希表，满足所有连接条件的元组对拼接后写入chunk；
+     * chunk写满时记住probe_pos_和match_，下一次从这里继续
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        while (!chunk.is_full()) {
+            if (probe_pos_ == probe_chunk_.count()) {
+                if (!next_probe_chunk()) {
+                    break;
+                }
+            }
+            const char *probe_rec = probe_chunk_.row(probe_pos_);
+            if (match_ == NO_ROW) {
+                uint64_t hash = hash_key(probe_rec, !build_left_);
+                match_ = slots_[find_slot(hash, probe_rec, !build_left_)];
+            }
+            for (; match_ != NO_ROW && !chunk.is_full(); match_ = next_[match_]) {
+                const char *build_rec = rows_.data() + match_ * build_len_;
+                const char *left_rec = build_left_ ? build_rec : probe_rec;
+                const char *right_rec = build_left_ ? probe_rec : build_rec;
+                if (pred_.eval(left_rec, right_rec)) {
+                    char *join_rec = chunk.append();
+                    memcpy(join_rec, left_rec, left_len_);
+                    memcpy(join_rec + left_len_, right_rec, right_len_);
+                }
+            }
+            if (match_ == NO_ROW) {
+                probe_pos_++;
+            }
+        }
+        return chunk.count() > 0;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+   private:
+    // 从儿子节点读取一个chunk放入chunks，返回false表示已经取完
+    static bool read_chunk(AbstractExecutor *child, std::deque<DataChunk> &chunks, size_t &num_rows) {
+        chunks.emplace_back();
+        if (!child->NextBatch(chunks.back())) {
+            chunks.pop_back();
+            return false;
+        }
+        num_rows += chunks.back().count();
+        return true;
+    }
+
+    // 先取出pending中已经读出的chunk，再从儿子节点读取
+    static bool pull(std::deque<DataChunk> &pending, AbstractExecutor *child, bool &done, DataChunk &chunk) {
+        if (!pending.empty()) {
+            chunk = std::move(pending.front());
+            pending.pop_front();
+            return true;
+        }
+        if (!done) {
+            done = !child->NextBatch(chunk);
+        }
+        return !done;
+    }
+
+    /**
+     * @brief 开始一轮连接：读入build端的全部元组，放不下时分区，再为留在内存中的元组建立哈希表
+     * @param level 这一轮的层数
+     */
+    void start_run(const ChunkSource &build, ChunkSource probe, int level) {
+        level_ = level;
+        partitioned_ = false;
+        mem_spilled_ = false;
+        rows_.clear();
+        row_hashes_.clear();
+        DataChunk chunk;
+        while (build(chunk)) {
+            for (size_t i = 0; i < chunk.count(); i++) {
+                add_build_row(chunk.row(i));
+            }
+        }
+        build_table();
+        probe_source_ = std::move(probe);
+        if (!partitioned_ && row_hashes_.empty()) {
+            // build端为空，连接结果为空，不必再读取probe端
+            probe_source_ = nullptr;
+        }
+    }
+
+    void add_build_row(const char *rec) {
+        uint64_t hash = hash_key(rec, build_left_);
+        bool full = (row_hashes_.size() + 1) * (build_len_ + ENTRY_SIZE) > mem_budget_;
+        if (!partitioned_ && full && level_ < SPILL_MAX_LEVEL) {
+            start_partitioning();
+            full = (row_hashes_.size() + 1) * (build_len_ + ENTRY_SIZE) > mem_budget_;
+        }
+        if (partitioned_) {
+            int part = spill_partition_of(hash, level_);
+            build_counts_[part]++;
+            if (part == 0 && !mem_spilled_ && full) {
+                // 分区0也放不下，把已经在内存中的元组写出
+                for (size_t row = 0; row < row_hashes_.size(); row++) {
+                    build_parts_.append(0, rows_.data() + row * build_len_);
+                }
+                rows_.clear();
+                row_hashes_.clear();
+                mem_spilled_ = true;
+            }
+            if (part != 0 || mem_spilled_) {
+                build_parts_.append(part, rec);
+                return;
+            }
+        }
+        rows_.insert(rows_.end(), rec, rec + build_len_);
+        row_hashes_.push_back(hash);
+    }
+
+    // 当前这一轮开始分区：内存中不属于分区0的元组写入各自分区的文件
+    void start_partitioning() {
+        partitioned_ = true;
+        build_counts_.assign(SPILL_FANOUT, 0);
+        build_parts_ = SpillPartitions(disk_manager_, build_len_);
+        probe_parts_ = SpillPartitions(disk_manager_, build_left_ ? right_len_ : left_len_);
+        size_t kept = 0;
+        for (size_t row = 0; row < row_hashes_.size(); row++) {
+            const char *rec = rows_.data() + row * build_len_;
+            int part = spill_partition_of(row_hashes_[row], level_);
+            build_counts_[part]++;
+            if (part != 0) {
+                build_parts_.append(part, rec);
+                continue;
+            }
+            memmove(rows_.data() + kept * build_len_, rec, build_len_);
+            row_hashes_[kept++] = row_hashes_[row];
+        }
+        rows_.resize(kept * build_len_);
+        row_hashes_.resize(kept);
+    }
+
+    void build_table() {
+        size_t num_rows = row_hashes_.size();
+        next_.assign(num_rows, NO_ROW);
+        size_t num_slots = 16;
+        while (num_slots < num_rows * 2) {
+            num_slots *= 2;
+        }
+        slots_.assign(num_slots, NO_ROW);
+        slot_mask_ = num_slots - 1;
+        for (uint32_t row = 0; row < num_rows; row++) {
+            uint64_t slot = find_slot(row_hashes_[row], rows_.data() + row * build_len_, build_left_);
+            if (slots_[slot] != NO_ROW) {
+                next_[row] = slots_[slot];
+            }
+            slots_[slot] = row;
+        }
+    }
+
+    /**
+     * @brief 取下一个要探测的chunk，当前这一轮的probe端取完后开始连接下一对磁盘上的分区
+     * @return 取到的chunk不为空时返回true，所有分区都连接完时返回false
+     */
+    bool next_probe_chunk() {
+        probe_pos_ = 0;
+        match_ = NO_ROW;
+        while (true) {
+            if (probe_source_ != nullptr && probe_source_(probe_chunk_)) {
+                if (partitioned_) {
+                    route_probe_chunk();
+                }
+                if (probe_chunk_.count() > 0) {
+                    return true;
+                }
+                continue;
+            }
+            finish_run();
+            if (spilled_.empty()) {
+                probe_chunk_.reset();
+                return false;
+            }
+            Partition part = std::move(spilled_.back());
+            spilled_.pop_back();
+            start_run([&part](DataChunk &chunk) { return part.build->read(chunk); },
+                      [probe = part.probe](DataChunk &chunk) { return probe->read(chunk); }, part.level);
+        }
+    }
+
+    // 分区后probe端的chunk只留下属于内存中分区0的元组，其余元组写入对应分区的文件，build端为空的分区直接丢弃
+    void route_probe_chunk() {
+        probe_chunk_.filter([&](const char *rec) {
+            int part = spill_partition_of(hash_key(rec, !build_left_), level_);
+            if (part == 0 && !mem_spilled_) {
+                return true;
+            }
+            if (build_counts_[part] > 0) {
+                probe_parts_.append(part, rec);
+            }
+            return false;
+        });
+    }
+
+    // 当前这一轮的probe端已经取完，两边都不为空的分区对留待之后连接
+    void finish_run() {
+        if (partitioned_) {
+            for (int part = 0; part < SPILL_FANOUT; part++) {
+                if (build_parts_.has(part) && probe_parts_.has(part)) {
+                    spilled_.push_back({build_parts_.finish(part), probe_parts_.finish(part), level_ + 1});
+                }
+            }
+        }
+        partitioned_ = false;
+        build_parts_.clear();
+        probe_parts_.clear();
+        probe_source_ = nullptr;
+    }
+
+    /**
+     * @brief 计算元组的连接key的哈希值
+     * @param is_left 元组来自左儿子还是右儿子
+     */
+    uint64_t hash_key(const char *rec, bool is_left) const {
+        KeyHasher hasher;
+        for (auto &key : keys_) {
+            hasher.add(rec + (is_left ? key.left_offset : key.right_offset), key.type, key.len);
+        }
+        return hasher.finish();
+    }
+
+    /**
+     * @brief 找到与rec的key相同的一组元组所在的槽，没有这样的组时返回遇到的第一个空槽
+     */
+    uint64_t find_slot(uint64_t hash, const char *rec, bool is_left) const {
+        for (uint64_t slot = hash & slot_mask_;; slot = (slot + 1) & slot_mask_) {
+            uint32_t row = slots_[slot];
+            if (row == NO_ROW ||
+                (row_hashes_[row] == hash && keys_equal(rows_.data() + row * build_len_, rec, is_left))) {
+                return slot;
+            }
+        }
+    }
+
+    // 判断build端元组与rec的连接key是否相同
+    bool keys_equal(const char *build_rec, const char *rec, bool is_left) const {
+        for (auto &key : keys_) {
+            const char *a = build_rec + (build_left_ ? key.left_offset : key.right_offset);
+            const char *b = rec + (is_left ? key.left_offset : key.right_offset);
+            if (ix_compare(a, b, key.type, key.len) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
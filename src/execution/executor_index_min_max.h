@@ -0,0 +1,109 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_aggregate.h"
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 用B+树索引直接求没有WHERE条件和分组字段的MIN/MAX，不扫描表
+ * 每个聚集函数使用一个第一个字段为聚集字段的B+树索引：最小值是第一个叶子的第一个key，
+ * 最大值是最后一个叶子的最后一个key，由文件头中记录的首尾叶子直接定位。
+ * 恰好输出一行，格式与其他聚集算子相同；表为空时与其他聚集算子一样输出0或空字符串
+ */
+class IndexMinMaxExecutor : public AbstractExecutor {
+   private:
+    SmManager *sm_manager_;
+    std::string tab_name_;
+    RmFileHandle *fh_;
+    std::vector<AggExpr> aggs_;                             // 都是MIN或MAX
+    std::vector<std::vector<std::string>> index_col_names_;  // 每个聚集函数使用的索引
+    AggregateFunctions funcs_;                              // 只用来确定输出字段
+    size_t len_;
+
+    std::vector<char> row_;  // 输出的一行
+    bool done_ = true;       // 批量执行时这一行已经输出
+
+   public:
+    IndexMinMaxExecutor(SmManager *sm_manager, std::string tab_name, std::vector<AggExpr> aggs,
+                        std::vector<std::vector<std::string>> index_col_names, Context *context) {
+        sm_manager_ = sm_manager;
+        context_ = context;
+        tab_name_ = std::move(tab_name);
+        fh_ = sm_manager_->fhs_.at(tab_name_).get();
+        aggs_ = std::move(aggs);
+        index_col_names_ = std::move(index_col_names);
+        funcs_ = AggregateFunctions(aggs_, sm_manager_->db_.get_table(tab_name_).cols, 0);
+        len_ = funcs_.cols().back().offset + funcs_.cols().back().len;
+    }
+
+    void beginBatch() override { done_ = false; }
+
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        if (done_) {
+            return false;
+        }
+        read_row();
+        memcpy(chunk.append(), row_.data(), len_);
+        done_ = true;
+        return true;
+    }
+
+    void beginTuple() override {
+        read_row();
+        done_ = false;
+    }
+
+    void nextTuple() override { done_ = true; }
+
+    std::unique_ptr<RmRecord> Next() override {
+        return std::make_unique<RmRecord>(static_cast<int>(len_), row_.data());
+    }
+
+    bool is_end() const override { return done_; }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return funcs_.cols(); }
+
+   private:
+    /**
+     * @brief 从每个聚集函数的索引中读出最小或最大的key，key的开头就是聚集字段的值
+     * 与全表扫描一样对表加共享锁，使结果不受并发插入和删除的影响
+     */
+    void read_row() {
+        context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd());
+        row_.assign(len_, 0);
+        for (size_t i = 0; i < aggs_.size(); i++) {
+            auto ih = sm_manager_->get_index_handle(tab_name_, index_col_names_[i]);
+            const ColMeta &out_col = funcs_.cols()[i];
+            Iid end = ih->leaf_end();
+            Iid begin = ih->leaf_begin();
+            if (aggs_[i].type == AGG_MAX && end.slot_no > 0) {
+                begin = Iid{end.page_no, end.slot_no - 1};
+            }
+            // MIN只读第一个key；MAX从最后一个key开始，最后一个叶子为空（只有空树）时才会读完整个索引
+            for (IxScan scan(ih, begin, end, sm_manager_->get_bpm()); !scan.is_end(); scan.next()) {
+                memcpy(row_.data() + out_col.offset, scan.key(), out_col.len);
+                if (aggs_[i].type == AGG_MIN) {
+                    break;
+                }
+            }
+        }
+    }
+};
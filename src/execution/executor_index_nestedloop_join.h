@@ -0,0 +1,206 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "executor_index_scan.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 索引嵌套循环连接
+ * 外表（左儿子）的每个元组都在内表的B+树索引上查找一次：索引开头的若干个字段上有与外表字段的等值连接条件，
+ * 用外表元组中这些字段的值拼成key的前缀，剩余的索引字段用最小值和最大值填充得到查找范围，再按rid读取内表的元组。
+ * 内表自己的条件和全部连接条件在输出前检查。输出的元组由外表元组和内表元组拼接而成，内表在右边
+ */
+class IndexNestedLoopJoinExecutor : public BatchExecutor {
+   private:
+    /* 作为key前缀的一个索引字段，outer_offset是外表元组中与它相等的字段的偏移 */
+    struct KeyCol {
+        int outer_offset;
+        int len;
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;  // 外表
+    SmManager *sm_manager_;
+    std::string tab_name_;                    // 内表的表名
+    RmFileHandle *fh_;                        // 内表的数据文件句柄
+    IxIndexHandle *ih_ = nullptr;             // 查找使用的索引，在beginBatch对表加锁之后取得
+    IndexMeta index_meta_;                    // 查找使用的索引的元数据
+    size_t left_len_;
+    size_t right_len_;
+    size_t len_;                              // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;               // join后获得的记录的字段
+    std::vector<Condition> fed_conds_;        // join条件
+    CompiledPredicate inner_pred_;            // 内表上的条件
+    CompiledPredicate pred_;                  // 由fed_conds_编译得到的谓词
+    std::vector<KeyCol> keys_;                // 依次对应索引开头的字段
+    std::vector<char> lower_key_;             // 当前外表元组的查找范围下界
+    std::vector<char> upper_key_;             // 当前外表元组的查找范围上界
+    std::vector<char> inner_rec_;             // 从内表读出的元组
+
+    DataChunk outer_chunk_;          // 正在处理的外表chunk
+    size_t outer_pos_ = 0;           // outer_chunk_中正在处理的元组
+    bool outer_done_ = true;         // 外表已经取完
+    std::unique_ptr<IxScan> scan_;   // 当前外表元组在索引上的查找范围，为nullptr时还没有查找
+
+   public:
+    /**
+     * @param left 外表
+     * @param tab_name 内表的表名
+     * @param inner_conds 内表上的单表条件
+     * @param index_col_names 内表上用于查找的B+树索引的字段
+     * @param conds 连接条件
+     */
+    IndexNestedLoopJoinExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> left, std::string tab_name,
+                                std::vector<Condition> inner_conds, const std::vector<std::string> &index_col_names,
+                                std::vector<Condition> conds, Context *context) {
+        sm_manager_ = sm_manager;
+        context_ = context;
+        left_ = std::move(left);
+        tab_name_ = std::move(tab_name);
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
+        index_meta_ = *tab.get_index_meta(index_col_names);
+        fh_ = sm_manager_->fhs_.at(tab_name_).get();
+        if (index_meta_.type == INDEX_HASH) {
+            throw InternalError("Index nested loop join requires a B+ tree index");
+        }
+        left_len_ = left_->tupleLen();
+        right_len_ = tab.cols.back().offset + tab.cols.back().len;
+        len_ = left_len_ + right_len_;
+        inner_pred_ = CompiledPredicate(inner_conds, tab.cols);
+        cols_ = left_->cols();
+        for (auto col : tab.cols) {
+            col.offset += left_len_;
+            cols_.push_back(col);
+        }
+        fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_, left_len_);
+
+        // 从索引的第一个字段开始，依次找与外表字段的等值条件，遇到第一个没有的字段为止
+        for (const auto &index_col : index_meta_.cols) {
+            auto outer_col = find_outer_col(index_col);
+            if (outer_col == nullptr) {
+                break;
+            }
+            keys_.push_back({outer_col->offset, index_col.len});
+        }
+        if (keys_.empty()) {
+            throw InternalError("Index nested loop join requires an equality condition on the first index column");
+        }
+        lower_key_.assign(index_meta_.col_tot_len, 0);
+        upper_key_.assign(index_meta_.col_tot_len, 0);
+        inner_rec_.resize(right_len_);
+    }
+
+    void beginBatch() override {
+        context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd());
+        ih_ = sm_manager_->get_index_handle(tab_name_, index_meta_.cols);
+        left_->beginBatch();
+        outer_chunk_.init(left_len_);
+        outer_pos_ = 0;
+        outer_done_ = false;
+        scan_.reset();
+    }
+
+    /**
+     * @brief 逐个外表元组在索引上查找，满足所有条件的内表元组与外表元组拼接后写入chunk；
+     * chunk写满时保留scan_的位置，下一次从这里继续
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        while (!chunk.is_full()) {
+            if (scan_ == nullptr) {
+                if (outer_done_) {
+                    break;
+                }
+                if (outer_pos_ == outer_chunk_.count()) {
+                    if (!left_->NextBatch(outer_chunk_)) {
+                        outer_done_ = true;
+                        break;
+                    }
+                    outer_pos_ = 0;
+                }
+                open_probe(outer_chunk_.row(outer_pos_));
+            }
+            const char *outer_rec = outer_chunk_.row(outer_pos_);
+            for (; !scan_->is_end() && !chunk.is_full(); scan_->next()) {
+                fh_->read_record(scan_->rid(), inner_rec_.data());
+                if (inner_pred_.eval(inner_rec_.data()) && pred_.eval(outer_rec, inner_rec_.data())) {
+                    char *join_rec = chunk.append();
+                    memcpy(join_rec, outer_rec, left_len_);
+                    memcpy(join_rec + left_len_, inner_rec_.data(), right_len_);
+                }
+            }
+            if (scan_->is_end()) {
+                scan_.reset();
+                outer_pos_++;
+            }
+        }
+        return chunk.count() > 0;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+   private:
+    // 找到与内表字段index_col有等值连接条件、类型和长度都相同的外表字段，没有时返回nullptr
+    const ColMeta *find_outer_col(const ColMeta &index_col) const {
+        for (const auto &cond : fed_conds_) {
+            if (cond.is_rhs_val || cond.op != OP_EQ) {
+                continue;
+            }
+            const TabCol *outer = nullptr;
+            if (cond.lhs_col.tab_name == tab_name_ && cond.lhs_col.col_name == index_col.name) {
+                outer = &cond.rhs_col;
+            } else if (cond.rhs_col.tab_name == tab_name_ && cond.rhs_col.col_name == index_col.name) {
+                outer = &cond.lhs_col;
+            } else {
+                continue;
+            }
+            auto &outer_cols = left_->cols();
+            for (const auto &col : outer_cols) {
+                if (col.tab_name == outer->tab_name && col.name == outer->col_name && col.type == index_col.type &&
+                    col.len == index_col.len) {
+                    return &col;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    // 用外表元组拼出查找范围并定位
+    void open_probe(const char *outer_rec) {
+        int prefix_len = 0;
+        for (const auto &key : keys_) {
+            memcpy(lower_key_.data() + prefix_len, outer_rec + key.outer_offset, key.len);
+            memcpy(upper_key_.data() + prefix_len, outer_rec + key.outer_offset, key.len);
+            prefix_len += key.len;
+        }
+        // 完整key的查找先查询Bloom filter，key一定不存在时不必自根向下查找
+        bool probed = false;
+        if (keys_.size() == index_meta_.cols.size() && !ih_->may_contain(lower_key_.data(), &probed)) {
+            scan_ = std::make_unique<IxScan>(ih_, Iid{-1, -1}, Iid{-1, -1}, sm_manager_->get_bpm());
+            return;
+        }
+        IndexScanExecutor::fill_key_suffix(index_meta_.cols, lower_key_.data(), prefix_len, false);
+        IndexScanExecutor::fill_key_suffix(index_meta_.cols, upper_key_.data(), prefix_len, true);
+        Iid lower = ih_->lower_bound(lower_key_.data());
+        Iid upper = ih_->upper_bound(upper_key_.data());
+        if (probed && lower == upper) {
+            ih_->note_false_positive();
+        }
+        scan_ = std::make_unique<IxScan>(ih_, lower, upper, sm_manager_->get_bpm());
+    }
+};
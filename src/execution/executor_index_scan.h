@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <cfloat>
 #include <climits>
 #include "execution_defs.h"
 #include "execution_manager.h"
@@ -31,25 +32,34 @@ class IndexScanExecutor : public AbstractExecutor {
     IndexMeta index_meta_;                      // index scan涉及到的索引元数据
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<IxScan> scan_;
+    std::unique_ptr<RmRecord> rec_;  // scan_当前位置对应的元组
+
+    // 哈希索引没有顺序，不使用scan_，而是一次取出与等值条件匹配的所有rid
+    std::vector<Rid> hash_rids_;
+    size_t hash_pos_ = 0;
+
+    bool index_only_;  // 索引覆盖了查询用到的所有列，直接由索引key构造元组，不访问表的数据文件
 
     SmManager *sm_manager_;
-    // 扫描范围结构
-    struct ScanRange {
-        char *lower_key;       // 范围下界
-        char *upper_key;       // 范围上界
-        bool lower_inclusive;  // 是否包含下界
-        bool upper_inclusive;  // 是否包含上界
-
-        ScanRange(char *lower, char *upper, bool l_incl, bool u_incl)
-            : lower_key(lower), upper_key(upper), lower_inclusive(l_incl), upper_inclusive(u_incl) {}
-    };
-    std::vector<ScanRange> scan_ranges_;
+    // 扫描范围：由索引列上的条件得到的索引key的上下界，key由所有索引列拼接而成，
+    // 没有条件约束的后缀列用该类型的最小/最大值填充
+    std::vector<char> lower_key_;   // 范围下界
+    std::vector<char> upper_key_;   // 范围上界
+    bool has_lower_ = false;        // 是否有下界，没有则从第一个叶子开始扫描
+    bool has_upper_ = false;        // 是否有上界，没有则扫描到最后一个叶子
+    bool lower_inclusive_ = true;   // 是否包含下界
+    bool upper_inclusive_ = true;   // 是否包含上界
+    bool empty_range_ = false;      // 条件互相矛盾，范围为空
+    bool point_lookup_ = false;     // 每个索引列上都有等值条件，扫描范围是一个完整的key
+
+    CompiledPredicate pred_;  // 由fed_conds_编译得到的谓词
 
    public:
     IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
-                      std::vector<std::string> index_col_names, Context *context) {
+                      std::vector<std::string> index_col_names, Context *context, bool index_only = false) {
         sm_manager_ = sm_manager;
+        index_only_ = index_only;
         context_ = context;
         tab_name_ = std::move(tab_name);
         tab_ = sm_manager_->db_.get_table(tab_name_);
@@ -74,20 +84,20 @@ class IndexScanExecutor : public AbstractExecutor {
             }
         }
         fed_conds_ = conds_;
+        pred_ = CompiledPredicate(fed_conds_, cols_);
+        analyze_conditions();
     }
 
     void beginTuple() override {
-        auto ih =
-            sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names_)).get();
-        analyze_conditions();
-        lock_ranges();
-        scan_ = std::make_unique<IxScan>(ih, ih->leaf_begin(), ih->leaf_end(), sm_manager_->get_bpm());
-
+        open_scan();
+        if (index_meta_.type == INDEX_HASH) {
+            find_next_hash_match();
+            return;
+        }
         while (!scan_->is_end()) {
             rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_);
-            if (eval_conds(fed_conds_,
-                           [this, rec = rec.get()](const Condition &cond) { return get_compare_values(rec, cond); })) {
+            rec_ = current_record();
+            if (pred_.eval(rec_->data)) {
                 return;
             }
             scan_->next();
@@ -95,116 +105,276 @@ class IndexScanExecutor : public AbstractExecutor {
     }
 
     void nextTuple() override {
+        if (index_meta_.type == INDEX_HASH) {
+            if (hash_pos_ < hash_rids_.size()) {
+                hash_pos_++;
+                find_next_hash_match();
+            }
+            return;
+        }
         if (scan_->is_end()) {
             return;
         }
 
         for (scan_->next(); !scan_->is_end(); scan_->next()) {
             rid_ = scan_->rid();
-            auto rec = fh_->get_record(rid_, context_);
-            if (eval_conds(fed_conds_,
-                           [this, rec = rec.get()](const Condition &cond) { return get_compare_values(rec, cond); })) {
+            rec_ = current_record();
+            if (pred_.eval(rec_->data)) {
                 return;
             }
         }
     }
 
-    std::unique_ptr<RmRecord> Next() override { return fh_->get_record(rid_, context_); }
+    std::unique_ptr<RmRecord> Next() override { return std::make_unique<RmRecord>(*rec_); }
 
     Rid &rid() override { return rid_; }
 
-    bool is_end() const override { return scan_->is_end(); }
+    bool is_end() const override {
+        return index_meta_.type == INDEX_HASH ? hash_pos_ >= hash_rids_.size() : scan_->is_end();
+    }
+
+    void beginBatch() override { open_scan(); }
+
+    /**
+     * @brief 沿扫描范围取出一批rid对应的元组直接写入chunk，再对整个chunk计算谓词
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        while (!is_end()) {
+            chunk.reset();
+            if (index_meta_.type == INDEX_HASH) {
+                for (; hash_pos_ < hash_rids_.size() && !chunk.is_full(); hash_pos_++) {
+                    rid_ = hash_rids_[hash_pos_];
+                    load_record(chunk.append(rid_));
+                }
+            } else {
+                for (; !scan_->is_end() && !chunk.is_full(); scan_->next()) {
+                    rid_ = scan_->rid();
+                    load_record(chunk.append(rid_));
+                }
+            }
+            pred_.filter(chunk);
+            if (chunk.count() > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 从key的offset处开始，用每一列类型的最小值（fill_max为false）或最大值（fill_max为true）填充剩余的索引列
+     * @param index_cols 索引包含的字段
+     */
+    static void fill_key_suffix(const std::vector<ColMeta> &index_cols, char *key, int offset, bool fill_max) {
+        int col_offset = 0;
+        for (const auto &col : index_cols) {
+            if (col_offset >= offset) {
+                char *dest = key + col_offset;
+                switch (col.type) {
+                    case TYPE_INT:
+                        *(int *)dest = fill_max ? INT_MAX : INT_MIN;
+                        break;
+                    case TYPE_FLOAT:
+                        *(float *)dest = fill_max ? FLT_MAX : -FLT_MAX;
+                        break;
+                    case TYPE_STRING:
+                        memset(dest, fill_max ? 0xff : 0, col.len);
+                        break;
+                }
+            }
+            col_offset += col.len;
+        }
+    }
 
    private:
-    std::tuple<char *, char *, ColType, int> get_compare_values(const RmRecord *rec, const Condition &cond) {
-        auto lhs_col = get_col(cols_, cond.lhs_col);
-        char *lhs = rec->data + lhs_col->offset;
+    /**
+     * @brief 对扫描范围加锁并定位到范围的起点，不检查谓词
+     * 先对表加意向读锁，与重建索引的排他锁冲突，保证扫描期间使用的句柄不会被替换
+     */
+    void open_scan() {
+        context_->lock_mgr_->lock_IS_on_table(context_->txn_, fh_->GetFd());
+        auto ih = sm_manager_->get_index_handle(tab_name_, index_col_names_);
+        if (ih->is_hash()) {
+            // planner保证每个索引列上都有等值条件，lower_key_就是完整的key；桶没有顺序，无法加间隙锁，改为对表加共享锁
+            context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd());
+            hash_rids_.clear();
+            hash_pos_ = 0;
+            if (!empty_range_) {
+                ih->get_value(lower_key_.data(), &hash_rids_, context_->txn_);
+            }
+            return;
+        }
+        // 完整key的等值查找先查询Bloom filter，key一定不存在时不必自根向下查找。这时lower和upper是同一个位置，
+        // 间隙锁的范围为空，不会与插入冲突（见check_gap_conflict），因此省去它不影响隔离性
+        bool probed = false;
+        if (point_lookup_ && !empty_range_ && !ih->may_contain(lower_key_.data(), &probed)) {
+            scan_.reset();
+            scan_ = std::make_unique<IxScan>(ih, Iid{-1, -1}, Iid{-1, -1}, sm_manager_->get_bpm());
+            return;
+        }
+        Iid lower = !has_lower_        ? ih->leaf_begin()
+                    : lower_inclusive_ ? ih->lower_bound(lower_key_.data())
+                                       : ih->upper_bound(lower_key_.data());
+        Iid upper = !has_upper_        ? ih->leaf_end()
+                    : upper_inclusive_ ? ih->upper_bound(upper_key_.data())
+                                       : ih->lower_bound(upper_key_.data());
+        if (empty_range_) {
+            upper = lower;
+        }
+        if (probed && lower == upper) {
+            ih->note_false_positive();
+        }
+        lock_range(lower, upper);
+        scan_.reset();  // 先释放上一次扫描持有的叶子读锁
+        scan_ = std::make_unique<IxScan>(ih, lower, upper, sm_manager_->get_bpm());
+    }
 
-        char *rhs = cond.is_rhs_val ? cond.rhs_val.raw->data : get_value(cols_, cond.rhs_col, rec);
-        return {lhs, rhs, lhs_col->type, lhs_col->len};
+    // 从hash_pos_开始找到第一个满足所有条件的元组
+    void find_next_hash_match() {
+        for (; hash_pos_ < hash_rids_.size(); hash_pos_++) {
+            rid_ = hash_rids_[hash_pos_];
+            rec_ = current_record();
+            if (pred_.eval(rec_->data)) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief 读取scan_当前位置对应的元组
+     * 覆盖索引时由索引key构造元组，只填充索引列，其余列置零（查询不会用到）；否则从表的数据文件中读取
+     */
+    std::unique_ptr<RmRecord> current_record() {
+        auto rec = std::make_unique<RmRecord>(len_);
+        load_record(rec->data);
+        return rec;
+    }
+
+    // 把当前位置对应的元组写入buf，规则同current_record
+    void load_record(char *buf) {
+        if (!index_only_) {
+            fh_->read_record(rid_, buf);
+            return;
+        }
+        memset(buf, 0, len_);
+        const char *key = index_meta_.type == INDEX_HASH ? lower_key_.data() : scan_->key();
+        int offset = 0;
+        for (const auto &col : index_meta_.cols) {
+            memcpy(buf + col.offset, key + offset, col.len);
+            offset += col.len;
+        }
     }
 
     const std::vector<ColMeta> &cols() const override { return cols_; }
     size_t tupleLen() const override { return len_; }
 
-    // 分析条件得到扫描范围
+    /**
+     * @brief 分析条件得到扫描范围[lower, upper)
+     * 从索引的第一列开始，依次使用每一列上的等值条件；遇到第一个没有等值条件的列时，
+     * 用该列上的范围条件收紧上下界后停止，后面的列不再参与范围计算（仍然由pred_过滤）
+     */
     void analyze_conditions() {
-        for (const auto &cond : fed_conds_) {
-            // 只处理索引第一列的条件
-            if (cond.lhs_col.col_name == index_col_names_[0] && cond.is_rhs_val) {
-                char *key = cond.rhs_val.raw->data;
+        lower_key_.assign(index_meta_.col_tot_len, 0);
+        upper_key_.assign(index_meta_.col_tot_len, 0);
+        int lower_len = 0;  // 下界中由条件确定的前缀长度
+        int upper_len = 0;  // 上界中由条件确定的前缀长度
+        size_t eq_cols = 0;  // 有等值条件的前缀列数
+        for (const auto &col : index_meta_.cols) {
+            const char *eq = nullptr;
+            const char *lo = nullptr;
+            const char *hi = nullptr;
+            bool lo_inclusive = true;
+            bool hi_inclusive = true;
+            for (const auto &cond : fed_conds_) {
+                if (!cond.is_rhs_val || cond.lhs_col.col_name != col.name) {
+                    continue;
+                }
+                const char *val = cond.rhs_val.raw->data;
                 switch (cond.op) {
                     case OP_EQ:
-                        scan_ranges_.emplace_back(key, key, true, true);
-                        break;
-                    case OP_LT:
-                        scan_ranges_.emplace_back(nullptr, key, true, false);
-                        break;
-                    case OP_LE:
-                        scan_ranges_.emplace_back(nullptr, key, true, true);
+                        eq = val;
                         break;
                     case OP_GT:
-                        scan_ranges_.emplace_back(key, nullptr, false, true);
-                        break;
                     case OP_GE:
-                        scan_ranges_.emplace_back(key, nullptr, true, true);
+                        if (tighter(val, cond.op == OP_GE, lo, lo_inclusive, col, true)) {
+                            lo = val;
+                            lo_inclusive = cond.op == OP_GE;
+                        }
+                        break;
+                    case OP_LT:
+                    case OP_LE:
+                        if (tighter(val, cond.op == OP_LE, hi, hi_inclusive, col, false)) {
+                            hi = val;
+                            hi_inclusive = cond.op == OP_LE;
+                        }
                         break;
                     default:
                         break;
                 }
             }
+            if (eq != nullptr) {
+                memcpy(lower_key_.data() + lower_len, eq, col.len);
+                memcpy(upper_key_.data() + upper_len, eq, col.len);
+                lower_len += col.len;
+                upper_len += col.len;
+                eq_cols++;
+                continue;
+            }
+            if (lo != nullptr) {
+                memcpy(lower_key_.data() + lower_len, lo, col.len);
+                lower_len += col.len;
+                lower_inclusive_ = lo_inclusive;
+            }
+            if (hi != nullptr) {
+                memcpy(upper_key_.data() + upper_len, hi, col.len);
+                upper_len += col.len;
+                upper_inclusive_ = hi_inclusive;
+            }
+            break;
         }
-    }
+        has_lower_ = lower_len > 0;
+        has_upper_ = upper_len > 0;
+        point_lookup_ = eq_cols == index_meta_.cols.size();
 
-    // 对范围加锁
-    void lock_ranges() {
-        auto ih =
-            sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names_)).get();
-
-        for (const auto &range : scan_ranges_) {
-            // 获取范围边界的rid
-            Iid start_iid = Iid{-1, -1};
-            Iid end_iid = Iid{INT_MAX, INT_MAX};
-
-            // 获取下界rid
-            if (range.lower_key != nullptr) {
-                // 最小rid
-                start_iid = ih->lower_bound(range.lower_key);
-                auto scan = IxScan(ih, start_iid, ih->leaf_end(), sm_manager_->get_bpm());
-                if (!scan.is_end()) {
-                    start_iid = scan.iid();
-                    if (!range.lower_inclusive) {
-                        // 不包含下界,移到下一个
-                        scan.next();
-                        if (!scan.is_end()) {
-                            start_iid = scan.iid();
-                        }
-                    }
-                }
-            }
+        // 包含下界时用最小值填充剩余的列，使用lower_bound；不包含下界时用最大值填充，使用upper_bound。上界反之
+        fill_key_suffix(index_meta_.cols, lower_key_.data(), lower_len, !lower_inclusive_);
+        fill_key_suffix(index_meta_.cols, upper_key_.data(), upper_len, upper_inclusive_);
 
-            // 获取上界rid
-            if (range.upper_key != nullptr) {
-                end_iid = ih->lower_bound(range.upper_key);
-                auto scan = IxScan(ih, ih->leaf_begin(), end_iid, sm_manager_->get_bpm());
-
-                if(!scan.is_end()) {
-                    end_iid = scan.iid();
-                    if(!range.upper_inclusive) {
-                        // 不包含上界,使用当前位置
-                        end_iid = scan.iid();
-                    } else {
-                        // 包含上界,移到下一个
-                        scan.next();
-                        if(!scan.is_end()) {
-                            end_iid = scan.iid();
-                        }
-                    }
-                }
+        if (has_lower_ && has_upper_) {
+            std::vector<ColType> col_types;
+            std::vector<int> col_lens;
+            for (const auto &col : index_meta_.cols) {
+                col_types.push_back(col.type);
+                col_lens.push_back(col.len);
             }
+            int cmp = ix_compare(lower_key_.data(), upper_key_.data(), col_types, col_lens);
+            empty_range_ = cmp > 0 || (cmp == 0 && (!lower_inclusive_ || !upper_inclusive_));
+        }
+    }
 
-            // 对范围加锁
-            context_->lock_mgr_->lock_gap(context_->txn_, fh_->GetFd(), start_iid, end_iid);
+    /**
+     * @brief 判断同一列上的新边界val是否比当前边界bound更紧
+     * @param is_lower 为true表示比较的是下界（越大越紧），否则为上界（越小越紧）
+     */
+    static bool tighter(const char *val, bool val_inclusive, const char *bound, bool bound_inclusive,
+                        const ColMeta &col, bool is_lower) {
+        if (bound == nullptr) {
+            return true;
+        }
+        int cmp = ix_compare(val, bound, col.type, col.len);
+        if (cmp == 0) {
+            return bound_inclusive && !val_inclusive;
+        }
+        return is_lower ? cmp > 0 : cmp < 0;
+    }
+
+    // 对扫描范围加间隙锁
+    void lock_range(const Iid &lower, const Iid &upper) {
+        if (!has_lower_ && !has_upper_) {
+            return;
         }
+        Iid start_iid = has_lower_ ? lower : Iid{-1, -1};
+        Iid end_iid = has_upper_ ? upper : Iid{INT_MAX, INT_MAX};
+        context_->lock_mgr_->lock_gap(context_->txn_, fh_->GetFd(), start_iid, end_iid);
     }
 };
\ No newline at end of file
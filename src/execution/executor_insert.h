@@ -18,21 +18,24 @@ See the Mulan PSL v2 for more details. */
 
 class InsertExecutor : public AbstractExecutor {
    private:
-    TabMeta tab_;                // 表的元数据
-    std::vector<Value> values_;  // 需要插入的数据
-    RmFileHandle *fh_;           // 表的数据文件句柄
-    std::string tab_name_;       // 表名称
-    Rid rid_;  // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值
+    TabMeta tab_;                             // 表的元数据
+    std::vector<std::vector<Value>> rows_;    // 需要插入的数据，每个元素是一行
+    RmFileHandle *fh_;                        // 表的数据文件句柄
+    std::string tab_name_;                    // 表名称
+    Rid rid_;  // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值，多行时为最后一行的位置
     SmManager *sm_manager_;
 
    public:
-    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Value> values, Context *context) {
+    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<std::vector<Value>> rows,
+                   Context *context) {
         sm_manager_ = sm_manager;
         tab_ = sm_manager_->db_.get_table(tab_name);
-        values_ = values;
+        rows_ = std::move(rows);
         tab_name_ = tab_name;
-        if (values.size() != tab_.cols.size()) {
-            throw InvalidValueCountError();
+        for (auto &values : rows_) {
+            if (values.size() != tab_.cols.size()) {
+                throw InvalidValueCountError();
+            }
         }
         fh_ = sm_manager_->fhs_.at(tab_name).get();
         context_ = context;
@@ -41,34 +44,70 @@ class InsertExecutor : public AbstractExecutor {
     std::unique_ptr<RmRecord> Next() override {
         context_->lock_mgr_->lock_IX_on_table(context_->txn_, fh_->GetFd());
 
-        // Make record buffer
-        RmRecord rec(fh_->get_file_hdr().record_size);
-        for (size_t i = 0; i < values_.size(); i++) {
-            auto &col = tab_.cols[i];
-            auto &val = values_[i];
-            if (col.type != val.type) {
-                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+        // Make record buffers
+        std::vector<RmRecord> recs;
+        recs.reserve(rows_.size());
+        for (auto &values : rows_) {
+            RmRecord &rec = recs.emplace_back(fh_->get_file_hdr().record_size);
+            for (size_t i = 0; i < values.size(); i++) {
+                auto &col = tab_.cols[i];
+                auto &val = values[i];
+                if (col.type != val.type) {
+                    throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+                }
+                val.init_raw(col.len);
+                memcpy(rec.data + col.offset, val.raw->data, col.len);
             }
-            val.init_raw(col.len);
-            memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
         // Insert into record file
-        rid_ = fh_->insert_record(rec.data, context_);
-        context_->txn_->append_write_record(new WriteRecord(WType::INSERT_TUPLE, tab_name_, rid_, rec));
-        context_->lock_mgr_->check_gap_conflict(context_->txn_, fh_->GetFd(), rid_);
-        // Insert into index
+        std::vector<Rid> rids;
+        rids.reserve(recs.size());
+        for (auto &rec : recs) {
+            rids.push_back(fh_->insert_record(rec.data, context_));
+        }
+        // Insert into index，每个索引的所有新键值对一起排序后批量插入
         for (size_t i = 0; i < tab_.indexes.size(); ++i) {
-            auto &index = tab_.indexes[i];
-            auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            std::vector<char> key(index.col_tot_len);
-            int offset = 0;
-            for (size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key.data() + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+            try {
+                get_index_handle(tab_.indexes[i])->insert_entries(index_entries(tab_.indexes[i], recs, rids),
+                                                                  context_->txn_);
+            } catch (DuplicateKeyError &) {
+                // 违反唯一索引：撤销已经插入的索引项和记录，整条insert语句不生效
+                for (size_t j = 0; j < i; ++j) {
+                    get_index_handle(tab_.indexes[j])->delete_entries(index_entries(tab_.indexes[j], recs, rids),
+                                                                      context_->txn_);
+                }
+                for (auto &rid : rids) {
+                    fh_->delete_record(rid, context_);
+                }
+                throw;
             }
-            ih->insert_entry(key.data(), rid_, context_->txn_);
+        }
+        for (size_t i = 0; i < recs.size(); i++) {
+            context_->txn_->append_write_record(new WriteRecord(WType::INSERT_TUPLE, tab_name_, rids[i], recs[i]));
+        }
+        for (auto &rid : rids) {
+            context_->lock_mgr_->check_gap_conflict(context_->txn_, fh_->GetFd(), rid);
+        }
+        if (!rids.empty()) {
+            rid_ = rids.back();
         }
         return nullptr;
     }
     Rid &rid() override { return rid_; }
+
+   private:
+    IxIndexHandle *get_index_handle(const IndexMeta &index) {
+        return sm_manager_->get_index_handle(tab_name_, index.cols);
+    }
+
+    static std::vector<std::pair<std::vector<char>, Rid>> index_entries(const IndexMeta &index,
+                                                                        const std::vector<RmRecord> &recs,
+                                                                        const std::vector<Rid> &rids) {
+        std::vector<std::pair<std::vector<char>, Rid>> entries;
+        entries.reserve(recs.size());
+        for (size_t i = 0; i < recs.size(); i++) {
+            entries.emplace_back(index.get_key(recs[i].data), rids[i]);
+        }
+        return entries;
+    }
 };
\ No newline at end of file
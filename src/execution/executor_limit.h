@@ -0,0 +1,95 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * LIMIT/OFFSET：跳过儿子节点的前offset个元组，最多输出limit个
+ * 输出够limit个之后不再向儿子节点取元组，扫描随之提前结束
+ */
+class LimitExecutor : public AbstractExecutor {
+   private:
+    std::unique_ptr<AbstractExecutor> prev_;
+    size_t limit_;
+    size_t offset_;
+    size_t skipped_ = 0;  // 已经跳过的元组数
+    size_t emitted_ = 0;  // 已经输出的元组数
+
+   public:
+    LimitExecutor(std::unique_ptr<AbstractExecutor> prev, size_t limit, size_t offset) {
+        prev_ = std::move(prev);
+        limit_ = limit;
+        offset_ = offset;
+    }
+
+    void beginBatch() override {
+        skipped_ = 0;
+        emitted_ = 0;
+        if (limit_ > 0) {
+            prev_->beginBatch();
+        }
+    }
+
+    /**
+     * @brief 在儿子节点的chunk上只缩小选择向量，不拷贝元组
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        while (emitted_ < limit_ && prev_->NextBatch(chunk)) {
+            chunk.filter([this](const char *) {
+                if (skipped_ < offset_) {
+                    skipped_++;
+                    return false;
+                }
+                if (emitted_ == limit_) {
+                    return false;
+                }
+                emitted_++;
+                return true;
+            });
+            if (chunk.count() > 0) {
+                return true;
+            }
+        }
+        chunk.init(tupleLen());
+        return false;
+    }
+
+    void beginTuple() override {
+        skipped_ = 0;
+        emitted_ = 0;
+        if (limit_ == 0) {
+            return;
+        }
+        for (prev_->beginTuple(); skipped_ < offset_ && !prev_->is_end(); skipped_++) {
+            prev_->nextTuple();
+        }
+    }
+
+    void nextTuple() override {
+        if (++emitted_ < limit_) {
+            prev_->nextTuple();
+        }
+    }
+
+    bool is_end() const override { return emitted_ >= limit_ || prev_->is_end(); }
+
+    std::unique_ptr<RmRecord> Next() override { return prev_->Next(); }
+
+    Rid &rid() override { return prev_->rid(); }
+
+    size_t tupleLen() const override { return prev_->tupleLen(); }
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
+};
@@ -0,0 +1,189 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 等值连接的sort-merge join
+ * 要求左右儿子的输出都已经按连接key升序排列（例如在连接字段上的B+树索引扫描），
+ * key取连接条件中第一个两边各有一个字段的等值条件，由planner保证两边按它有序。
+ * 两边各有一个游标同步前进，每边只读一遍；key相同时把右边这一组元组复制到group_中，
+ * 再与左边key相同的每个元组逐个拼接，因此两边都可以有重复的key。输出前仍然用全部连接条件检查
+ */
+class MergeJoinExecutor : public BatchExecutor {
+   private:
+    /* 儿子节点输出上的游标，逐个元组前进，当前chunk取完时读取下一个chunk */
+    struct Cursor {
+        AbstractExecutor *child;
+        DataChunk chunk;
+        size_t pos = 0;
+        bool valid = false;  // 是否指向一个元组，为false时儿子节点已经取完
+
+        void begin() {
+            child->beginBatch();
+            fetch();
+        }
+
+        void fetch() {
+            pos = 0;
+            valid = child->NextBatch(chunk);
+        }
+
+        void advance() {
+            if (++pos == chunk.count()) {
+                fetch();
+            }
+        }
+
+        const char *row() const { return chunk.row(pos); }
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;   // 左儿子节点
+    std::unique_ptr<AbstractExecutor> right_;  // 右儿子节点
+    size_t left_len_;
+    size_t right_len_;
+    size_t len_;                               // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                // join后获得的记录的字段
+    std::vector<Condition> fed_conds_;         // join条件
+    CompiledPredicate pred_;                   // 由fed_conds_编译得到的谓词
+    int left_key_offset_ = -1;                 // 连接key在左边元组中的偏移
+    int right_key_offset_ = -1;                // 连接key在右边元组中的偏移
+    ColType key_type_;
+    int key_len_;
+
+    Cursor left_cur_;
+    Cursor right_cur_;
+    std::vector<char> group_;  // 右边与左边当前元组key相同的一组元组
+    size_t group_rows_ = 0;    // group_中的元组数，为0时没有正在拼接的组
+    size_t group_pos_ = 0;     // 左边当前元组下一个要拼接的group_中的元组
+
+   public:
+    MergeJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                      std::vector<Condition> conds) {
+        left_ = std::move(left);
+        right_ = std::move(right);
+        left_len_ = left_->tupleLen();
+        right_len_ = right_->tupleLen();
+        len_ = left_len_ + right_len_;
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_len_;
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_, left_len_);
+
+        for (auto &cond : fed_conds_) {
+            if (cond.is_rhs_val || cond.op != OP_EQ) {
+                continue;
+            }
+            auto lhs_col = get_col(cols_, cond.lhs_col);
+            auto rhs_col = get_col(cols_, cond.rhs_col);
+            bool lhs_left = lhs_col->offset < static_cast<int>(left_len_);
+            bool rhs_left = rhs_col->offset < static_cast<int>(left_len_);
+            if (lhs_left == rhs_left) {
+                continue;
+            }
+            auto left_col = lhs_left ? lhs_col : rhs_col;
+            auto right_col = lhs_left ? rhs_col : lhs_col;
+            left_key_offset_ = left_col->offset;
+            right_key_offset_ = right_col->offset - static_cast<int>(left_len_);
+            key_type_ = left_col->type;
+            key_len_ = left_col->len;
+            break;
+        }
+        if (left_key_offset_ < 0) {
+            throw InternalError("Merge join requires an equality condition between its inputs");
+        }
+        left_cur_.child = left_.get();
+        right_cur_.child = right_.get();
+    }
+
+    void beginBatch() override {
+        left_cur_.begin();
+        right_cur_.begin();
+        group_.clear();
+        group_rows_ = 0;
+        group_pos_ = 0;
+    }
+
+    /**
+     * @brief 两边的游标按key的大小交替前进，遇到相同的key时输出左边每个元组与右边这一组元组的拼接；
+     * chunk写满时记住左边的游标和group_pos_，下一次从这里继续
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        while (!chunk.is_full()) {
+            if (group_rows_ > 0) {
+                const char *left_rec = left_cur_.row();
+                for (; group_pos_ < group_rows_ && !chunk.is_full(); group_pos_++) {
+                    const char *right_rec = group_.data() + group_pos_ * right_len_;
+                    if (pred_.eval(left_rec, right_rec)) {
+                        char *join_rec = chunk.append();
+                        memcpy(join_rec, left_rec, left_len_);
+                        memcpy(join_rec + left_len_, right_rec, right_len_);
+                    }
+                }
+                if (group_pos_ < group_rows_) {
+                    break;
+                }
+                // 左边的下一个元组key仍然相同时，与同一组再拼接一遍
+                group_pos_ = 0;
+                left_cur_.advance();
+                if (!left_cur_.valid || compare_key(left_cur_.row(), group_.data()) != 0) {
+                    group_rows_ = 0;
+                }
+                continue;
+            }
+            if (!left_cur_.valid || !right_cur_.valid) {
+                break;
+            }
+            int cmp = compare_key(left_cur_.row(), right_cur_.row());
+            if (cmp < 0) {
+                left_cur_.advance();
+            } else if (cmp > 0) {
+                right_cur_.advance();
+            } else {
+                load_group();
+            }
+        }
+        return chunk.count() > 0;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+   private:
+    // 比较左边元组与右边元组的连接key
+    int compare_key(const char *left_rec, const char *right_rec) const {
+        return ix_compare(left_rec + left_key_offset_, right_rec + right_key_offset_, key_type_, key_len_);
+    }
+
+    // 把右边与左边当前元组key相同的所有元组复制到group_中，右边的游标停在这一组之后
+    void load_group() {
+        group_.clear();
+        group_rows_ = 0;
+        group_pos_ = 0;
+        const char *left_rec = left_cur_.row();
+        while (right_cur_.valid && compare_key(left_rec, right_cur_.row()) == 0) {
+            group_.insert(group_.end(), right_cur_.row(), right_cur_.row() + right_len_);
+            group_rows_++;
+            right_cur_.advance();
+        }
+    }
+};
@@ -22,11 +22,19 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     size_t len_;                               // join后获得的每条记录的长度
     std::vector<ColMeta> cols_;                // join后获得的记录的字段
     std::vector<Condition> fed_conds_;         // join条件
+    CompiledPredicate pred_;                   // 由fed_conds_编译得到的谓词，分别传入左右两边的元组求值
     bool isend;
 
     std::unique_ptr<RmRecord> left_rec_;   // 左表当前记录
     std::unique_ptr<RmRecord> right_rec_;  // 右表当前记录
 
+    // 批量执行：左表的一个chunk与右表逐个chunk做连接，右表扫描完一遍之后再取左表的下一个chunk
+    DataChunk left_chunk_;
+    DataChunk right_chunk_;
+    bool left_valid_ = false;   // left_chunk_中有未处理完的元组
+    bool right_valid_ = false;  // right_chunk_中有未处理完的元组
+    size_t pair_pos_ = 0;       // 当前两个chunk之间下一个要检查的元组对，左表元组下标 * 右表元组数 + 右表元组下标
+
    public:
     NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
                            std::vector<Condition> conds) {
@@ -42,6 +50,7 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
         isend = false;
         fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_, left_->tupleLen());
     }
 
     void beginTuple() override {
@@ -58,6 +67,10 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
             return;
         }
         right_rec_ = right_->Next();
+        // 第一对记录同样要满足连接条件
+        if (!pred_.eval(left_rec_->data, right_rec_->data)) {
+            nextTuple();
+        }
     }
 
     void nextTuple() override {
@@ -75,9 +88,7 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
             }
 
             right_rec_ = right_->Next();
-            if (eval_conds(fed_conds_, [this](const Condition &cond) {
-                    return get_compare_values(left_rec_.get(), right_rec_.get(), cond);
-                })) {
+            if (pred_.eval(left_rec_->data, right_rec_->data)) {
                 return;  // 找到匹配的记录对
             }
         }
@@ -90,35 +101,60 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         return join_rec;
     }
 
-    bool is_end() const override { return isend; }
-
-    Rid &rid() override { return _abstract_rid; }
-
-   private:
-    std::tuple<char *, char *, ColType, int> get_compare_values(const RmRecord *left_rec, const RmRecord *right_rec,
-                                                                const Condition &cond) {
-        auto lhs_col = get_col(cols_, cond.lhs_col);
-        auto rhs_col = get_col(cols_, cond.rhs_col);
-
-        char *lhs_val = nullptr;
-        char *rhs_val = nullptr;
-
-        // 确定左值来自哪个表
-        if (lhs_col->offset < static_cast<int>(left_->tupleLen())) {
-            lhs_val = left_rec->data + lhs_col->offset;
-        } else {
-            lhs_val = right_rec->data + (lhs_col->offset - left_->tupleLen());
+    void beginBatch() override {
+        pair_pos_ = 0;
+        left_->beginBatch();
+        left_valid_ = left_->NextBatch(left_chunk_);
+        right_valid_ = false;
+        if (left_valid_) {
+            right_->beginBatch();
+            right_valid_ = right_->NextBatch(right_chunk_);
+            left_valid_ = right_valid_;  // 右表为空时连接结果为空
         }
+    }
 
-        // 确定右值来自哪个表
-        if (rhs_col->offset < static_cast<int>(left_->tupleLen())) {
-            rhs_val = left_rec->data + rhs_col->offset;
-        } else {
-            rhs_val = right_rec->data + (rhs_col->offset - left_->tupleLen());
+    /**
+     * @brief 在左右两个chunk的所有元组对上计算连接条件，满足条件的元组对拼接后写入chunk；
+     * chunk写满时记住pair_pos_，下一次从这里继续
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        size_t left_len = left_->tupleLen();
+        size_t right_len = right_->tupleLen();
+        while (left_valid_ && !chunk.is_full()) {
+            size_t right_count = right_chunk_.count();
+            size_t pair_count = left_chunk_.count() * right_count;
+            for (; pair_pos_ < pair_count && !chunk.is_full(); pair_pos_++) {
+                const char *left_rec = left_chunk_.row(pair_pos_ / right_count);
+                const char *right_rec = right_chunk_.row(pair_pos_ % right_count);
+                if (pred_.eval(left_rec, right_rec)) {
+                    char *join_rec = chunk.append();
+                    memcpy(join_rec, left_rec, left_len);
+                    memcpy(join_rec + left_len, right_rec, right_len);
+                }
+            }
+            if (pair_pos_ < pair_count) {
+                break;
+            }
+            pair_pos_ = 0;
+            right_valid_ = right_->NextBatch(right_chunk_);
+            if (!right_valid_) {
+                left_valid_ = left_->NextBatch(left_chunk_);
+                if (left_valid_) {
+                    right_->beginBatch();
+                    right_valid_ = right_->NextBatch(right_chunk_);
+                }
+            }
         }
-
-        return {lhs_val, rhs_val, lhs_col->type, lhs_col->len};
+        return chunk.count() > 0;
     }
 
+    bool is_end() const override { return isend; }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    size_t tupleLen() const override { return len_; }
+
+   private:
     const std::vector<ColMeta> &cols() const override { return cols_; }
 };
\ No newline at end of file
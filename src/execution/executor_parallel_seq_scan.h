@@ -0,0 +1,256 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 按morsel并行的顺序扫描
+ * 表的数据页[RM_FIRST_RECORD_PAGE, num_pages)每MORSEL_PAGES页为一个morsel，工作线程每次领取编号最小的未领取的morsel，
+ * 在自己的线程中读页、计算谓词并做投影，结果放进这个morsel的槽位。
+ * 汇集（gather）在调用NextBatch的线程中进行，按morsel的编号依次输出，因此输出的顺序与SeqScanExecutor相同。
+ * 工作线程最多领先汇集MORSEL_WINDOW_PER_WORKER * 线程数个morsel，限制缓存的结果占用的内存
+ */
+class ParallelSeqScanExecutor : public BatchExecutor {
+   private:
+    static constexpr size_t MORSEL_WINDOW_PER_WORKER = 2;  // 每个工作线程对应的槽位数
+
+    std::string tab_name_;              // 表的名称
+    std::vector<Condition> conds_;      // scan的条件
+    RmFileHandle *fh_;                  // 表的数据文件句柄
+    size_t tab_len_;                    // 表中每条记录的长度
+    std::vector<ColMeta> cols_;         // 输出的字段，没有投影时为表的字段
+    size_t len_;                        // 输出的每条记录的长度
+    std::vector<ColMeta> proj_cols_;    // 需要投影时每个输出字段在表中的位置，不需要投影时为空
+    CompiledPredicate pred_;            // 由conds_编译得到的谓词，只读，工作线程共享
+    size_t num_workers_;                // 工作线程数
+
+    SmManager *sm_manager_;
+
+    // 以下由工作线程和汇集线程共享，受mutex_保护
+    std::mutex mutex_;
+    std::condition_variable worker_cv_;          // 有新的morsel可以领取，或者需要停止
+    std::condition_variable gather_cv_;          // 有morsel扫描完成，或者工作线程出错
+    std::vector<std::vector<DataChunk>> slots_;  // 第m个morsel的结果放在slots_[m % slots_.size()]
+    std::vector<bool> ready_;                    // 槽位中的结果是否已经完成
+    size_t next_morsel_ = 0;                     // 下一个要领取的morsel
+    size_t emit_morsel_ = 0;                     // 下一个要汇集的morsel
+    bool stop_ = false;                          // 通知工作线程退出
+    std::exception_ptr error_;                   // 工作线程抛出的异常，由汇集线程重新抛出
+
+    // beginBatch时确定，扫描过程中不变
+    RmFileHdr file_hdr_{};
+    size_t num_morsels_ = 0;
+    std::vector<std::thread> workers_;
+
+    std::vector<DataChunk> emit_chunks_;  // 正在输出的morsel的结果
+    size_t emit_pos_ = 0;
+
+   public:
+    /**
+     * @param sel_cols 工作线程直接投影出的字段，为空时输出表的全部字段
+     * @param num_workers 工作线程数
+     */
+    ParallelSeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                            const std::vector<TabCol> &sel_cols, Context *context,
+                            size_t num_workers = default_workers()) {
+        sm_manager_ = sm_manager;
+        tab_name_ = std::move(tab_name);
+        conds_ = std::move(conds);
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
+        fh_ = sm_manager_->fhs_.at(tab_name_).get();
+        tab_len_ = tab.cols.back().offset + tab.cols.back().len;
+        context_ = context;
+        pred_ = CompiledPredicate(conds_, tab.cols);
+        num_workers_ = std::max<size_t>(num_workers, 1);
+
+        cols_ = tab.cols;
+        len_ = tab_len_;
+        if (!sel_cols.empty()) {
+            cols_.clear();
+            len_ = 0;
+            for (auto &sel_col : sel_cols) {
+                auto col = *get_col(tab.cols, sel_col);
+                proj_cols_.push_back(col);
+                col.offset = static_cast<int>(len_);
+                len_ += col.len;
+                cols_.push_back(col);
+            }
+        }
+    }
+
+    ~ParallelSeqScanExecutor() override { stop_workers(); }
+
+    // 默认的工作线程数，与CPU核数相同
+    static size_t default_workers() { return std::max(std::thread::hardware_concurrency(), 1u); }
+
+    /**
+     * @brief 对整张表加共享锁，按当前的页数切分morsel并启动工作线程；重复调用时先停止上一次扫描的工作线程
+     */
+    void beginBatch() override {
+        stop_workers();
+        context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd());
+        file_hdr_ = fh_->get_file_hdr();
+        int data_pages = std::max(file_hdr_.num_pages - RM_FIRST_RECORD_PAGE, 0);
+        num_morsels_ = (data_pages + MORSEL_PAGES - 1) / MORSEL_PAGES;
+        next_morsel_ = 0;
+        emit_morsel_ = 0;
+        stop_ = false;
+        error_ = nullptr;
+        slots_.assign(num_workers_ * MORSEL_WINDOW_PER_WORKER, {});
+        ready_.assign(slots_.size(), false);
+        emit_chunks_.clear();
+        emit_pos_ = 0;
+        for (size_t i = 0; i < std::min(num_workers_, num_morsels_); i++) {
+            workers_.emplace_back(&ParallelSeqScanExecutor::work, this);
+        }
+    }
+
+    /**
+     * @brief 汇集：等待下一个morsel完成，依次输出它的结果chunk
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        while (emit_pos_ == emit_chunks_.size()) {
+            if (emit_morsel_ == num_morsels_) {
+                chunk.init(len_);
+                return false;
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                size_t slot = emit_morsel_ % slots_.size();
+                gather_cv_.wait(lock, [&] { return ready_[slot] || error_ != nullptr; });
+                if (error_ != nullptr) {
+                    std::rethrow_exception(error_);
+                }
+                emit_chunks_ = std::move(slots_[slot]);
+                slots_[slot].clear();
+                ready_[slot] = false;
+                emit_morsel_++;
+            }
+            emit_pos_ = 0;
+            worker_cv_.notify_all();
+        }
+        std::swap(chunk, emit_chunks_[emit_pos_++]);
+        return true;
+    }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    size_t tupleLen() const override { return len_; }
+
+   private:
+    /**
+     * @brief 工作线程：不断领取下一个morsel并扫描，直到所有morsel都被领取或者需要停止
+     */
+    void work() {
+        try {
+            for (;;) {
+                size_t morsel;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    worker_cv_.wait(lock, [&] {
+                        return stop_ || next_morsel_ == num_morsels_ || next_morsel_ < emit_morsel_ + slots_.size();
+                    });
+                    if (stop_ || next_morsel_ == num_morsels_) {
+                        return;
+                    }
+                    morsel = next_morsel_++;
+                }
+                std::vector<DataChunk> result;
+                scan_morsel(morsel, result);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    slots_[morsel % slots_.size()] = std::move(result);
+                    ready_[morsel % slots_.size()] = true;
+                }
+                gather_cv_.notify_one();
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                error_ = std::current_exception();
+                stop_ = true;
+            }
+            gather_cv_.notify_one();
+            worker_cv_.notify_all();
+        }
+    }
+
+    /**
+     * @brief 扫描一个morsel中的页面：把记录拷贝进chunk，chunk满或者morsel结束时计算谓词，再投影到结果中
+     */
+    void scan_morsel(size_t morsel, std::vector<DataChunk> &result) const {
+        int first_page = RM_FIRST_RECORD_PAGE + static_cast<int>(morsel) * MORSEL_PAGES;
+        int last_page = std::min(first_page + MORSEL_PAGES, file_hdr_.num_pages);
+        DataChunk chunk(tab_len_);
+        for (int page_no = first_page; page_no < last_page; page_no++) {
+            RmPageHandle page_handle = fh_->fetch_page_handle(page_no);
+            for (int slot_no = 0; slot_no < file_hdr_.num_records_per_page; slot_no++) {
+                if (Bitmap::is_set(page_handle.bitmap, slot_no)) {
+                    memcpy(chunk.append(Rid{page_no, slot_no}), page_handle.get_slot(slot_no), tab_len_);
+                    if (chunk.is_full()) {
+                        flush(chunk, result);
+                    }
+                }
+            }
+            sm_manager_->get_bpm()->unpin_page(page_handle.page->get_page_id(), false);
+        }
+        flush(chunk, result);
+    }
+
+    /**
+     * @brief 过滤chunk中的记录，把满足条件的记录放入结果；不需要投影时整个chunk直接移入结果，否则投影到紧凑的chunk中
+     */
+    void flush(DataChunk &chunk, std::vector<DataChunk> &result) const {
+        pred_.filter(chunk);
+        if (chunk.count() == 0) {
+            chunk.reset();
+            return;
+        }
+        if (proj_cols_.empty()) {
+            result.push_back(std::move(chunk));
+            chunk = DataChunk(tab_len_);
+            return;
+        }
+        for (size_t i = 0; i < chunk.count(); i++) {
+            if (result.empty() || result.back().is_full()) {
+                result.emplace_back(len_);
+            }
+            const char *rec = chunk.row(i);
+            char *proj_rec = result.back().append(chunk.rid(i));
+            for (size_t j = 0; j < proj_cols_.size(); j++) {
+                memcpy(proj_rec + cols_[j].offset, rec + proj_cols_[j].offset, cols_[j].len);
+            }
+        }
+        chunk.reset();
+    }
+
+    void stop_workers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        worker_cv_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+    }
+};
@@ -21,6 +21,7 @@ class ProjectionExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;               // 需要投影的字段
     size_t len_;                              // 字段总长度
     std::vector<size_t> sel_idxs_;
+    DataChunk prev_chunk_;                    // 批量执行时儿子节点产生的元组
 
    public:
     ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols) {
@@ -60,6 +61,27 @@ class ProjectionExecutor : public AbstractExecutor {
         return proj_rec;
     }
 
+    void beginBatch() override { prev_->beginBatch(); }
+
+    /**
+     * @brief 对儿子节点产生的一批元组做投影，只拷贝选择向量中的有效元组，输出的chunk是紧凑的
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        if (!prev_->NextBatch(prev_chunk_)) {
+            return false;
+        }
+        auto &prev_cols = prev_->cols();
+        for (size_t i = 0; i < prev_chunk_.count(); i++) {
+            const char *rec = prev_chunk_.row(i);
+            char *proj_rec = chunk.append(prev_chunk_.rid(i));
+            for (size_t j = 0; j < sel_idxs_.size(); j++) {
+                memcpy(proj_rec + cols_[j].offset, rec + prev_cols[sel_idxs_[j]].offset, cols_[j].len);
+            }
+        }
+        return true;
+    }
+
     void beginTuple() override { prev_->beginTuple(); }
 
     void nextTuple() override { prev_->nextTuple(); }
@@ -28,6 +28,9 @@ class SeqScanExecutor : public AbstractExecutor {
     Rid rid_;
     std::unique_ptr<RecScan> scan_;  // table_iterator
 
+    CompiledPredicate pred_;              // 由fed_conds_编译得到的谓词
+    Rid batch_rid_;                       // 批量执行时下一个要检查的slot
+
     SmManager *sm_manager_;
 
    public:
@@ -43,6 +46,7 @@ class SeqScanExecutor : public AbstractExecutor {
         context_ = context;
 
         fed_conds_ = conds_;
+        pred_ = CompiledPredicate(fed_conds_, cols_);
     }
 
     /**
@@ -57,8 +61,7 @@ class SeqScanExecutor : public AbstractExecutor {
         while (!scan_->is_end()) {
             rid_ = scan_->rid();
             auto rec = fh_->get_record(rid_, context_);
-            if (eval_conds(fed_conds_,
-                           [this, rec = rec.get()](const Condition &cond) { return get_compare_values(rec, cond); })) {
+            if (pred_.eval(rec->data)) {
                 return;
             }
             scan_->next();
@@ -77,8 +80,7 @@ class SeqScanExecutor : public AbstractExecutor {
         for (scan_->next(); !scan_->is_end(); scan_->next()) {
             rid_ = scan_->rid();
             auto rec = fh_->get_record(rid_, context_);
-            if (eval_conds(fed_conds_,
-                           [this, rec = rec.get()](const Condition &cond) { return get_compare_values(rec, cond); })) {
+            if (pred_.eval(rec->data)) {
                 return;
             }
         }
@@ -94,6 +96,42 @@ class SeqScanExecutor : public AbstractExecutor {
         return fh_->get_record(rid_, context_);
     }
 
+    /**
+     * @brief 批量扫描同样对整张表加共享锁。表级共享锁已经阻止了其他事务修改这张表，因此不再逐条加记录锁
+     */
+    void beginBatch() override {
+        context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd());
+        batch_rid_ = Rid{RM_FIRST_RECORD_PAGE, 0};
+    }
+
+    /**
+     * @brief 按页读取记录，每个页面只fetch一次，把页面中的记录直接拷贝进chunk，再对整个chunk计算谓词
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        RmFileHdr file_hdr = fh_->get_file_hdr();
+        while (batch_rid_.page_no < file_hdr.num_pages) {
+            chunk.reset();
+            while (!chunk.is_full() && batch_rid_.page_no < file_hdr.num_pages) {
+                RmPageHandle page_handle = fh_->fetch_page_handle(batch_rid_.page_no);
+                for (; batch_rid_.slot_no < file_hdr.num_records_per_page && !chunk.is_full(); batch_rid_.slot_no++) {
+                    if (Bitmap::is_set(page_handle.bitmap, batch_rid_.slot_no)) {
+                        memcpy(chunk.append(batch_rid_), page_handle.get_slot(batch_rid_.slot_no), len_);
+                    }
+                }
+                sm_manager_->get_bpm()->unpin_page(page_handle.page->get_page_id(), false);
+                if (batch_rid_.slot_no == file_hdr.num_records_per_page) {
+                    batch_rid_ = Rid{batch_rid_.page_no + 1, 0};
+                }
+            }
+            pred_.filter(chunk);
+            if (chunk.count() > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool is_end() const override { return scan_->is_end(); }
 
     Rid &rid() override { return rid_; }
@@ -101,13 +139,4 @@ class SeqScanExecutor : public AbstractExecutor {
     const std::vector<ColMeta> &cols() const override { return cols_; }
 
     size_t tupleLen() const override { return len_; }
-
-   private:
-    std::tuple<char *, char *, ColType, int> get_compare_values(const RmRecord *rec, const Condition &cond) {
-        auto lhs_col = get_col(cols_, cond.lhs_col);
-        char *lhs = rec->data + lhs_col->offset;
-
-        char *rhs = cond.is_rhs_val ? cond.rhs_val.raw->data : get_value(cols_, cond.rhs_col, rec);
-        return {lhs, rhs, lhs_col->type, lhs_col->len};
-    }
-};
\ No newline at end of file
+};
@@ -0,0 +1,151 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_aggregate.h"
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * 流式聚集，要求输入中分组key相同的元组是相邻的（例如按分组字段有序的索引扫描）
+ * 只保存当前一组的key和聚集状态，分组key变化时输出这一组，不需要哈希表，输出按输入的顺序。
+ * 输出的格式与HashAggregateExecutor相同：先是分组字段，然后是各个聚集函数的结果。没有分组字段时恰好输出一行
+ */
+class StreamAggregateExecutor : public BatchExecutor {
+   private:
+    /* 一个分组字段 */
+    struct KeyCol {
+        int in_offset;   // 字段在输入元组中的偏移
+        int key_offset;  // 字段在分组key中的偏移，也是在输出元组中的偏移
+        ColType type;
+        int len;
+    };
+
+    std::unique_ptr<AbstractExecutor> prev_;
+    std::vector<KeyCol> keys_;       // 分组字段
+    size_t key_len_ = 0;             // 分组key的长度
+    AggregateFunctions funcs_;
+    size_t len_;                     // 输出元组的长度
+    std::vector<ColMeta> cols_;      // 输出元组的字段
+
+    std::vector<char> group_;        // 当前一组的key和聚集状态
+    bool has_group_ = false;         // group_中有还没有输出的组
+    bool emitted_ = false;           // 已经输出过至少一组
+    DataChunk in_chunk_;             // 儿子节点的chunk
+    size_t in_pos_ = 0;              // in_chunk_中下一个要聚集的元组
+    bool in_done_ = true;            // 儿子节点已经取完
+
+   public:
+    /**
+     * @param group_cols 分组字段，输入中这些字段都相同的元组必须相邻
+     * @param aggs 聚集函数
+     */
+    StreamAggregateExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &group_cols,
+                            const std::vector<AggExpr> &aggs) {
+        prev_ = std::move(prev);
+        for (const auto &group_col : group_cols) {
+            ColMeta col = *get_col(prev_->cols(), group_col);
+            keys_.push_back({col.offset, static_cast<int>(key_len_), col.type, col.len});
+            col.offset = static_cast<int>(key_len_);
+            cols_.push_back(col);
+            key_len_ += col.len;
+        }
+        funcs_ = AggregateFunctions(aggs, prev_->cols(), static_cast<int>(key_len_));
+        cols_.insert(cols_.end(), funcs_.cols().begin(), funcs_.cols().end());
+        len_ = cols_.empty() ? 0 : cols_.back().offset + cols_.back().len;
+        group_.resize(key_len_ + funcs_.state_len());
+    }
+
+    void beginBatch() override {
+        prev_->beginBatch();
+        in_chunk_.init(prev_->tupleLen());
+        in_pos_ = 0;
+        in_done_ = false;
+        has_group_ = false;
+        emitted_ = false;
+    }
+
+    /**
+     * @brief 依次聚集儿子节点的元组，分组key变化时输出当前一组；儿子节点取完时输出最后一组
+     */
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(len_);
+        while (!chunk.is_full()) {
+            if (in_pos_ == in_chunk_.count()) {
+                if (!in_done_ && prev_->NextBatch(in_chunk_)) {
+                    in_pos_ = 0;
+                    continue;
+                }
+                in_done_ = true;
+                in_pos_ = 0;
+                in_chunk_.reset();
+                if (!has_group_ && keys_.empty() && !emitted_) {
+                    // 没有分组字段时，即使输入为空也输出一行
+                    start_group(nullptr);
+                }
+                if (has_group_) {
+                    emit(chunk);
+                }
+                break;
+            }
+            const char *rec = in_chunk_.row(in_pos_);
+            if (has_group_ && !key_equal(rec)) {
+                emit(chunk);
+                continue;
+            }
+            if (!has_group_) {
+                start_group(rec);
+            }
+            funcs_.update(group_.data() + key_len_, rec);
+            in_pos_++;
+        }
+        return chunk.count() > 0;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+   private:
+    /**
+     * @brief 以rec的分组key开始新的一组，浮点数的-0按+0保存；没有分组字段时rec可以为nullptr
+     */
+    void start_group(const char *rec) {
+        for (auto &key : keys_) {
+            memcpy(group_.data() + key.key_offset, rec + key.in_offset, key.len);
+            if (key.type == TYPE_FLOAT && *reinterpret_cast<float *>(group_.data() + key.key_offset) == 0.0f) {
+                *reinterpret_cast<float *>(group_.data() + key.key_offset) = 0.0f;
+            }
+        }
+        funcs_.init(group_.data() + key_len_);
+        has_group_ = true;
+    }
+
+    void emit(DataChunk &chunk) {
+        char *out = chunk.append();
+        memcpy(out, group_.data(), key_len_);
+        funcs_.finalize(group_.data() + key_len_, out);
+        has_group_ = false;
+        emitted_ = true;
+    }
+
+    bool key_equal(const char *rec) const {
+        for (auto &key : keys_) {
+            if (ix_compare(group_.data() + key.key_offset, rec + key.in_offset, key.type, key.len) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -9,6 +9,9 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+
+#include <algorithm>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -24,6 +27,7 @@ class UpdateExecutor : public AbstractExecutor {
     std::vector<Rid> rids_;
     std::string tab_name_;
     std::vector<SetClause> set_clauses_;
+    std::vector<IndexMeta> indexes_;  // 包含被set_clauses_修改的字段的索引，其余索引的key不会变化，不需要维护
     SmManager* sm_manager_;
 
    public:
@@ -37,54 +41,83 @@ class UpdateExecutor : public AbstractExecutor {
         conds_ = conds;
         rids_ = rids;
         context_ = context;
+        for (auto& index : tab_.indexes) {
+            bool touched = std::any_of(index.cols.begin(), index.cols.end(), [this](const ColMeta& col) {
+                return std::any_of(set_clauses_.begin(), set_clauses_.end(),
+                                   [&col](const SetClause& set_clause) { return set_clause.lhs.col_name == col.name; });
+            });
+            if (touched) {
+                indexes_.push_back(index);
+            }
+        }
     }
 
     std::unique_ptr<RmRecord> Next() override {
+        std::vector<RmRecord> old_recs;
+        std::vector<RmRecord> new_recs;
+        old_recs.reserve(rids_.size());
+        new_recs.reserve(rids_.size());
         for (auto& rid : rids_) {
             context_->lock_mgr_->lock_exclusive_on_record(context_->txn_, rid, fh_->GetFd());
 
             auto rec = fh_->get_record(rid, context_);
             context_->txn_->append_write_record(new WriteRecord(WType::UPDATE_TUPLE, tab_name_, rid, *rec));
             context_->lock_mgr_->check_gap_conflict(context_->txn_, fh_->GetFd(), rid);
-            // delete old index entries
-            for (auto& index : tab_.indexes) {
-                auto ih =
-                    sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-
-                std::vector<char> old_key(index.col_tot_len);
-                int offset = 0;
-                for (auto& col : index.cols) {
-                    memcpy(old_key.data() + offset, rec->data + col.offset, col.len);
-                    offset += col.len;
-                }
-
-                ih->delete_entry(old_key.data(), context_->txn_);
-            }
-
-            // update record
+            old_recs.push_back(*rec);
             for (auto& set_clause : set_clauses_) {
                 auto col = tab_.get_col(set_clause.lhs.col_name);
                 memcpy(rec->data + col->offset, set_clause.rhs.raw->data, col->len);
             }
-            fh_->update_record(rid, rec->data, context_);
-
-            // insert new index entries
-            for (auto& index : tab_.indexes) {
-                auto ih =
-                    sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+            new_recs.push_back(*rec);
+        }
 
-                std::vector<char> new_key(index.col_tot_len);
-                int offset = 0;
-                for (auto& col : index.cols) {
-                    memcpy(new_key.data() + offset, rec->data + col.offset, col.len);
-                    offset += col.len;
+        // key没有变化的行保留原来的索引项（rid也不变），只维护key变化了的行
+        std::vector<std::vector<std::pair<std::vector<char>, Rid>>> old_entries(indexes_.size());
+        std::vector<std::vector<std::pair<std::vector<char>, Rid>>> new_entries(indexes_.size());
+        for (size_t i = 0; i < indexes_.size(); ++i) {
+            for (size_t j = 0; j < rids_.size(); j++) {
+                auto old_key = indexes_[i].get_key(old_recs[j].data);
+                auto new_key = indexes_[i].get_key(new_recs[j].data);
+                if (old_key != new_key) {
+                    old_entries[i].emplace_back(std::move(old_key), rids_[j]);
+                    new_entries[i].emplace_back(std::move(new_key), rids_[j]);
                 }
+            }
+        }
 
-                ih->insert_entry(new_key.data(), rid, context_->txn_);
+        // 先删除所有旧索引项，再批量插入所有新索引项；这样交换两行的唯一key也不会误报冲突
+        for (size_t i = 0; i < indexes_.size(); ++i) {
+            get_index_handle(indexes_[i])->delete_entries(old_entries[i], context_->txn_);
+        }
+        // update records
+        for (size_t i = 0; i < rids_.size(); i++) {
+            fh_->update_record(rids_[i], new_recs[i].data, context_);
+        }
+        // insert new index entries
+        for (size_t i = 0; i < indexes_.size(); ++i) {
+            try {
+                get_index_handle(indexes_[i])->insert_entries(new_entries[i], context_->txn_);
+            } catch (DuplicateKeyError&) {
+                // 违反唯一索引：删除已经插入的新索引项，恢复旧记录和旧索引项
+                for (size_t j = 0; j < i; ++j) {
+                    get_index_handle(indexes_[j])->delete_entries(new_entries[j], context_->txn_);
+                }
+                for (size_t j = 0; j < rids_.size(); j++) {
+                    fh_->update_record(rids_[j], old_recs[j].data, context_);
+                }
+                for (size_t j = 0; j < indexes_.size(); ++j) {
+                    get_index_handle(indexes_[j])->insert_entries(old_entries[j], context_->txn_);
+                }
+                throw;
             }
         }
         return nullptr;
     }
 
     Rid& rid() override { return _abstract_rid; }
+
+   private:
+    IxIndexHandle* get_index_handle(const IndexMeta& index) {
+        return sm_manager_->get_index_handle(tab_name_, index.cols);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,105 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "data_chunk.h"
+#include "defs.h"
+#include "spill_file.h"
+
+/*
+ * hash join和哈希聚集共用的key哈希与溢出分区
+ * 哈希表使用哈希值的低位，分区使用高位：第level层分区取从最高位往下的第level段SPILL_FANOUT_BITS位，
+ * 因此同一个分区继续分区时用的是哈希值的下一段，与上一层及哈希表互不影响
+ */
+
+static constexpr int SPILL_FANOUT_BITS = 4;
+static constexpr int SPILL_FANOUT = 1 << SPILL_FANOUT_BITS;  // 每次分区的分区数
+static constexpr int SPILL_MAX_LEVEL = 4;                    // 最多分区的层数，再往下的分区直接全部放进内存
+
+using ChunkSource = std::function<bool(DataChunk &)>;  // 逐个chunk地产生元组，返回false表示已经取完
+
+/**
+ * 逐个字段计算key的哈希值：64位FNV-1a，最后用murmur3的finalizer打散，浮点数的+0和-0按+0计算
+ */
+class KeyHasher {
+   private:
+    uint64_t h_ = 14695981039346656037ull;
+
+   public:
+    void add(const char *val, ColType type, int len) {
+        const float zero = 0.0f;
+        if (type == TYPE_FLOAT && *reinterpret_cast<const float *>(val) == 0.0f) {
+            val = reinterpret_cast<const char *>(&zero);
+        }
+        for (int i = 0; i < len; i++) {
+            h_ = (h_ ^ static_cast<uint8_t>(val[i])) * 1099511628211ull;
+        }
+    }
+
+    uint64_t finish() const {
+        uint64_t h = h_;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+// 哈希值在第level层分区中所属的分区
+inline int spill_partition_of(uint64_t hash, int level) {
+    return static_cast<int>((hash >> (64 - SPILL_FANOUT_BITS * (level + 1))) & (SPILL_FANOUT - 1));
+}
+
+/**
+ * 一轮分区中SPILL_FANOUT个分区的临时文件，每个分区的文件在第一次写入时才创建
+ */
+class SpillPartitions {
+   private:
+    DiskManager *disk_manager_ = nullptr;
+    size_t tuple_len_ = 0;
+    std::vector<std::shared_ptr<SpillFile>> files_;
+
+   public:
+    SpillPartitions() = default;
+
+    SpillPartitions(DiskManager *disk_manager, size_t tuple_len)
+        : disk_manager_(disk_manager), tuple_len_(tuple_len), files_(SPILL_FANOUT) {}
+
+    void append(int part, const char *rec) {
+        if (files_[part] == nullptr) {
+            files_[part] = std::make_shared<SpillFile>(disk_manager_, tuple_len_);
+        }
+        files_[part]->append(rec);
+    }
+
+    // 分区是否写入过元组
+    bool has(int part) const { return !files_.empty() && files_[part] != nullptr; }
+
+    /**
+     * @brief 写完分区并取出它的文件，之后可以从头读出；分区没有写入过元组时返回nullptr
+     */
+    std::shared_ptr<SpillFile> finish(int part) {
+        if (files_[part] != nullptr) {
+            files_[part]->finish();
+        }
+        return std::move(files_[part]);
+    }
+
+    // 丢弃所有分区的文件
+    void clear() { files_.clear(); }
+};
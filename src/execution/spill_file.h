@@ -0,0 +1,118 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "data_chunk.h"
+#include "storage/disk_manager.h"
+
+/**
+ * 算子内存不够时溢出到磁盘的临时文件
+ * 先顺序追加等长的元组，调用finish()之后再从头顺序读出。文件通过DiskManager按块读写，
+ * 一块由若干页组成、连续存放整数个元组。文件建在当前数据库的目录下，对象析构时删除
+ */
+class SpillFile {
+   private:
+    static constexpr int BLOCK_PAGES = 16;  // 一块至少包含的页数
+
+    DiskManager *disk_manager_;
+    std::string path_;
+    int fd_;
+    size_t tuple_len_;
+    int block_pages_;          // 一块的页数
+    size_t tuples_per_block_;  // 一块中的元组数
+    size_t num_tuples_ = 0;    // 写入的元组总数
+    std::vector<char> block_;  // 正在写入或读出的块
+    size_t block_pos_ = 0;     // 写入时为块中已有的元组数，读出时为块中下一个要读的元组
+    int block_no_ = 0;         // 写入时为下一个要写出的块，读出时为下一个要读入的块
+    size_t num_read_ = 0;      // 已经读出的元组数
+
+   public:
+    SpillFile(DiskManager *disk_manager, size_t tuple_len) : disk_manager_(disk_manager), tuple_len_(tuple_len) {
+        static std::atomic<uint64_t> next_id{0};
+        do {
+            path_ = "spill_" + std::to_string(next_id++) + ".tmp";
+        } while (disk_manager_->is_file(path_));
+        disk_manager_->create_file(path_);
+        fd_ = disk_manager_->open_file(path_);
+        block_pages_ = std::max(BLOCK_PAGES, static_cast<int>((tuple_len_ + PAGE_SIZE - 1) / PAGE_SIZE));
+        tuples_per_block_ = block_size() / tuple_len_;
+        block_.resize(block_size());
+    }
+
+    SpillFile(const SpillFile &) = delete;
+    SpillFile &operator=(const SpillFile &) = delete;
+
+    ~SpillFile() {
+        disk_manager_->close_file(fd_);
+        disk_manager_->destroy_file(path_);
+    }
+
+    size_t size() const { return num_tuples_; }
+
+    void append(const char *tuple) {
+        memcpy(block_.data() + block_pos_ * tuple_len_, tuple, tuple_len_);
+        num_tuples_++;
+        if (++block_pos_ == tuples_per_block_) {
+            write_block();
+        }
+    }
+
+    /**
+     * @brief 写完所有元组，写出最后一个不满的块并释放缓冲区，之后可以读出
+     */
+    void finish() {
+        if (block_pos_ > 0) {
+            write_block();
+        }
+        block_.clear();
+        block_.shrink_to_fit();
+        block_no_ = 0;
+        num_read_ = 0;
+    }
+
+    /**
+     * @brief 读出下一批元组，每次最多CHUNK_CAPACITY个
+     * @return 读出的元组个数大于0时返回true，全部读完时返回false
+     */
+    bool read(DataChunk &chunk) {
+        chunk.init(tuple_len_);
+        if (block_.empty() && num_read_ < num_tuples_) {
+            block_.resize(block_size());
+        }
+        while (!chunk.is_full() && num_read_ < num_tuples_) {
+            if (num_read_ % tuples_per_block_ == 0) {
+                disk_manager_->read_page(fd_, block_no_++ * block_pages_, block_.data(), block_size());
+                block_pos_ = 0;
+            }
+            memcpy(chunk.append(), block_.data() + block_pos_++ * tuple_len_, tuple_len_);
+            num_read_++;
+        }
+        if (num_read_ == num_tuples_) {
+            block_.clear();
+            block_.shrink_to_fit();
+        }
+        return chunk.count() > 0;
+    }
+
+   private:
+    int block_size() const { return block_pages_ * PAGE_SIZE; }
+
+    void write_block() {
+        disk_manager_->write_page(fd_, block_no_++ * block_pages_, block_.data(), block_size());
+        block_pos_ = 0;
+    }
+};
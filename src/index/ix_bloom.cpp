@@ -0,0 +1,82 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_bloom.h"
+
+#include <algorithm>
+
+/**
+ * @param key_types 上层key的字段类型
+ * @param key_lens 上层key的字段长度
+ * @param capacity 预计加入的key数量，不足IX_BLOOM_MIN_KEYS时按IX_BLOOM_MIN_KEYS分配
+ */
+IxBloomFilter::IxBloomFilter(std::vector<ColType> key_types, std::vector<int> key_lens, int64_t capacity)
+    : key_types_(std::move(key_types)), key_lens_(std::move(key_lens)) {
+    capacity_ = std::max<int64_t>(capacity, IX_BLOOM_MIN_KEYS);
+    int64_t block_bits = BLOCK_WORDS * 64;
+    num_blocks_ = (capacity_ * IX_BLOOM_BITS_PER_KEY + block_bits - 1) / block_bits;
+    words_ = std::make_unique<std::atomic<uint64_t>[]>(num_blocks_ * BLOCK_WORDS);
+    for (int64_t i = 0; i < num_blocks_ * BLOCK_WORDS; i++) {
+        words_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 加入一个key：高32位选择块，低32位作为双重哈希的起点和步长，在块内置IX_BLOOM_NUM_PROBES个bit
+ */
+void IxBloomFilter::add(const char *key) {
+    uint64_t h = hash(key);
+    std::atomic<uint64_t> *block = &words_[((h >> 32) * num_blocks_ >> 32) * BLOCK_WORDS];
+    uint32_t bit = static_cast<uint32_t>(h);
+    uint32_t step = (bit >> 9) | 1;
+    for (int i = 0; i < IX_BLOOM_NUM_PROBES; i++, bit += step) {
+        block[(bit & 511) >> 6].fetch_or(uint64_t{1} << (bit & 63), std::memory_order_relaxed);
+    }
+    num_added_++;
+}
+
+/**
+ * @brief 判断key是否可能存在：返回false时key一定不在索引中，返回true时可能是误判
+ */
+bool IxBloomFilter::may_contain(const char *key) const {
+    uint64_t h = hash(key);
+    const std::atomic<uint64_t> *block = &words_[((h >> 32) * num_blocks_ >> 32) * BLOCK_WORDS];
+    uint32_t bit = static_cast<uint32_t>(h);
+    uint32_t step = (bit >> 9) | 1;
+    for (int i = 0; i < IX_BLOOM_NUM_PROBES; i++, bit += step) {
+        if ((block[(bit & 511) >> 6].load(std::memory_order_relaxed) & (uint64_t{1} << (bit & 63))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 64位的FNV-1a，再用murmur3的64位finalizer打散；与IxHashTable::hash一样，浮点数的+0和-0按+0计算
+ */
+uint64_t IxBloomFilter::hash(const char *key) const {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < key_types_.size(); i++) {
+        const float zero = 0.0f;
+        const char *bytes = key_types_[i] == TYPE_FLOAT && *reinterpret_cast<const float *>(key) == 0.0f
+                                ? reinterpret_cast<const char *>(&zero)
+                                : key;
+        for (int j = 0; j < key_lens_[i]; j++) {
+            h = (h ^ static_cast<uint8_t>(bytes[j])) * 1099511628211ull;
+        }
+        key += key_lens_[i];
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
@@ -0,0 +1,69 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "ix_defs.h"
+
+/* SHOW BLOOM STATS显示的信息，计数从索引打开时开始累计 */
+struct IxBloomStats {
+    bool enabled;               // 是否为索引启用了Bloom filter
+    int64_t num_bits;           // filter的bit数，还没有构建时为0
+    int64_t num_keys;           // 构建以来加入filter的key数量
+    int64_t lookups;            // 查询filter的次数
+    int64_t negatives;          // filter判断key不存在、省去一次索引查找的次数
+    int64_t false_positives;    // filter判断可能存在，但索引中实际没有这个key的次数
+    int64_t rebuilds;           // filter构建的次数
+};
+
+/**
+ * 分块的Bloom filter，判断上层key（不含rid）是否可能存在于索引中
+ * bit数组按512 bit（一个cache line）分块，key的哈希值选中一个块，所有探测位都落在这个块内，一次判断只访问一个块。
+ * filter只增加不删除：删除key不清除bit（其他key可能共用），只计数，由IxIndexHandle在删除过多或插入超出容量时重新构建。
+ * add和may_contain可以并发执行，bit用原子操作置位
+ */
+class IxBloomFilter {
+   private:
+    static constexpr int BLOCK_WORDS = 8;  // 每块8个64位字，共512 bit
+
+    std::vector<ColType> key_types_;            // 上层key的字段类型
+    std::vector<int> key_lens_;                 // 上层key的字段长度
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+    int64_t num_blocks_;
+    int64_t capacity_;                          // 分配bit时按多少个key计算
+    std::atomic<int64_t> num_added_{0};         // 构建以来加入的key数量（含重复）
+    std::atomic<int64_t> num_removed_{0};       // 构建以来删除的key数量
+
+   public:
+    IxBloomFilter(std::vector<ColType> key_types, std::vector<int> key_lens, int64_t capacity);
+
+    void add(const char *key);
+
+    bool may_contain(const char *key) const;
+
+    void note_removed(int64_t n = 1) { num_removed_ += n; }
+
+    // 加入的key超出容量（误判率高于预期），或者删除的key超过加入的一半（大量bit已经失效）时需要重新构建
+    bool is_stale() const {
+        int64_t added = num_added_;
+        return added > capacity_ || 2 * num_removed_ > added;
+    }
+
+    int64_t num_bits() const { return num_blocks_ * BLOCK_WORDS * 64; }
+
+    int64_t num_added() const { return num_added_; }
+
+   private:
+    uint64_t hash(const char *key) const;
+};
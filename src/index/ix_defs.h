@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "defs.h"
@@ -21,11 +22,32 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+// 哈希索引的初始页面：目录头页面、第一个目录页面、第一个桶
+constexpr int IX_HASH_DIR_HDR_PAGE = 1;
+constexpr int IX_HASH_INIT_DIR_PAGE = 2;
+constexpr int IX_HASH_INIT_BUCKET_PAGE = 3;
+constexpr int IX_HASH_INIT_NUM_PAGES = 4;
+// ANALYZE INDEX：等深直方图最多的桶数，以及最多采样的叶子结点（哈希索引为桶）数量，叶子不多于采样数量的两倍时全部扫描
+constexpr int IX_HIST_MAX_BUCKETS = 32;
+constexpr int IX_ANALYZE_SAMPLE_PAGES = 64;
+// 重建索引时批量装载的结点填充率，留出少量空位，使重建之后的插入不会立即引起分裂
+constexpr double IX_BULK_LOAD_FILL_FACTOR = 0.9;
+// Bloom filter：每个key占用的bit数和每个key在块内置位的数量，约1%的误判率；按不少于IX_BLOOM_MIN_KEYS个key分配
+constexpr int IX_BLOOM_BITS_PER_KEY = 10;
+constexpr int IX_BLOOM_NUM_PROBES = 6;
+constexpr int IX_BLOOM_MIN_KEYS = 1024;
+
+/* 压缩格式的结点中每个键值对对应的slot，编码后的key存放在页面末尾向前增长的堆中 */
+struct IxSlot {
+    uint16_t offset;    // 编码后的key在页面中的偏移
+    uint16_t len;       // 编码后的key的长度
+    Rid rid;
+};
 
 class IxFileHdr {
 public: 
-    page_id_t first_free_page_no_;      // 文件中第一个空闲的磁盘页面的页面号
-    int num_pages_;                     // 磁盘文件中页面的数量
+    page_id_t first_free_page_no_;      // 文件中第一个空闲的磁盘页面的页面号，哈希索引用来链接回收的溢出桶
+    int num_pages_;                     // 磁盘文件中已经分配的页面数量，即下一个要分配的页号
     page_id_t root_page_;               // B+树根节点对应的页面号
     int col_num_;                       // 索引包含的字段数量
     std::vector<ColType> col_types_;    // 字段的类型
@@ -36,10 +58,29 @@ public:
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    IndexType index_type_;              // 索引的实现方式（B+树、B-link树或哈希）
+    bool unique_;                       // 是否为唯一索引；非唯一索引在key之后追加rid，以(key, rid)作为物理上的排序键
+    bool compressed_;                   // 结点是否采用压缩格式（前缀压缩+变长key），索引包含字符串字段时启用
+    bool bloom_;                        // 是否在内存中为索引维护Bloom filter，filter本身不持久化，打开后首次查找时构建
+    // 统计信息：以下三项随插入、删除和结点的分裂、合并维护，ANALYZE INDEX时重新校准
+    int64_t num_keys_;                  // 键值对数量
+    int num_leaves_;                    // 叶子结点数量，哈希索引为桶页面（含溢出页面）数量，只由ANALYZE INDEX得到
+    int height_;                        // 树的高度，只有根结点时为1，哈希索引固定为1
+    // 统计信息：以下各项由ANALYZE INDEX采样得到，analyzed_为false表示还没有收集过
+    bool analyzed_;
+    double avg_fill_;                   // 叶子结点（哈希索引为桶）的平均填充率
+    int64_t distinct_keys_;             // 第一个字段不同取值的数量，哈希索引为完整key不同取值的数量
+    int num_hist_buckets_;              // 第一个字段上等深直方图的桶数，每个桶约有num_keys_ / num_hist_buckets_个键值对
+    std::vector<char> hist_bounds_;     // 直方图的num_hist_buckets_ + 1个边界：最小值和每个桶的上界，每个长col_lens_[0]
     int tot_len_;                       // 记录结构体的整体长度
 
     IxFileHdr() {
         tot_len_ = col_num_ = 0;
+        index_type_ = INDEX_BTREE;
+        unique_ = false;
+        compressed_ = false;
+        bloom_ = false;
+        init_stats();
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
@@ -47,12 +88,37 @@ public:
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
                 col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
                     tot_len_ = 0;
+                    index_type_ = INDEX_BTREE;
+                    unique_ = false;
+                    compressed_ = false;
+                    bloom_ = false;
+                    init_stats();
                 } 
 
-    void update_tot_len() {
-        tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
-        tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
+    void init_stats() {
+        num_keys_ = 0;
+        num_leaves_ = 1;
+        height_ = 1;
+        analyzed_ = false;
+        avg_fill_ = 0;
+        distinct_keys_ = 0;
+        num_hist_buckets_ = 0;
+        hist_bounds_.clear();
+    }
+
+    void update_tot_len() { tot_len_ = fixed_len() + static_cast<int>(hist_bounds_.size()); }
+
+    // 除直方图以外的部分序列化后的长度
+    int fixed_len() const {
+        int len = sizeof(page_id_t) * 4 + sizeof(int) * 6 + sizeof(IndexType) + sizeof(bool) * 3;
+        len += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
+        len += sizeof(int64_t) * 2 + sizeof(int) * 3 + sizeof(bool) + sizeof(double);
+        return len;
+    }
+
+    // 文件头页面除去固定部分之后最多能放下的直方图桶数
+    int max_hist_buckets() const {
+        return std::min(IX_HIST_MAX_BUCKETS, (PAGE_SIZE - fixed_len()) / col_lens_[0] - 1);
     }
 
     void serialize(char* dest) {
@@ -85,6 +151,30 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &index_type_, sizeof(IndexType));
+        offset += sizeof(IndexType);
+        memcpy(dest + offset, &unique_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &compressed_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &bloom_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &num_keys_, sizeof(int64_t));
+        offset += sizeof(int64_t);
+        memcpy(dest + offset, &num_leaves_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &height_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &analyzed_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &avg_fill_, sizeof(double));
+        offset += sizeof(double);
+        memcpy(dest + offset, &distinct_keys_, sizeof(int64_t));
+        offset += sizeof(int64_t);
+        memcpy(dest + offset, &num_hist_buckets_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, hist_bounds_.data(), hist_bounds_.size());
+        offset += hist_bounds_.size();
         assert(offset == tot_len_);
     }
 
@@ -100,7 +190,6 @@ public:
         offset += sizeof(page_id_t);
         col_num_ = *reinterpret_cast<const int*>(src + offset);
         offset += sizeof(int);
-        std::cout << col_num_ << "\n";
         for(int i = 0; i < col_num_; ++i) {
             // col_types_[i] = *reinterpret_cast<const ColType*>(src + offset);
             ColType type = *reinterpret_cast<const ColType*>(src + offset);
@@ -123,8 +212,47 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        index_type_ = *reinterpret_cast<const IndexType*>(src + offset);
+        offset += sizeof(IndexType);
+        unique_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        compressed_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        bloom_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        memcpy(&num_keys_, src + offset, sizeof(int64_t));
+        offset += sizeof(int64_t);
+        num_leaves_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        height_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        analyzed_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        memcpy(&avg_fill_, src + offset, sizeof(double));
+        offset += sizeof(double);
+        memcpy(&distinct_keys_, src + offset, sizeof(int64_t));
+        offset += sizeof(int64_t);
+        num_hist_buckets_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        int hist_len = num_hist_buckets_ == 0 ? 0 : (num_hist_buckets_ + 1) * col_lens_[0];
+        hist_bounds_.assign(src + offset, src + offset + hist_len);
+        offset += hist_bounds_.size();
         assert(offset == tot_len_);
     }
+
+    // 上层传入的key（不含rid）的长度
+    int key_len() const { return unique_ ? col_tot_len_ : col_tot_len_ - static_cast<int>(sizeof(Rid)); }
+
+    // 压缩格式中一个键值对编码后（含slot）的最大长度：字符串字段不去掉末尾的0时还要多2字节的长度
+    int max_entry_len() const {
+        int len = static_cast<int>(sizeof(IxSlot)) + col_tot_len_;
+        for (auto type : col_types_) {
+            if (type == TYPE_STRING) {
+                len += sizeof(uint16_t);
+            }
+        }
+        return len;
+    }
 };
 
 class IxPageHdr {
@@ -135,6 +263,34 @@ public:
     bool is_leaf;                   // 是否为叶节点
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
     page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+    page_id_t right_link;           // B-link树中同一层右兄弟结点的页号，最右结点为IX_NO_PAGE
+    bool has_high_key;              // B-link树中结点是否有high key（每层最右结点没有，其范围向右无界）
+    // 以下字段只用于压缩格式的结点
+    bool has_low_key;               // 结点是否有low key（每层最左结点没有），与high key一起界定结点内所有key的范围
+    int prefix_len;                 // 结点内所有key共同的前缀长度，前缀不重复存储，从low key中取得
+    int key_bytes;                  // 堆中仍然有效的编码后key的总长度
+    int heap_size;                  // 堆已经使用的长度（包括删除后留下的空洞），堆从页面末尾向前增长
+};
+
+/**
+ * 哈希索引的目录头页面：| IxHashDirHdr | 目录页面的页号数组 |
+ * 目录共有2^global_depth项，每项是一个桶的页号，依次存放在多个目录页面中
+ */
+class IxHashDirHdr {
+public:
+    int global_depth;               // 全局深度，用哈希值的低global_depth位在目录中定位桶
+    int num_dir_pages;              // 目录页面的数量
+};
+
+/**
+ * 哈希索引的桶页面：| IxHashBucketHdr | (key, rid) * num_key |
+ * 桶内的键值对无序存放；一个桶放满并且无法再分裂时（所有key的哈希值相同，或已达到最大深度），在overflow上链接溢出页面
+ */
+class IxHashBucketHdr {
+public:
+    int local_depth;                // 局部深度，桶内所有key的哈希值的低local_depth位相同，溢出页面中不使用
+    int num_key;                    // 本页面中的键值对数量
+    page_id_t overflow;             // 下一个溢出页面，没有则为IX_NO_PAGE
 };
 
 class Iid {
@@ -0,0 +1,437 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_hash.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "ix_index_handle.h"
+
+// 每个目录页面存放的目录项数量
+static constexpr int IX_HASH_DIR_ENTRIES = PAGE_SIZE / sizeof(page_id_t);
+// 目录头页面最多能记录的目录页面数量
+static constexpr int IX_HASH_MAX_DIR_PAGES = (PAGE_SIZE - sizeof(IxHashDirHdr)) / sizeof(page_id_t);
+// 全局深度的上限，此时目录共2^19项，占用512个目录页面
+static constexpr int IX_HASH_MAX_DEPTH = 19;
+static_assert((1 << IX_HASH_MAX_DEPTH) / IX_HASH_DIR_ENTRIES <= IX_HASH_MAX_DIR_PAGES);
+
+static IxHashDirHdr *dir_hdr(Page *page) { return reinterpret_cast<IxHashDirHdr *>(page->get_data()); }
+
+// 目录头页面中，IxHashDirHdr之后是目录页面的页号数组
+static page_id_t *dir_pages(char *data) { return reinterpret_cast<page_id_t *>(data + sizeof(IxHashDirHdr)); }
+
+static page_id_t *dir_entries(Page *page) { return reinterpret_cast<page_id_t *>(page->get_data()); }
+
+IxHashTable::IxHashTable(IxFileHdr *file_hdr, BufferPoolManager *buffer_pool_manager, int fd,
+                         std::function<void()> update_file_hdr)
+    : file_hdr_(file_hdr),
+      buffer_pool_manager_(buffer_pool_manager),
+      fd_(fd),
+      update_file_hdr_(std::move(update_file_hdr)) {
+    bucket_capacity_ = static_cast<int>((PAGE_SIZE - sizeof(IxHashBucketHdr)) / entry_size());
+    int key_col_num = file_hdr_->unique_ ? file_hdr_->col_num_ : file_hdr_->col_num_ - 2;
+    key_types_.assign(file_hdr_->col_types_.begin(), file_hdr_->col_types_.begin() + key_col_num);
+    key_lens_.assign(file_hdr_->col_lens_.begin(), file_hdr_->col_lens_.begin() + key_col_num);
+}
+
+/**
+ * @brief 在新建的索引文件中写入哈希索引的初始页面：全局深度为0，目录只有一项，指向一个空桶
+ */
+void IxHashTable::init_file(DiskManager *disk_manager, int fd) {
+    char page_buf[PAGE_SIZE];
+
+    memset(page_buf, 0, PAGE_SIZE);
+    *reinterpret_cast<IxHashDirHdr *>(page_buf) = {.global_depth = 0, .num_dir_pages = 1};
+    dir_pages(page_buf)[0] = IX_HASH_INIT_DIR_PAGE;
+    disk_manager->write_page(fd, IX_HASH_DIR_HDR_PAGE, page_buf, PAGE_SIZE);
+
+    memset(page_buf, 0, PAGE_SIZE);
+    reinterpret_cast<page_id_t *>(page_buf)[0] = IX_HASH_INIT_BUCKET_PAGE;
+    disk_manager->write_page(fd, IX_HASH_INIT_DIR_PAGE, page_buf, PAGE_SIZE);
+
+    memset(page_buf, 0, PAGE_SIZE);
+    *reinterpret_cast<IxHashBucketHdr *>(page_buf) = {.local_depth = 0, .num_key = 0, .overflow = IX_NO_PAGE};
+    disk_manager->write_page(fd, IX_HASH_INIT_BUCKET_PAGE, page_buf, PAGE_SIZE);
+}
+
+/**
+ * @brief 查找与key相等的所有键值对，按rid的顺序放入result
+ *
+ * @param key 上层传入的key（不含rid）
+ * @return 是否找到了键值对
+ */
+bool IxHashTable::get_value(const char *key, std::vector<Rid> *result) {
+    std::shared_lock lock(latch_);
+
+    size_t old_size = result->size();
+    for (page_id_t page_no = find_bucket(hash(key)); page_no != IX_NO_PAGE;) {
+        Page *page = fetch_page(page_no);
+        for (int i = 0; i < bucket_hdr(page)->num_key; i++) {
+            if (compare_key(entry_at(page, i), key) == 0) {
+                result->push_back(*rid_at(page, i));
+            }
+        }
+        page_no = bucket_hdr(page)->overflow;
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+    std::sort(result->begin() + old_size, result->end(), [](const Rid &a, const Rid &b) {
+        return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+    });
+    return result->size() > old_size;
+}
+
+/**
+ * @brief 插入键值对，桶满时分裂桶（必要时目录加倍），无法分裂时链接溢出页面
+ * 唯一索引中key已经存在时抛出DuplicateKeyError
+ *
+ * @param key 索引中实际存储的key（非唯一索引已经追加了rid）
+ * @return 插入到的桶的页号
+ */
+page_id_t IxHashTable::insert_entry(const char *key, const Rid &rid) {
+    std::unique_lock lock(latch_);
+
+    std::vector<char> entry(entry_size());
+    memcpy(entry.data(), key, file_hdr_->col_tot_len_);
+    memcpy(entry.data() + file_hdr_->col_tot_len_, &rid, sizeof(Rid));
+
+    uint32_t hash_value = hash(key);
+    while (true) {
+        page_id_t bucket_no = find_bucket(hash_value);
+        Page *bucket = fetch_page(bucket_no);
+
+        bool has_room = false;
+        for (page_id_t page_no = bucket_no; page_no != IX_NO_PAGE;) {
+            Page *page = page_no == bucket_no ? bucket : fetch_page(page_no);
+            has_room = has_room || bucket_hdr(page)->num_key < bucket_capacity_;
+            bool duplicate = false;
+            for (int i = 0; file_hdr_->unique_ && i < bucket_hdr(page)->num_key; i++) {
+                duplicate = duplicate || compare_key(entry_at(page, i), key) == 0;
+            }
+            page_no = bucket_hdr(page)->overflow;
+            if (page != bucket) {
+                buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+            }
+            if (duplicate) {
+                buffer_pool_manager_->unpin_page(bucket->get_page_id(), false);
+                throw DuplicateKeyError();
+            }
+        }
+
+        if (has_room || !split_bucket(bucket, hash_value)) {
+            append_entry(bucket, entry.data());
+            buffer_pool_manager_->unpin_page(bucket->get_page_id(), true);
+            return bucket_no;
+        }
+        // 分裂之后key所在的桶可能已经改变，重新定位
+        buffer_pool_manager_->unpin_page(bucket->get_page_id(), true);
+    }
+}
+
+/**
+ * @brief 删除键值对(key, rid)，用桶内最后一个键值对填补空位；桶不合并，目录也不收缩
+ *
+ * @param key 索引中实际存储的key（非唯一索引已经追加了rid）
+ * @return 是否删除了键值对
+ */
+bool IxHashTable::delete_entry(const char *key, const Rid &rid) {
+    std::unique_lock lock(latch_);
+
+    for (page_id_t page_no = find_bucket(hash(key)); page_no != IX_NO_PAGE;) {
+        Page *page = fetch_page(page_no);
+        IxHashBucketHdr *hdr = bucket_hdr(page);
+        for (int i = 0; i < hdr->num_key; i++) {
+            if (*rid_at(page, i) == rid && compare_key(entry_at(page, i), key) == 0) {
+                memcpy(entry_at(page, i), entry_at(page, hdr->num_key - 1), entry_size());
+                hdr->num_key--;
+                buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+                return true;
+            }
+        }
+        page_no = hdr->overflow;
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+    return false;
+}
+
+int IxHashTable::get_global_depth() {
+    std::shared_lock lock(latch_);
+    Page *hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    int global_depth = dir_hdr(hdr_page)->global_depth;
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), false);
+    return global_depth;
+}
+
+/**
+ * @brief 目录中所有不同的桶的页号（不含溢出页面），按页号排序，用于ANALYZE INDEX采样
+ */
+std::vector<page_id_t> IxHashTable::get_bucket_pages() {
+    std::shared_lock lock(latch_);
+    return collect_bucket_pages();
+}
+
+/**
+ * @brief 读出一个桶（含溢出页面）中所有的上层key（不含rid），依次追加到keys中
+ * @return 桶占用的页面数量
+ */
+int IxHashTable::read_bucket(page_id_t bucket_no, std::vector<char> *keys) {
+    std::shared_lock lock(latch_);
+    return collect_bucket(bucket_no, keys);
+}
+
+/**
+ * @brief 读出所有桶中的上层key，依次追加到keys中
+ * 整个过程持有同一个共享锁，期间桶不会分裂，每个键值对恰好读到一次
+ */
+void IxHashTable::read_all_keys(std::vector<char> *keys) {
+    std::shared_lock lock(latch_);
+    for (page_id_t bucket_no : collect_bucket_pages()) {
+        collect_bucket(bucket_no, keys);
+    }
+}
+
+std::vector<page_id_t> IxHashTable::collect_bucket_pages() {
+    Page *hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    int num_entries = 1 << dir_hdr(hdr_page)->global_depth;
+    std::vector<page_id_t> buckets;
+    for (int idx = 0; idx < num_entries; idx += IX_HASH_DIR_ENTRIES) {
+        Page *dir_page = fetch_page(dir_pages(hdr_page->get_data())[idx / IX_HASH_DIR_ENTRIES]);
+        int n = std::min(num_entries - idx, IX_HASH_DIR_ENTRIES);
+        buckets.insert(buckets.end(), dir_entries(dir_page), dir_entries(dir_page) + n);
+        buffer_pool_manager_->unpin_page(dir_page->get_page_id(), false);
+    }
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), false);
+    std::sort(buckets.begin(), buckets.end());
+    buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+    return buckets;
+}
+
+int IxHashTable::collect_bucket(page_id_t bucket_no, std::vector<char> *keys) {
+    int key_len = std::accumulate(key_lens_.begin(), key_lens_.end(), 0);
+    int num_pages = 0;
+    for (page_id_t page_no = bucket_no; page_no != IX_NO_PAGE; num_pages++) {
+        Page *page = fetch_page(page_no);
+        for (int i = 0; i < bucket_hdr(page)->num_key; i++) {
+            keys->insert(keys->end(), entry_at(page, i), entry_at(page, i) + key_len);
+        }
+        page_no = bucket_hdr(page)->overflow;
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+    return num_pages;
+}
+
+/**
+ * @brief 计算上层key的哈希值：对各字段的字节做FNV-1a，再用murmur3的finalizer打散，保证低位分布均匀
+ * 浮点数的+0和-0相等但字节不同，统一按+0计算
+ */
+uint32_t IxHashTable::hash(const char *key) const {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < key_types_.size(); i++) {
+        const float zero = 0.0f;
+        const char *bytes = key_types_[i] == TYPE_FLOAT && *reinterpret_cast<const float *>(key) == 0.0f
+                                ? reinterpret_cast<const char *>(&zero)
+                                : key;
+        for (int j = 0; j < key_lens_[i]; j++) {
+            h = (h ^ static_cast<uint8_t>(bytes[j])) * 16777619u;
+        }
+        key += key_lens_[i];
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+int IxHashTable::compare_key(const char *a, const char *b) const { return ix_compare(a, b, key_types_, key_lens_); }
+
+/**
+ * @brief 新建一个页面
+ * @note pin the page, remember to unpin it outside!
+ */
+Page *IxHashTable::create_page() {
+    PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+    Page *page = buffer_pool_manager_->new_page(&page_id);
+    file_hdr_->num_pages_++;
+    update_file_hdr_();
+    return page;
+}
+
+/**
+ * @brief 获取一个空的溢出页面，优先复用桶分裂时回收的溢出页面
+ * @note pin the page, remember to unpin it outside!
+ */
+Page *IxHashTable::create_overflow_page() {
+    Page *page;
+    if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+        page = fetch_page(file_hdr_->first_free_page_no_);
+        file_hdr_->first_free_page_no_ = bucket_hdr(page)->overflow;
+        update_file_hdr_();
+    } else {
+        page = create_page();
+    }
+    *bucket_hdr(page) = {.local_depth = 0, .num_key = 0, .overflow = IX_NO_PAGE};
+    return page;
+}
+
+/**
+ * @brief 用哈希值的低global_depth位在目录中找到对应的桶
+ */
+page_id_t IxHashTable::find_bucket(uint32_t hash_value) const {
+    Page *hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    uint32_t idx = hash_value & ((1u << dir_hdr(hdr_page)->global_depth) - 1);
+    page_id_t dir_page_no = dir_pages(hdr_page->get_data())[idx / IX_HASH_DIR_ENTRIES];
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), false);
+
+    Page *dir_page = fetch_page(dir_page_no);
+    page_id_t bucket_no = dir_entries(dir_page)[idx % IX_HASH_DIR_ENTRIES];
+    buffer_pool_manager_->unpin_page(dir_page->get_page_id(), false);
+    return bucket_no;
+}
+
+/**
+ * @brief 把一个键值对放入bucket链中第一个有空位的页面，都满时在链尾链接新的溢出页面
+ *
+ * @param bucket 桶的主页面，由调用者pin住
+ */
+void IxHashTable::append_entry(Page *bucket, const char *entry) {
+    Page *page = bucket;
+    while (bucket_hdr(page)->num_key >= bucket_capacity_) {
+        Page *next;
+        if (bucket_hdr(page)->overflow == IX_NO_PAGE) {
+            next = create_overflow_page();
+            bucket_hdr(page)->overflow = next->get_page_id().page_no;
+        } else {
+            next = fetch_page(bucket_hdr(page)->overflow);
+        }
+        if (page != bucket) {
+            buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+        }
+        page = next;
+    }
+    memcpy(entry_at(page, bucket_hdr(page)->num_key), entry, entry_size());
+    bucket_hdr(page)->num_key++;
+    if (page != bucket) {
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    }
+}
+
+/**
+ * @brief 把已满的桶按哈希值的第local_depth位分裂为两个桶，local_depth等于global_depth时先把目录加倍
+ * 原桶的溢出页面全部回收，键值对重新分配到两个桶中
+ *
+ * @param bucket 要分裂的桶的主页面，由调用者pin住
+ * @param hash_value 引起分裂的key的哈希值，用于确定桶在目录中的位置
+ * @return 是否完成了分裂；桶内所有key与hash_value在低IX_HASH_MAX_DEPTH位上都相同时，分裂无法把它们分开，返回false
+ */
+bool IxHashTable::split_bucket(Page *bucket, uint32_t hash_value) {
+    std::vector<char> entries;
+    for (page_id_t page_no = bucket->get_page_id().page_no; page_no != IX_NO_PAGE;) {
+        Page *page = page_no == bucket->get_page_id().page_no ? bucket : fetch_page(page_no);
+        entries.insert(entries.end(), entry_at(page, 0), entry_at(page, bucket_hdr(page)->num_key));
+        page_no = bucket_hdr(page)->overflow;
+        if (page != bucket) {
+            buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+        }
+    }
+    int num_entries = static_cast<int>(entries.size()) / entry_size();
+
+    int local_depth = bucket_hdr(bucket)->local_depth;
+    uint32_t max_mask = (1u << IX_HASH_MAX_DEPTH) - 1;
+    bool separable = false;
+    for (int i = 0; i < num_entries && !separable; i++) {
+        separable = ((hash(entries.data() + i * entry_size()) ^ hash_value) & max_mask) != 0;
+    }
+    if (!separable || local_depth >= IX_HASH_MAX_DEPTH) {
+        return false;
+    }
+
+    Page *hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    int global_depth = dir_hdr(hdr_page)->global_depth;
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), false);
+    if (local_depth == global_depth) {
+        if (!double_directory()) {
+            return false;
+        }
+        global_depth++;
+    }
+
+    // 回收原桶的溢出页面
+    page_id_t overflow = bucket_hdr(bucket)->overflow;
+    if (overflow != IX_NO_PAGE) {
+        while (overflow != IX_NO_PAGE) {
+            Page *page = fetch_page(overflow);
+            page_id_t next = bucket_hdr(page)->overflow;
+            bucket_hdr(page)->overflow = file_hdr_->first_free_page_no_;
+            file_hdr_->first_free_page_no_ = overflow;
+            buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+            overflow = next;
+        }
+        update_file_hdr_();
+    }
+    *bucket_hdr(bucket) = {.local_depth = local_depth + 1, .num_key = 0, .overflow = IX_NO_PAGE};
+    Page *new_bucket = create_page();
+    *bucket_hdr(new_bucket) = {.local_depth = local_depth + 1, .num_key = 0, .overflow = IX_NO_PAGE};
+
+    // 原来指向该桶的目录项中，第local_depth位为1的改为指向新桶
+    hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    uint32_t low_bits = hash_value & ((1u << local_depth) - 1);
+    for (uint32_t k = 1; k < (1u << (global_depth - local_depth)); k += 2) {
+        uint32_t idx = low_bits | (k << local_depth);
+        Page *dir_page = fetch_page(dir_pages(hdr_page->get_data())[idx / IX_HASH_DIR_ENTRIES]);
+        dir_entries(dir_page)[idx % IX_HASH_DIR_ENTRIES] = new_bucket->get_page_id().page_no;
+        buffer_pool_manager_->unpin_page(dir_page->get_page_id(), true);
+    }
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), false);
+
+    for (int i = 0; i < num_entries; i++) {
+        const char *entry = entries.data() + i * entry_size();
+        append_entry((hash(entry) >> local_depth) & 1 ? new_bucket : bucket, entry);
+    }
+    buffer_pool_manager_->unpin_page(new_bucket->get_page_id(), true);
+    return true;
+}
+
+/**
+ * @brief 目录加倍：新的后一半目录项与前一半相同，global_depth加1
+ * @return 是否完成了加倍，已达到IX_HASH_MAX_DEPTH时返回false
+ */
+bool IxHashTable::double_directory() {
+    Page *hdr_page = fetch_page(IX_HASH_DIR_HDR_PAGE);
+    IxHashDirHdr *hdr = dir_hdr(hdr_page);
+    if (hdr->global_depth >= IX_HASH_MAX_DEPTH) {
+        buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), false);
+        return false;
+    }
+
+    int old_size = 1 << hdr->global_depth;
+    page_id_t *pages = dir_pages(hdr_page->get_data());
+    if (old_size * 2 <= IX_HASH_DIR_ENTRIES) {
+        Page *dir_page = fetch_page(pages[0]);
+        memcpy(dir_entries(dir_page) + old_size, dir_entries(dir_page), old_size * sizeof(page_id_t));
+        buffer_pool_manager_->unpin_page(dir_page->get_page_id(), true);
+    } else {
+        // 目录已经占满整数个页面，复制每个目录页面
+        int num_dir_pages = hdr->num_dir_pages;
+        for (int i = 0; i < num_dir_pages; i++) {
+            Page *src = fetch_page(pages[i]);
+            Page *dst = create_page();
+            memcpy(dst->get_data(), src->get_data(), PAGE_SIZE);
+            pages[num_dir_pages + i] = dst->get_page_id().page_no;
+            buffer_pool_manager_->unpin_page(src->get_page_id(), false);
+            buffer_pool_manager_->unpin_page(dst->get_page_id(), true);
+        }
+        hdr->num_dir_pages *= 2;
+    }
+    hdr->global_depth++;
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), true);
+    return true;
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <functional>
+#include <shared_mutex>
+
+#include "ix_defs.h"
+
+/**
+ * 可扩展哈希索引，只支持等值查找
+ * 与B+树使用同样的索引文件（第0页为IxFileHdr），由IxIndexHandle在index_type_为INDEX_HASH时使用。
+ * 目录头页面记录所有目录页面，目录页面中第i项是哈希值低global_depth位为i的桶的页号；
+ * 一次查找只访问目录头页面、一个目录页面和一个桶，与索引中的数据量无关
+ */
+class IxHashTable {
+   private:
+    IxFileHdr *file_hdr_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;
+    int bucket_capacity_;               // 每个桶页面最多存放的键值对数量
+    std::vector<ColType> key_types_;    // 上层key的字段类型（不含非唯一索引追加的rid）
+    std::vector<int> key_lens_;         // 上层key的字段长度
+    std::shared_mutex latch_;           // 查找时共享，插入和删除时独占
+    std::function<void()> update_file_hdr_;  // 修改file_hdr_之后调用，把文件头写回文件头页面
+
+   public:
+    IxHashTable(IxFileHdr *file_hdr, BufferPoolManager *buffer_pool_manager, int fd,
+                std::function<void()> update_file_hdr);
+
+    static void init_file(DiskManager *disk_manager, int fd);
+
+    bool get_value(const char *key, std::vector<Rid> *result);
+
+    page_id_t insert_entry(const char *key, const Rid &rid);
+
+    bool delete_entry(const char *key, const Rid &rid);
+
+    int get_global_depth();
+
+    int get_bucket_capacity() const { return bucket_capacity_; }
+
+    std::vector<page_id_t> get_bucket_pages();
+
+    int read_bucket(page_id_t bucket_no, std::vector<char> *keys);
+
+    void read_all_keys(std::vector<char> *keys);
+
+   private:
+    uint32_t hash(const char *key) const;
+
+    int compare_key(const char *a, const char *b) const;
+
+    int entry_size() const { return file_hdr_->col_tot_len_ + static_cast<int>(sizeof(Rid)); }
+
+    static IxHashBucketHdr *bucket_hdr(Page *page) { return reinterpret_cast<IxHashBucketHdr *>(page->get_data()); }
+
+    char *entry_at(Page *page, int idx) const {
+        return page->get_data() + sizeof(IxHashBucketHdr) + idx * entry_size();
+    }
+
+    Rid *rid_at(Page *page, int idx) const {
+        return reinterpret_cast<Rid *>(entry_at(page, idx) + file_hdr_->col_tot_len_);
+    }
+
+    Page *fetch_page(page_id_t page_no) const { return buffer_pool_manager_->fetch_page(PageId{fd_, page_no}); }
+
+    Page *create_page();
+
+    Page *create_overflow_page();
+
+    page_id_t find_bucket(uint32_t hash_value) const;
+
+    void append_entry(Page *bucket, const char *entry);
+
+    bool split_bucket(Page *bucket, uint32_t hash_value);
+
+    bool double_directory();
+
+    // 以下两个函数由调用者持有latch_
+    std::vector<page_id_t> collect_bucket_pages();
+
+    int collect_bucket(page_id_t bucket_no, std::vector<char> *keys);
+};
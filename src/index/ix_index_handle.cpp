@@ -10,6 +10,12 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <string>
+#include <utility>
+
 #include "ix_scan.h"
 // #define DEBUG
 #ifdef DEBUG
@@ -20,8 +26,10 @@ See the Mulan PSL v2 for more details. */
     print("node_size: " << node.get_size());           \
     print(" node_id: " << node.get_page_id().page_no); \
     print(" node keys: ");                             \
+    std::vector<char> key_buf(file_hdr_->col_tot_len_); \
     for (int i = 0; i < node.get_size(); ++i) {        \
-        print(print_key(node.get_key(i), file_hdr_));  \
+        node.copy_key(i, key_buf.data());              \
+        print(print_key(key_buf.data(), file_hdr_));   \
     }                                                  \
     print("\n")
 #define debug(x) println(#x << ": " << x);
@@ -86,6 +94,148 @@ void unlock_pages(BufferPoolManager *buffer_pool_manager, Transaction *transacti
     }
 }
 
+/**
+ * @brief 把第key_idx个key完整地复制到dest中，定长格式直接复制，压缩格式需要解码
+ *
+ * @param dest 长度至少为file_hdr->col_tot_len
+ */
+void IxNodeHandle::copy_key(int key_idx, char *dest) const {
+    if (is_compressed()) {
+        decode_key(page->get_data() + slots[key_idx].offset, dest);
+    } else {
+        memcpy(dest, get_key(key_idx), file_hdr->col_tot_len_);
+    }
+}
+
+/**
+ * @brief 比较第key_idx个key和target
+ *
+ * @return 小于、等于、大于target时分别返回负数、0、正数
+ */
+int IxNodeHandle::compare_key(int key_idx, const char *target) const {
+    if (!is_compressed()) {
+        return ix_compare(get_key(key_idx), target, file_hdr->col_types_, file_hdr->col_lens_);
+    }
+    char key[IX_MAX_COL_LEN + sizeof(Rid)];
+    copy_key(key_idx, key);
+    return ix_compare(key, target, file_hdr->col_types_, file_hdr->col_lens_);
+}
+
+/**
+ * @brief 压缩格式：low_key和high_key在第一个字段上的公共前缀长度
+ * 结点内所有key都落在[low_key, high_key)中，因此都以该前缀开头；只有第一个字段是字符串时才使用前缀
+ *
+ * @param low_key 结点的下界，为nullptr表示没有下界
+ * @param high_key 结点的上界，为nullptr表示没有上界
+ */
+int IxNodeHandle::prefix_len_between(const char *low_key, const char *high_key) const {
+    if (low_key == nullptr || high_key == nullptr || file_hdr->col_types_[0] != TYPE_STRING) {
+        return 0;
+    }
+    int len = 0;
+    while (len < file_hdr->col_lens_[0] && low_key[len] == high_key[len]) {
+        len++;
+    }
+    return len;
+}
+
+/**
+ * @brief 压缩格式：编码一个key，返回编码后的长度
+ * 字符串字段编码为2字节的长度加上去掉末尾0之后的内容，其中第一个字段还要去掉结点的公共前缀；其他类型的字段原样存放
+ *
+ * @param key 完整的key
+ * @param prefix_len 要去掉的公共前缀长度
+ * @param dest 编码的结果，为nullptr时只计算长度
+ */
+int IxNodeHandle::encode_key(const char *key, int prefix_len, char *dest) const {
+    int len = 0;
+    for (size_t i = 0; i < file_hdr->col_types_.size(); i++) {
+        int col_len = file_hdr->col_lens_[i];
+        if (file_hdr->col_types_[i] != TYPE_STRING) {
+            if (dest != nullptr) {
+                memcpy(dest + len, key, col_len);
+            }
+            len += col_len;
+        } else {
+            int skip = i == 0 ? prefix_len : 0;
+            int end = col_len;
+            while (end > skip && key[end - 1] == 0) {
+                end--;
+            }
+            uint16_t str_len = end - skip;
+            if (dest != nullptr) {
+                memcpy(dest + len, &str_len, sizeof(uint16_t));
+                memcpy(dest + len + sizeof(uint16_t), key + skip, str_len);
+            }
+            len += sizeof(uint16_t) + str_len;
+        }
+        key += col_len;
+    }
+    return len;
+}
+
+/**
+ * @brief 压缩格式：把src处编码后的key解码为完整的key，公共前缀从low key中取得
+ */
+void IxNodeHandle::decode_key(const char *src, char *dest) const {
+    for (size_t i = 0; i < file_hdr->col_types_.size(); i++) {
+        int col_len = file_hdr->col_lens_[i];
+        if (file_hdr->col_types_[i] != TYPE_STRING) {
+            memcpy(dest, src, col_len);
+            src += col_len;
+        } else {
+            int skip = i == 0 ? page_hdr->prefix_len : 0;
+            uint16_t str_len;
+            memcpy(&str_len, src, sizeof(uint16_t));
+            memcpy(dest, get_low_key(), skip);
+            memcpy(dest + skip, src + sizeof(uint16_t), str_len);
+            memset(dest + skip + str_len, 0, col_len - skip - str_len);
+            src += sizeof(uint16_t) + str_len;
+        }
+        dest += col_len;
+    }
+}
+
+/**
+ * @brief 压缩格式：把结点的所有键值对解码出来，追加到keys_out和rids_out中
+ */
+void IxNodeHandle::decode_pairs(std::vector<char> *keys_out, std::vector<Rid> *rids_out) const {
+    size_t old_size = keys_out->size();
+    keys_out->resize(old_size + get_size() * file_hdr->col_tot_len_);
+    for (int i = 0; i < get_size(); i++) {
+        copy_key(i, keys_out->data() + old_size + i * file_hdr->col_tot_len_);
+        rids_out->push_back(*get_rid(i));
+    }
+}
+
+/**
+ * @brief 压缩格式：按当前的low key和high key重新计算公共前缀，并用n个键值对重建结点
+ * 调用者需要保证所有key都在结点的范围内，并且结点能够放下这些键值对
+ *
+ * @param keys_in n个完整的key，不能指向当前结点的页面
+ */
+void IxNodeHandle::rebuild(const char *keys_in, const Rid *rids_in, int n) {
+    page_hdr->prefix_len =
+        prefix_len_between(has_low_key() ? get_low_key() : nullptr, has_high_key() ? get_high_key() : nullptr);
+    page_hdr->num_key = 0;
+    page_hdr->key_bytes = 0;
+    page_hdr->heap_size = 0;
+    insert_pairs(0, keys_in, rids_in, n);
+}
+
+/**
+ * @brief 压缩格式：整理编码区，消除删除键值对之后留下的空洞
+ */
+void IxNodeHandle::compact() {
+    std::vector<char> all_keys;
+    std::vector<Rid> all_rids;
+    decode_pairs(&all_keys, &all_rids);
+    page_hdr->num_key = 0;
+    page_hdr->key_bytes = 0;
+    page_hdr->heap_size = 0;
+    insert_pairs(0, all_keys.data(), all_rids.data(), static_cast<int>(all_rids.size()));
+}
+
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
  *
@@ -103,9 +253,7 @@ int IxNodeHandle::lower_bound(const char *target) const {
 
     while (left <= right) {
         int mid = left + (right - left) / 2;
-        const char *mid_key = get_key(mid);
-
-        if (ix_compare(mid_key, target, file_hdr->col_types_, file_hdr->col_lens_) >= 0) {
+        if (compare_key(mid, target) >= 0) {
             result = mid;
             right = mid - 1;
         } else {
@@ -119,23 +267,21 @@ int IxNodeHandle::lower_bound(const char *target) const {
 /**
  * @brief 在当前node中查找第一个>target的key_idx
  *
- * @return key_idx，范围为[1,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
- * @note 注意此处的范围从1开始
+ * @return key_idx，内部结点范围为[1,num_key]，叶子结点范围为[0,num_key]，如果返回的key_idx=num_key，则表示target大于等于最后一个key
+ * @note 内部结点的第0个key不参与查找，因此内部结点的范围从1开始
  */
 int IxNodeHandle::upper_bound(const char *target) const {
     // Todo:
     // 查找当前节点中第一个大于target的key，并返回key的位置给上层
     // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
 
-    int left = 1;
+    int left = page_hdr->is_leaf ? 0 : 1;
     int right = page_hdr->num_key - 1;
     int result = page_hdr->num_key;
 
     while (left <= right) {
         int mid = left + (right - left) / 2;
-        const char *mid_key = get_key(mid);
-
-        if (ix_compare(mid_key, target, file_hdr->col_types_, file_hdr->col_lens_) > 0) {
+        if (compare_key(mid, target) > 0) {
             result = mid;
             right = mid - 1;
         } else {
@@ -163,7 +309,7 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
 
     int key_idx = lower_bound(key);
 
-    if (key_idx < get_size() && ix_compare(get_key(key_idx), key, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+    if (key_idx < get_size() && compare_key(key_idx, key) == 0) {
         *value = get_rid(key_idx);
         return true;
     }
@@ -211,6 +357,29 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
         return;
     }
 
+    if (is_compressed()) {
+        // 压缩格式：slot数组从前向后增长，编码后的key从页尾向前增长，连续空间不够时先整理空洞
+        int slot_begin = static_cast<int>(sizeof(IxPageHdr)) + 2 * file_hdr->col_tot_len_;
+        for (int i = 0; i < n; i++) {
+            const char *k = key + i * file_hdr->col_tot_len_;
+            assert(memcmp(k, get_low_key(), page_hdr->prefix_len) == 0);
+            int len = encode_key(k, page_hdr->prefix_len, nullptr);
+            int slot_end = slot_begin + (page_hdr->num_key + 1) * static_cast<int>(sizeof(IxSlot));
+            if (slot_end + len > PAGE_SIZE - page_hdr->heap_size) {
+                compact();
+            }
+            assert(slot_end + len <= PAGE_SIZE - page_hdr->heap_size);
+            page_hdr->heap_size += len;
+            int offset = PAGE_SIZE - page_hdr->heap_size;
+            encode_key(k, page_hdr->prefix_len, page->get_data() + offset);
+            memmove(&slots[pos + i + 1], &slots[pos + i], (page_hdr->num_key - pos - i) * sizeof(IxSlot));
+            slots[pos + i] = IxSlot{static_cast<uint16_t>(offset), static_cast<uint16_t>(len), rid[i]};
+            page_hdr->num_key++;
+            page_hdr->key_bytes += len;
+        }
+        return;
+    }
+
     memmove(get_key(pos + n), get_key(pos), (page_hdr->num_key - pos) * file_hdr->col_tot_len_);
     memmove(get_rid(pos + n), get_rid(pos), (page_hdr->num_key - pos) * sizeof(Rid));
 
@@ -235,7 +404,7 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
     // 4. 返回完成插入操作之后的键值对数量
 
     int key_idx = lower_bound(key);
-    if (key_idx < get_size() && ix_compare(get_key(key_idx), key, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+    if (key_idx < get_size() && compare_key(key_idx, key) == 0) {
         return get_size();
     }
     insert_pairs(key_idx, key, &value, 1);
@@ -253,6 +422,16 @@ void IxNodeHandle::erase_pair(int pos) {
     // 2. 删除该位置的rid
     // 3. 更新结点的键值对数量
 
+    if (is_compressed()) {
+        page_hdr->key_bytes -= slots[pos].len;
+        memmove(&slots[pos], &slots[pos + 1], (get_size() - pos - 1) * sizeof(IxSlot));
+        page_hdr->num_key--;
+        if (page_hdr->num_key == 0) {
+            page_hdr->heap_size = 0;
+        }
+        return;
+    }
+
     for (int i = pos; i < get_size() - 1; i++) {
         memcpy(get_key(i), get_key(i + 1), file_hdr->col_tot_len_);
         memcpy(get_rid(i), get_rid(i + 1), sizeof(Rid));
@@ -273,7 +452,7 @@ int IxNodeHandle::remove(const char *key) {
     // 3. 返回完成删除操作后的键值对数量
 
     int key_idx = lower_bound(key);
-    if (key_idx < get_size() && ix_compare(get_key(key_idx), key, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+    if (key_idx < get_size() && compare_key(key_idx, key) == 0) {
         erase_pair(key_idx);
     }
     return get_size();
@@ -281,17 +460,29 @@ int IxNodeHandle::remove(const char *key) {
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
-    // init file_hdr_
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
-    char *buf = new char[PAGE_SIZE];
-    memset(buf, 0, PAGE_SIZE);
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
+    // init file_hdr_，文件头页面和其他页面一样经过缓冲池读取
+    Page *hdr_page = buffer_pool_manager_->fetch_page(PageId{fd, IX_FILE_HDR_PAGE});
     file_hdr_ = new IxFileHdr();
-    file_hdr_->deserialize(buf);
+    file_hdr_->deserialize(hdr_page->get_data());
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), false);
 
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
+
+    if (is_hash()) {
+        hash_table_ = std::make_unique<IxHashTable>(file_hdr_, buffer_pool_manager_, fd, [this] { update_file_hdr(); });
+    }
+}
+
+/**
+ * @brief 根结点、叶子链表的首尾、页面数量等文件头信息发生变化后，把file_hdr_写回缓冲池中的文件头页面
+ * 文件头页面和结点页面一样随缓冲池刷盘，不需要等到关闭索引时才整体写回
+ */
+void IxIndexHandle::update_file_hdr() {
+    std::scoped_lock lock(file_hdr_latch_);
+    Page *hdr_page = buffer_pool_manager_->fetch_page(PageId{fd_, IX_FILE_HDR_PAGE});
+    file_hdr_->serialize(hdr_page->get_data());
+    buffer_pool_manager_->unpin_page(hdr_page->get_page_id(), true);
 }
 
 /**
@@ -299,18 +490,24 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  * @param key 要查找的目标key值
  * @param operation 查找到目标键值对后要进行的操作类型
  * @param transaction 事务参数，如果不需要则默认传入nullptr
+ * @param[out] upper_key 不为nullptr时传出叶子结点中key的严格上界（查找路径上最靠下的右侧分隔key），没有上界时为空
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
  * @note need to Unlatch and unpin the leaf node outside!
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
  */
 std::pair<IxNodeHandle, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
-                                                            Transaction *transaction, bool find_first) {
+                                                            Transaction *transaction, bool find_first,
+                                                            std::vector<char> *upper_key) {
     // Todo:
     // 1. 获取根节点
     // 2. 从根节点开始不断向下查找目标key
     // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
 
     bool is_read = operation == Operation::FIND;
+    if (is_read && is_blink()) {
+        return {blink_find_leaf(key), false};
+    }
+
     bool root_is_latched = false;
     if (!is_read) {
         root_latch_.lock();
@@ -320,13 +517,25 @@ std::pair<IxNodeHandle, bool> IxIndexHandle::find_leaf_page(const char *key, Ope
 
     current.page->lock(!is_read);
 
-    char *min_key = current.get_key(0);
-    bool change_min_key = operation == Operation::INSERT
-                              ? ix_compare(key, min_key, file_hdr_->col_types_, file_hdr_->col_lens_) < 0
+    // B-link树和压缩格式的结点不维护父结点中的最小key（见insert_entry），不需要因此保留祖先结点的锁
+    bool maintain_min_key = !is_blink() && !is_compressed();
+    bool change_min_key = operation == Operation::INSERT && maintain_min_key
+                              ? ix_compare(key, current.get_key(0), file_hdr_->col_types_, file_hdr_->col_lens_) < 0
                               : false;
 
+    if (upper_key != nullptr) {
+        upper_key->clear();
+    }
     while (!current.is_leaf_page()) {
         page_id_t child_page_id = current.internal_lookup(key);
+        if (upper_key != nullptr) {
+            // 孩子结点的key都小于其右侧的分隔key，越靠下的分隔key越紧
+            int sep_idx = current.upper_bound(key);
+            if (sep_idx < current.get_size()) {
+                upper_key->resize(file_hdr_->col_tot_len_);
+                current.copy_key(sep_idx, upper_key->data());
+            }
+        }
         IxNodeHandle child = fetch_node(child_page_id);
         child.page->lock(!is_read);
 
@@ -336,9 +545,8 @@ std::pair<IxNodeHandle, bool> IxIndexHandle::find_leaf_page(const char *key, Ope
         } else {
             transaction->append_index_latch_page_set(current.page);
 
-            if (operation == Operation::DELETE) {
-                min_key = child.get_key(0);
-                change_min_key = ix_compare(key, min_key, file_hdr_->col_types_, file_hdr_->col_lens_) == 0;
+            if (operation == Operation::DELETE && maintain_min_key) {
+                change_min_key = ix_compare(key, child.get_key(0), file_hdr_->col_types_, file_hdr_->col_lens_) == 0;
             }
 
             if (child.is_safe(operation) && !change_min_key) {
@@ -356,8 +564,56 @@ std::pair<IxNodeHandle, bool> IxIndexHandle::find_leaf_page(const char *key, Ope
     return {current, root_is_latched};
 }
 
+/**
+ * @brief B-link树的读路径，自根向下查找key所在的叶子结点
+ * 读者不获取root_latch_，也不做latch coupling，任意时刻最多只持有一个结点的读锁；
+ * 如果某个结点在读者释放其父结点之后被并发分裂，key会不小于该结点的high key，此时沿right link向右移动即可
+ *
+ * @param key 要查找的目标key值
+ * @return 目标叶子结点
+ * @note 返回的叶子结点已加读锁并pin住，需要在外面unlatch和unpin
+ */
+IxNodeHandle IxIndexHandle::blink_find_leaf(const char *key) {
+    IxNodeHandle current = fetch_node(file_hdr_->root_page_);
+    current.page->lock(false);
+
+    while (true) {
+        current = blink_move_right(current, key);
+        if (current.is_leaf_page()) {
+            return current;
+        }
+        page_id_t child_page_no = current.internal_lookup(key);
+        current.page->unlock(false);
+        buffer_pool_manager_->unpin_page(current.get_page_id(), false);
+
+        current = fetch_node(child_page_no);
+        current.page->lock(false);
+    }
+}
+
+/**
+ * @brief B-link树：从node开始沿right link向右移动，直到key落在结点的范围内
+ *
+ * @param node 已加读锁的结点
+ * @param key 目标key值
+ * @return key所在范围的同层结点（已加读锁并pin住）
+ * @note B-link树的结点只会向右分裂且不会被合并删除，因此先释放当前结点再锁住右兄弟是安全的
+ */
+IxNodeHandle IxIndexHandle::blink_move_right(IxNodeHandle node, const char *key) {
+    while (node.need_move_right(key)) {
+        page_id_t right_page_no = node.get_right_link();
+        node.page->unlock(false);
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+
+        node = fetch_node(right_page_no);
+        node.page->lock(false);
+    }
+    return node;
+}
+
 /**
  * @brief 用于查找指定键在叶子结点中的对应的值result
+ * 非唯一索引中同一个key可能对应多个rid，并且可能跨越多个叶子，会按rid的顺序全部放入result
  *
  * @param key 查找的目标key值
  * @param result 用于存放结果的容器
@@ -371,13 +627,43 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     // 3. 把rid存入result参数中
     // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
 
-    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::FIND, transaction);
-
-    Rid *rid;
-    bool found = leaf.leaf_lookup(key, &rid);
+    bool probed = false;
+    if (!may_contain(key, &probed)) {
+        return false;
+    }
+    if (is_hash()) {
+        bool found = hash_table_->get_value(key, result);
+        if (!found && probed) {
+            note_false_positive();
+        }
+        return found;
+    }
 
-    if (found) {
-        result->push_back(*rid);
+    // 与key相等的键值对都落在[lower, upper]之间
+    std::vector<char> lower = make_key(key, Rid{INT_MIN, INT_MIN});
+    std::vector<char> upper = make_key(key, Rid{INT_MAX, INT_MAX});
+    auto [leaf, root_is_latched] = find_leaf_page(lower.data(), Operation::FIND, transaction);
+
+    size_t old_size = result->size();
+    int idx = leaf.lower_bound(lower.data());
+    while (true) {
+        if (idx >= leaf.get_size()) {
+            if (leaf.get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+                break;
+            }
+            IxNodeHandle next = fetch_node(leaf.get_next_leaf());
+            next.page->lock(false);
+            leaf.page->unlock(false);
+            buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+            leaf = next;
+            idx = 0;
+            continue;
+        }
+        if (leaf.compare_key(idx, upper.data()) > 0) {
+            break;
+        }
+        result->push_back(*leaf.get_rid(idx));
+        idx++;
     }
 
     leaf.page->unlock(false);
@@ -386,6 +672,10 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     if (root_is_latched) {
         root_latch_.unlock();
     }
+    bool found = result->size() > old_size;
+    if (!found && probed) {
+        note_false_positive();
+    }
     return found;
 }
 
@@ -408,21 +698,29 @@ IxNodeHandle IxIndexHandle::split(IxNodeHandle &node) {
     new_node.page_hdr->is_leaf = node.page_hdr->is_leaf;
     new_node.page_hdr->parent = node.get_parent_page_no();
 
-    int total_size = node.get_size();
-    int split_point = (total_size + 1) / 2;
-    int new_size = total_size - split_point;
+    if (is_compressed()) {
+        split_compressed(node, new_node);
+    } else {
+        int total_size = node.get_size();
+        int split_point = (total_size + 1) / 2;
+        int new_size = total_size - split_point;
 
-    new_node.insert_pairs(0, node.get_key(split_point), node.get_rid(split_point), new_size);
-    node.set_size(split_point);
+        new_node.insert_pairs(0, node.get_key(split_point), node.get_rid(split_point), new_size);
+        node.set_size(split_point);
+    }
 
     if (node.is_leaf_page()) {
+        update_stats(0, 1);
         new_node.set_next_leaf(node.get_next_leaf());
         new_node.set_prev_leaf(node.get_page_no());
         node.set_next_leaf(new_node.get_page_no());
 
         if (new_node.get_next_leaf() != INVALID_PAGE_ID) {
+            // 后继叶子可能正被IxScan持有读锁，修改前加写锁；此时node持有写锁，加锁顺序与扫描一样从左往右
             IxNodeHandle next = fetch_node(new_node.get_next_leaf());
+            next.page->lock();
             next.set_prev_leaf(new_node.get_page_no());
+            next.page->unlock();
             buffer_pool_manager_->unpin_page(next.get_page_id(), true);
         }
     } else {
@@ -432,9 +730,61 @@ IxNodeHandle IxIndexHandle::split(IxNodeHandle &node) {
         }
     }
 
+    if (is_blink()) {
+        // B-link树：新结点接管原结点的high key和right link，原结点的high key变为新结点的第一个key
+        // 此时原结点仍持有写锁，读者解锁后看到的一定是完整的分裂结果
+        // 压缩格式的结点在split_compressed()中已经设置好了high key
+        new_node.set_right_link(node.get_right_link());
+        if (!is_compressed()) {
+            new_node.page_hdr->has_high_key = node.has_high_key();
+            if (node.has_high_key()) {
+                memcpy(new_node.get_high_key(), node.get_high_key(), file_hdr_->col_tot_len_);
+            }
+            node.set_high_key(new_node.get_key(0));
+        }
+        node.set_right_link(new_node.get_page_no());
+    }
+
     return new_node;
 }
 
+/**
+ * @brief 压缩格式的结点按编码后的字节数把键值对平均分配到node和new_node中
+ * 分裂点的key成为node的high key和new_node的low key，new_node继承node原来的high key，两个结点各自按新的范围重新计算公共前缀
+ * 没有high key的结点（每层最右边的结点）无法使用公共前缀，并且顺序插入总是落在这里，因此只分出末尾约1/8的字节，
+ * 让大部分键值对进入有上下界、可以压缩的node
+ *
+ * @param node 需要拆分的结点
+ * @param new_node 新建的右兄弟结点
+ */
+void IxIndexHandle::split_compressed(IxNodeHandle &node, IxNodeHandle &new_node) {
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    node.decode_pairs(&keys, &rids);
+
+    int total_size = node.get_size();
+    int used_bytes = node.get_used_bytes();
+    int left_target = node.has_high_key() ? used_bytes / 2 : used_bytes - used_bytes / 8;
+    int split_point = 0;
+    int left_bytes = 0;
+    while (split_point < total_size - 1 && left_bytes < left_target) {
+        left_bytes += sizeof(IxSlot) + node.slots[split_point].len;
+        split_point++;
+    }
+    split_point = std::max(split_point, 1);
+    const char *split_key = keys.data() + split_point * file_hdr_->col_tot_len_;
+
+    new_node.page_hdr->has_high_key = node.has_high_key();
+    if (node.has_high_key()) {
+        memcpy(new_node.get_high_key(), node.get_high_key(), file_hdr_->col_tot_len_);
+    }
+    new_node.set_low_key(split_key);
+    node.set_high_key(split_key);
+
+    node.rebuild(keys.data(), rids.data(), split_point);
+    new_node.rebuild(split_key, rids.data() + split_point, total_size - split_point);
+}
+
 /**
  * @brief Insert key & value pair into internal page after split
  * 拆分(Split)后，向上找到old_node的父结点
@@ -461,15 +811,20 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle old_node, const char *key, I
         IxNodeHandle new_root = create_node();
         new_root.page_hdr->is_leaf = false;
         new_root.page_hdr->parent = INVALID_PAGE_ID;
+        new_root.page_hdr->right_link = IX_NO_PAGE;
+        new_root.page_hdr->has_high_key = false;
 
-        new_root.insert_pair(0, old_node.get_key(0), {old_node.get_page_no(), -1});
+        std::vector<char> first_key(file_hdr_->col_tot_len_);
+        old_node.copy_key(0, first_key.data());
+        new_root.insert_pair(0, first_key.data(), {old_node.get_page_no(), -1});
         new_root.insert_pair(1, key, {new_node.get_page_no(), -1});
 
         // 更新子节点的父指针
         old_node.set_parent_page_no(new_root.get_page_no());
         new_node.set_parent_page_no(new_root.get_page_no());
 
-        // 更新根节点信息
+        // 更新根节点信息，树高加1
+        update_stats(0, 0, 1);
         update_root_page_no(new_root.get_page_no());
 
         buffer_pool_manager_->unpin_page(new_root.get_page_id(), true);
@@ -489,7 +844,9 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle old_node, const char *key, I
 
     if (parent.is_overflow()) {
         IxNodeHandle new_parent = split(parent);
-        insert_into_parent(parent, new_parent.get_key(0), new_parent, transaction);
+        std::vector<char> split_key(file_hdr_->col_tot_len_);
+        new_parent.copy_key(0, split_key.data());
+        insert_into_parent(parent, split_key.data(), new_parent, transaction);
 
         buffer_pool_manager_->unpin_page(new_parent.get_page_id(), true);
     }
@@ -499,9 +856,10 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle old_node, const char *key, I
 
 /**
  * @brief 将指定键值对插入到B+树中
+ * 唯一索引在找到目标叶子后检查key是否已经存在，存在则释放所有锁并抛出DuplicateKeyError
  * @param (key, value) 要插入的键值对
  * @param transaction 事务指针
- * @return page_id_t 插入到的叶结点的page_no
+ * @return page_id_t 插入到的叶结点的page_no，哈希索引为桶的page_no
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
     // Todo:
@@ -510,19 +868,53 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
     // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
 
-    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::INSERT, transaction);
+    std::vector<char> entry_key = make_key(key, value);
+    if (is_hash()) {
+        page_id_t bucket_no;
+        try {
+            bucket_no = hash_table_->insert_entry(entry_key.data(), value);
+        } catch (DuplicateKeyError &) {
+            capture(key);
+            throw;
+        }
+        update_stats(1);
+        capture(key);
+        bloom_add(key);
+        return bucket_no;
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(entry_key.data(), Operation::INSERT, transaction);
+
+    Rid *existing;
+    if (file_hdr_->unique_ && leaf.leaf_lookup(entry_key.data(), &existing)) {
+        leaf.page->unlock();
+        unlock_pages(buffer_pool_manager_, transaction);
+        buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+        if (root_is_latched) {
+            root_latch_.unlock();
+        }
+        // 被拒绝的记录可能已经短暂地写入了表中，在线重建时也要同步这个key，使其不会从表中被装载进新索引
+        capture(key);
+        throw DuplicateKeyError();
+    }
 
-    if (leaf.get_size() < leaf.insert(key, value)) {
+    if (leaf.get_size() < leaf.insert(entry_key.data(), value)) {
+        update_stats(1);
         if (leaf.is_overflow()) {
             IxNodeHandle new_leaf = split(leaf);
-            insert_into_parent(leaf, new_leaf.get_key(0), new_leaf, transaction);
+            std::vector<char> split_key(file_hdr_->col_tot_len_);
+            new_leaf.copy_key(0, split_key.data());
+            insert_into_parent(leaf, split_key.data(), new_leaf, transaction);
 
             if (leaf.get_page_no() == file_hdr_->last_leaf_) {
                 file_hdr_->last_leaf_ = new_leaf.get_page_no();
+                update_file_hdr();
             }
             buffer_pool_manager_->unpin_page(new_leaf.get_page_id(), true);
         }
-        maintain_parent(leaf);
+        // B-link树和压缩格式的结点中，内部结点的key只作为子树的下界使用，插入不会使其失效，无需向上维护
+        if (!is_blink() && !is_compressed()) {
+            maintain_parent(leaf);
+        }
     }
 
     leaf.page->unlock();
@@ -532,39 +924,275 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     if (root_is_latched) {
         root_latch_.unlock();
     }
+    capture(key);
+    bloom_add(key);
     return leaf.get_page_no();
 }
 
 /**
- * @brief 用于删除B+树中含有指定key的键值对
+ * @brief 用于删除B+树中指定的键值对(key, value)
  * @param key 要删除的key值
+ * @param value 要删除的键值对的rid，唯一索引中key对应的rid与之不同时不删除
  * @param transaction 事务指针
+ * @return 是否删除了键值对
  */
-bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+bool IxIndexHandle::delete_entry(const char *key, const Rid &value, Transaction *transaction) {
     // Todo:
     // 1. 获取该键值对所在的叶子结点
     // 2. 在该叶子结点中删除键值对
     // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
     // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
 
-    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::DELETE, transaction);
+    std::vector<char> entry_key = make_key(key, value);
+    if (is_hash()) {
+        bool deleted = hash_table_->delete_entry(entry_key.data(), value);
+        if (deleted) {
+            update_stats(-1);
+            capture(key);
+            bloom_remove(1);
+        }
+        return deleted;
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(entry_key.data(), Operation::DELETE, transaction);
 
-    if (leaf.get_size() > leaf.remove(key)) {
-        if (leaf.is_underflow()) {
-            coalesce_or_redistribute(leaf, transaction, &root_is_latched);
-        } else {
-            maintain_parent(leaf);
+    Rid *existing;
+    bool found = leaf.leaf_lookup(entry_key.data(), &existing) && *existing == value;
+    // B-link树删除后不做合并和重分配（结点只会向右分裂，读者才能安全地沿right link移动），稀疏的结点留给重建处理
+    if (found) {
+        leaf.remove(entry_key.data());
+        update_stats(-1);
+        if (!is_blink()) {
+            if (leaf.is_underflow()) {
+                coalesce_or_redistribute(leaf, transaction, &root_is_latched);
+            } else if (!is_compressed()) {
+                maintain_parent(leaf);
+            }
         }
     }
 
-    leaf.page->unlock();
-    unlock_pages(buffer_pool_manager_, transaction);
-    buffer_pool_manager_->unpin_page(leaf.get_page_id(), true);
+    release_after_delete(leaf, found, transaction);
 
     if (root_is_latched) {
         root_latch_.unlock();
     }
-    return true;
+    if (found) {
+        capture(key);
+        bloom_remove(1);
+    }
+    return found;
+}
+
+/**
+ * @brief 用于删除B+树中key对应的第一个键值对（按rid排序）
+ * @param key 要删除的key值
+ * @param transaction 事务指针
+ * @return 是否删除了键值对
+ */
+bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+    std::vector<Rid> rids;
+    if (!get_value(key, &rids, transaction)) {
+        return false;
+    }
+    return delete_entry(key, rids.front(), transaction);
+}
+
+/**
+ * @brief 把(key, rid)转换为索引中实际存储的key，并按key排序，使落在同一个叶子中的键值对相邻
+ */
+std::vector<std::pair<std::vector<char>, Rid>> IxIndexHandle::sort_entries(
+    const std::vector<std::pair<std::vector<char>, Rid>> &entries) const {
+    std::vector<std::pair<std::vector<char>, Rid>> sorted;
+    sorted.reserve(entries.size());
+    for (auto &[key, rid] : entries) {
+        sorted.emplace_back(make_key(key.data(), rid), rid);
+    }
+    std::sort(sorted.begin(), sorted.end(), [this](const auto &a, const auto &b) {
+        return ix_compare(a.first.data(), b.first.data(), file_hdr_->col_types_, file_hdr_->col_lens_) < 0;
+    });
+    return sorted;
+}
+
+/**
+ * @brief 批量插入键值对：按key排序后逐个叶子插入，落在同一个叶子中的键值对只需要一次自根向下的查找
+ * 每个叶子中第一个键值对按insert_entry的方式插入（可能分裂结点）；之后的键值对只在不超出叶子的key范围、
+ * 并且叶子插入后不会溢出时继续放入当前叶子，否则重新查找
+ * 唯一索引中key重复时，撤销本次已经插入的键值对并抛出DuplicateKeyError，即要么全部插入，要么都不插入
+ *
+ * @param entries 上层传入的(key, rid)，顺序任意
+ * @param transaction 事务指针
+ */
+void IxIndexHandle::insert_entries(const std::vector<std::pair<std::vector<char>, Rid>> &entries,
+                                   Transaction *transaction) {
+    auto sorted = sort_entries(entries);
+    auto equal_key = [this](const std::vector<char> &a, const std::vector<char> &b) {
+        return ix_compare(a.data(), b.data(), file_hdr_->col_types_, file_hdr_->col_lens_) == 0;
+    };
+    // 与insert_entry相同，插入成功或者被拒绝时都要在在线重建期间记录这些key
+    auto capture_all = [&]() {
+        for (auto &[key, rid] : entries) {
+            capture(key.data());
+        }
+    };
+    // 全部插入成功之后才加入filter，被撤销的键值对不需要加入
+    auto bloom_add_all = [&]() {
+        for (auto &[key, rid] : entries) {
+            bloom_add(key.data());
+        }
+    };
+    // 撤销sorted中前n个已经插入的键值对
+    auto rollback = [&](size_t n) {
+        std::vector<std::pair<std::vector<char>, Rid>> inserted;
+        for (size_t j = 0; j < n; j++) {
+            auto &key = sorted[j].first;
+            inserted.emplace_back(std::vector<char>(key.begin(), key.begin() + file_hdr_->key_len()), sorted[j].second);
+        }
+        delete_entries(inserted, transaction);
+        capture_all();
+    };
+    for (size_t i = 1; file_hdr_->unique_ && i < sorted.size(); i++) {
+        if (equal_key(sorted[i - 1].first, sorted[i].first)) {
+            rollback(0);
+            throw DuplicateKeyError();
+        }
+    }
+
+    if (is_hash()) {
+        for (size_t i = 0; i < sorted.size(); i++) {
+            try {
+                hash_table_->insert_entry(sorted[i].first.data(), sorted[i].second);
+                update_stats(1);
+            } catch (DuplicateKeyError &) {
+                rollback(i);
+                throw;
+            }
+        }
+        capture_all();
+        bloom_add_all();
+        return;
+    }
+
+    size_t i = 0;
+    std::vector<char> upper_key;
+    while (i < sorted.size()) {
+        auto [leaf, root_is_latched] =
+            find_leaf_page(sorted[i].first.data(), Operation::INSERT, transaction, false, &upper_key);
+
+        bool is_split = false;
+        bool duplicate = false;
+        int inserted = 0;
+        do {
+            const char *key = sorted[i].first.data();
+            Rid *existing;
+            if (file_hdr_->unique_ && leaf.leaf_lookup(key, &existing)) {
+                duplicate = true;
+                break;
+            }
+            leaf.insert(key, sorted[i].second);
+            inserted++;
+            i++;
+            if (leaf.is_overflow()) {
+                IxNodeHandle new_leaf = split(leaf);
+                std::vector<char> split_key(file_hdr_->col_tot_len_);
+                new_leaf.copy_key(0, split_key.data());
+                insert_into_parent(leaf, split_key.data(), new_leaf, transaction);
+
+                if (leaf.get_page_no() == file_hdr_->last_leaf_) {
+                    file_hdr_->last_leaf_ = new_leaf.get_page_no();
+                    update_file_hdr();
+                }
+                buffer_pool_manager_->unpin_page(new_leaf.get_page_id(), true);
+                is_split = true;
+            }
+        } while (!is_split && i < sorted.size() && leaf.is_safe(Operation::INSERT) &&
+                 (upper_key.empty() || ix_compare(sorted[i].first.data(), upper_key.data(), file_hdr_->col_types_,
+                                                  file_hdr_->col_lens_) < 0));
+        update_stats(inserted);
+        // 只有叶子中第一个插入的键值对可能成为叶子的最小key
+        if (!is_blink() && !is_compressed()) {
+            maintain_parent(leaf);
+        }
+
+        leaf.page->unlock();
+        unlock_pages(buffer_pool_manager_, transaction);
+        buffer_pool_manager_->unpin_page(leaf.get_page_id(), true);
+        if (root_is_latched) {
+            root_latch_.unlock();
+        }
+
+        if (duplicate) {
+            rollback(i);
+            throw DuplicateKeyError();
+        }
+    }
+    capture_all();
+    bloom_add_all();
+}
+
+/**
+ * @brief 批量删除键值对：按key排序后逐个叶子删除，落在同一个叶子中的键值对只需要一次自根向下的查找
+ * 每个叶子中第一个键值对按delete_entry的方式删除（可能合并或重分配结点）；之后的键值对只在不超出叶子的key范围、
+ * 叶子删除后不会下溢、并且不会改变需要向上维护的最小key时继续在当前叶子中删除，否则重新查找
+ *
+ * @param entries 上层传入的(key, rid)，顺序任意；唯一索引中key对应的rid与之不同时不删除
+ * @param transaction 事务指针
+ * @return 删除的键值对数量
+ */
+int IxIndexHandle::delete_entries(const std::vector<std::pair<std::vector<char>, Rid>> &entries,
+                                  Transaction *transaction) {
+    auto sorted = sort_entries(entries);
+    int deleted = 0;
+
+    if (is_hash()) {
+        for (auto &[key, rid] : sorted) {
+            if (hash_table_->delete_entry(key.data(), rid)) {
+                deleted++;
+                capture(key.data());
+            }
+        }
+        update_stats(-deleted);
+        bloom_remove(deleted);
+        return deleted;
+    }
+
+    size_t i = 0;
+    std::vector<char> upper_key;
+    while (i < sorted.size()) {
+        auto [leaf, root_is_latched] =
+            find_leaf_page(sorted[i].first.data(), Operation::DELETE, transaction, false, &upper_key);
+
+        int leaf_deleted = 0;
+        do {
+            const char *key = sorted[i].first.data();
+            Rid *existing;
+            if (leaf.leaf_lookup(key, &existing) && *existing == sorted[i].second) {
+                leaf.remove(key);
+                leaf_deleted++;
+                capture(key);
+            }
+            i++;
+        } while (i < sorted.size() && leaf.is_safe(Operation::DELETE) &&
+                 (upper_key.empty() || ix_compare(sorted[i].first.data(), upper_key.data(), file_hdr_->col_types_,
+                                                  file_hdr_->col_lens_) < 0) &&
+                 (is_blink() || is_compressed() || leaf.compare_key(0, sorted[i].first.data()) < 0));
+        bool modified = leaf_deleted > 0;
+        deleted += leaf_deleted;
+        update_stats(-leaf_deleted);
+        // B-link树删除后不做合并和重分配，见delete_entry
+        if (modified && !is_blink()) {
+            if (leaf.is_underflow()) {
+                coalesce_or_redistribute(leaf, transaction, &root_is_latched);
+            } else if (!is_compressed()) {
+                maintain_parent(leaf);
+            }
+        }
+
+        release_after_delete(leaf, modified, transaction);
+        if (root_is_latched) {
+            root_latch_.unlock();
+        }
+    }
+    bloom_remove(deleted);
+    return deleted;
 }
 
 /**
@@ -604,18 +1232,44 @@ void IxIndexHandle::coalesce_or_redistribute(IxNodeHandle node, Transaction *tra
     IxNodeHandle parent = fetch_node(node.get_parent_page_no());
 
     int index = parent.find_child(node);
+    if (is_compressed() && parent.get_size() < 2) {
+        // 压缩格式的结点可能容忍下溢，父结点只剩node一个孩子时没有兄弟结点可以合并或重分配
+        buffer_pool_manager_->unpin_page(parent.get_page_id(), false);
+        return;
+    }
     Rid *rid = index == 0 ? parent.get_rid(1) : parent.get_rid(index - 1);
     IxNodeHandle neighbor = fetch_node(rid->page_no);
+    // 兄弟结点可能正被IxScan持有读锁，修改前加写锁。扫描沿叶子链从左往右做latch coupling，写者也必须从左往右加锁，
+    // 兄弟结点在左边时先放开node，再依次锁住neighbor和node；父结点持有写锁，其间其他写者和自根向下的读者都进不来
+    Page *neighbor_page = neighbor.page;
+    PageId neighbor_id = neighbor.get_page_id();
+    if (index == 0) {
+        neighbor_page->lock();
+    } else {
+        node.page->unlock();
+        neighbor_page->lock();
+        node.page->lock();
+    }
 
-    if (neighbor.get_size() + node.get_size() >= 2 * node.get_min_size()) {
+    if (is_compressed()) {
+        // 压缩格式按字节判断：合并后放得下就合并，否则从兄弟结点借一个键值对，二者都做不到时容忍下溢
+        if (can_coalesce(neighbor, node, index)) {
+            coalesce(neighbor, node, parent, index, transaction, root_is_latched);
+            transaction->append_index_deleted_page(node.page);
+        } else {
+            redistribute_compressed(neighbor, node, parent, index);
+        }
+    } else if (neighbor.get_size() + node.get_size() >= 2 * node.get_min_size()) {
         redistribute(neighbor, node, parent, index);
     } else {
         coalesce(neighbor, node, parent, index, transaction, root_is_latched);
         transaction->append_index_deleted_page(node.page);
     }
 
+    // coalesce()可能交换neighbor和node，按加锁时记下的页面解锁和unpin；node的pin属于调用者
+    neighbor_page->unlock();
     buffer_pool_manager_->unpin_page(parent.get_page_id(), true);
-    buffer_pool_manager_->unpin_page(neighbor.get_page_id(), true);
+    buffer_pool_manager_->unpin_page(neighbor_id, true);
 }
 
 /**
@@ -629,17 +1283,14 @@ bool IxIndexHandle::adjust_root(IxNodeHandle old_root_node) {
     // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
     // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
     // 3. 除了上述两种情况，不需要进行操作
-
-    if (old_root_node.is_leaf_page() && old_root_node.get_size() == 0) {
-        file_hdr_->root_page_ = INVALID_PAGE_ID;
-        return true;
-    }
+    // 注意：根结点是叶结点时即使为空也保留，之后的插入仍然从它开始，first_leaf_和last_leaf_也继续指向它
 
     if (!old_root_node.is_leaf_page() && old_root_node.get_size() == 1) {
         IxNodeHandle new_root = fetch_node(old_root_node.get_rid(0)->page_no);
         new_root.set_parent_page_no(INVALID_PAGE_ID);
 
-        file_hdr_->root_page_ = new_root.get_page_id().page_no;
+        update_stats(0, 0, -1);
+        update_root_page_no(new_root.get_page_id().page_no);
         return true;
     }
 
@@ -712,30 +1363,149 @@ void IxIndexHandle::coalesce(IxNodeHandle &neighbor_node, IxNodeHandle &node, Ix
     int node_size = node.get_size();
     int neighbor_size = neighbor_node.get_size();
 
-    neighbor_node.insert_pairs(neighbor_size, node.get_key(0), node.get_rid(0), node_size);
+    if (is_compressed()) {
+        // 合并后的结点范围是两个结点范围的并集，按新的范围重建
+        std::vector<char> keys;
+        std::vector<Rid> rids;
+        collect_pairs(neighbor_node, node, &keys, &rids);
+        neighbor_node.page_hdr->has_high_key = node.has_high_key();
+        if (node.has_high_key()) {
+            memcpy(neighbor_node.get_high_key(), node.get_high_key(), file_hdr_->col_tot_len_);
+        }
+        neighbor_node.rebuild(keys.data(), rids.data(), neighbor_size + node_size);
+    } else {
+        neighbor_node.insert_pairs(neighbor_size, node.get_key(0), node.get_rid(0), node_size);
+    }
 
     for (int i = 0; i < node_size; i++) {
         maintain_child(neighbor_node, neighbor_size + i);
     }
 
     if (node.is_leaf_page()) {
+        update_stats(0, -1);
         if (node.get_page_id().page_no == file_hdr_->last_leaf_) {
             file_hdr_->last_leaf_ = neighbor_node.get_page_id().page_no;
+            update_file_hdr();
         }
         erase_leaf(node);
     }
 
-    buffer_pool_manager_->unpin_page(node.get_page_id(), true);
-    buffer_pool_manager_->delete_page(node.get_page_id());
-    file_hdr_->num_pages_--;
-
-    maintain_parent(neighbor_node);
+    // node仍然被锁住、被pin住，由调用者加入index_deleted_page_set，等释放之后在release_after_delete()中从缓冲池删除
+    if (!is_compressed()) {
+        maintain_parent(neighbor_node);
+    }
     parent.erase_pair(index);
     if (parent.is_underflow()) {
         coalesce_or_redistribute(parent, transaction, root_is_latched);
     }
+}
 
-    buffer_pool_manager_->unpin_page(parent.get_page_id(), true);
+/**
+ * @brief 压缩格式：把相邻的left和right两个结点的键值对按顺序解码出来
+ * 内部结点的第0个key等于其low key，也就是父结点中指向它的key，因此拼接后仍是合法的内部结点
+ */
+void IxIndexHandle::collect_pairs(IxNodeHandle left, IxNodeHandle right, std::vector<char> *keys,
+                                  std::vector<Rid> *rids) const {
+    left.decode_pairs(keys, rids);
+    right.decode_pairs(keys, rids);
+}
+
+/**
+ * @brief 压缩格式：假设node的范围变为[low_key, high_key)并用keys中的前n个key重建，重建之后使用的字节数
+ */
+int IxIndexHandle::rebuilt_used_bytes(IxNodeHandle node, const std::vector<char> &keys, int n,
+                                      const char *low_key, const char *high_key) const {
+    int prefix_len = node.prefix_len_between(low_key, high_key);
+    int used = n * static_cast<int>(sizeof(IxSlot));
+    for (int i = 0; i < n; i++) {
+        used += node.encode_key(keys.data() + i * file_hdr_->col_tot_len_, prefix_len, nullptr);
+    }
+    return used;
+}
+
+/**
+ * @brief 压缩格式：node和兄弟结点neighbor_node合并之后是否放得下
+ * @param index node在parent中的rid_idx，index=0时neighbor_node在node的右边
+ */
+bool IxIndexHandle::can_coalesce(IxNodeHandle neighbor_node, IxNodeHandle node, int index) const {
+    IxNodeHandle &left = index == 0 ? node : neighbor_node;
+    IxNodeHandle &right = index == 0 ? neighbor_node : node;
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    collect_pairs(left, right, &keys, &rids);
+    int used = rebuilt_used_bytes(left, keys, static_cast<int>(rids.size()),
+                                  left.has_low_key() ? left.get_low_key() : nullptr,
+                                  right.has_high_key() ? right.get_high_key() : nullptr);
+    return left.fits(used);
+}
+
+/**
+ * @brief 压缩格式：从兄弟结点neighbor_node移动一个键值对到node，同时调整两个结点的范围和parent中的分隔key
+ * index=0时把neighbor_node的第一个键值对移到node末尾，新的分隔key是neighbor_node剩下的第一个key；
+ * 否则把neighbor_node的最后一个键值对移到node开头，它的key就是新的分隔key
+ *
+ * @return 是否完成了重分配，node或parent放不下时不做任何修改并返回false
+ */
+bool IxIndexHandle::redistribute_compressed(IxNodeHandle neighbor_node, IxNodeHandle node, IxNodeHandle parent,
+                                            int index) {
+    if (neighbor_node.get_size() < 2) {
+        return false;
+    }
+    bool is_next = index == 0;
+    int sep_idx = is_next ? 1 : index;
+    int remove_idx = is_next ? 0 : neighbor_node.get_size() - 1;
+
+    std::vector<char> moved_key(file_hdr_->col_tot_len_);
+    std::vector<char> new_sep(file_hdr_->col_tot_len_);
+    neighbor_node.copy_key(remove_idx, moved_key.data());
+    Rid moved_rid = *neighbor_node.get_rid(remove_idx);
+    if (is_next) {
+        neighbor_node.copy_key(1, new_sep.data());
+    } else {
+        new_sep = moved_key;
+    }
+
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    if (!is_next) {
+        keys = moved_key;
+        rids.push_back(moved_rid);
+    }
+    node.decode_pairs(&keys, &rids);
+    if (is_next) {
+        keys.insert(keys.end(), moved_key.begin(), moved_key.end());
+        rids.push_back(moved_rid);
+    }
+    int n = static_cast<int>(rids.size());
+
+    const char *low_key = is_next ? (node.has_low_key() ? node.get_low_key() : nullptr) : new_sep.data();
+    const char *high_key = is_next ? new_sep.data() : (node.has_high_key() ? node.get_high_key() : nullptr);
+    if (!node.fits(rebuilt_used_bytes(node, keys, n, low_key, high_key))) {
+        return false;
+    }
+    int parent_used = parent.get_used_bytes() - parent.slots[sep_idx].len +
+                      parent.encode_key(new_sep.data(), parent.page_hdr->prefix_len, nullptr);
+    if (!parent.fits(parent_used)) {
+        return false;
+    }
+
+    // 范围缩小后原来的公共前缀仍然有效，neighbor_node不需要重建
+    neighbor_node.erase_pair(remove_idx);
+    if (is_next) {
+        node.set_high_key(new_sep.data());
+        neighbor_node.set_low_key(new_sep.data());
+    } else {
+        node.set_low_key(new_sep.data());
+        neighbor_node.set_high_key(new_sep.data());
+    }
+    node.rebuild(keys.data(), rids.data(), n);
+
+    Rid child = *parent.get_rid(sep_idx);
+    parent.erase_pair(sep_idx);
+    parent.insert_pair(sep_idx, new_sep.data(), child);
+
+    maintain_child(node, is_next ? n - 1 : 0);
+    return true;
 }
 
 /**
@@ -762,59 +1532,80 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * @brief FindLeafPage + lower_bound
  *
  * @param key
- * @return Iid
+ * @return Iid 第一个>=key的位置，若不存在则为leaf_end()
  * @note 上层传入的key本来是int类型，通过(const char *)&key进行了转换
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
+    assert(!is_hash());
+    std::vector<char> entry_key = make_key(key, Rid{INT_MIN, INT_MIN});
     Transaction txn(0);
-    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::FIND, &txn);
-    int idx = leaf.lower_bound(key);
-
-    if (root_is_latched) {
-        root_latch_.unlock();
-    }
-
-    leaf.page->unlock(false);
+    auto [leaf, root_is_latched] = find_leaf_page(entry_key.data(), Operation::FIND, &txn);
+    int idx = leaf.lower_bound(entry_key.data());
     unlock_pages(buffer_pool_manager_, &txn);
-    buffer_pool_manager_->unpin_page(leaf.page->get_page_id(), false);
     if (root_is_latched) {
         root_latch_.unlock();
     }
 
-    return {leaf.get_page_id().page_no, idx};
+    return leaf_position(leaf, idx);
 }
 
 /**
  * @brief FindLeafPage + upper_bound
  *
  * @param key
- * @return Iid
+ * @return Iid 第一个>key的位置，若不存在则为leaf_end()
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
+    assert(!is_hash());
+    std::vector<char> entry_key = make_key(key, Rid{INT_MAX, INT_MAX});
     Transaction txn(0);
-    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::FIND, &txn);
-
-    int idx = leaf.upper_bound(key);
-    page_id_t page_id = leaf.get_page_id().page_no;
+    auto [leaf, root_is_latched] = find_leaf_page(entry_key.data(), Operation::FIND, &txn);
+    int idx = leaf.upper_bound(entry_key.data());
+    unlock_pages(buffer_pool_manager_, &txn);
+    if (root_is_latched) {
+        root_latch_.unlock();
+    }
 
-    if (idx == leaf.get_size()) {
-        if (file_hdr_->last_leaf_ == leaf.get_page_id().page_no) {
-            return leaf_end();
-        }
+    return leaf_position(leaf, idx);
+}
 
-        page_id = leaf.get_next_leaf();
+/**
+ * @brief 把叶子内的位置(leaf, idx)规范化为IxScan可以直接使用的Iid
+ * 若idx越过了leaf的最后一个key，且leaf不是最后一个叶子，则移动到后继叶子的第一个key（跳过空叶子），
+ * 使得同一个位置只有唯一的Iid表示，可以和IxScan遍历到的iid直接比较
+ *
+ * @param leaf 已加读锁并pin住的叶子结点，函数返回前会unlatch并unpin
+ * @param idx 在leaf中的位置
+ * @return Iid
+ */
+Iid IxIndexHandle::leaf_position(IxNodeHandle leaf, int idx) const {
+    while (idx >= leaf.get_size() && leaf.get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        IxNodeHandle next = fetch_node(leaf.get_next_leaf());
+        next.page->lock(false);
+        leaf.page->unlock(false);
+        buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+        leaf = next;
         idx = 0;
     }
-
+    Iid iid{leaf.get_page_no(), idx};
     leaf.page->unlock(false);
-    unlock_pages(buffer_pool_manager_, &txn);
-    buffer_pool_manager_->unpin_page(leaf.page->get_page_id(), false);
-    if (root_is_latched) {
-        root_latch_.unlock();
-    }
+    buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+    return iid;
+}
 
-    return {page_id, idx};
+/**
+ * @brief 由上层传入的key和rid构造B+树中实际存储的key
+ * 唯一索引直接使用key；非唯一索引在key之后追加rid，使(key, rid)成为唯一的排序键。
+ * 查找时传入INT_MIN/INT_MAX组成的rid，可以得到所有与key相等的键值对的下界/上界
+ */
+std::vector<char> IxIndexHandle::make_key(const char *key, const Rid &rid) const {
+    std::vector<char> entry_key(file_hdr_->col_tot_len_);
+    memcpy(entry_key.data(), key, file_hdr_->key_len());
+    if (!file_hdr_->unique_) {
+        memcpy(entry_key.data() + file_hdr_->key_len(), &rid, sizeof(Rid));
+    }
+    return entry_key;
 }
 
 /**
@@ -858,18 +1649,18 @@ IxNodeHandle IxIndexHandle::fetch_node(int page_no) const {
  *
  * @return IxNodeHandle*
  * @note pin the page, remember to unpin it outside!
- * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
- * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
- * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
- * 与Record的处理不同，Record将未插入满的记录页认为是free_page
+ * 注意：B+树删除的结点页面目前不会被复用，num_pages_只增不减，始终是下一个要分配的页号，
+ * 重新打开索引时据此恢复disk_manager中的页号分配位置
  */
 IxNodeHandle IxIndexHandle::create_node() {
-    IxNodeHandle node;
-    file_hdr_->num_pages_++;
-
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     Page *page = buffer_pool_manager_->new_page(&new_page_id);
+    {
+        std::scoped_lock lock(file_hdr_latch_);
+        file_hdr_->num_pages_ = std::max(file_hdr_->num_pages_, new_page_id.page_no + 1);
+    }
+    update_file_hdr();
     return {file_hdr_, page};
 }
 
@@ -899,6 +1690,7 @@ void IxIndexHandle::maintain_parent(IxNodeHandle node) {
 
 /**
  * @brief 要删除leaf之前调用此函数，更新leaf前驱结点的next指针和后继结点的prev指针
+ * 前驱结点就是coalesce()中合并进去的左兄弟，已经由coalesce_or_redistribute()加了写锁；后继结点在这里按从左往右的顺序加写锁
  *
  * @param leaf 要删除的leaf
  */
@@ -910,16 +1702,36 @@ void IxIndexHandle::erase_leaf(IxNodeHandle leaf) {
     buffer_pool_manager_->unpin_page(prev.get_page_id(), true);
 
     IxNodeHandle next = fetch_node(leaf.get_next_leaf());
+    next.page->lock();
     next.set_prev_leaf(leaf.get_prev_leaf());  // 注意此处是SetPrevLeaf()
+    next.page->unlock();
     buffer_pool_manager_->unpin_page(next.get_page_id(), true);
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除结束时释放叶子和祖先结点的写锁并unpin，然后从缓冲池中删除合并掉的结点
+ * 合并掉的结点不能在合并时立即删除：此时它仍被写者锁住，也可能被刚离开它的IxScan短暂地pin住，
+ * 提前归还的frame会在仍被使用时分配给其他页面。PageId在unpin之前取出，之后frame可能被换出并装入别的页面
  *
- * @param node
+ * @param leaf 删除键值对的叶子，已加写锁并pin住
+ * @param is_dirty 叶子是否被修改
  */
-void IxIndexHandle::release_node_handle(IxNodeHandle &node) { file_hdr_->num_pages_--; }
+void IxIndexHandle::release_after_delete(IxNodeHandle leaf, bool is_dirty, Transaction *transaction) {
+    auto deleted_set = transaction->get_index_deleted_page_set();
+    std::vector<PageId> deleted;
+    for (Page *page : *deleted_set) {
+        deleted.push_back(page->get_page_id());
+    }
+    deleted_set->clear();
+
+    leaf.page->unlock();
+    unlock_pages(buffer_pool_manager_, transaction);
+    buffer_pool_manager_->unpin_page(leaf.get_page_id(), is_dirty);
+    // 仍被其他线程pin住时删除失败，页面号不会再被引用，之后像普通页面一样被换出
+    for (auto &page_id : deleted) {
+        buffer_pool_manager_->delete_page(page_id);
+    }
+}
 
 /**
  * @brief 将node的第child_idx个孩子结点的父节点置为node
@@ -932,4 +1744,673 @@ void IxIndexHandle::maintain_child(IxNodeHandle node, int child_idx) {
         child.set_parent_page_no(node.get_page_no());
         buffer_pool_manager_->unpin_page(child.get_page_id(), true);
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief 修改统计信息中的计数
+ * 写者在释放root_latch_之后仍可能分裂或合并结点，因此计数在file_hdr_latch_下修改，随下一次写回文件头页面持久化
+ */
+void IxIndexHandle::update_stats(int64_t key_delta, int leaf_delta, int height_delta) {
+    std::scoped_lock lock(file_hdr_latch_);
+    file_hdr_->num_keys_ += key_delta;
+    file_hdr_->num_leaves_ += leaf_delta;
+    file_hdr_->height_ += height_delta;
+}
+
+/**
+ * @brief 返回文件头（含统计信息）的副本
+ */
+IxFileHdr IxIndexHandle::get_stats() {
+    std::scoped_lock lock(file_hdr_latch_);
+    return *file_hdr_;
+}
+
+/**
+ * @brief 从根结点开始每层随机选择一个孩子，得到一个随机的叶子结点
+ * 与查找一样自上而下加读锁，拿到孩子的锁之后释放父结点
+ *
+ * @param[out] height 下降经过的层数，即树的高度
+ * @note 返回的叶子持有读锁并被pin住，需要在外面unlock和unpin
+ */
+IxNodeHandle IxIndexHandle::sample_leaf(std::mt19937 &rng, int *height) {
+    IxNodeHandle node = fetch_node(file_hdr_->root_page_);
+    node.page->lock(false);
+    *height = 1;
+    while (!node.is_leaf_page()) {
+        int idx = std::uniform_int_distribution<int>(0, node.get_size() - 1)(rng);
+        IxNodeHandle child = fetch_node(node.value_at(idx));
+        child.page->lock(false);
+        node.page->unlock(false);
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+        node = child;
+        (*height)++;
+    }
+    return node;
+}
+
+/**
+ * @brief ANALYZE INDEX：重新收集统计信息并写回文件头
+ * 叶子不多于2 * IX_ANALYZE_SAMPLE_PAGES个时沿叶子链表扫描全部叶子，键值对数量、叶子数量和不同取值数量都是精确的；
+ * 否则随机下降采样IX_ANALYZE_SAMPLE_PAGES个叶子，用叶子内相邻键值对第一个字段不同的比例估计不同取值的数量。
+ * 采样得到的第一个字段排序后按分位数切分为等深直方图。整个过程最多同时持有两个结点的读锁，不阻塞并发的读写
+ */
+void IxIndexHandle::analyze() {
+    std::mt19937 rng(std::random_device{}());
+    IxFileHdr stats = get_stats();
+    ColType lead_type = file_hdr_->col_types_[0];
+    int lead_len = file_hdr_->col_lens_[0];
+    std::vector<char> samples;  // 采样得到的第一个字段，依次存放
+
+    if (is_hash()) {
+        analyze_hash(rng, &stats, &samples);
+    } else {
+        bool full_scan = stats.num_leaves_ <= 2 * IX_ANALYZE_SAMPLE_PAGES;
+        int64_t pairs = 0;    // 参与比较的相邻键值对数量
+        int64_t changes = 0;  // 其中第一个字段不同的数量
+        double fill_sum = 0;
+        int num_sampled = 0;
+        std::vector<char> key(file_hdr_->col_tot_len_);
+        // 取出叶子中每个键值对的第一个字段；chained为true时叶子按顺序到达，还要与上一个叶子的最后一个key比较
+        auto collect = [&](IxNodeHandle &leaf, bool chained) {
+            for (int i = 0; i < leaf.get_size(); i++) {
+                leaf.copy_key(i, key.data());
+                if (!samples.empty() && (i > 0 || chained)) {
+                    pairs++;
+                    changes += ix_compare(samples.data() + samples.size() - lead_len, key.data(), lead_type,
+                                          lead_len) != 0;
+                }
+                samples.insert(samples.end(), key.data(), key.data() + lead_len);
+            }
+            fill_sum += is_compressed() ? static_cast<double>(leaf.get_used_bytes()) / leaf.get_capacity()
+                                        : static_cast<double>(leaf.get_size()) / file_hdr_->btree_order_;
+            num_sampled++;
+        };
+
+        IxNodeHandle leaf = sample_leaf(rng, &stats.height_);
+        if (full_scan) {
+            leaf.page->unlock(false);
+            buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+            leaf = fetch_node(file_hdr_->first_leaf_);
+            leaf.page->lock(false);
+            while (true) {
+                collect(leaf, true);
+                if (leaf.get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+                    break;
+                }
+                IxNodeHandle next = fetch_node(leaf.get_next_leaf());
+                next.page->lock(false);
+                leaf.page->unlock(false);
+                buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+                leaf = next;
+            }
+            leaf.page->unlock(false);
+            buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+            stats.num_keys_ = static_cast<int64_t>(samples.size() / lead_len);
+            stats.num_leaves_ = num_sampled;
+            stats.distinct_keys_ = stats.num_keys_ == 0 ? 0 : changes + 1;
+        } else {
+            // 同一个叶子可能被多次抽到，最多尝试2 * IX_ANALYZE_SAMPLE_PAGES次
+            std::vector<page_id_t> visited;
+            for (int attempt = 0; attempt < 2 * IX_ANALYZE_SAMPLE_PAGES && num_sampled < IX_ANALYZE_SAMPLE_PAGES;
+                 attempt++) {
+                if (attempt > 0) {
+                    leaf = sample_leaf(rng, &stats.height_);
+                }
+                if (std::find(visited.begin(), visited.end(), leaf.get_page_no()) == visited.end()) {
+                    visited.push_back(leaf.get_page_no());
+                    collect(leaf, false);
+                }
+                leaf.page->unlock(false);
+                buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+            }
+            double change_ratio = pairs == 0 ? 1 : static_cast<double>(changes) / pairs;
+            stats.distinct_keys_ = 1 + std::llround((stats.num_keys_ - 1) * change_ratio);
+        }
+        stats.avg_fill_ = num_sampled == 0 ? 0 : fill_sum / num_sampled;
+    }
+
+    // 等深直方图：排序后的样本按分位数取每个桶的上界，第0个边界为样本的最小值
+    int num_samples = static_cast<int>(samples.size() / lead_len);
+    std::vector<const char *> sorted(num_samples);
+    for (int i = 0; i < num_samples; i++) {
+        sorted[i] = samples.data() + i * lead_len;
+    }
+    std::sort(sorted.begin(), sorted.end(), [&](const char *a, const char *b) {
+        return ix_compare(a, b, lead_type, lead_len) < 0;
+    });
+    if (!is_hash()) {
+        // 样本中不同取值的数量是一个下界，采样的叶子较少时相邻键值对的估计可能低于它
+        int64_t sample_distinct = 0;
+        for (int i = 0; i < num_samples; i++) {
+            sample_distinct += i == 0 || ix_compare(sorted[i - 1], sorted[i], lead_type, lead_len) != 0;
+        }
+        stats.distinct_keys_ = std::max(stats.distinct_keys_, sample_distinct);
+    }
+    int num_buckets = std::min(file_hdr_->max_hist_buckets(), num_samples);
+    std::vector<char> bounds;
+    if (num_buckets > 0) {
+        bounds.insert(bounds.end(), sorted[0], sorted[0] + lead_len);
+        for (int b = 1; b <= num_buckets; b++) {
+            const char *bound = sorted[(static_cast<int64_t>(b) * num_samples + num_buckets - 1) / num_buckets - 1];
+            bounds.insert(bounds.end(), bound, bound + lead_len);
+        }
+    }
+
+    {
+        std::scoped_lock lock(file_hdr_latch_);
+        file_hdr_->num_keys_ = stats.num_keys_;
+        file_hdr_->num_leaves_ = stats.num_leaves_;
+        file_hdr_->height_ = stats.height_;
+        file_hdr_->analyzed_ = true;
+        file_hdr_->avg_fill_ = stats.avg_fill_;
+        file_hdr_->distinct_keys_ = stats.distinct_keys_;
+        file_hdr_->num_hist_buckets_ = num_buckets;
+        file_hdr_->hist_bounds_ = std::move(bounds);
+        file_hdr_->update_tot_len();
+    }
+    update_file_hdr();
+}
+
+/**
+ * @brief 哈希索引的ANALYZE INDEX：桶不多于2 * IX_ANALYZE_SAMPLE_PAGES个时读出全部的桶，否则随机采样
+ * IX_ANALYZE_SAMPLE_PAGES个桶，按比例估计页面数量和不同key的数量。相等的key一定在同一个桶中，
+ * 因此每个桶中不同key的数量是精确的
+ *
+ * @param[out] stats 填入num_leaves_、height_、avg_fill_、distinct_keys_，读出全部桶时还有num_keys_
+ * @param[out] samples 采样得到的第一个字段，依次存放
+ */
+void IxIndexHandle::analyze_hash(std::mt19937 &rng, IxFileHdr *stats, std::vector<char> *samples) {
+    std::vector<page_id_t> buckets = hash_table_->get_bucket_pages();
+    int num_buckets = static_cast<int>(buckets.size());
+    bool full_scan = num_buckets <= 2 * IX_ANALYZE_SAMPLE_PAGES;
+    if (!full_scan) {
+        std::shuffle(buckets.begin(), buckets.end(), rng);
+        buckets.resize(IX_ANALYZE_SAMPLE_PAGES);
+    }
+
+    int key_len = file_hdr_->key_len();
+    int lead_len = file_hdr_->col_lens_[0];
+    int num_pages = 0;
+    int64_t num_entries = 0;
+    int64_t distinct = 0;
+    for (page_id_t bucket_no : buckets) {
+        std::vector<char> keys;
+        num_pages += hash_table_->read_bucket(bucket_no, &keys);
+        std::vector<std::string> bucket_keys;
+        for (size_t offset = 0; offset < keys.size(); offset += key_len) {
+            bucket_keys.emplace_back(keys.data() + offset, key_len);
+            samples->insert(samples->end(), keys.data() + offset, keys.data() + offset + lead_len);
+        }
+        std::sort(bucket_keys.begin(), bucket_keys.end());
+        distinct += std::unique(bucket_keys.begin(), bucket_keys.end()) - bucket_keys.begin();
+        num_entries += static_cast<int64_t>(bucket_keys.size());
+    }
+
+    double scale = static_cast<double>(num_buckets) / buckets.size();
+    stats->num_leaves_ = static_cast<int>(std::lround(num_pages * scale));
+    stats->height_ = 1;
+    stats->avg_fill_ = static_cast<double>(num_entries) / (num_pages * hash_table_->get_bucket_capacity());
+    stats->distinct_keys_ = std::llround(distinct * scale);
+    if (full_scan) {
+        stats->num_keys_ = num_entries;
+    }
+}
+
+/**
+ * @brief 估计第一个字段落在[lower, upper]范围内的键值对所占的比例，供查询计划选择索引
+ * 收集过统计信息时使用等深直方图，桶内按数值线性插值（字符串字段取桶的一半）；等值条件取1/distinct与直方图中
+ * 上界等于该值的桶所占比例的较大者。没有统计信息时，单字段唯一索引的等值条件为1/键值对数量，
+ * 其他等值条件取1/10，范围条件取1/3
+ *
+ * @param lower 第一个字段的下界，nullptr表示没有下界
+ * @param upper 第一个字段的上界，nullptr表示没有上界
+ * @return 估计的选择率，在[0, 1]之间
+ */
+double IxIndexHandle::estimate_selectivity(const char *lower, bool lower_inclusive, const char *upper,
+                                           bool upper_inclusive) {
+    IxFileHdr stats = get_stats();
+    ColType type = stats.col_types_[0];
+    int len = stats.col_lens_[0];
+    bool is_eq = lower != nullptr && upper != nullptr && lower_inclusive && upper_inclusive &&
+                 ix_compare(lower, upper, type, len) == 0;
+    int key_col_num = stats.unique_ ? stats.col_num_ : stats.col_num_ - 2;
+    if (is_eq && stats.unique_ && key_col_num == 1) {
+        return 1.0 / std::max<int64_t>(stats.num_keys_, 1);
+    }
+    if (lower == nullptr && upper == nullptr) {
+        return 1;
+    }
+    if (!stats.analyzed_ || stats.num_hist_buckets_ == 0) {
+        return is_eq ? 0.1 : 1.0 / 3;
+    }
+
+    int num_buckets = stats.num_hist_buckets_;
+    auto bound = [&](int i) { return stats.hist_bounds_.data() + i * len; };
+    auto to_double = [&](const char *v) {
+        return type == TYPE_INT ? static_cast<double>(*reinterpret_cast<const int *>(v))
+                                : static_cast<double>(*reinterpret_cast<const float *>(v));
+    };
+    // 小于v的键值对所占的比例
+    auto fraction_below = [&](const char *v) {
+        if (ix_compare(v, bound(0), type, len) <= 0) {
+            return 0.0;
+        }
+        if (ix_compare(v, bound(num_buckets), type, len) > 0) {
+            return 1.0;
+        }
+        int i = 1;
+        while (ix_compare(bound(i), v, type, len) < 0) {
+            i++;
+        }
+        double t = 0.5;
+        if (type != TYPE_STRING) {
+            double lo = to_double(bound(i - 1));
+            double hi = to_double(bound(i));
+            t = hi > lo ? (to_double(v) - lo) / (hi - lo) : 1;
+        }
+        return (i - 1 + t) / num_buckets;
+    };
+    // 等于v的键值对所占的比例
+    auto fraction_equal = [&](const char *v) {
+        if (ix_compare(v, bound(0), type, len) < 0 || ix_compare(v, bound(num_buckets), type, len) > 0) {
+            return 0.0;
+        }
+        int same = 0;
+        for (int i = 1; i <= num_buckets; i++) {
+            same += ix_compare(bound(i), v, type, len) == 0;
+        }
+        return std::max(1.0 / std::max<int64_t>(stats.distinct_keys_, 1), static_cast<double>(same) / num_buckets);
+    };
+
+    if (is_eq) {
+        return fraction_equal(lower);
+    }
+    double high = upper == nullptr ? 1 : fraction_below(upper) + (upper_inclusive ? fraction_equal(upper) : 0);
+    double low = lower == nullptr ? 0 : fraction_below(lower) + (lower_inclusive ? 0 : fraction_equal(lower));
+    return std::clamp(high - low, 0.0, 1.0);
+}
+
+/**
+ * @brief 在线重建索引期间记录修改过的key，没有在重建时直接返回
+ * 修改在结点上完成之后才记录：检查capturing_时还没有开始记录的修改，一定对之后才开始的装载可见
+ *
+ * @param key 上层传入的key，或者索引中实际存储的key（只取前key_len()个字节）
+ */
+void IxIndexHandle::capture(const char *key) {
+    if (!capturing_) {
+        return;
+    }
+    std::scoped_lock lock(capture_latch_);
+    if (capturing_) {
+        changed_keys_.emplace_back(key, key + file_hdr_->key_len());
+    }
+}
+
+/**
+ * @brief 开始记录修改过的key，必须在读取表中的记录进行装载之前调用
+ */
+void IxIndexHandle::start_capture() {
+    std::scoped_lock lock(capture_latch_);
+    changed_keys_.clear();
+    capturing_ = true;
+}
+
+/**
+ * @brief 取出目前为止记录的key，之后的修改继续记录
+ */
+std::vector<std::vector<char>> IxIndexHandle::take_changed_keys() {
+    std::scoped_lock lock(capture_latch_);
+    return std::exchange(changed_keys_, {});
+}
+
+/**
+ * @brief 停止记录修改并丢弃还没有取出的key
+ */
+void IxIndexHandle::stop_capture() {
+    std::scoped_lock lock(capture_latch_);
+    capturing_ = false;
+    changed_keys_.clear();
+}
+
+/**
+ * @brief 在线重建索引：把keys中每个key对应的键值对同步为与原索引source中当前的相同
+ * 装载时读到的表可能包含了部分修改，也可能包含插入时因为key重复而被拒绝的记录，因此不重放修改本身，
+ * 而是按source的当前内容删除多余的、插入缺少的键值对；之后再修改的key会再次记录，最后一次同步在表的排他锁下进行
+ *
+ * @param source 原索引
+ * @param keys 在source上修改过的key，见take_changed_keys()
+ * @param transaction 事务指针
+ */
+void IxIndexHandle::sync_keys(IxIndexHandle *source, const std::vector<std::vector<char>> &keys,
+                              Transaction *transaction) {
+    // 同一个key可能被修改多次，只需要同步一次
+    std::vector<std::vector<char>> unique_keys = keys;
+    std::sort(unique_keys.begin(), unique_keys.end());
+    unique_keys.erase(std::unique(unique_keys.begin(), unique_keys.end()), unique_keys.end());
+    for (auto &key : unique_keys) {
+        std::vector<Rid> expected;
+        std::vector<Rid> current;
+        source->get_value(key.data(), &expected, transaction);
+        get_value(key.data(), &current, transaction);
+        for (auto &rid : current) {
+            if (std::find(expected.begin(), expected.end(), rid) == expected.end()) {
+                delete_entry(key.data(), rid, transaction);
+            }
+        }
+        for (auto &rid : expected) {
+            if (std::find(current.begin(), current.end(), rid) == current.end()) {
+                insert_entry(key.data(), rid, transaction);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 把键值对批量装载到刚创建的空索引中，用于重建索引
+ * B+树按key排序后自底向上逐层构建，每层从左到右依次填满结点（留出IX_BULK_LOAD_FILL_FACTOR之外的空位），
+ * 上一层由每个结点的第一个key和页号组成，直到只剩一个结点作为根结点；哈希索引逐个插入。
+ * 新索引在装载完成之前对其他线程不可见，因此不需要加锁。唯一索引中key重复的键值对只保留一个：
+ * 在线重建时读到重复的key，说明读取期间这个key被修改过，之后的sync_keys()会纠正
+ *
+ * @param entries 上层传入的(key, rid)，顺序任意
+ */
+void IxIndexHandle::bulk_load(const std::vector<std::pair<std::vector<char>, Rid>> &entries) {
+    assert(file_hdr_->num_keys_ == 0);
+    auto sorted = sort_entries(entries);
+    if (file_hdr_->unique_) {
+        auto equal_key = [this](const auto &a, const auto &b) {
+            return ix_compare(a.first.data(), b.first.data(), file_hdr_->col_types_, file_hdr_->col_lens_) == 0;
+        };
+        sorted.erase(std::unique(sorted.begin(), sorted.end(), equal_key), sorted.end());
+    }
+    int64_t num_keys = static_cast<int64_t>(sorted.size());
+    if (is_hash()) {
+        for (auto &[key, rid] : sorted) {
+            hash_table_->insert_entry(key.data(), rid);
+        }
+        update_stats(num_keys);
+        return;
+    }
+    if (sorted.empty()) {
+        return;
+    }
+
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    keys.reserve(sorted.size() * file_hdr_->col_tot_len_);
+    rids.reserve(sorted.size());
+    for (auto &[key, rid] : sorted) {
+        keys.insert(keys.end(), key.begin(), key.end());
+        rids.push_back(rid);
+    }
+    sorted = {};
+
+    bulk_load_level(&keys, &rids, true);
+    page_id_t first_leaf = rids.front().page_no;
+    page_id_t last_leaf = rids.back().page_no;
+    int num_leaves = static_cast<int>(rids.size());
+    int height = 1;
+    while (rids.size() > 1) {
+        bulk_load_level(&keys, &rids, false);
+        height++;
+    }
+
+    {
+        std::scoped_lock lock(file_hdr_latch_);
+        file_hdr_->root_page_ = rids.front().page_no;
+        file_hdr_->first_leaf_ = first_leaf;
+        file_hdr_->last_leaf_ = last_leaf;
+        file_hdr_->num_keys_ = num_keys;
+        file_hdr_->num_leaves_ = num_leaves;
+        file_hdr_->height_ = height;
+    }
+    update_file_hdr();
+}
+
+/**
+ * @brief 批量装载的一层：把排好序的键值对从左到右依次放入新建的结点，相邻结点之间的链接在创建右边的结点时补上
+ * 完成后keys和rids替换为上一层的键值对，即每个结点的第一个key和结点的页号
+ *
+ * @param keys 这一层的key，依次存放
+ * @param rids 叶子层为记录的rid，内部结点层为孩子结点的页号
+ * @param is_leaf 是否为叶子层
+ */
+void IxIndexHandle::bulk_load_level(std::vector<char> *keys, std::vector<Rid> *rids, bool is_leaf) {
+    int key_len = file_hdr_->col_tot_len_;
+    int total = static_cast<int>(rids->size());
+    std::vector<char> parent_keys;
+    std::vector<Rid> parent_rids;
+    IxNodeHandle prev;
+    for (int begin = 0; begin < total;) {
+        // 叶子层的第一个结点沿用创建索引时的空根结点
+        IxNodeHandle node = is_leaf && begin == 0 ? fetch_node(file_hdr_->root_page_) : create_node();
+        *node.page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = IX_NO_PAGE,
+            .num_key = 0,
+            .is_leaf = is_leaf,
+            .prev_leaf = is_leaf ? (begin == 0 ? IX_LEAF_HEADER_PAGE : prev.get_page_no()) : IX_NO_PAGE,
+            .next_leaf = is_leaf ? IX_LEAF_HEADER_PAGE : IX_NO_PAGE,
+            .right_link = IX_NO_PAGE,
+            .has_high_key = false,
+            .has_low_key = false,
+            .prefix_len = 0,
+            .key_bytes = 0,
+            .heap_size = 0,
+        };
+
+        int n = bulk_load_node_size(node, *keys, begin, total);
+        const char *first_key = keys->data() + static_cast<size_t>(begin) * key_len;
+        const char *high_key = begin + n < total ? first_key + static_cast<size_t>(n) * key_len : nullptr;
+        if (is_compressed()) {
+            if (begin > 0) {
+                node.set_low_key(first_key);
+            }
+            if (high_key != nullptr) {
+                node.set_high_key(high_key);
+            }
+            node.rebuild(first_key, rids->data() + begin, n);
+        } else {
+            node.insert_pairs(0, first_key, rids->data() + begin, n);
+            if (is_blink() && high_key != nullptr) {
+                node.set_high_key(high_key);
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            maintain_child(node, i);
+        }
+
+        if (begin > 0) {
+            if (is_leaf) {
+                prev.set_next_leaf(node.get_page_no());
+            }
+            if (is_blink()) {
+                prev.set_right_link(node.get_page_no());
+            }
+            buffer_pool_manager_->unpin_page(prev.get_page_id(), true);
+        }
+        parent_keys.insert(parent_keys.end(), first_key, first_key + key_len);
+        parent_rids.push_back(Rid{node.get_page_no(), -1});
+        prev = node;
+        begin += n;
+    }
+    buffer_pool_manager_->unpin_page(prev.get_page_id(), true);
+
+    if (is_leaf) {
+        IxNodeHandle leaf_header = fetch_node(IX_LEAF_HEADER_PAGE);
+        leaf_header.set_next_leaf(parent_rids.front().page_no);
+        leaf_header.set_prev_leaf(parent_rids.back().page_no);
+        buffer_pool_manager_->unpin_page(leaf_header.get_page_id(), true);
+    }
+    *keys = std::move(parent_keys);
+    *rids = std::move(parent_rids);
+}
+
+/**
+ * @brief 批量装载时从第begin个key开始放入node的键值对数量
+ * 定长格式按IX_BULK_LOAD_FILL_FACTOR求出每个结点的容量，再把剩下的键值对平均分给所需数量的结点，避免最后一个结点过小。
+ * 压缩格式逐个加入key，直到编码后的字节数超过可用空间的IX_BULK_LOAD_FILL_FACTOR；结点的公共前缀由下一个结点的
+ * 第一个key（即这个结点的high key）决定，加入的key越多只会越短，变短时重新计算已加入的key编码后的长度
+ */
+int IxIndexHandle::bulk_load_node_size(IxNodeHandle &node, const std::vector<char> &keys, int begin,
+                                       int total) const {
+    int remaining = total - begin;
+    if (!is_compressed()) {
+        int capacity = std::max(2, static_cast<int>(file_hdr_->btree_order_ * IX_BULK_LOAD_FILL_FACTOR));
+        int num_nodes = (remaining + capacity - 1) / capacity;
+        return (remaining + num_nodes - 1) / num_nodes;
+    }
+
+    int key_len = file_hdr_->col_tot_len_;
+    auto key_at = [&](int i) { return keys.data() + static_cast<size_t>(begin + i) * key_len; };
+    // 放入n个键值对时结点的high key
+    auto high_key = [&](int n) { return n < remaining ? key_at(n) : nullptr; };
+    const char *low_key = begin > 0 ? key_at(0) : nullptr;
+    int budget = static_cast<int>((node.get_capacity() - file_hdr_->max_entry_len()) * IX_BULK_LOAD_FILL_FACTOR);
+
+    int n = 1;
+    int prefix_len = node.prefix_len_between(low_key, high_key(1));
+    int used = static_cast<int>(sizeof(IxSlot)) + node.encode_key(key_at(0), prefix_len, nullptr);
+    while (n < remaining) {
+        int next_prefix_len = node.prefix_len_between(low_key, high_key(n + 1));
+        int next_used = used;
+        if (next_prefix_len != prefix_len) {
+            next_used = 0;
+            for (int i = 0; i < n; i++) {
+                next_used += static_cast<int>(sizeof(IxSlot)) + node.encode_key(key_at(i), next_prefix_len, nullptr);
+            }
+        }
+        next_used += static_cast<int>(sizeof(IxSlot)) + node.encode_key(key_at(n), next_prefix_len, nullptr);
+        if (n >= 2 && next_used > budget) {
+            break;
+        }
+        n++;
+        used = next_used;
+        prefix_len = next_prefix_len;
+    }
+    return n;
+}
+
+/**
+ * @brief 启用或关闭索引的Bloom filter，设置写回文件头；启用后在第一次查找时构建filter
+ */
+void IxIndexHandle::set_bloom(bool enabled) {
+    std::unique_lock lock(bloom_latch_);
+    {
+        std::scoped_lock hdr_lock(file_hdr_latch_);
+        file_hdr_->bloom_ = enabled;
+    }
+    update_file_hdr();
+    bloom_.reset();
+}
+
+/**
+ * @brief 在查找索引之前查询Bloom filter，判断key是否可能存在
+ * filter还没有构建或者已经过时（见IxBloomFilter::is_stale）时先重新构建
+ *
+ * @param key 上层传入的key（不含rid）
+ * @param[out] probed 不为nullptr时传出是否查询了filter，没有启用filter时为false
+ * @return false表示key一定不在索引中；没有启用filter时总是返回true
+ */
+bool IxIndexHandle::may_contain(const char *key, bool *probed) {
+    std::shared_lock lock(bloom_latch_);
+    while (file_hdr_->bloom_ && (bloom_ == nullptr || bloom_->is_stale())) {
+        lock.unlock();
+        {
+            std::unique_lock build_lock(bloom_latch_);
+            if (file_hdr_->bloom_ && (bloom_ == nullptr || bloom_->is_stale())) {
+                build_bloom();
+            }
+        }
+        lock.lock();
+    }
+    if (probed != nullptr) {
+        *probed = file_hdr_->bloom_;
+    }
+    if (!file_hdr_->bloom_) {
+        return true;
+    }
+    bloom_lookups_++;
+    if (bloom_->may_contain(key)) {
+        return true;
+    }
+    bloom_negatives_++;
+    return false;
+}
+
+IxBloomStats IxIndexHandle::get_bloom_stats() {
+    std::shared_lock lock(bloom_latch_);
+    return {.enabled = file_hdr_->bloom_,
+            .num_bits = bloom_ == nullptr ? 0 : bloom_->num_bits(),
+            .num_keys = bloom_ == nullptr ? 0 : bloom_->num_added(),
+            .lookups = bloom_lookups_,
+            .negatives = bloom_negatives_,
+            .false_positives = bloom_false_positives_,
+            .rebuilds = bloom_rebuilds_};
+}
+
+/**
+ * @brief 插入成功之后把key加入filter。必须在键值对写入索引之后调用：构建filter期间这里会等待，
+ * 构建时没有读到的键值对在构建完成后加入新的filter，不会漏掉
+ */
+void IxIndexHandle::bloom_add(const char *key) {
+    std::shared_lock lock(bloom_latch_);
+    if (bloom_ != nullptr) {
+        bloom_->add(key);
+    }
+}
+
+// 删除的key无法从filter中去掉，只计数，删除过多时下一次查找重新构建
+void IxIndexHandle::bloom_remove(int64_t n) {
+    if (n == 0) {
+        return;
+    }
+    std::shared_lock lock(bloom_latch_);
+    if (bloom_ != nullptr) {
+        bloom_->note_removed(n);
+    }
+}
+
+/**
+ * @brief 读出索引中所有的key，按实际数量构建新的filter，调用者持有bloom_latch_的独占锁
+ * B+树持有root_latch_沿叶子链表读取：结构修改（分裂、合并、重分配）都要持有root_latch_，键值对不会在读取期间
+ * 移动到已经读过的叶子中；叶子内的插入和删除照常进行，插入的key由bloom_add()在构建完成后加入
+ */
+void IxIndexHandle::build_bloom() {
+    int key_len = file_hdr_->key_len();
+    std::vector<char> keys;
+    if (is_hash()) {
+        hash_table_->read_all_keys(&keys);
+    } else {
+        std::scoped_lock lock(root_latch_);
+        std::vector<char> key(file_hdr_->col_tot_len_);
+        IxNodeHandle leaf = fetch_node(file_hdr_->first_leaf_);
+        leaf.page->lock(false);
+        while (true) {
+            for (int i = 0; i < leaf.get_size(); i++) {
+                leaf.copy_key(i, key.data());
+                keys.insert(keys.end(), key.begin(), key.begin() + key_len);
+            }
+            if (leaf.get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+                break;
+            }
+            IxNodeHandle next = fetch_node(leaf.get_next_leaf());
+            next.page->lock(false);
+            leaf.page->unlock(false);
+            buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+            leaf = next;
+        }
+        leaf.page->unlock(false);
+        buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+    }
+
+    int key_col_num = file_hdr_->unique_ ? file_hdr_->col_num_ : file_hdr_->col_num_ - 2;
+    std::vector<ColType> key_types(file_hdr_->col_types_.begin(), file_hdr_->col_types_.begin() + key_col_num);
+    std::vector<int> key_lens(file_hdr_->col_lens_.begin(), file_hdr_->col_lens_.begin() + key_col_num);
+    // 按现有key数量的两倍分配，key数量翻倍之前不需要重新构建
+    int64_t num_keys = static_cast<int64_t>(keys.size() / key_len);
+    bloom_ = std::make_unique<IxBloomFilter>(std::move(key_types), std::move(key_lens), 2 * num_keys);
+    for (int64_t i = 0; i < num_keys; i++) {
+        bloom_->add(keys.data() + i * key_len);
+    }
+    bloom_rebuilds_++;
+}
@@ -10,7 +10,14 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <random>
+#include <shared_mutex>
+
+#include "ix_bloom.h"
 #include "ix_defs.h"
+#include "ix_hash.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
@@ -46,7 +53,14 @@ inline int ix_compare(const char* a, const char* b, const std::vector<ColType>&
     return 0;
 }
 
-/* 管理B+树中的每个节点 */
+/**
+ * 管理B+树中的每个节点
+ * 结点有两种格式：
+ * 定长格式：| IxPageHdr | keys（每个col_tot_len字节） | rids | B-link树的high key |
+ * 压缩格式：| IxPageHdr | high key | low key | slots ->     <- 编码后的key |
+ *   high key和low key界定了结点内所有key的范围，二者在第一个字符串字段上的公共前缀就是结点内所有key的公共前缀，
+ *   编码时去掉该前缀以及字符串字段末尾填充的0，因此字符串索引的每个结点可以放下多得多的键值对
+ */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
@@ -55,18 +69,28 @@ class IxNodeHandle {
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
     Page *page;                     // 存储节点的页面
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
-    char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids;                      // page->data的第三部分，指针指向首地址
+    char *keys;                     // 定长格式：page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
+    Rid *rids;                      // 定长格式：page->data的第三部分，指针指向首地址
+    IxSlot *slots;                  // 压缩格式：high key和low key之后的slot数组
 
    public:
     IxNodeHandle() = default;
 
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+        if (file_hdr->compressed_) {
+            keys = nullptr;
+            rids = nullptr;
+            slots = reinterpret_cast<IxSlot *>(page->get_data() + sizeof(IxPageHdr) + 2 * file_hdr->col_tot_len_);
+        } else {
+            keys = page->get_data() + sizeof(IxPageHdr);
+            rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+            slots = nullptr;
+        }
     }
 
+    bool is_compressed() const { return file_hdr->compressed_; }
+
     int get_size() const { return page_hdr->num_key; }
 
     void set_size(int size) { page_hdr->num_key = size; }
@@ -100,13 +124,81 @@ class IxNodeHandle {
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    /* 定长格式中第key_idx个key的地址，压缩格式的结点需要用copy_key()解码 */
+    char *get_key(int key_idx) const {
+        assert(!is_compressed());
+        return keys + key_idx * file_hdr->col_tot_len_;
+    }
+
+    void copy_key(int key_idx, char *dest) const;
+
+    int compare_key(int key_idx, const char *target) const;
+
+    Rid *get_rid(int rid_idx) const { return is_compressed() ? &slots[rid_idx].rid : &rids[rid_idx]; }
+
+    void set_key(int key_idx, const char *key) { memcpy(get_key(key_idx), key, file_hdr->col_tot_len_); }
+
+    void set_rid(int rid_idx, const Rid &rid) { *get_rid(rid_idx) = rid; }
+
+    /**
+     * B-link树：high key是当前结点（及其子树）所有key的严格上界，定长格式存放在rids数组之后；
+     * 压缩格式的结点（不论是否B-link树）都维护high key，紧跟在page_hdr之后
+     */
+    char *get_high_key() const {
+        return is_compressed() ? page->get_data() + sizeof(IxPageHdr)
+                               : reinterpret_cast<char *>(rids + file_hdr->btree_order_ + 1);
+    }
+
+    void set_high_key(const char *key) {
+        memcpy(get_high_key(), key, file_hdr->col_tot_len_);
+        page_hdr->has_high_key = true;
+    }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    bool has_high_key() const { return page_hdr->has_high_key; }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    page_id_t get_right_link() const { return page_hdr->right_link; }
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    /* 压缩格式：low key是当前结点所有key的下界（可以相等），紧跟在high key之后 */
+    char *get_low_key() const { return page->get_data() + sizeof(IxPageHdr) + file_hdr->col_tot_len_; }
+
+    void set_low_key(const char *key) {
+        memcpy(get_low_key(), key, file_hdr->col_tot_len_);
+        page_hdr->has_low_key = true;
+    }
+
+    bool has_low_key() const { return page_hdr->has_low_key; }
+
+    // 压缩格式：slots和编码后的key可以使用的总字节数
+    int get_capacity() const {
+        return static_cast<int>(PAGE_SIZE - sizeof(IxPageHdr)) - 2 * file_hdr->col_tot_len_;
+    }
+
+    // 压缩格式：slots和编码后的key已经使用的字节数（不含删除留下的空洞）
+    int get_used_bytes() const { return get_size() * static_cast<int>(sizeof(IxSlot)) + page_hdr->key_bytes; }
+
+    // 压缩格式：使用used字节时结点是否没有溢出，即至少还能再放下一个最长的键值对
+    bool fits(int used) const { return used <= get_capacity() - file_hdr->max_entry_len(); }
+
+    // 压缩格式：结点至少要使用的字节数，少于此值需要合并或重分配
+    int get_min_used() const { return (get_capacity() - file_hdr->max_entry_len()) / 2; }
+
+    int prefix_len_between(const char *low_key, const char *high_key) const;
+
+    int encode_key(const char *key, int prefix_len, char *dest) const;
+
+    void decode_pairs(std::vector<char> *keys_out, std::vector<Rid> *rids_out) const;
+
+    void rebuild(const char *keys_in, const Rid *rids_in, int n);
+
+    void set_right_link(page_id_t page_no) { page_hdr->right_link = page_no; }
+
+    /**
+     * @brief B-link树：key不小于high key，说明当前结点在读者到达之前被分裂过，
+     * key所在的位置已经被移到了右兄弟结点，需要沿right link向右移动
+     */
+    bool need_move_right(const char *key) const {
+        return has_high_key() && ix_compare(key, get_high_key(), file_hdr->col_types_, file_hdr->col_lens_) >= 0;
+    }
 
     int lower_bound(const char *target) const;
 
@@ -159,16 +251,31 @@ class IxNodeHandle {
     bool is_safe(Operation op) {
         switch (op) {
             case Operation::INSERT:
+                if (is_compressed()) {
+                    return fits(get_used_bytes() + file_hdr->max_entry_len());
+                }
                 return get_size() + 1 < get_max_size();
             case Operation::DELETE:
+                // B-link树删除时不合并结点，因此任何结点都是安全的
+                if (file_hdr->index_type_ == INDEX_BLINK) {
+                    return true;
+                }
+                if (is_compressed()) {
+                    return get_used_bytes() - file_hdr->max_entry_len() >= get_min_used();
+                }
                 return get_size() - 1 >= get_min_size();
             default:
                 return true;
         }
     }
 
-    bool is_overflow() { return get_size() >= get_max_size(); }
-    bool is_underflow() { return get_size() < get_min_size(); }
+    bool is_overflow() { return is_compressed() ? !fits(get_used_bytes()) : get_size() >= get_max_size(); }
+    bool is_underflow() { return is_compressed() ? get_used_bytes() < get_min_used() : get_size() < get_min_size(); }
+
+   private:
+    void decode_key(const char *src, char *dest) const;
+
+    void compact();
 };
 
 /* B+树 */
@@ -182,6 +289,17 @@ class IxIndexHandle {
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
     std::mutex root_latch_;
+    std::mutex file_hdr_latch_;                 // 保护文件头页面的写回
+    std::unique_ptr<IxHashTable> hash_table_;   // 哈希索引的实现，B+树索引为空
+    std::mutex capture_latch_;                  // 保护在线重建期间记录的修改
+    std::atomic<bool> capturing_{false};        // 是否正在记录修改，见start_capture()
+    std::vector<std::vector<char>> changed_keys_;  // 在线重建期间修改过的key（上层传入的key，不含rid）
+    std::shared_mutex bloom_latch_;             // 查询和维护filter时共享，构建filter或启用/关闭时独占
+    std::unique_ptr<IxBloomFilter> bloom_;      // file_hdr_->bloom_为true时使用，为空表示还没有构建
+    std::atomic<int64_t> bloom_lookups_{0};     // 以下计数见IxBloomStats
+    std::atomic<int64_t> bloom_negatives_{0};
+    std::atomic<int64_t> bloom_false_positives_{0};
+    std::atomic<int64_t> bloom_rebuilds_{0};
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -190,7 +308,7 @@ class IxIndexHandle {
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
     std::pair<IxNodeHandle, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
-                                                 bool find_first = false);
+                                                 bool find_first = false, std::vector<char> *upper_key = nullptr);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
@@ -200,8 +318,15 @@ class IxIndexHandle {
     void insert_into_parent(IxNodeHandle old_node, const char *key, IxNodeHandle new_node, Transaction *transaction);
 
     // for delete
+    bool delete_entry(const char *key, const Rid &value, Transaction *transaction);
+
     bool delete_entry(const char *key, Transaction *transaction);
 
+    // for batch
+    void insert_entries(const std::vector<std::pair<std::vector<char>, Rid>> &entries, Transaction *transaction);
+
+    int delete_entries(const std::vector<std::pair<std::vector<char>, Rid>> &entries, Transaction *transaction);
+
     void coalesce_or_redistribute(IxNodeHandle node, Transaction *transaction = nullptr,
                                 bool *root_is_latched = nullptr);
     bool adjust_root(IxNodeHandle old_root_node);
@@ -219,12 +344,83 @@ class IxIndexHandle {
 
     Iid leaf_begin() const;
 
+    bool is_unique() const { return file_hdr_->unique_; }
+
+    // 哈希索引只支持get_value、insert_entry和delete_entry，不能按范围扫描
+    bool is_hash() const { return file_hdr_->index_type_ == INDEX_HASH; }
+
+    // for statistics
+    IxFileHdr get_stats();
+    void analyze();
+    double estimate_selectivity(const char *lower, bool lower_inclusive, const char *upper, bool upper_inclusive);
+
+    // for online rebuild
+    void bulk_load(const std::vector<std::pair<std::vector<char>, Rid>> &entries);
+    void start_capture();
+    std::vector<std::vector<char>> take_changed_keys();
+    void stop_capture();
+    void sync_keys(IxIndexHandle *source, const std::vector<std::vector<char>> &keys, Transaction *transaction);
+
+    // for bloom filter
+    bool has_bloom() const { return file_hdr_->bloom_; }
+    void set_bloom(bool enabled);
+    bool may_contain(const char *key, bool *probed = nullptr);
+    void note_false_positive() { bloom_false_positives_++; }
+    IxBloomStats get_bloom_stats();
+
    private:
     // 辅助函数
-    void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
+    void update_root_page_no(page_id_t root) {
+        file_hdr_->root_page_ = root;
+        update_file_hdr();
+    }
+
+    void update_file_hdr();
+    void update_stats(int64_t key_delta, int leaf_delta = 0, int height_delta = 0);
+    void capture(const char *key);
+    void bloom_add(const char *key);
+    void bloom_remove(int64_t n);
+    void build_bloom();
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    bool is_blink() const { return file_hdr_->index_type_ == INDEX_BLINK; }
+
+    // 压缩格式的结点中，内部结点的key只是子树的下界，不再随子树的最小key变化而维护
+    bool is_compressed() const { return file_hdr_->compressed_; }
+
+    // for compressed nodes
+    void split_compressed(IxNodeHandle &node, IxNodeHandle &new_node);
+
+    void collect_pairs(IxNodeHandle left, IxNodeHandle right, std::vector<char> *keys, std::vector<Rid> *rids) const;
+
+    int rebuilt_used_bytes(IxNodeHandle node, const std::vector<char> &keys, int n, const char *low_key,
+                           const char *high_key) const;
+
+    bool can_coalesce(IxNodeHandle neighbor_node, IxNodeHandle node, int index) const;
+
+    bool redistribute_compressed(IxNodeHandle neighbor_node, IxNodeHandle node, IxNodeHandle parent, int index);
+
+    // for B-link tree readers
+    IxNodeHandle blink_find_leaf(const char *key);
+
+    IxNodeHandle blink_move_right(IxNodeHandle node, const char *key);
+
+    // for analyze
+    IxNodeHandle sample_leaf(std::mt19937 &rng, int *height);
+    void analyze_hash(std::mt19937 &rng, IxFileHdr *stats, std::vector<char> *samples);
+    // for bulk load
+    int bulk_load_node_size(IxNodeHandle &node, const std::vector<char> &keys, int begin, int total) const;
+    void bulk_load_level(std::vector<char> *keys, std::vector<Rid> *rids, bool is_leaf);
+    // for lower_bound/upper_bound
+    Iid leaf_position(IxNodeHandle leaf, int idx) const;
+
+    // 由上层传入的key和rid构造B+树中实际存储的key
+    std::vector<char> make_key(const char *key, const Rid &rid) const;
+
+    std::vector<std::pair<std::vector<char>, Rid>> sort_entries(
+        const std::vector<std::pair<std::vector<char>, Rid>> &entries) const;
+
     // for get/create node
     IxNodeHandle fetch_node(int page_no) const;
 
@@ -235,7 +431,7 @@ class IxIndexHandle {
 
     void erase_leaf(IxNodeHandle leaf);
 
-    void release_node_handle(IxNodeHandle &node);
+    void release_after_delete(IxNodeHandle leaf, bool is_dirty, Transaction *transaction);
 
     void maintain_child(IxNodeHandle node, int child_idx);
 
@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -54,7 +55,8 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols,
+                      IndexType index_type = INDEX_BTREE, bool unique = false) {
         std::string ix_name = get_index_name(filename, index_cols);
         // Create index file
         disk_manager_->create_file(ix_name);
@@ -73,25 +75,55 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
+        // 非唯一索引把rid的page_no和slot_no作为两个int字段追加在key之后，使相同的key按rid排序
+        if (!unique) {
+            col_tot_len += sizeof(Rid);
+            col_num += 2;
+        }
         // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        // B-link树的每个结点在rids之后还要额外存放一个high key
+        int high_key_len = index_type == INDEX_BLINK ? col_tot_len : 0;
+        int btree_order =
+            static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr) - high_key_len) / (col_tot_len + sizeof(Rid)) - 1);
         assert(btree_order > 2);
 
         // Create file header and write to file
-        IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
+        int num_pages = index_type == INDEX_HASH ? IX_HASH_INIT_NUM_PAGES : IX_INIT_NUM_PAGES;
+        IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, num_pages, IX_INIT_ROOT_PAGE,
                                 col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
                                 IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
-        for(int i = 0; i < col_num; ++i) {
-            fhdr->col_types_.push_back(index_cols[i].type);
-            fhdr->col_lens_.push_back(index_cols[i].len);
+        fhdr->index_type_ = index_type;
+        fhdr->unique_ = unique;
+        for(auto& col: index_cols) {
+            fhdr->col_types_.push_back(col.type);
+            fhdr->col_lens_.push_back(col.len);
+        }
+        if (!unique) {
+            fhdr->col_types_.push_back(TYPE_INT);  // rid.page_no
+            fhdr->col_lens_.push_back(sizeof(int));
+            fhdr->col_types_.push_back(TYPE_INT);  // rid.slot_no
+            fhdr->col_lens_.push_back(sizeof(int));
         }
+        // 字符串字段定长存储时大部分是末尾填充的0，并且相邻的key往往有很长的公共前缀，这类索引使用压缩格式的结点；
+        // 压缩格式的结点按字节而不是按键值对数量判断是否需要分裂，要求一页至少能放下4个最长的键值对
+        bool has_string = std::find(fhdr->col_types_.begin(), fhdr->col_types_.end(), TYPE_STRING) != fhdr->col_types_.end();
+        int compressed_area = static_cast<int>(PAGE_SIZE - sizeof(IxPageHdr)) - 2 * col_tot_len;
+        fhdr->compressed_ = index_type != INDEX_HASH && has_string && compressed_area >= 4 * fhdr->max_entry_len();
         fhdr->update_tot_len();
         
-        char* data = new char[fhdr->tot_len_];
-        fhdr->serialize(data);
-
-        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data, fhdr->tot_len_);
+        // 文件头页面之后会经过缓冲池读写，写入完整的一页
+        std::vector<char> data(PAGE_SIZE);
+        fhdr->serialize(data.data());
+        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data.data(), PAGE_SIZE);
+        delete fhdr;
+
+        // 哈希索引没有B+树的结点，写入目录和第一个桶
+        if (index_type == INDEX_HASH) {
+            IxHashTable::init_file(disk_manager_, fd);
+            disk_manager_->close_file(fd);
+            return;
+        }
 
         char page_buf[PAGE_SIZE];  // 在内存中初始化page_buf中的内容，然后将其写入磁盘
         memset(page_buf, 0, PAGE_SIZE);
@@ -107,6 +139,12 @@ class IxManager {
                 .is_leaf = true,
                 .prev_leaf = IX_INIT_ROOT_PAGE,
                 .next_leaf = IX_INIT_ROOT_PAGE,
+                .right_link = IX_NO_PAGE,
+                .has_high_key = false,
+                .has_low_key = false,
+                .prefix_len = 0,
+                .key_bytes = 0,
+                .heap_size = 0,
             };
             disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, PAGE_SIZE);
         }
@@ -122,13 +160,17 @@ class IxManager {
                 .is_leaf = true,
                 .prev_leaf = IX_LEAF_HEADER_PAGE,
                 .next_leaf = IX_LEAF_HEADER_PAGE,
+                .right_link = IX_NO_PAGE,
+                .has_high_key = false,
+                .has_low_key = false,
+                .prefix_len = 0,
+                .key_bytes = 0,
+                .heap_size = 0,
             };
             // Must write PAGE_SIZE here in case of future fetch_node()
             disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
         }
 
-        disk_manager_->set_fd2pageno(fd, IX_INIT_NUM_PAGES - 1);  // DEBUG
-
         // Close index file
         disk_manager_->close_file(fd);
     }
@@ -143,6 +185,15 @@ class IxManager {
         disk_manager_->destroy_file(ix_name);
     }
 
+    // 重建索引时新索引先装载到临时文件中，文件名在表名之后加上".rebuild"，表名中不会出现'.'，不会与其他索引重名
+    std::string get_rebuild_filename(const std::string &filename) { return filename + ".rebuild"; }
+
+    // 用重建得到的临时索引文件替换原来的索引文件，两个文件都必须已经关闭
+    void replace_with_rebuilt(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        disk_manager_->rename_file(get_index_name(get_rebuild_filename(filename), index_cols),
+                                   get_index_name(filename, index_cols));
+    }
+
     // 注意这里打开文件，创建并返回了index file handle的指针
     std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
         std::string ix_name = get_index_name(filename, index_cols);
@@ -156,12 +207,12 @@ class IxManager {
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
-    void close_index(const IxIndexHandle *ih) {
-        char* data = new char[ih->file_hdr_->tot_len_];
-        ih->file_hdr_->serialize(data);
-        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
-        // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
-        buffer_pool_manager_->flush_all_pages(ih->fd_);
+    void close_index(IxIndexHandle *ih) {
+        // 文件头在每次修改后都已经写回文件头页面（见IxIndexHandle::update_file_hdr），随其他页面一起刷盘即可；
+        // 键值对数量等统计信息的计数不会每次都写回，关闭前再写一次
+        ih->update_file_hdr();
+        // 缓冲区的所有页刷到磁盘并移出缓冲池，注意这句话必须写在close_file前面
+        buffer_pool_manager_->remove_all_pages(ih->fd_);
         disk_manager_->close_file(ih->fd_);
     }
 };
\ No newline at end of file
@@ -11,23 +11,73 @@ See the Mulan PSL v2 for more details. */
 #include "ix_scan.h"
 
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个rid，当前叶子用完时通过latch coupling移动到后继叶子
  */
 void IxScan::next() {
-    assert(!is_end());
-    IxNodeHandle node = ih_->fetch_node(iid_.page_no);
-    assert(node.is_leaf_page());
-    assert(iid_.slot_no < node.get_size());
+    assert(!is_end() && node_held_);
+    assert(iid_.slot_no < node_.get_size());
     // increment slot no
     iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node.get_size()) {
+    skip_exhausted_leaves();
+    if (is_end()) {
+        release_leaf();
+    }
+}
+
+/**
+ * @brief 若iid_已经越过当前叶子的最后一个slot，则移动到后继叶子的第一个slot
+ * B-link树删除后不合并结点，可能存在空的叶子，需要一并跳过
+ * @note 先对后继叶子加读锁，再释放当前叶子，保证扫描过程中不会看到正在修改的叶子链
+ */
+void IxScan::skip_exhausted_leaves() {
+    while (iid_ != end_ && node_.get_next_leaf() != IX_LEAF_HEADER_PAGE && iid_.slot_no >= node_.get_size()) {
         // go to next leaf
-        iid_.slot_no = 0;
-        iid_.page_no = node.get_next_leaf();
+        IxNodeHandle next = ih_->fetch_node(node_.get_next_leaf());
+        next.page->lock(false);
+        release_leaf();
+        hold_leaf(next);
+        iid_ = Iid(next.get_page_no(), 0);
     }
 }
 
+/**
+ * @brief 记录已经pin住并加了读锁的叶子，同时预取它的后继叶子
+ */
+void IxScan::hold_leaf(IxNodeHandle node) {
+    node_ = node;
+    node_held_ = true;
+    if (node_.get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        bpm_->prefetch_page(PageId{node_.get_page_id().fd, node_.get_next_leaf()});
+    }
+}
+
+/**
+ * @brief 释放当前叶子的读锁并unpin
+ */
+void IxScan::release_leaf() {
+    if (!node_held_) {
+        return;
+    }
+    node_.page->unlock(false);
+    bpm_->unpin_page(node_.get_page_id(), false);
+    node_held_ = false;
+}
+
 Rid IxScan::rid() const {
-    return ih_->get_rid(iid_);
-}
\ No newline at end of file
+    assert(node_held_ && iid_.slot_no < node_.get_size());
+    return *node_.get_rid(iid_.slot_no);
+}
+
+/**
+ * @brief 当前位置的索引key，在调用next()之前有效
+ * 定长格式直接指向被pin住的叶子中的数据，压缩格式解码到key_buf_中
+ */
+const char *IxScan::key() const {
+    assert(node_held_ && iid_.slot_no < node_.get_size());
+    if (!node_.is_compressed()) {
+        return node_.get_key(iid_.slot_no);
+    }
+    key_buf_.resize(ih_->file_hdr_->col_tot_len_);
+    node_.copy_key(iid_.slot_no, key_buf_.data());
+    return key_buf_.data();
+}
@@ -17,16 +17,35 @@ See the Mulan PSL v2 for more details. */
 
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 扫描期间始终pin住当前叶子并持有其读锁，在叶子内部直接移动slot，
+// 跨叶子时先对后继叶子加读锁再释放当前叶子（latch coupling），每个叶子只需要fetch一次
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
     Iid iid_;  // 初始为lower（用于遍历的指针）
     Iid end_;  // 初始为upper
     BufferPoolManager *bpm_;
+    IxNodeHandle node_;        // iid_所在的叶子结点，is_end()之前一直被pin住且持有读锁
+    bool node_held_ = false;   // node_当前是否被pin住并持有读锁
+    mutable std::vector<char> key_buf_;  // 压缩格式的叶子中key需要解码，key()返回的数据存放在这里
 
    public:
     IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
-        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {}
+        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {
+        if (!is_end()) {
+            IxNodeHandle node = ih_->fetch_node(iid_.page_no);
+            node.page->lock(false);
+            hold_leaf(node);
+            skip_exhausted_leaves();
+            if (is_end()) {
+                release_leaf();
+            }
+        }
+    }
+
+    ~IxScan() override { release_leaf(); }
+
+    IxScan(const IxScan &) = delete;
+    IxScan &operator=(const IxScan &) = delete;
 
     void next() override;
 
@@ -34,5 +53,14 @@ class IxScan : public RecScan {
 
     Rid rid() const override;
 
+    const char *key() const;
+
     const Iid &iid() const { return iid_; }
-};
\ No newline at end of file
+
+   private:
+    void skip_exhausted_leaves();
+
+    void hold_leaf(IxNodeHandle node);
+
+    void release_leaf();
+};
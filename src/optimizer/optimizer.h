@@ -38,6 +38,12 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::ShowTables>(query->parse)) {
             // show tables;
             return std::make_shared<OtherPlan>(T_ShowTable, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowIndexStats>(query->parse)) {
+            // show index stats [from table];
+            return std::make_shared<OtherPlan>(T_ShowIndexStats, x->tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowBloomStats>(query->parse)) {
+            // show bloom stats [from table];
+            return std::make_shared<OtherPlan>(T_ShowBloomStats, x->tab_name);
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
@@ -28,6 +28,11 @@ typedef enum PlanTag{
     T_DropTable,
     T_CreateIndex,
     T_DropIndex,
+    T_AnalyzeIndex,
+    T_RebuildIndex,
+    T_SetIndexBloom,
+    T_ShowIndexStats,
+    T_ShowBloomStats,
     T_Insert,
     T_Update,
     T_Delete,
@@ -37,9 +42,18 @@ typedef enum PlanTag{
     T_Transaction_abort,
     T_Transaction_rollback,
     T_SeqScan,
+    T_ParallelSeqScan,
     T_IndexScan,
+    T_IndexOnlyScan,
     T_NestLoop,
+    T_HashJoin,
+    T_MergeJoin,
+    T_IndexNestLoop,
+    T_HashAggregate,
+    T_StreamAggregate,
+    T_IndexMinMax,
     T_Sort,
+    T_Limit,
     T_Projection
 } PlanTag;
 
@@ -95,6 +109,8 @@ class JoinPlan : public Plan
         std::shared_ptr<Plan> right_;
         // 连接条件
         std::vector<Condition> conds_;
+        // index nested loop join在内表（右节点）上查找使用的索引
+        std::vector<std::string> index_col_names_;
         // future TODO: 后续可以支持的连接类型
         JoinType type;
         
@@ -115,29 +131,70 @@ class ProjectionPlan : public Plan
         
 };
 
+class AggregatePlan : public Plan
+{
+    public:
+        AggregatePlan(PlanTag tag, std::shared_ptr<Plan> subplan, std::vector<TabCol> group_cols,
+                      std::vector<AggExpr> aggs)
+        {
+            Plan::tag = tag;
+            subplan_ = std::move(subplan);
+            group_cols_ = std::move(group_cols);
+            aggs_ = std::move(aggs);
+        }
+        ~AggregatePlan(){}
+        std::shared_ptr<Plan> subplan_;
+        // 分组字段，输出时在前
+        std::vector<TabCol> group_cols_;
+        // 聚集函数，输出时在分组字段之后
+        std::vector<AggExpr> aggs_;
+        // T_IndexMinMax时每个聚集函数读取的索引，subplan_是这个表上的扫描
+        std::vector<std::vector<std::string>> index_col_names_;
+};
+
 class SortPlan : public Plan
 {
     public:
-        SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, TabCol sel_col, bool is_desc)
+        SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, std::vector<TabCol> sel_cols, std::vector<bool> is_descs)
         {
             Plan::tag = tag;
             subplan_ = std::move(subplan);
-            sel_col_ = sel_col;
-            is_desc_ = is_desc;
+            sel_cols_ = std::move(sel_cols);
+            is_descs_ = std::move(is_descs);
         }
         ~SortPlan(){}
         std::shared_ptr<Plan> subplan_;
-        TabCol sel_col_;
-        bool is_desc_;
+        // 排序字段，依次比较
+        std::vector<TabCol> sel_cols_;
+        std::vector<bool> is_descs_;
+        // 下推到排序中的LIMIT，limit_为-1时没有LIMIT
+        int limit_ = -1;
+        int offset_ = 0;
         
 };
 
+class LimitPlan : public Plan
+{
+    public:
+        LimitPlan(PlanTag tag, std::shared_ptr<Plan> subplan, int limit, int offset)
+        {
+            Plan::tag = tag;
+            subplan_ = std::move(subplan);
+            limit_ = limit;
+            offset_ = offset;
+        }
+        ~LimitPlan(){}
+        std::shared_ptr<Plan> subplan_;
+        int limit_;
+        int offset_;
+};
+
 // dml语句，包括insert; delete; update; select语句　
 class DMLPlan : public Plan
 {
     public:
         DMLPlan(PlanTag tag, std::shared_ptr<Plan> subplan,std::string tab_name,
-                std::vector<Value> values, std::vector<Condition> conds,
+                std::vector<std::vector<Value>> values, std::vector<Condition> conds,
                 std::vector<SetClause> set_clauses)
         {
             Plan::tag = tag;
@@ -150,7 +207,7 @@ class DMLPlan : public Plan
         ~DMLPlan(){}
         std::shared_ptr<Plan> subplan_;
         std::string tab_name_;
-        std::vector<Value> values_;
+        std::vector<std::vector<Value>> values_;  // insert的每一行
         std::vector<Condition> conds_;
         std::vector<SetClause> set_clauses_;
 };
@@ -159,17 +216,24 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                IndexType index_type = INDEX_BTREE, bool unique = false, bool enabled = false)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            index_type_ = index_type;
+            unique_ = unique;
+            enabled_ = enabled;
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        IndexType index_type_;      // create index时使用的索引实现方式
+        bool unique_;               // create unique index
+        bool enabled_;              // alter index set bloom时启用还是关闭
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -11,24 +11,45 @@ See the Mulan PSL v2 for more details. */
 #include "planner.h"
 
 #include <memory>
+#include <set>
 
 #include "execution/executor_delete.h"
 #include "execution/executor_index_scan.h"
 #include "execution/executor_insert.h"
 #include "execution/executor_nestedloop_join.h"
+#include "execution/executor_parallel_seq_scan.h"
 #include "execution/executor_projection.h"
 #include "execution/executor_seq_scan.h"
 #include "execution/executor_update.h"
 #include "index/ix.h"
 #include "record_printer.h"
 
-// 目前的索引匹配规则为：完全匹配索引字段，且全部为单点查询，不会自动调整where条件的顺序
+// 目前的索引匹配规则为：where条件匹配索引字段的前缀即可，扫描范围由IndexScanExecutor根据条件计算
+// 哈希索引只能用于每个索引字段上都有与常量的等值条件的查询，满足时优先于B+树索引
+// 有多个可用的B+树索引时，选择第一个字段上的条件估计选择率最低的索引，相同时取靠前的索引
 bool Planner::get_index_cols(std::string tab_name, const std::vector<Condition> &curr_conds,
                              std::vector<std::string> &index_col_names) {
     TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+    std::vector<std::string> tree_index_col_names;  // 选择率最低的可用B+树索引
+    double best_selectivity = 2;
     // 遍历所有索引
     for (const auto &index : tab.indexes) {
         index_col_names.clear();
+        if (index.type == INDEX_HASH) {
+            bool all_eq = std::all_of(index.cols.begin(), index.cols.end(), [&](const ColMeta &index_col) {
+                return std::any_of(curr_conds.begin(), curr_conds.end(), [&](const Condition &cond) {
+                    return cond.lhs_col.tab_name == tab_name && cond.lhs_col.col_name == index_col.name &&
+                           cond.op == OP_EQ && cond.is_rhs_val;
+                });
+            });
+            if (all_eq) {
+                for (const auto &index_col : index.cols) {
+                    index_col_names.push_back(index_col.name);
+                }
+                return true;
+            }
+            continue;
+        }
         // 尝试匹配索引的每一列
         for (const auto &index_col : index.cols) {
             bool col_matched = false;
@@ -47,11 +68,104 @@ bool Planner::get_index_cols(std::string tab_name, const std::vector<Condition>
         }
 
         if (!index_col_names.empty()) {
-            return true;  // 找到可用的索引
+            double selectivity = estimate_selectivity(tab_name, index, curr_conds);
+            if (selectivity >= best_selectivity) {
+                continue;
+            }
+            best_selectivity = selectivity;
+            // 条件只需要匹配索引的前缀，扫描时使用的是完整的索引
+            tree_index_col_names.clear();
+            for (const auto &index_col : index.cols) {
+                tree_index_col_names.push_back(index_col.name);
+            }
         }
     }
 
-    return false;  // 没有找到任何可用的索引
+    index_col_names = tree_index_col_names;
+    return !index_col_names.empty();  // 是否找到可用的索引
+}
+
+/**
+ * @brief 用索引的统计信息估计索引第一个字段上与常量比较的条件的选择率，多个条件取最紧的上下界
+ *
+ * @param tab_name 表名
+ * @param index 索引
+ * @param curr_conds 该表上的单表条件
+ * @return double 估计的选择率，第一个字段上没有可用的条件时为1
+ */
+double Planner::estimate_selectivity(const std::string &tab_name, const IndexMeta &index,
+                                     const std::vector<Condition> &curr_conds) {
+    const ColMeta &col = index.cols[0];
+    const char *lower = nullptr;
+    const char *upper = nullptr;
+    bool lower_inclusive = true;
+    bool upper_inclusive = true;
+    for (const auto &cond : curr_conds) {
+        if (cond.lhs_col.tab_name != tab_name || cond.lhs_col.col_name != col.name || !cond.is_rhs_val) {
+            continue;
+        }
+        const char *val = cond.rhs_val.raw->data;
+        if (cond.op == OP_EQ || cond.op == OP_GT || cond.op == OP_GE) {
+            int cmp = lower == nullptr ? 1 : ix_compare(val, lower, col.type, col.len);
+            if (cmp > 0 || (cmp == 0 && cond.op == OP_GT)) {
+                lower = val;
+                lower_inclusive = cond.op != OP_GT;
+            }
+        }
+        if (cond.op == OP_EQ || cond.op == OP_LT || cond.op == OP_LE) {
+            int cmp = upper == nullptr ? -1 : ix_compare(val, upper, col.type, col.len);
+            if (cmp < 0 || (cmp == 0 && cond.op == OP_LT)) {
+                upper = val;
+                upper_inclusive = cond.op != OP_LT;
+            }
+        }
+    }
+    // 生成计划时还没有对表加锁，读取期间持有ihs_latch_，挡住重建索引替换句柄
+    std::shared_lock lock(sm_manager_->ihs_latch_);
+    auto &ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name, index.cols));
+    return ih->estimate_selectivity(lower, lower_inclusive, upper, upper_inclusive);
+}
+
+/**
+ * @brief 判断索引是否覆盖了查询在该表上用到的所有列（投影列、where条件、连接条件以及排序列），
+ * 若覆盖则可以直接从索引的key中构造元组，不需要访问表的数据文件
+ *
+ * @param tab_name 表名
+ * @param index_col_names 索引包含的字段
+ * @param curr_conds 该表上的单表条件
+ * @param query 查询，其中conds为剩余的连接条件
+ */
+bool Planner::is_covering_index(const std::string &tab_name, const std::vector<std::string> &index_col_names,
+                                const std::vector<Condition> &curr_conds, std::shared_ptr<Query> query) {
+    auto is_covered = [&](const TabCol &col) {
+        return col.tab_name != tab_name ||
+               std::find(index_col_names.begin(), index_col_names.end(), col.col_name) != index_col_names.end();
+    };
+    auto conds_covered = [&](const std::vector<Condition> &conds) {
+        return std::all_of(conds.begin(), conds.end(), [&](const Condition &cond) {
+            return is_covered(cond.lhs_col) && (cond.is_rhs_val || is_covered(cond.rhs_col));
+        });
+    };
+    if (!std::all_of(query->cols.begin(), query->cols.end(), is_covered) || !conds_covered(curr_conds) ||
+        !conds_covered(query->conds)) {
+        return false;
+    }
+    // 聚集的字段和分组字段同样要从索引中取得
+    if (!std::all_of(query->group_cols.begin(), query->group_cols.end(), is_covered) ||
+        !std::all_of(query->aggs.begin(), query->aggs.end(), [&](const AggExpr &agg) { return is_covered(agg.col); })) {
+        return false;
+    }
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    if (x != nullptr && x->has_sort) {
+        for (const auto &order : x->orders) {
+            TabCol order_col = {.tab_name = tab_name, .col_name = order->cols->col_name};
+            if ((order->cols->tab_name.empty() || order->cols->tab_name == tab_name) &&
+                sm_manager_->db_.get_table(tab_name).is_col(order_col.col_name) && !is_covered(order_col)) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 /**
@@ -131,6 +245,197 @@ std::shared_ptr<Plan> pop_scan(int *scantbl, std::string table, std::vector<std:
     return nullptr;
 }
 
+/**
+ * @brief 为计划树中的每个连接选择算法，连接条件要等到make_one_rel结束、所有条件都下推到位之后才确定，因此单独遍历一次
+ * 两边都已经按某个两表字段的等值条件有序输出（在该字段上的B+树索引扫描）时使用merge join，
+ * 这个条件移到连接条件的最前面；其次外表远小于内表、内表在连接字段上有B+树索引时使用index nested loop join；
+ * 否则有两个字段的等值条件时使用hash join，再否则使用nested loop join（按块执行）。
+ * 顺序扫描不会为了merge join改成全范围的索引扫描：索引扫描逐个rid回表读取元组，比顺序扫描加hash join慢
+ */
+void Planner::choose_join_method(const std::shared_ptr<Plan> &plan) {
+    auto x = std::dynamic_pointer_cast<JoinPlan>(plan);
+    if (x == nullptr) {
+        return;
+    }
+    choose_join_method(x->left_);
+    choose_join_method(x->right_);
+    x->tag = T_NestLoop;
+    for (auto it = x->conds_.begin(); it != x->conds_.end(); it++) {
+        if (it->is_rhs_val || it->op != OP_EQ) {
+            continue;
+        }
+        x->tag = T_HashJoin;
+        // 条件的左边字段可能属于右儿子
+        if ((is_ordered_on(x->left_, it->lhs_col) && is_ordered_on(x->right_, it->rhs_col)) ||
+            (is_ordered_on(x->left_, it->rhs_col) && is_ordered_on(x->right_, it->lhs_col))) {
+            std::rotate(x->conds_.begin(), it, it + 1);
+            x->tag = T_MergeJoin;
+            return;
+        }
+    }
+    for (const auto &cond : x->conds_) {
+        if (!cond.is_rhs_val && cond.op == OP_EQ && use_index_join(x, cond)) {
+            x->tag = T_IndexNestLoop;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 判断能否按cond使用index nested loop join：一边是单表扫描，表上有第一个字段为cond中该表字段的B+树索引，
+ * 并且另一边（外表）估计的元组数乘以一次查找的代价小于内表的元组数。可以时把内表换到右边并记下使用的索引
+ */
+bool Planner::use_index_join(const std::shared_ptr<JoinPlan> &join, const Condition &cond) {
+    // 一次索引查找（自根向下再回表）大约相当于顺序扫描并hash这么多个元组，取自executor_index_join_test中的基准测试
+    static constexpr double INDEX_PROBE_COST = 32;
+    for (bool inner_left : {false, true}) {
+        auto inner = std::dynamic_pointer_cast<ScanPlan>(inner_left ? join->left_ : join->right_);
+        auto outer = inner_left ? join->right_ : join->left_;
+        if (inner == nullptr) {
+            continue;
+        }
+        const TabCol &inner_col = cond.lhs_col.tab_name == inner->tab_name_ ? cond.lhs_col : cond.rhs_col;
+        const TabCol &outer_col = cond.lhs_col.tab_name == inner->tab_name_ ? cond.rhs_col : cond.lhs_col;
+        if (inner_col.tab_name != inner->tab_name_ || outer_col.tab_name == inner->tab_name_) {
+            continue;
+        }
+        TabMeta &tab = sm_manager_->db_.get_table(inner->tab_name_);
+        const ColMeta &outer_meta = *sm_manager_->db_.get_table(outer_col.tab_name).get_col(outer_col.col_name);
+        auto index = std::find_if(tab.indexes.begin(), tab.indexes.end(), [&](const IndexMeta &index) {
+            return index.type != INDEX_HASH && index.cols[0].name == inner_col.col_name &&
+                   index.cols[0].type == outer_meta.type && index.cols[0].len == outer_meta.len;
+        });
+        if (index == tab.indexes.end() ||
+            estimate_rows(outer) * INDEX_PROBE_COST >= estimate_table_rows(inner->tab_name_)) {
+            continue;
+        }
+        if (inner_left) {
+            std::swap(join->left_, join->right_);
+        }
+        join->index_col_names_.clear();
+        for (const auto &index_col : index->cols) {
+            join->index_col_names_.push_back(index_col.name);
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 估计计划输出的元组数：扫描为表的元组数乘以条件的选择率，连接假设是外键连接，取两边中较大的
+ */
+double Planner::estimate_rows(const std::shared_ptr<Plan> &plan) {
+    if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        return std::max(estimate_rows(x->left_), estimate_rows(x->right_));
+    }
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    double rows = estimate_table_rows(scan->tab_name_);
+    if (scan->tag == T_IndexScan || scan->tag == T_IndexOnlyScan) {
+        TabMeta &tab = sm_manager_->db_.get_table(scan->tab_name_);
+        return rows * estimate_selectivity(scan->tab_name_, *tab.get_index_meta(scan->index_col_names_), scan->conds_);
+    }
+    return scan->conds_.empty() ? rows : rows / 3;
+}
+
+/**
+ * @brief 估计表中的元组数：有索引时就是索引中的key数，否则按数据文件中每页都装满估计
+ */
+double Planner::estimate_table_rows(const std::string &tab_name) {
+    TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+    if (!tab.indexes.empty()) {
+        std::shared_lock lock(sm_manager_->ihs_latch_);
+        auto &ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name, tab.indexes[0].cols));
+        return static_cast<double>(ih->get_stats().num_keys_);
+    }
+    RmFileHdr hdr = sm_manager_->fhs_.at(tab_name)->get_file_hdr();
+    return static_cast<double>(hdr.num_pages - 1) * hdr.num_records_per_page;
+}
+
+/**
+ * @brief 判断plan是否按col升序输出：plan是col所在表上的索引扫描，并且使用的是第一个字段为col的B+树索引
+ */
+bool Planner::is_ordered_on(const std::shared_ptr<Plan> &plan, const TabCol &col) {
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    if (scan == nullptr || scan->tab_name_ != col.tab_name ||
+        (scan->tag != T_IndexScan && scan->tag != T_IndexOnlyScan)) {
+        return false;
+    }
+    auto index = sm_manager_->db_.get_table(scan->tab_name_).get_index_meta(scan->index_col_names_);
+    return index->type != INDEX_HASH && index->cols[0].name == col.col_name;
+}
+
+// 判断按索引扫描时分组key相同的元组是否相邻：索引是B+树，并且前k个字段恰好是k个不同的分组字段
+static bool is_group_prefix(const IndexMeta &index, const std::string &tab_name,
+                            const std::vector<TabCol> &group_cols) {
+    std::set<std::string> names;
+    for (const auto &col : group_cols) {
+        if (col.tab_name != tab_name) {
+            return false;
+        }
+        names.insert(col.col_name);
+    }
+    if (index.type == INDEX_HASH || index.cols.size() < names.size()) {
+        return false;
+    }
+    return std::all_of(index.cols.begin(), index.cols.begin() + names.size(),
+                       [&](const ColMeta &col) { return names.count(col.name) > 0; });
+}
+
+/**
+ * @brief 判断plan的输出中分组key相同的元组是否相邻：没有分组字段，或者plan是按分组字段有序的索引扫描
+ */
+bool Planner::is_grouped_on(const std::shared_ptr<Plan> &plan, const std::vector<TabCol> &group_cols) {
+    if (group_cols.empty()) {
+        return true;
+    }
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    if (scan == nullptr || (scan->tag != T_IndexScan && scan->tag != T_IndexOnlyScan)) {
+        return false;
+    }
+    auto index = sm_manager_->db_.get_table(scan->tab_name_).get_index_meta(scan->index_col_names_);
+    return is_group_prefix(*index, scan->tab_name_, group_cols);
+}
+
+// 找到表上按分组字段有序的B+树索引
+bool Planner::get_group_index(const std::string &tab_name, const std::vector<TabCol> &group_cols,
+                              std::vector<std::string> &index_col_names) {
+    for (const auto &index : sm_manager_->db_.get_table(tab_name).indexes) {
+        if (is_group_prefix(index, tab_name, group_cols)) {
+            index_col_names.clear();
+            for (const auto &col : index.cols) {
+                index_col_names.push_back(col.name);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 为每个聚集函数找到第一个字段为聚集字段的B+树索引，所有聚集函数都是这张表上的MIN/MAX并且都找到时返回true
+ */
+bool Planner::get_min_max_indexes(const std::string &tab_name, const std::vector<AggExpr> &aggs,
+                                  std::vector<std::vector<std::string>> &index_col_names) {
+    index_col_names.clear();
+    TabMeta &tab = sm_manager_->db_.get_table(tab_name);
+    for (const auto &agg : aggs) {
+        if ((agg.type != AGG_MIN && agg.type != AGG_MAX) || agg.col.tab_name != tab_name) {
+            return false;
+        }
+        auto index = std::find_if(tab.indexes.begin(), tab.indexes.end(), [&](const IndexMeta &index) {
+            return index.type != INDEX_HASH && index.cols[0].name == agg.col.col_name;
+        });
+        if (index == tab.indexes.end()) {
+            return false;
+        }
+        index_col_names.emplace_back();
+        for (const auto &col : index->cols) {
+            index_col_names.back().push_back(col.name);
+        }
+    }
+    return true;
+}
+
 std::shared_ptr<Query> Planner::logical_optimization(std::shared_ptr<Query> query, Context *context) {
     // TODO 实现逻辑优化规则
 
@@ -141,6 +446,10 @@ std::shared_ptr<Plan> Planner::physical_optimization(std::shared_ptr<Query> quer
     std::shared_ptr<Plan> plan = make_one_rel(query);
 
     // 其他物理优化
+    choose_join_method(plan);
+
+    // 处理聚集和group by
+    plan = generate_agg_plan(query, std::move(plan));
 
     // 处理orderby
     plan = generate_sort_plan(query, std::move(plan));
@@ -163,8 +472,10 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query) {
             table_scan_executors[i] =
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_col_names);
         } else {  // 存在索引
+            PlanTag tag = is_covering_index(tables[i], index_col_names, curr_conds, query) ? T_IndexOnlyScan
+                                                                                            : T_IndexScan;
             table_scan_executors[i] =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
+                std::make_shared<ScanPlan>(tag, sm_manager_, tables[i], curr_conds, index_col_names);
         }
     }
     // 只有一个表，不需要join。
@@ -255,6 +566,35 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query) {
     return table_join_executors;
 }
 
+/**
+ * @brief 处理聚集和GROUP BY
+ * 单表上没有WHERE条件和分组字段、只有MIN/MAX，并且聚集字段都有B+树索引时，直接读索引的首尾key，不扫描表；
+ * 单表顺序扫描时，如果有按分组字段有序的覆盖索引，改为只读索引的扫描；
+ * 输入中分组key相同的元组相邻时用流式聚集，否则用哈希聚集
+ */
+std::shared_ptr<Plan> Planner::generate_agg_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan) {
+    if (query->aggs.empty() && query->group_cols.empty()) {
+        return plan;
+    }
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    std::vector<std::vector<std::string>> min_max_indexes;
+    if (scan != nullptr && scan->conds_.empty() && query->group_cols.empty() &&
+        get_min_max_indexes(scan->tab_name_, query->aggs, min_max_indexes)) {
+        auto agg = std::make_shared<AggregatePlan>(T_IndexMinMax, std::move(plan), query->group_cols, query->aggs);
+        agg->index_col_names_ = std::move(min_max_indexes);
+        return agg;
+    }
+    std::vector<std::string> index_col_names;
+    if (scan != nullptr && scan->tag == T_SeqScan && !query->group_cols.empty() &&
+        get_group_index(scan->tab_name_, query->group_cols, index_col_names) &&
+        is_covering_index(scan->tab_name_, index_col_names, scan->conds_, query)) {
+        plan = std::make_shared<ScanPlan>(T_IndexOnlyScan, sm_manager_, scan->tab_name_, scan->conds_,
+                                          index_col_names);
+    }
+    PlanTag tag = is_grouped_on(plan, query->group_cols) ? T_StreamAggregate : T_HashAggregate;
+    return std::make_shared<AggregatePlan>(tag, std::move(plan), query->group_cols, query->aggs);
+}
+
 std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan) {
     auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
     if (!x->has_sort) {
@@ -267,11 +607,66 @@ std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query,
         const auto &sel_tab_cols = sm_manager_->db_.get_table(sel_tab_name).cols;
         all_cols.insert(all_cols.end(), sel_tab_cols.begin(), sel_tab_cols.end());
     }
-    TabCol sel_col;
-    for (auto &col : all_cols) {
-        if (col.name.compare(x->order->cols->col_name) == 0) sel_col = {.tab_name = col.tab_name, .col_name = col.name};
+    std::vector<TabCol> sel_cols;
+    std::vector<bool> is_descs;
+    for (const auto &order : x->orders) {
+        auto col = std::find_if(all_cols.begin(), all_cols.end(), [&](const ColMeta &col) {
+            return col.name == order->cols->col_name &&
+                   (order->cols->tab_name.empty() || col.tab_name == order->cols->tab_name);
+        });
+        if (col == all_cols.end()) {
+            throw ColumnNotFoundError(order->cols->col_name);
+        }
+        sel_cols.push_back({.tab_name = col->tab_name, .col_name = col->name});
+        is_descs.push_back(order->orderby_dir == ast::OrderBy_DESC);
+    }
+    return std::make_shared<SortPlan>(T_Sort, std::move(plan), std::move(sel_cols), std::move(is_descs));
+}
+
+/**
+ * @brief 处理LIMIT/OFFSET：放在投影下面，使没有排序时扫描能提前结束；有排序时下推到排序中，用Top-N排序
+ */
+std::shared_ptr<Plan> Planner::generate_limit_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan) {
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    if (x->limit == nullptr) {
+        return plan;
+    }
+    if (auto sort = std::dynamic_pointer_cast<SortPlan>(plan)) {
+        sort->limit_ = x->limit->count;
+        sort->offset_ = x->limit->offset;
+        return plan;
+    }
+    return std::make_shared<LimitPlan>(T_Limit, std::move(plan), x->limit->count, x->limit->offset);
+}
+
+/**
+ * @brief 有多个CPU核时，把数据页不少于PARALLEL_SCAN_MIN_PAGES的表上的顺序扫描改为按morsel并行的顺序扫描
+ * 并行扫描的输出顺序与顺序扫描相同，放在选择计划生成的最后，不影响之前按T_SeqScan做的判断
+ */
+void Planner::parallelize_scans(const std::shared_ptr<Plan> &plan) {
+    if (ParallelSeqScanExecutor::default_workers() <= 1) {
+        return;
+    }
+    if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        if (x->tag == T_SeqScan &&
+            sm_manager_->fhs_.at(x->tab_name_)->get_file_hdr().num_pages >= PARALLEL_SCAN_MIN_PAGES) {
+            x->tag = T_ParallelSeqScan;
+        }
+    } else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        parallelize_scans(x->left_);
+        // index nested loop join的内表不扫描
+        if (x->tag != T_IndexNestLoop) {
+            parallelize_scans(x->right_);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<AggregatePlan>(plan)) {
+        if (x->tag != T_IndexMinMax) {
+            parallelize_scans(x->subplan_);
+        }
+    } else if (auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
+        parallelize_scans(x->subplan_);
+    } else if (auto x = std::dynamic_pointer_cast<LimitPlan>(plan)) {
+        parallelize_scans(x->subplan_);
     }
-    return std::make_shared<SortPlan>(T_Sort, std::move(plan), sel_col, x->order->orderby_dir == ast::OrderBy_DESC);
 }
 
 /**
@@ -288,6 +683,8 @@ std::shared_ptr<Plan> Planner::generate_select_plan(std::shared_ptr<Query> query
     //物理优化
     auto sel_cols = query->cols;
     std::shared_ptr<Plan> plannerRoot = physical_optimization(query, context);
+    plannerRoot = generate_limit_plan(query, std::move(plannerRoot));
+    parallelize_scans(plannerRoot);
     plannerRoot = std::make_shared<ProjectionPlan>(T_Projection, std::move(plannerRoot), std::move(sel_cols));
 
     return plannerRoot;
@@ -316,10 +713,21 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>(),
+                                                interp_index_type(x->index_type), x->unique);
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::AnalyzeIndex>(query->parse)) {
+        // analyze index
+        plannerRoot = std::make_shared<DDLPlan>(T_AnalyzeIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::RebuildIndex>(query->parse)) {
+        // alter index rebuild
+        plannerRoot = std::make_shared<DDLPlan>(T_RebuildIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::SetIndexBloom>(query->parse)) {
+        // alter index set bloom
+        plannerRoot = std::make_shared<DDLPlan>(T_SetIndexBloom, x->tab_name, x->col_names, std::vector<ColDef>(),
+                                                INDEX_BTREE, false, x->enabled);
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(query->parse)) {
         // insert;
         plannerRoot = std::make_shared<DMLPlan>(T_Insert, std::shared_ptr<Plan>(), x->tab_name, query->values,
@@ -343,8 +751,9 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
                 std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
         }
 
-        plannerRoot = std::make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name, std::vector<Value>(),
-                                                query->conds, std::vector<SetClause>());
+        plannerRoot = std::make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name,
+                                                std::vector<std::vector<Value>>(), query->conds,
+                                                std::vector<SetClause>());
     } else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(query->parse)) {
         // update;
         // 生成表扫描方式
@@ -362,14 +771,15 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             table_scan_executors =
                 std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
         }
-        plannerRoot = std::make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name, std::vector<Value>(),
-                                                query->conds, query->set_clauses);
+        plannerRoot = std::make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name,
+                                                std::vector<std::vector<Value>>(), query->conds, query->set_clauses);
     } else if (auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse)) {
         std::shared_ptr<plannerInfo> root = std::make_shared<plannerInfo>(x);
         // 生成select语句的查询执行计划
         std::shared_ptr<Plan> projection = generate_select_plan(std::move(query), context);
-        plannerRoot = std::make_shared<DMLPlan>(T_select, projection, std::string(), std::vector<Value>(),
-                                                std::vector<Condition>(), std::vector<SetClause>());
+        plannerRoot = std::make_shared<DMLPlan>(T_select, projection, std::string(),
+                                                std::vector<std::vector<Value>>(), std::vector<Condition>(),
+                                                std::vector<SetClause>());
     } else {
         throw InternalError("Unexpected AST root");
     }
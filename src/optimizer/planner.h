@@ -42,7 +42,11 @@ class Planner {
 
     std::shared_ptr<Plan> make_one_rel(std::shared_ptr<Query> query);
 
+    std::shared_ptr<Plan> generate_agg_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
+
     std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
+
+    std::shared_ptr<Plan> generate_limit_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
     
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> query, Context *context);
 
@@ -50,9 +54,48 @@ class Planner {
     // int get_indexNo(std::string tab_name, std::vector<Condition> curr_conds);
     bool get_index_cols(std::string tab_name, const std::vector<Condition>& curr_conds, std::vector<std::string>& index_col_names);
 
+    double estimate_selectivity(const std::string &tab_name, const IndexMeta &index,
+                                const std::vector<Condition> &curr_conds);
+
+    bool is_covering_index(const std::string &tab_name, const std::vector<std::string> &index_col_names,
+                           const std::vector<Condition> &curr_conds, std::shared_ptr<Query> query);
+
+    void choose_join_method(const std::shared_ptr<Plan> &plan);
+
+    bool is_ordered_on(const std::shared_ptr<Plan> &plan, const TabCol &col);
+
+    bool is_grouped_on(const std::shared_ptr<Plan> &plan, const std::vector<TabCol> &group_cols);
+
+    bool get_group_index(const std::string &tab_name, const std::vector<TabCol> &group_cols,
+                         std::vector<std::string> &index_col_names);
+
+    bool get_min_max_indexes(const std::string &tab_name, const std::vector<AggExpr> &aggs,
+                             std::vector<std::vector<std::string>> &index_col_names);
+
+    void parallelize_scans(const std::shared_ptr<Plan> &plan);
+
+    bool use_index_join(const std::shared_ptr<JoinPlan> &join, const Condition &cond);
+
+    double estimate_rows(const std::shared_ptr<Plan> &plan);
+
+    double estimate_table_rows(const std::string &tab_name);
+
     ColType interp_sv_type(ast::SvType sv_type) {
         std::map<ast::SvType, ColType> m = {
             {ast::SV_TYPE_INT, TYPE_INT}, {ast::SV_TYPE_FLOAT, TYPE_FLOAT}, {ast::SV_TYPE_STRING, TYPE_STRING}};
         return m.at(sv_type);
     }
+
+    IndexType interp_index_type(const std::string &index_type) {
+        if (index_type.empty()) {
+            return INDEX_BTREE;
+        }
+        std::string upper = index_type;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        std::map<std::string, IndexType> m = {{"BTREE", INDEX_BTREE}, {"BLINK", INDEX_BLINK}, {"HASH", INDEX_HASH}};
+        if (m.count(upper) == 0) {
+            throw IndexTypeNotSupportedError(index_type);
+        }
+        return m.at(upper);
+    }
 };
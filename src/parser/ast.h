@@ -26,6 +26,10 @@ enum SvCompOp {
     SV_OP_EQ, SV_OP_NE, SV_OP_LT, SV_OP_GT, SV_OP_LE, SV_OP_GE
 };
 
+enum SvAggType {
+    SV_AGG_NONE, SV_AGG_COUNT, SV_AGG_SUM, SV_AGG_MIN, SV_AGG_MAX, SV_AGG_AVG
+};
+
 enum OrderByDir {
     OrderBy_DEFAULT,
     OrderBy_ASC,
@@ -43,6 +47,18 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+struct ShowIndexStats : public TreeNode {
+    std::string tab_name;       // 为空表示所有表上的索引
+
+    ShowIndexStats(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
+struct ShowBloomStats : public TreeNode {
+    std::string tab_name;       // 为空表示所有表上的索引
+
+    ShowBloomStats(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -96,9 +112,13 @@ struct DescTable : public TreeNode {
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    std::string index_type;     // USING子句指定的索引实现方式，为空表示默认的B+树
+    bool unique;                // CREATE UNIQUE INDEX
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, std::string index_type_ = "",
+                bool unique_ = false) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), index_type(std::move(index_type_)),
+            unique(unique_) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -109,6 +129,31 @@ struct DropIndex : public TreeNode {
             tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
 };
 
+struct AnalyzeIndex : public TreeNode {
+    std::string tab_name;
+    std::vector<std::string> col_names;
+
+    AnalyzeIndex(std::string tab_name_, std::vector<std::string> col_names_) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+};
+
+struct RebuildIndex : public TreeNode {
+    std::string tab_name;
+    std::vector<std::string> col_names;
+
+    RebuildIndex(std::string tab_name_, std::vector<std::string> col_names_) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+};
+
+struct SetIndexBloom : public TreeNode {
+    std::string tab_name;
+    std::vector<std::string> col_names;
+    bool enabled;               // SET BLOOM ON为true，OFF为false
+
+    SetIndexBloom(std::string tab_name_, std::vector<std::string> col_names_, bool enabled_) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), enabled(enabled_) {}
+};
+
 struct Expr : public TreeNode {
 };
 
@@ -136,9 +181,10 @@ struct StringLit : public Value {
 struct Col : public Expr {
     std::string tab_name;
     std::string col_name;
+    SvAggType agg_type;  // 选择列表中的聚集函数，COUNT(*)的col_name为"*"
 
-    Col(std::string tab_name_, std::string col_name_) :
-            tab_name(std::move(tab_name_)), col_name(std::move(col_name_)) {}
+    Col(std::string tab_name_, std::string col_name_, SvAggType agg_type_ = SV_AGG_NONE) :
+            tab_name(std::move(tab_name_)), col_name(std::move(col_name_)), agg_type(agg_type_) {}
 };
 
 struct SetClause : public TreeNode {
@@ -166,12 +212,20 @@ struct OrderBy : public TreeNode
        cols(std::move(cols_)), orderby_dir(std::move(orderby_dir_)) {}
 };
 
+// LIMIT count OFFSET offset
+struct Limit : public TreeNode
+{
+    int count;
+    int offset;
+    Limit(int count_, int offset_) : count(count_), offset(offset_) {}
+};
+
 struct InsertStmt : public TreeNode {
     std::string tab_name;
-    std::vector<std::shared_ptr<Value>> vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> rows;  // VALUES之后的每个括号是一行
 
-    InsertStmt(std::string tab_name_, std::vector<std::shared_ptr<Value>> vals_) :
-            tab_name(std::move(tab_name_)), vals(std::move(vals_)) {}
+    InsertStmt(std::string tab_name_, std::vector<std::vector<std::shared_ptr<Value>>> rows_) :
+            tab_name(std::move(tab_name_)), rows(std::move(rows_)) {}
 };
 
 struct DeleteStmt : public TreeNode {
@@ -211,17 +265,22 @@ struct SelectStmt : public TreeNode {
     std::vector<std::shared_ptr<JoinExpr>> jointree;
 
     
+    std::vector<std::shared_ptr<Col>> group_by;    // GROUP BY的字段
+
     bool has_sort;
-    std::shared_ptr<OrderBy> order;
+    std::vector<std::shared_ptr<OrderBy>> orders;  // ORDER BY的各个字段，依次比较
+    std::shared_ptr<Limit> limit;                  // 没有LIMIT时为nullptr
 
 
     SelectStmt(std::vector<std::shared_ptr<Col>> cols_,
                std::vector<std::string> tabs_,
                std::vector<std::shared_ptr<BinaryExpr>> conds_,
-               std::shared_ptr<OrderBy> order_) :
-            cols(std::move(cols_)), tabs(std::move(tabs_)), conds(std::move(conds_)), 
-            order(std::move(order_)) {
-                has_sort = (bool)order;
+               std::vector<std::shared_ptr<Col>> group_by_,
+               std::vector<std::shared_ptr<OrderBy>> orders_,
+               std::shared_ptr<Limit> limit_) :
+            cols(std::move(cols_)), tabs(std::move(tabs_)), conds(std::move(conds_)), group_by(std::move(group_by_)),
+            orders(std::move(orders_)), limit(std::move(limit_)) {
+                has_sort = !orders.empty();
             }
 };
 
@@ -237,6 +296,8 @@ struct SemValue {
 
     SvCompOp sv_comp_op;
 
+    SvAggType sv_agg_type;
+
     std::shared_ptr<TypeLen> sv_type_len;
 
     std::shared_ptr<Field> sv_field;
@@ -246,6 +307,7 @@ struct SemValue {
 
     std::shared_ptr<Value> sv_val;
     std::vector<std::shared_ptr<Value>> sv_vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> sv_rows;
 
     std::shared_ptr<Col> sv_col;
     std::vector<std::shared_ptr<Col>> sv_cols;
@@ -257,6 +319,9 @@ struct SemValue {
     std::vector<std::shared_ptr<BinaryExpr>> sv_conds;
 
     std::shared_ptr<OrderBy> sv_orderby;
+    std::vector<std::shared_ptr<OrderBy>> sv_orderbys;
+
+    std::shared_ptr<Limit> sv_limit;
 };
 
 extern std::shared_ptr<ast::TreeNode> parse_tree;
@@ -79,6 +79,14 @@ private:
             std::cout << "HELP\n";
         } else if (auto x = std::dynamic_pointer_cast<ShowTables>(node)) {
             std::cout << "SHOW_TABLES\n";
+        } else if (auto x = std::dynamic_pointer_cast<ShowIndexStats>(node)) {
+            std::cout << "SHOW_INDEX_STATS\n";
+            if (!x->tab_name.empty())
+                print_val(x->tab_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<ShowBloomStats>(node)) {
+            std::cout << "SHOW_BLOOM_STATS\n";
+            if (!x->tab_name.empty())
+                print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<CreateTable>(node)) {
             std::cout << "CREATE_TABLE\n";
             print_val(x->tab_name, offset);
@@ -95,12 +103,32 @@ private:
             // print_val(x->col_name, offset);
             for(auto col_name: x->col_names)
                 print_val(col_name, offset);
+            if (!x->index_type.empty())
+                print_val(x->index_type, offset);
+            if (x->unique)
+                print_val("UNIQUE", offset);
         } else if (auto x = std::dynamic_pointer_cast<DropIndex>(node)) {
             std::cout << "DROP_INDEX\n";
             print_val(x->tab_name, offset);
             // print_val(x->col_name, offset);
             for(auto col_name: x->col_names)
                 print_val(col_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<AnalyzeIndex>(node)) {
+            std::cout << "ANALYZE_INDEX\n";
+            print_val(x->tab_name, offset);
+            for(auto col_name: x->col_names)
+                print_val(col_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<RebuildIndex>(node)) {
+            std::cout << "REBUILD_INDEX\n";
+            print_val(x->tab_name, offset);
+            for(auto col_name: x->col_names)
+                print_val(col_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<SetIndexBloom>(node)) {
+            std::cout << "SET_INDEX_BLOOM\n";
+            print_val(x->tab_name, offset);
+            for(auto col_name: x->col_names)
+                print_val(col_name, offset);
+            print_val(x->enabled ? "ON" : "OFF", offset);
         } else if (auto x = std::dynamic_pointer_cast<ColDef>(node)) {
             std::cout << "COL_DEF\n";
             print_val(x->col_name, offset);
@@ -134,7 +162,9 @@ private:
         } else if (auto x = std::dynamic_pointer_cast<InsertStmt>(node)) {
             std::cout << "INSERT\n";
             print_val(x->tab_name, offset);
-            print_node_list(x->vals, offset);
+            for (auto &row : x->rows) {
+                print_node_list(row, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DeleteStmt>(node)) {
             std::cout << "DELETE\n";
             print_val(x->tab_name, offset);
@@ -21,6 +21,8 @@ int main() {
         "drop table tb;",
         "create index tb(a);",
         "create index tb(a, b, c);",
+        "create index tb(a) using blink;",
+        "create unique index tb(a, b);",
         "drop index tb(a, b, c);",
         "drop index tb(b);",
         "insert into tb values (1, 3.14, 'pi');",
@@ -30,6 +32,7 @@ int main() {
         "select * from tb where x <> 2 and y >= 3. and z <= '123' and b < tb.a;",
         "select x.a, y.b from x, y where x.a = y.b and c = d;",
         "select x.a, y.b from x join y where x.a = y.b and c = d;",
+        "select count(*), sum(b), max(tb.c) from tb where a > 1 group by a, tb.d order by a;",
         "exit;",
         "help;",
         "",
@@ -23,6 +23,7 @@ using namespace ast;
 // keywords
 %token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
 WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY
+USING UNIQUE STATS ANALYZE ALTER REBUILD BLOOM ON OFF LIMIT OFFSET GROUP COUNT SUM MIN MAX AVG
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -40,16 +41,20 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_expr> expr
 %type <sv_val> value
 %type <sv_vals> valueList
-%type <sv_str> tbName colName
+%type <sv_rows> valueRows
+%type <sv_str> tbName colName optUsing
 %type <sv_strs> tableList colNameList
-%type <sv_col> col
-%type <sv_cols> colList selector
+%type <sv_col> col selItem
+%type <sv_cols> colList selector selList opt_group_clause
+%type <sv_agg_type> aggFunc
 %type <sv_set_clause> setClause
 %type <sv_set_clauses> setClauses
 %type <sv_cond> condition
 %type <sv_conds> whereClause optWhereClause
-%type <sv_orderby>  order_clause opt_order_clause
+%type <sv_orderby>  order_item
+%type <sv_orderbys> order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_limit> opt_limit_clause
 
 %%
 start:
@@ -106,6 +111,22 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    |   SHOW INDEX STATS
+    {
+        $$ = std::make_shared<ShowIndexStats>("");
+    }
+    |   SHOW INDEX STATS FROM tbName
+    {
+        $$ = std::make_shared<ShowIndexStats>($5);
+    }
+    |   SHOW BLOOM STATS
+    {
+        $$ = std::make_shared<ShowBloomStats>("");
+    }
+    |   SHOW BLOOM STATS FROM tbName
+    {
+        $$ = std::make_shared<ShowBloomStats>($5);
+    }
     ;
 
 ddl:
@@ -121,20 +142,40 @@ ddl:
     {
         $$ = std::make_shared<DescTable>($2);
     }
-    |   CREATE INDEX tbName '(' colNameList ')'
+    |   CREATE INDEX tbName '(' colNameList ')' optUsing
     {
-        $$ = std::make_shared<CreateIndex>($3, $5);
+        $$ = std::make_shared<CreateIndex>($3, $5, $7);
+    }
+    |   CREATE UNIQUE INDEX tbName '(' colNameList ')' optUsing
+    {
+        $$ = std::make_shared<CreateIndex>($4, $6, $8, true);
     }
     |   DROP INDEX tbName '(' colNameList ')'
     {
         $$ = std::make_shared<DropIndex>($3, $5);
     }
+    |   ANALYZE INDEX tbName '(' colNameList ')'
+    {
+        $$ = std::make_shared<AnalyzeIndex>($3, $5);
+    }
+    |   ALTER INDEX tbName '(' colNameList ')' REBUILD
+    {
+        $$ = std::make_shared<RebuildIndex>($3, $5);
+    }
+    |   ALTER INDEX tbName '(' colNameList ')' SET BLOOM ON
+    {
+        $$ = std::make_shared<SetIndexBloom>($3, $5, true);
+    }
+    |   ALTER INDEX tbName '(' colNameList ')' SET BLOOM OFF
+    {
+        $$ = std::make_shared<SetIndexBloom>($3, $5, false);
+    }
     ;
 
 dml:
-        INSERT INTO tbName VALUES '(' valueList ')'
+        INSERT INTO tbName VALUES valueRows
     {
-        $$ = std::make_shared<InsertStmt>($3, $6);
+        $$ = std::make_shared<InsertStmt>($3, $5);
     }
     |   DELETE FROM tbName optWhereClause
     {
@@ -144,9 +185,9 @@ dml:
     {
         $$ = std::make_shared<UpdateStmt>($2, $4, $5);
     }
-    |   SELECT selector FROM tableList optWhereClause opt_order_clause
+    |   SELECT selector FROM tableList optWhereClause opt_group_clause opt_order_clause opt_limit_clause
     {
-        $$ = std::make_shared<SelectStmt>($2, $4, $5, $6);
+        $$ = std::make_shared<SelectStmt>($2, $4, $5, $6, $7, $8);
     }
     ;
 
@@ -194,6 +235,17 @@ type:
     }
     ;
 
+valueRows:
+        '(' valueList ')'
+    {
+        $$ = std::vector<std::vector<std::shared_ptr<Value>>>{$2};
+    }
+    |   valueRows ',' '(' valueList ')'
+    {
+        $$.push_back($4);
+    }
+    ;
+
 valueList:
         value
     {
@@ -329,7 +381,43 @@ selector:
     {
         $$ = {};
     }
-    |   colList
+    |   selList
+    ;
+
+selList:
+        selItem
+    {
+        $$ = std::vector<std::shared_ptr<Col>>{$1};
+    }
+    |   selList ',' selItem
+    {
+        $$.push_back($3);
+    }
+    ;
+
+selItem:
+        col
+    |   aggFunc '(' col ')'
+    {
+        $$ = $3;
+        $$->agg_type = $1;
+    }
+    |   COUNT '(' col ')'
+    {
+        $$ = $3;
+        $$->agg_type = SV_AGG_COUNT;
+    }
+    |   COUNT '(' '*' ')'
+    {
+        $$ = std::make_shared<Col>("", "*", SV_AGG_COUNT);
+    }
+    ;
+
+aggFunc:
+        SUM     { $$ = SV_AGG_SUM; }
+    |   MIN     { $$ = SV_AGG_MIN; }
+    |   MAX     { $$ = SV_AGG_MAX; }
+    |   AVG     { $$ = SV_AGG_AVG; }
     ;
 
 tableList:
@@ -347,6 +435,14 @@ tableList:
     }
     ;
 
+opt_group_clause:
+        GROUP BY colList
+    {
+        $$ = $3;
+    }
+    |   /* epsilon */ { /* ignore*/ }
+    ;
+
 opt_order_clause:
     ORDER BY order_clause      
     { 
@@ -356,6 +452,17 @@ opt_order_clause:
     ;
 
 order_clause:
+        order_item
+    {
+        $$ = std::vector<std::shared_ptr<OrderBy>>{$1};
+    }
+    |   order_clause ',' order_item
+    {
+        $$.push_back($3);
+    }
+    ;
+
+order_item:
       col  opt_asc_desc 
     { 
         $$ = std::make_shared<OrderBy>($1, $2);
@@ -368,6 +475,26 @@ opt_asc_desc:
     |       { $$ = OrderBy_DEFAULT; }
     ;    
 
+opt_limit_clause:
+        LIMIT VALUE_INT
+    {
+        $$ = std::make_shared<Limit>($2, 0);
+    }
+    |   LIMIT VALUE_INT OFFSET VALUE_INT
+    {
+        $$ = std::make_shared<Limit>($2, $4);
+    }
+    |   /* epsilon */ { /* ignore*/ }
+    ;
+
+optUsing:
+        /* epsilon */ { $$ = ""; }
+    |   USING IDENTIFIER
+    {
+        $$ = $2;
+    }
+    ;
+
 tbName: IDENTIFIER;
 
 colName: IDENTIFIER;
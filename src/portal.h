@@ -15,9 +15,17 @@ See the Mulan PSL v2 for more details. */
 #include <string>
 #include "optimizer/plan.h"
 #include "execution/executor_abstract.h"
-#include "execution/executor_nestedloop_join.h"
+#include "execution/executor_block_nestedloop_join.h"
+#include "execution/executor_hash_aggregate.h"
+#include "execution/executor_hash_join.h"
+#include "execution/executor_index_min_max.h"
+#include "execution/executor_index_nestedloop_join.h"
+#include "execution/executor_limit.h"
+#include "execution/executor_merge_join.h"
+#include "execution/executor_parallel_seq_scan.h"
 #include "execution/executor_projection.h"
 #include "execution/executor_seq_scan.h"
+#include "execution/executor_stream_aggregate.h"
 #include "execution/executor_index_scan.h"
 #include "execution/executor_update.h"
 #include "execution/executor_insert.h"
@@ -154,25 +162,76 @@ class Portal
     std::unique_ptr<AbstractExecutor> convert_plan_executor(std::shared_ptr<Plan> plan, Context *context)
     {
         if(auto x = std::dynamic_pointer_cast<ProjectionPlan>(plan)){
+            auto scan = std::dynamic_pointer_cast<ScanPlan>(x->subplan_);
+            if(scan != nullptr && scan->tag == T_ParallelSeqScan) {
+                // 投影由并行扫描的工作线程完成
+                return std::make_unique<ParallelSeqScanExecutor>(sm_manager_, scan->tab_name_, scan->conds_,
+                                                                 x->sel_cols_, context);
+            }
             return std::make_unique<ProjectionExecutor>(convert_plan_executor(x->subplan_, context), 
                                                         x->sel_cols_);
         } else if(auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
             if(x->tag == T_SeqScan) {
                 return std::make_unique<SeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_, context);
             }
+            else if(x->tag == T_ParallelSeqScan) {
+                return std::make_unique<ParallelSeqScanExecutor>(sm_manager_, x->tab_name_, x->conds_,
+                                                                 std::vector<TabCol>(), context);
+            }
             else {
-                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, context);
+                return std::make_unique<IndexScanExecutor>(sm_manager_, x->tab_name_, x->conds_, x->index_col_names_, context,
+                                                           x->tag == T_IndexOnlyScan);
             } 
         } else if(auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
             std::unique_ptr<AbstractExecutor> left = convert_plan_executor(x->left_, context);
+            if(x->tag == T_IndexNestLoop) {
+                // 内表不单独扫描，由连接算子在索引上查找
+                auto inner = std::dynamic_pointer_cast<ScanPlan>(x->right_);
+                return std::make_unique<IndexNestedLoopJoinExecutor>(sm_manager_, std::move(left), inner->tab_name_,
+                                                                     inner->conds_, x->index_col_names_,
+                                                                     std::move(x->conds_), context);
+            }
             std::unique_ptr<AbstractExecutor> right = convert_plan_executor(x->right_, context);
-            std::unique_ptr<AbstractExecutor> join = std::make_unique<NestedLoopJoinExecutor>(
+            if(x->tag == T_MergeJoin) {
+                return std::make_unique<MergeJoinExecutor>(std::move(left), std::move(right), std::move(x->conds_));
+            }
+            if(x->tag == T_HashJoin) {
+                return std::make_unique<HashJoinExecutor>(sm_manager_, std::move(left), std::move(right),
+                                                          std::move(x->conds_));
+            }
+            // 不能hash的连接按块嵌套循环执行，右儿子每一块左儿子元组扫描一遍
+            std::unique_ptr<AbstractExecutor> join = std::make_unique<BlockNestedLoopJoinExecutor>(
                                 std::move(left), 
                                 std::move(right), std::move(x->conds_));
             return join;
         } else if(auto x = std::dynamic_pointer_cast<SortPlan>(plan)) {
-            return std::make_unique<SortExecutor>(convert_plan_executor(x->subplan_, context), 
-                                            x->sel_col_, x->is_desc_);
+            std::unique_ptr<AbstractExecutor> prev = convert_plan_executor(x->subplan_, context);
+            if(x->limit_ < 0) {
+                return std::make_unique<SortExecutor>(sm_manager_, std::move(prev), x->sel_cols_, x->is_descs_);
+            }
+            // 只需要前offset + limit个元组，放得进内存时用Top-N排序，否则完整排序之后再截取
+            size_t n = static_cast<size_t>(x->limit_) + x->offset_;
+            if(TopNExecutor::fits_in_memory(n, prev->tupleLen())) {
+                return std::make_unique<TopNExecutor>(std::move(prev), x->sel_cols_, x->is_descs_, x->limit_,
+                                                      x->offset_);
+            }
+            auto sort = std::make_unique<SortExecutor>(sm_manager_, std::move(prev), x->sel_cols_, x->is_descs_);
+            return std::make_unique<LimitExecutor>(std::move(sort), x->limit_, x->offset_);
+        } else if(auto x = std::dynamic_pointer_cast<AggregatePlan>(plan)) {
+            if(x->tag == T_IndexMinMax) {
+                // 直接读索引的首尾key，不扫描表
+                auto scan = std::dynamic_pointer_cast<ScanPlan>(x->subplan_);
+                return std::make_unique<IndexMinMaxExecutor>(sm_manager_, scan->tab_name_, x->aggs_,
+                                                             x->index_col_names_, context);
+            }
+            std::unique_ptr<AbstractExecutor> prev = convert_plan_executor(x->subplan_, context);
+            if(x->tag == T_StreamAggregate) {
+                return std::make_unique<StreamAggregateExecutor>(std::move(prev), x->group_cols_, x->aggs_);
+            }
+            return std::make_unique<HashAggregateExecutor>(sm_manager_, std::move(prev), x->group_cols_, x->aggs_);
+        } else if(auto x = std::dynamic_pointer_cast<LimitPlan>(plan)) {
+            return std::make_unique<LimitExecutor>(convert_plan_executor(x->subplan_, context), x->limit_,
+                                                   x->offset_);
         }
         return nullptr;
     }
@@ -31,6 +31,17 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid &rid, Context *cont
     return std::make_unique<RmRecord>(file_hdr_.record_size, data);
 }
 
+/**
+ * @description: 把记录号为rid的记录拷贝到buf中，不分配RmRecord，供批量执行时直接写入DataChunk
+ * @param {Rid&} rid 记录号
+ * @param {char*} buf 至少record_size字节的缓冲区
+ */
+void RmFileHandle::read_record(const Rid &rid, char *buf) const {
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    memcpy(buf, page_handle.get_slot(rid.slot_no), file_hdr_.record_size);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+}
+
 /**
  * @description: 在当前表中插入一条记录，不指定插入位置
  * @param {char*} buf 要插入的记录的数据
@@ -77,8 +77,8 @@ class RmManager {
     void close_file(const RmFileHandle* file_handle) {
         disk_manager_->write_page(file_handle->fd_, RM_FILE_HDR_PAGE, (char *)&file_handle->file_hdr_,
                                   sizeof(file_handle->file_hdr_));
-        // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
-        buffer_pool_manager_->flush_all_pages(file_handle->fd_);
+        // 缓冲区的所有页刷到磁盘并移出缓冲池，注意这句话必须写在close_file前面
+        buffer_pool_manager_->remove_all_pages(file_handle->fd_);
         disk_manager_->close_file(file_handle->fd_);
     }
 };
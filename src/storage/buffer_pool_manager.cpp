@@ -143,6 +143,20 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     return true;
 }
 
+/**
+ * @description: 预取目标页，若目标页已经在缓冲池中则什么也不做，否则提示磁盘提前读取该页
+ * 预取不占用frame也不改变pin_count_，之后的fetch_page可以直接命中page cache而不必等待磁盘
+ * @param {PageId} page_id 目标page的page_id
+ */
+void BufferPoolManager::prefetch_page(PageId page_id) {
+    std::scoped_lock lock{latch_};
+
+    frame_id_t frame_id;
+    if (!GetFrameId(page_id, &frame_id)) {
+        disk_manager_->prefetch_page(page_id.fd, page_id.page_no);
+    }
+}
+
 /**
  * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用
  * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
@@ -252,6 +266,31 @@ void BufferPoolManager::flush_all_pages(int fd) {
     }
 }
 
+/**
+ * @description: 将fd对应文件的所有页面写回磁盘并移出缓冲池，在关闭文件之前调用，
+ * 避免之后打开的文件复用同一个fd时读到缓冲池中残留的旧页面
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolManager::remove_all_pages(int fd) {
+    std::scoped_lock lock{latch_};
+    for (size_t i = 0; i < pool_size_; i++) {
+        Page *page = &pages_[i];
+        if (page->get_page_id().fd != fd || page->get_page_id().page_no == INVALID_PAGE_ID) {
+            continue;
+        }
+        if (page->is_dirty_) {
+            disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
+        }
+        page_table_.erase(page->get_page_id());
+        replacer_->pin(i);  // 从replacer中移除，避免该帧同时出现在free_list_和replacer中
+        page->pin_count_ = 0;
+        page->is_dirty_ = false;
+        page->id_.page_no = static_cast<page_id_t>(INVALID_PAGE_ID);
+        page->reset_memory();
+        free_list_.emplace_back(i);
+    }
+}
+
 bool BufferPoolManager::GetFrameId(PageId page_id, frame_id_t *frame_id) {
     auto it = page_table_.find(page_id);
     if (it == page_table_.end()) {
@@ -68,6 +68,8 @@ class BufferPoolManager {
 
     bool unpin_page(PageId page_id, bool is_dirty);
 
+    void prefetch_page(PageId page_id);
+
     bool flush_page(PageId page_id);
 
     Page* new_page(PageId* page_id);
@@ -76,6 +78,8 @@ class BufferPoolManager {
 
     void flush_all_pages(int fd);
 
+    void remove_all_pages(int fd);
+
    private:
     bool find_victim_page(frame_id_t* frame_id);
     bool GetFrameId(PageId page_id, frame_id_t *frame_id);
@@ -11,6 +11,8 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <fcntl.h>     // for posix_fadvise
+#include <stdio.h>     // for rename
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
 #include <unistd.h>    // for lseek
@@ -31,7 +33,7 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
     // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
     // 2.调用write()函数
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
-    off_t file_offset = static_cast<off_t>(page_no * PAGE_SIZE);
+    off_t file_offset = static_cast<off_t>(page_no) * PAGE_SIZE;
 
     if (lseek(fd, file_offset, SEEK_SET) == -1) {
         throw UnixError();
@@ -55,7 +57,7 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
     // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
     // 2.调用read()函数
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
-    off_t file_offset = static_cast<off_t>(page_no * PAGE_SIZE);
+    off_t file_offset = static_cast<off_t>(page_no) * PAGE_SIZE;
 
     if (lseek(fd, file_offset, SEEK_SET) == -1) {
         throw UnixError();
@@ -67,6 +69,16 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
     }
 }
 
+/**
+ * @description: 提示操作系统即将读取指定页面，由内核异步地将其预读到page cache中，不阻塞调用者
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 将要读取的页面编号
+ */
+void DiskManager::prefetch_page(int fd, page_id_t page_no) {
+    // 预读只是一个提示，失败时不影响正确性，因此忽略返回值
+    posix_fadvise(fd, static_cast<off_t>(page_no) * PAGE_SIZE, PAGE_SIZE, POSIX_FADV_WILLNEED);
+}
+
 /**
  * @description: 分配一个新的页号
  * @return {page_id_t} 分配的新页号
@@ -120,9 +132,11 @@ void DiskManager::create_file(const std::string &path) {
     // Todo:
     // 调用open()函数，使用O_CREAT模式
     // 注意不能重复创建相同文件
-    if (open(path.c_str(), O_CREAT | O_EXCL, 0666) == -1) {
+    int fd = open(path.c_str(), O_CREAT | O_EXCL, 0666);
+    if (fd == -1) {
         throw FileExistsError(path);
     }
+    close(fd);
 }
 
 /**
@@ -142,6 +156,26 @@ void DiskManager::destroy_file(const std::string &path) {
     unlink(path.c_str());
 }
 
+/**
+ * @description: 把文件改名为new_path，new_path已经存在时会被替换；两个文件都不能处于打开状态
+ * @param {string} &old_path 原来的文件路径
+ * @param {string} &new_path 新的文件路径
+ */
+void DiskManager::rename_file(const std::string &old_path, const std::string &new_path) {
+    if (!is_file(old_path)) {
+        throw FileNotFoundError(old_path);
+    }
+    if (path2fd_.count(old_path)) {
+        throw FileNotClosedError(old_path);
+    }
+    if (path2fd_.count(new_path)) {
+        throw FileNotClosedError(new_path);
+    }
+    if (rename(old_path.c_str(), new_path.c_str()) < 0) {
+        throw UnixError();
+    }
+}
+
 
 /**
  * @description: 打开指定路径文件 
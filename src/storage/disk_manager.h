@@ -36,6 +36,8 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void prefetch_page(int fd, page_id_t page_no);
+
     page_id_t allocate_page(int fd);
 
     void deallocate_page(page_id_t page_id);
@@ -54,6 +56,8 @@ class DiskManager {
 
     void destroy_file(const std::string &path);
 
+    void rename_file(const std::string &old_path, const std::string &new_path);
+
     int open_file(const std::string &path);
 
     void close_file(int fd);
@@ -244,12 +244,15 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
 }
 
 /**
- * @description: 创建索引
+ * @description: 创建索引，并为表中已有的记录建立索引项
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {IndexType} index_type 索引的实现方式，默认为B+树
+ * @param {bool} unique 是否为唯一索引，已有的记录中存在重复的key时抛出DuplicateKeyError，不会建立索引
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                             IndexType index_type, bool unique) {
     if (ix_manager_->exists(tab_name, col_names)) {
         throw IndexExistsError(tab_name, col_names);
     }
@@ -261,16 +264,34 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
     cols.reserve(col_names.size());
     for (const auto& col_name : col_names) {
         auto col = tab.get_col(col_name);
-        col->index = true;
         cols.push_back(*col);
         total_len += col->len;
     }
-    ix_manager_->create_index(tab_name, cols);
+    ix_manager_->create_index(tab_name, cols, index_type, unique);
+    auto ih = ix_manager_->open_index(tab_name, cols);
 
-    tab.indexes.emplace_back(tab_name, cols, total_len, cols.size());
+    IndexMeta index(tab_name, cols, total_len, cols.size(), index_type, unique);
+    auto fh = fhs_.at(tab_name).get();
+    Transaction txn(INVALID_TXN_ID);
+    try {
+        for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+            auto rec = fh->get_record(scan.rid(), context);
+            ih->insert_entry(index.get_key(rec->data).data(), scan.rid(), &txn);
+        }
+    } catch (DuplicateKeyError&) {
+        ix_manager_->close_index(ih.get());
+        ix_manager_->destroy_index(tab_name, cols);
+        throw;
+    }
 
-    auto ih = ix_manager_->open_index(tab_name, cols);
-    ihs_.emplace(ix_manager_->get_index_name(tab_name, cols), std::move(ih));
+    for (const auto& col_name : col_names) {
+        tab.get_col(col_name)->index = true;
+    }
+    tab.indexes.push_back(index);
+    {
+        std::unique_lock lock(ihs_latch_);
+        ihs_.emplace(ix_manager_->get_index_name(tab_name, cols), std::move(ih));
+    }
     flush_meta();
 }
 
@@ -298,7 +319,11 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<std::s
         cols.push_back(*tab.get_col(col_name));
     }
     std::string index_name = ix_manager_->get_index_name(tab_name, cols);
-    ihs_.erase(index_name);
+    {
+        std::unique_lock lock(ihs_latch_);
+        ix_manager_->close_index(ihs_.at(index_name).get());
+        ihs_.erase(index_name);
+    }
 
     IndexMeta index(tab_name, cols, total_len, cols.size());
     auto it = std::find(tab.indexes.begin(), tab.indexes.end(), index);
@@ -331,8 +356,236 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<ColMet
     }
 
     std::string index_name = ix_manager_->get_index_name(tab_name, cols);
-    ihs_.erase(index_name);
+    {
+        std::unique_lock lock(ihs_latch_);
+        ix_manager_->close_index(ihs_.at(index_name).get());
+        ihs_.erase(index_name);
+    }
 
     ix_manager_->destroy_index(tab_name, cols);
     flush_meta();
 }
+
+/**
+ * @description: 重新收集索引的统计信息（见IxIndexHandle::analyze），叶子较多时只采样一部分
+ * @param {string&} tab_name 表名称
+ * @param {vector<string>&} col_names 索引包含的字段名称
+ * @param {Context*} context
+ */
+void SmManager::analyze_index(const std::string& tab_name, const std::vector<std::string>& col_names,
+                              Context* context) {
+    if (!ix_manager_->exists(tab_name, col_names)) {
+        throw IndexNotFoundError(tab_name, col_names);
+    }
+    get_index_handle(tab_name, col_names)->analyze();
+}
+
+/**
+ * @description: 在线重建索引：把表中的记录批量装载到临时文件中的新索引（见IxIndexHandle::bulk_load），
+ * 然后用它替换原来的索引，回收删除之后留下的稀疏结点和不再使用的页面
+ * 装载期间表上的读写照常进行，原索引记录修改过的key（见IxIndexHandle::start_capture），装载完成后先把这些key
+ * 在新索引上同步一遍；之后对表加排他锁，同步剩余的key并替换ihs_中的索引句柄，排他锁只在最后这一小段时间内持有
+ * 出错（包括加排他锁时事务被中止）时删除临时文件，原来的索引保持不变
+ * @param {string&} tab_name 表名称
+ * @param {vector<string>&} col_names 索引包含的字段名称
+ * @param {Context*} context
+ */
+void SmManager::rebuild_index(const std::string& tab_name, const std::vector<std::string>& col_names,
+                              Context* context) {
+    if (!ix_manager_->exists(tab_name, col_names)) {
+        throw IndexNotFoundError(tab_name, col_names);
+    }
+    IndexMeta& index = *db_.get_table(tab_name).get_index_meta(col_names);
+    std::string index_name = ix_manager_->get_index_name(tab_name, col_names);
+    std::string rebuild_filename = ix_manager_->get_rebuild_filename(tab_name);
+    if (ix_manager_->exists(rebuild_filename, col_names)) {
+        ix_manager_->destroy_index(rebuild_filename, col_names);  // 上一次重建中途退出留下的临时文件
+    }
+
+    auto fh = fhs_.at(tab_name).get();
+    IxIndexHandle* old_ih = get_index_handle(tab_name, col_names);
+    old_ih->start_capture();
+    ix_manager_->create_index(rebuild_filename, index.cols, index.type, index.unique);
+    auto ih = ix_manager_->open_index(rebuild_filename, index.cols);
+    ih->set_bloom(old_ih->has_bloom());
+    Transaction txn(INVALID_TXN_ID);
+    try {
+        std::vector<std::pair<std::vector<char>, Rid>> entries;
+        for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+            auto rec = fh->get_record(scan.rid(), context);
+            entries.emplace_back(index.get_key(rec->data), scan.rid());
+        }
+        ih->bulk_load(entries);
+        ih->sync_keys(old_ih, old_ih->take_changed_keys(), &txn);
+
+        if (context != nullptr) {
+            context->lock_mgr_->lock_exclusive_on_table(context->txn_, fh->GetFd());
+        }
+        ih->sync_keys(old_ih, old_ih->take_changed_keys(), &txn);
+    } catch (...) {
+        old_ih->stop_capture();
+        ix_manager_->close_index(ih.get());
+        ix_manager_->destroy_index(rebuild_filename, index.cols);
+        throw;
+    }
+    old_ih->stop_capture();
+
+    // 表上的排他锁使执行器不再使用原来的句柄，ihs_latch_挡住不加表锁的读者
+    std::unique_lock lock(ihs_latch_);
+    ix_manager_->close_index(old_ih);
+    ix_manager_->close_index(ih.get());
+    ix_manager_->replace_with_rebuilt(tab_name, index.cols);
+    ihs_.at(index_name) = ix_manager_->open_index(tab_name, index.cols);
+}
+
+/**
+ * @description: 取得索引的句柄，调用者必须已经持有表上的锁（意向锁即可）：重建索引要对表加排他锁才能替换句柄，
+ * 因此句柄在调用者的事务结束之前一直有效
+ * @param {string&} tab_name 表名称
+ * @param {vector<ColMeta>&} cols 索引包含的字段
+ */
+IxIndexHandle* SmManager::get_index_handle(const std::string& tab_name, const std::vector<ColMeta>& cols) {
+    std::shared_lock lock(ihs_latch_);
+    return ihs_.at(ix_manager_->get_index_name(tab_name, cols)).get();
+}
+
+IxIndexHandle* SmManager::get_index_handle(const std::string& tab_name, const std::vector<std::string>& col_names) {
+    std::shared_lock lock(ihs_latch_);
+    return ihs_.at(ix_manager_->get_index_name(tab_name, col_names)).get();
+}
+
+/**
+ * @description: 启用或关闭索引的Bloom filter（见IxIndexHandle::may_contain），设置保存在索引文件头中
+ * @param {string&} tab_name 表名称
+ * @param {vector<string>&} col_names 索引包含的字段名称
+ * @param {bool} enabled 启用还是关闭
+ * @param {Context*} context
+ */
+void SmManager::set_index_bloom(const std::string& tab_name, const std::vector<std::string>& col_names, bool enabled,
+                                Context* context) {
+    if (!ix_manager_->exists(tab_name, col_names)) {
+        throw IndexNotFoundError(tab_name, col_names);
+    }
+    get_index_handle(tab_name, col_names)->set_bloom(enabled);
+}
+
+/**
+ * @description: 显示索引的统计信息：键值对数量、叶子数量、高度、平均填充率、第一个字段不同取值的数量和直方图的桶数
+ * 没有ANALYZE过的索引，定长格式的B+树用键值对数量和叶子数量估计填充率，其余未收集的项显示为"-"
+ * @param {string&} tab_name 表名称，为空时显示所有表上的索引
+ * @param {Context*} context
+ */
+void SmManager::show_index_stats(const std::string& tab_name, Context* context) {
+    if (!tab_name.empty() && !db_.is_table(tab_name)) {
+        throw TableNotFoundError(tab_name);
+    }
+    std::fstream outfile;
+    outfile.open("output.txt", std::ios::out | std::ios::app);
+    std::vector<std::string> captions = {"Index", "Type", "Keys", "Leaves", "Height", "Fill", "Distinct", "Histogram"};
+    RecordPrinter printer(captions.size());
+    auto output = [&](const std::vector<std::string>& fields) {
+        printer.print_record(fields, context);
+        outfile << "|";
+        for (auto& field : fields) {
+            outfile << " " << field << " |";
+        }
+        outfile << "\n";
+    };
+    printer.print_separator(context);
+    output(captions);
+    printer.print_separator(context);
+    for (auto& [name, tab] : db_.tabs_) {
+        if (!tab_name.empty() && name != tab_name) {
+            continue;
+        }
+        for (auto& index : tab.indexes) {
+            IxFileHdr stats;
+            {
+                // SHOW不加表锁，读取期间挡住重建索引替换句柄
+                std::shared_lock lock(ihs_latch_);
+                stats = ihs_.at(ix_manager_->get_index_name(name, index.cols))->get_stats();
+            }
+            std::string index_name = name + "(";
+            for (size_t i = 0; i < index.cols.size(); i++) {
+                index_name += (i == 0 ? "" : ",") + index.cols[i].name;
+            }
+            index_name += ")";
+            std::string type = indextype2str(index.type) + (index.unique ? " UNIQUE" : "");
+
+            // 哈希索引的桶页面数量只由ANALYZE INDEX得到
+            bool has_leaves = stats.analyzed_ || index.type != INDEX_HASH;
+            double fill = stats.avg_fill_;
+            bool has_fill = stats.analyzed_;
+            if (!has_fill && index.type != INDEX_HASH && !stats.compressed_) {
+                fill = static_cast<double>(stats.num_keys_) / stats.num_leaves_ / stats.btree_order_;
+                has_fill = true;
+            }
+            char fill_buf[16];
+            snprintf(fill_buf, sizeof(fill_buf), "%.1f%%", fill * 100);
+
+            output({index_name, type, std::to_string(stats.num_keys_),
+                    has_leaves ? std::to_string(stats.num_leaves_) : "-", std::to_string(stats.height_),
+                    has_fill ? fill_buf : "-",
+                    stats.analyzed_ ? std::to_string(stats.distinct_keys_) : "-",
+                    stats.analyzed_ ? std::to_string(stats.num_hist_buckets_) : "-"});
+        }
+    }
+    printer.print_separator(context);
+    outfile.close();
+}
+
+/**
+ * @description: 显示启用了Bloom filter的索引的filter大小、查询次数、省去的查找次数和误判率
+ * 误判率为误判次数占所有不存在的key的查询次数的比例，计数从索引打开时开始累计
+ * @param {string&} tab_name 表名称，为空时显示所有表上的索引
+ * @param {Context*} context
+ */
+void SmManager::show_bloom_stats(const std::string& tab_name, Context* context) {
+    if (!tab_name.empty() && !db_.is_table(tab_name)) {
+        throw TableNotFoundError(tab_name);
+    }
+    std::fstream outfile;
+    outfile.open("output.txt", std::ios::out | std::ios::app);
+    std::vector<std::string> captions = {"Index", "Bits", "Keys", "Lookups", "Skipped", "False positives", "FP rate"};
+    RecordPrinter printer(captions.size());
+    auto output = [&](const std::vector<std::string>& fields) {
+        printer.print_record(fields, context);
+        outfile << "|";
+        for (auto& field : fields) {
+            outfile << " " << field << " |";
+        }
+        outfile << "\n";
+    };
+    printer.print_separator(context);
+    output(captions);
+    printer.print_separator(context);
+    for (auto& [name, tab] : db_.tabs_) {
+        if (!tab_name.empty() && name != tab_name) {
+            continue;
+        }
+        for (auto& index : tab.indexes) {
+            IxBloomStats stats;
+            {
+                std::shared_lock lock(ihs_latch_);
+                stats = ihs_.at(ix_manager_->get_index_name(name, index.cols))->get_bloom_stats();
+            }
+            if (!stats.enabled) {
+                continue;
+            }
+            std::string index_name = name + "(";
+            for (size_t i = 0; i < index.cols.size(); i++) {
+                index_name += (i == 0 ? "" : ",") + index.cols[i].name;
+            }
+            index_name += ")";
+            int64_t absent = stats.negatives + stats.false_positives;
+            char rate_buf[16];
+            snprintf(rate_buf, sizeof(rate_buf), "%.2f%%", absent == 0 ? 0 : 100.0 * stats.false_positives / absent);
+
+            output({index_name, std::to_string(stats.num_bits), std::to_string(stats.num_keys),
+                    std::to_string(stats.lookups), std::to_string(stats.negatives),
+                    std::to_string(stats.false_positives), absent == 0 ? "-" : rate_buf});
+        }
+    }
+    printer.print_separator(context);
+    outfile.close();
+}
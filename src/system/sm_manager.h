@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <shared_mutex>
+
 #include "index/ix.h"
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
@@ -30,6 +32,9 @@ class SmManager {
     DbMeta db_;             // 当前打开的数据库的元数据
     std::unordered_map<std::string, std::unique_ptr<RmFileHandle>> fhs_;    // file name -> record file handle, 当前数据库中每张表的数据文件
     std::unordered_map<std::string, std::unique_ptr<IxIndexHandle>> ihs_;   // file name -> index file handle, 当前数据库中每个索引的文件
+    // 保护ihs_：增删索引和重建索引替换句柄时加写锁；执行器在表锁的保护下通过get_index_handle取得句柄，
+    // 不加表锁的读者（如planner读取统计信息）在使用句柄期间一直持有读锁
+    std::shared_mutex ihs_latch_;
    private:
     DiskManager* disk_manager_;
     BufferPoolManager* buffer_pool_manager_;
@@ -48,6 +53,8 @@ class SmManager {
 
     BufferPoolManager* get_bpm() { return buffer_pool_manager_; }
 
+    DiskManager* get_disk_manager() { return disk_manager_; }
+
     RmManager* get_rm_manager() { return rm_manager_; }  
 
     IxManager* get_ix_manager() { return ix_manager_; }  
@@ -72,9 +79,25 @@ class SmManager {
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      IndexType index_type = INDEX_BTREE, bool unique = false);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+    void analyze_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+
+    void rebuild_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+
+    void set_index_bloom(const std::string& tab_name, const std::vector<std::string>& col_names, bool enabled,
+                         Context* context);
+
+    void show_index_stats(const std::string& tab_name, Context* context);
+
+    void show_bloom_stats(const std::string& tab_name, Context* context);
+
+    IxIndexHandle* get_index_handle(const std::string& tab_name, const std::vector<ColMeta>& cols);
+
+    IxIndexHandle* get_index_handle(const std::string& tab_name, const std::vector<std::string>& col_names);
 };
\ No newline at end of file
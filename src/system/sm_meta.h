@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <string>
@@ -47,13 +48,28 @@ struct IndexMeta {
     int col_tot_len;            // 索引字段长度总和
     size_t col_num;             // 索引字段数量
     std::vector<ColMeta> cols;  // 索引包含的字段
+    IndexType type;             // 索引的实现方式
+    bool unique;                // 是否为唯一索引
 
     IndexMeta() {}
-    IndexMeta(const std::string &tab_name, const std::vector<ColMeta> &cols, int col_tot_len, size_t col_num)
-        : tab_name(tab_name), col_tot_len(col_tot_len), col_num(col_num), cols(cols) {}
+    IndexMeta(const std::string &tab_name, const std::vector<ColMeta> &cols, int col_tot_len, size_t col_num,
+              IndexType type = INDEX_BTREE, bool unique = false)
+        : tab_name(tab_name), col_tot_len(col_tot_len), col_num(col_num), cols(cols), type(type), unique(unique) {}
+
+    // 从一条记录中取出索引包含的字段，拼接成索引的key
+    std::vector<char> get_key(const char *rec) const {
+        std::vector<char> key(col_tot_len);
+        int offset = 0;
+        for (const auto &col : cols) {
+            memcpy(key.data() + offset, rec + col.offset, col.len);
+            offset += col.len;
+        }
+        return key;
+    }
 
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
-        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
+        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num << " " << index.type << " "
+           << index.unique;
         for (auto &col : index.cols) {
             os << "\n" << col;
         }
@@ -66,7 +82,7 @@ struct IndexMeta {
     }
 
     friend std::istream &operator>>(std::istream &is, IndexMeta &index) {
-        is >> index.tab_name >> index.col_tot_len >> index.col_num;
+        is >> index.tab_name >> index.col_tot_len >> index.col_num >> index.type >> index.unique;
         for (size_t i = 0; i < index.col_num; ++i) {
             ColMeta col;
             is >> col;
@@ -0,0 +1,152 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "execution/execution_predicate.h"
+#include "index/ix.h"
+
+/** 元组的字段为(a int, b float, c char(4), d int)，共16字节；
+ * 对照组用ix_compare逐个条件求值，与编译后的谓词的结果比较 */
+class CompiledPredicateTest : public ::testing::Test {
+   public:
+    static constexpr int rec_len = 16;
+
+    std::vector<ColMeta> cols_ = {
+        {.tab_name = "t", .name = "a", .type = TYPE_INT, .len = 4, .offset = 0, .index = false},
+        {.tab_name = "t", .name = "b", .type = TYPE_FLOAT, .len = 4, .offset = 4, .index = false},
+        {.tab_name = "t", .name = "c", .type = TYPE_STRING, .len = 4, .offset = 8, .index = false},
+        {.tab_name = "t", .name = "d", .type = TYPE_INT, .len = 4, .offset = 12, .index = false},
+    };
+    std::mt19937 rng_{20231018};
+
+    // 取值范围很小，使各种运算符都有相当比例的元组满足
+    void RandomRecord(char *rec) {
+        *reinterpret_cast<int *>(rec) = static_cast<int>(rng_() % 7) - 3;
+        *reinterpret_cast<float *>(rec + 4) = (static_cast<int>(rng_() % 7) - 3) / 2.0f;
+        for (int i = 0; i < 4; i++) {
+            rec[8 + i] = static_cast<char>('a' + rng_() % 3);
+        }
+        *reinterpret_cast<int *>(rec + 12) = static_cast<int>(rng_() % 7) - 3;
+    }
+
+    Condition RandomCond(const std::vector<ColMeta> &cols) {
+        const ColMeta &col = cols[rng_() % cols.size()];
+        Condition cond{.lhs_col = {col.tab_name, col.name}, .op = static_cast<CompOp>(rng_() % 6)};
+        // 一半与常量比较，一半与同类型的另一个字段比较
+        if (rng_() % 2 == 0) {
+            cond.is_rhs_val = true;
+            char buf[rec_len];
+            RandomRecord(buf);
+            if (col.type == TYPE_INT) {
+                cond.rhs_val.set_int(*reinterpret_cast<int *>(buf + 12));
+            } else if (col.type == TYPE_FLOAT) {
+                cond.rhs_val.set_float(*reinterpret_cast<float *>(buf + 4));
+            } else {
+                cond.rhs_val.set_str(std::string(buf + 8, 4));
+            }
+            cond.rhs_val.init_raw(col.len);
+        } else {
+            cond.is_rhs_val = false;
+            std::vector<ColMeta> same_type;
+            for (auto &other : cols) {
+                if (other.type == col.type) {
+                    same_type.push_back(other);
+                }
+            }
+            const ColMeta &rhs = same_type[rng_() % same_type.size()];
+            cond.rhs_col = {rhs.tab_name, rhs.name};
+        }
+        return cond;
+    }
+
+    static bool Reference(const std::vector<Condition> &conds, const std::vector<ColMeta> &cols, const char *rec) {
+        auto find = [&](const TabCol &target) {
+            return *std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) {
+                return col.tab_name == target.tab_name && col.name == target.col_name;
+            });
+        };
+        for (auto &cond : conds) {
+            ColMeta lhs = find(cond.lhs_col);
+            const char *rhs = cond.is_rhs_val ? cond.rhs_val.raw->data : rec + find(cond.rhs_col).offset;
+            int cmp = ix_compare(rec + lhs.offset, rhs, lhs.type, lhs.len);
+            bool ok = (cond.op == OP_EQ && cmp == 0) || (cond.op == OP_NE && cmp != 0) ||
+                      (cond.op == OP_LT && cmp < 0) || (cond.op == OP_GT && cmp > 0) ||
+                      (cond.op == OP_LE && cmp <= 0) || (cond.op == OP_GE && cmp >= 0);
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief 单个元组和批量过滤：随机生成的条件组合上，编译后的谓词与逐个条件调用ix_compare的结果相同
+ */
+TEST_F(CompiledPredicateTest, EvalAndFilterTest) {
+    for (int round = 0; round < 200; round++) {
+        std::vector<Condition> conds;
+        int num_conds = static_cast<int>(rng_() % 4);
+        for (int i = 0; i < num_conds; i++) {
+            conds.push_back(RandomCond(cols_));
+        }
+        CompiledPredicate pred(conds, cols_);
+        EXPECT_EQ(pred.empty(), conds.empty());
+
+        DataChunk chunk(rec_len);
+        std::vector<bool> expected;
+        while (!chunk.is_full()) {
+            char *rec = chunk.append();
+            RandomRecord(rec);
+            expected.push_back(Reference(conds, cols_, rec));
+            ASSERT_EQ(pred.eval(rec), expected.back()) << "round " << round;
+        }
+        std::vector<std::string> kept;
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (expected[i]) {
+                kept.emplace_back(chunk.row(i), rec_len);
+            }
+        }
+        pred.filter(chunk);
+        ASSERT_EQ(chunk.count(), kept.size()) << "round " << round;
+        for (size_t i = 0; i < chunk.count(); i++) {
+            ASSERT_EQ(std::string(chunk.row(i), rec_len), kept[i]);
+        }
+    }
+}
+
+/**
+ * @brief 连接条件：拼接后的字段偏移按split拆分到左右两个元组，分别传入求值与拼接后求值的结果相同
+ */
+TEST_F(CompiledPredicateTest, JoinTest) {
+    std::vector<ColMeta> join_cols = cols_;
+    for (auto col : cols_) {
+        col.tab_name = "s";
+        col.offset += rec_len;
+        join_cols.push_back(col);
+    }
+    for (int round = 0; round < 200; round++) {
+        std::vector<Condition> conds;
+        for (int i = 0; i < 3; i++) {
+            conds.push_back(RandomCond(join_cols));
+        }
+        CompiledPredicate pred(conds, join_cols, rec_len);
+        char joined[rec_len * 2];
+        RandomRecord(joined);
+        RandomRecord(joined + rec_len);
+        ASSERT_EQ(pred.eval(joined, joined + rec_len), Reference(conds, join_cols, joined)) << "round " << round;
+    }
+
+    Condition missing{.lhs_col = {"t", "x"}, .op = OP_EQ, .is_rhs_val = false, .rhs_col = {"t", "a"}};
+    EXPECT_THROW(CompiledPredicate({missing}, cols_), ColumnNotFoundError);
+}
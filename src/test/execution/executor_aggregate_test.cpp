@@ -0,0 +1,315 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <set>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_delete.h"
+#include "execution/executor_hash_aggregate.h"
+#include "execution/executor_index_min_max.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_stream_aggregate.h"
+#include "operator_test_util.h"
+
+class ExecutorAggregateTest : public OperatorTest {
+   public:
+    ExecutorAggregateTest() : OperatorTest("ExecutorAggregateTest_db") {}
+
+    /**
+     * @brief 检查聚集的输出：每个输出元组的分组key恰好对应输入中的一组，没有遗漏的组，
+     * 每个聚集函数的结果与直接在这一组的输入元组上计算的结果相同
+     */
+    static void CheckResult(const std::vector<std::string> &rows, const std::vector<std::string> &input,
+                            const std::vector<ColMeta> &in_cols, const std::vector<TabCol> &group_cols,
+                            const std::vector<AggExpr> &aggs, const std::vector<ColMeta> &out_cols) {
+        auto find_col = [&](const TabCol &target) {
+            return *std::find_if(in_cols.begin(), in_cols.end(),
+                                 [&](const ColMeta &col) { return col.name == target.col_name; });
+        };
+        auto group_key = [&](const char *rec, bool is_output) {
+            std::string key;
+            size_t offset = 0;
+            for (auto &group_col : group_cols) {
+                auto col = find_col(group_col);
+                std::string val(rec + (is_output ? offset : col.offset), col.len);
+                if (col.type == TYPE_FLOAT && *reinterpret_cast<const float *>(val.data()) == 0.0f) {
+                    EXPECT_TRUE(!is_output || !std::signbit(*reinterpret_cast<const float *>(val.data())));
+                    *reinterpret_cast<float *>(&val[0]) = 0.0f;
+                }
+                key += val;
+                offset += col.len;
+            }
+            return key;
+        };
+        std::map<std::string, std::vector<const char *>> groups;
+        for (auto &rec : input) {
+            groups[group_key(rec.data(), false)].push_back(rec.data());
+        }
+        if (group_cols.empty()) {
+            groups[""];  // 没有分组字段时输入为空也输出一行
+        }
+        ASSERT_EQ(rows.size(), groups.size());
+        std::set<std::string> seen;
+        for (auto &row : rows) {
+            std::string key = group_key(row.data(), true);
+            ASSERT_TRUE(seen.insert(key).second) << "duplicate group";
+            ASSERT_EQ(groups.count(key), 1u);
+            auto &recs = groups[key];
+            for (size_t i = 0; i < aggs.size(); i++) {
+                auto &out_col = out_cols[group_cols.size() + i];
+                EXPECT_EQ(out_col.name, aggs[i].name);
+                const char *out = row.data() + out_col.offset;
+                if (aggs[i].type == AGG_COUNT) {
+                    EXPECT_EQ(*reinterpret_cast<const int *>(out), static_cast<int>(recs.size()));
+                    continue;
+                }
+                auto col = find_col(aggs[i].col);
+                if (aggs[i].type == AGG_MIN || aggs[i].type == AGG_MAX) {
+                    std::string expected(col.len, '\0');
+                    for (size_t r = 0; r < recs.size(); r++) {
+                        int cmp = ix_compare(recs[r] + col.offset, expected.data(), col.type, col.len);
+                        if (r == 0 || (aggs[i].type == AGG_MIN ? cmp < 0 : cmp > 0)) {
+                            expected.assign(recs[r] + col.offset, col.len);
+                        }
+                    }
+                    EXPECT_EQ(ix_compare(out, expected.data(), col.type, col.len), 0) << aggs[i].name;
+                    continue;
+                }
+                double sum = 0;
+                for (auto rec : recs) {
+                    sum += col.type == TYPE_INT ? *reinterpret_cast<const int *>(rec + col.offset)
+                                                : *reinterpret_cast<const float *>(rec + col.offset);
+                }
+                if (aggs[i].type == AGG_SUM && col.type == TYPE_INT) {
+                    EXPECT_EQ(*reinterpret_cast<const int *>(out), static_cast<int>(sum)) << aggs[i].name;
+                } else {
+                    double expected = aggs[i].type == AGG_SUM ? sum : (recs.empty() ? 0 : sum / recs.size());
+                    double tolerance = 1e-4 * std::max(1.0, std::abs(expected));
+                    EXPECT_NEAR(*reinterpret_cast<const float *>(out), expected, tolerance) << aggs[i].name;
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @brief 哈希聚集的结果正确：按int、float（含+0和-0）、字符串以及多个字段分组，没有分组字段，
+ * 全部在内存中、组放不下时写出分区、每一层都放不下直到最后一层，以及空输入
+ */
+TEST_F(ExecutorAggregateTest, HashAggregateTest) {
+    CreateTable("t", SignedKeys(20000, 3000));
+    CreateTable("e", {});
+    struct Case {
+        std::vector<TabCol> group_cols;
+        std::vector<AggExpr> aggs;
+    };
+    const std::vector<Case> cases = {
+        {{{"t", "s"}},
+         {{AGG_COUNT, {"", "*"}, "COUNT(*)"},
+          {AGG_SUM, {"t", "k"}, "SUM(k)"},
+          {AGG_AVG, {"t", "k"}, "AVG(k)"},
+          {AGG_MIN, {"t", "f"}, "MIN(f)"},
+          {AGG_MAX, {"t", "id"}, "MAX(id)"}}},
+        {{{"t", "f"}},
+         {{AGG_COUNT, {"t", "id"}, "COUNT(id)"},
+          {AGG_MIN, {"t", "s"}, "MIN(s)"},
+          {AGG_MAX, {"t", "k"}, "MAX(k)"},
+          {AGG_SUM, {"t", "f"}, "SUM(f)"}}},
+        {{{"t", "k"}, {"t", "s"}}, {{AGG_AVG, {"t", "f"}, "AVG(f)"}, {AGG_MAX, {"t", "s"}, "MAX(s)"}}},
+        {{{"t", "k"}}, {}},
+        {{},
+         {{AGG_COUNT, {"", "*"}, "COUNT(*)"},
+          {AGG_SUM, {"t", "k"}, "SUM(k)"},
+          {AGG_MIN, {"t", "k"}, "MIN(k)"},
+          {AGG_MAX, {"t", "f"}, "MAX(f)"},
+          {AGG_AVG, {"t", "f"}, "AVG(f)"}}},
+    };
+    // 第二种内存上限下只有一部分组在内存中，第三种下每一层都放不下一个组，分区到最后一层才在内存中聚集
+    const std::vector<size_t> budgets = {QUERY_MEMORY_BUDGET, 16 * 1024, 1};
+    auto input = RunBatch(Scan("t").get());
+    auto in_cols = Scan("t")->cols();
+    for (size_t c = 0; c < cases.size(); c++) {
+        for (size_t budget : budgets) {
+            SCOPED_TRACE("case " + std::to_string(c) + " budget " + std::to_string(budget));
+            HashAggregateExecutor agg(sm_manager_.get(), Scan("t"), cases[c].group_cols, cases[c].aggs, budget);
+            for (bool batch : {true, false}) {
+                auto rows = batch ? RunBatch(&agg) : RunTuple(&agg);
+                CheckResult(rows, input, in_cols, cases[c].group_cols, cases[c].aggs, agg.cols());
+            }
+        }
+        std::vector<TabCol> empty_group_cols = cases[c].group_cols;
+        std::vector<AggExpr> empty_aggs = cases[c].aggs;
+        for (auto &col : empty_group_cols) {
+            col.tab_name = "e";
+        }
+        for (auto &agg : empty_aggs) {
+            agg.col.tab_name = agg.col.col_name == "*" ? "" : "e";
+        }
+        HashAggregateExecutor empty_agg(sm_manager_.get(), Scan("e"), empty_group_cols, empty_aggs);
+        for (bool batch : {true, false}) {
+            auto rows = batch ? RunBatch(&empty_agg) : RunTuple(&empty_agg);
+            CheckResult(rows, {}, in_cols, cases[c].group_cols, cases[c].aggs, empty_agg.cols());
+        }
+    }
+}
+
+/**
+ * @brief 流式聚集的结果正确：输入是按索引(k, s)有序的索引扫描，按k、按(s, k)分组，没有分组字段，以及空输入
+ */
+TEST_F(ExecutorAggregateTest, StreamAggregateTest) {
+    CreateTable("t", SignedKeys(20000, 3000));
+    CreateTable("e", {});
+    const std::vector<std::string> index_col_names = {"k", "s"};
+    sm_manager_->create_index("t", index_col_names, context_.get());
+    sm_manager_->create_index("e", index_col_names, context_.get());
+    struct Case {
+        std::vector<TabCol> group_cols;
+        std::vector<AggExpr> aggs;
+    };
+    const std::vector<Case> cases = {
+        {{{"", "k"}},
+         {{AGG_COUNT, {"", "*"}, "COUNT(*)"},
+          {AGG_SUM, {"", "f"}, "SUM(f)"},
+          {AGG_MIN, {"", "s"}, "MIN(s)"},
+          {AGG_MAX, {"", "id"}, "MAX(id)"}}},
+        {{{"", "s"}, {"", "k"}}, {{AGG_AVG, {"", "id"}, "AVG(id)"}, {AGG_MAX, {"", "f"}, "MAX(f)"}}},
+        {{},
+         {{AGG_COUNT, {"", "*"}, "COUNT(*)"},
+          {AGG_SUM, {"", "k"}, "SUM(k)"},
+          {AGG_MIN, {"", "f"}, "MIN(f)"},
+          {AGG_AVG, {"", "f"}, "AVG(f)"}}},
+    };
+    for (const std::string tab_name : {"t", "e"}) {
+        auto input = RunBatch(Scan(tab_name).get());
+        auto in_cols = Scan(tab_name)->cols();
+        for (size_t c = 0; c < cases.size(); c++) {
+            SCOPED_TRACE("table " + tab_name + " case " + std::to_string(c));
+            std::vector<TabCol> group_cols = cases[c].group_cols;
+            std::vector<AggExpr> aggs = cases[c].aggs;
+            for (auto &col : group_cols) {
+                col.tab_name = tab_name;
+            }
+            for (auto &agg : aggs) {
+                agg.col.tab_name = agg.col.col_name == "*" ? "" : tab_name;
+            }
+            auto scan = std::make_unique<IndexScanExecutor>(sm_manager_.get(), tab_name, std::vector<Condition>{},
+                                                            index_col_names, context_.get());
+            StreamAggregateExecutor agg(std::move(scan), group_cols, aggs);
+            for (bool batch : {true, false}) {
+                auto rows = batch ? RunBatch(&agg) : RunTuple(&agg);
+                CheckResult(rows, input, in_cols, group_cols, aggs, agg.cols());
+            }
+        }
+    }
+}
+
+/**
+ * @brief 用索引求MIN/MAX的结果正确：int、多字段索引的第一个float字段、字符串，
+ * 删除最小和最大的一部分元组之后，删除全部元组之后，以及空表
+ */
+TEST_F(ExecutorAggregateTest, IndexMinMaxTest) {
+    CreateTable("t", SignedKeys(20000, 3000));
+    CreateTable("e", {});
+    const std::vector<std::vector<std::string>> index_col_names = {{"k"}, {"k"}, {"f", "id"}, {"f", "id"},
+                                                                   {"s"}, {"s"}};
+    for (const std::string tab_name : {"t", "e"}) {
+        for (size_t i = 0; i < index_col_names.size(); i += 2) {
+            sm_manager_->create_index(tab_name, index_col_names[i], context_.get());
+        }
+    }
+    auto check = [&](const std::string &tab_name) {
+        SCOPED_TRACE("table " + tab_name);
+        const std::vector<AggExpr> aggs = {{AGG_MIN, {tab_name, "k"}, "MIN(k)"}, {AGG_MAX, {tab_name, "k"}, "MAX(k)"},
+                                           {AGG_MIN, {tab_name, "f"}, "MIN(f)"}, {AGG_MAX, {tab_name, "f"}, "MAX(f)"},
+                                           {AGG_MIN, {tab_name, "s"}, "MIN(s)"}, {AGG_MAX, {tab_name, "s"}, "MAX(s)"}};
+        auto input = RunBatch(Scan(tab_name).get());
+        IndexMinMaxExecutor agg(sm_manager_.get(), tab_name, aggs, index_col_names, context_.get());
+        for (bool batch : {true, false}) {
+            auto rows = batch ? RunBatch(&agg) : RunTuple(&agg);
+            CheckResult(rows, input, Scan(tab_name)->cols(), {}, aggs, agg.cols());
+        }
+    };
+    auto delete_where = [&](const std::string &tab_name, const std::function<bool(int)> &pred) {
+        std::vector<Rid> rids;
+        auto scan = Scan(tab_name);
+        for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
+            if (pred(*reinterpret_cast<const int *>(scan->Next()->data + 4))) {
+                rids.push_back(scan->rid());
+            }
+        }
+        DeleteExecutor(sm_manager_.get(), tab_name, {}, rids, context_.get()).Next();
+    };
+    check("t");
+    check("e");
+    // 删除之后首尾叶子中的key变少，最大值可能不在原来的位置
+    delete_where("t", [](int k) { return k < -2900 || k >= 2500; });
+    check("t");
+    delete_where("t", [](int) { return true; });
+    check("t");
+}
+
+/**
+ * @brief 哈希聚集基准测试：默认内存上限下对10M个元组按取值个数不同的int字段分组，
+ * 组数最多的一种放不进内存、需要写出分区，输出每秒聚集的元组数
+ */
+TEST_F(ExecutorAggregateTest, DISABLED_HashAggregateBenchmark) {
+    const size_t num_rows = 10000000;
+    const std::vector<AggExpr> aggs = {{AGG_COUNT, {"", "*"}, "COUNT(*)"},
+                                       {AGG_SUM, {"g", "id"}, "SUM(id)"},
+                                       {AGG_MAX, {"g", "f"}, "MAX(f)"}};
+    for (int domain : {16, 1 << 10, 1 << 20, 1 << 30}) {
+        HashAggregateExecutor agg(sm_manager_.get(), std::make_unique<GeneratorExecutor>(num_rows, domain),
+                                  {{"g", "k"}}, aggs);
+        auto start = std::chrono::steady_clock::now();
+        size_t num_groups = 0;
+        int64_t total = 0;
+        DataChunk chunk;
+        for (agg.beginBatch(); agg.NextBatch(chunk);) {
+            num_groups += chunk.count();
+            for (size_t i = 0; i < chunk.count(); i++) {
+                total += *reinterpret_cast<const int *>(chunk.row(i) + 4);
+            }
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_EQ(total, static_cast<int64_t>(num_rows));
+        printf("[ bench    ] hash aggregate %zu rows into %9zu groups %9.2f ms %12.0f rows/s\n", num_rows,
+               num_groups, secs * 1000, num_rows / secs);
+    }
+}
+
+/**
+ * @brief 用索引求MAX的基准测试：与顺序扫描之后哈希聚集比较，输出各自的耗时
+ */
+TEST_F(ExecutorAggregateTest, DISABLED_IndexMinMaxBenchmark) {
+    const int num_rows = 1000000;
+    CreateTable("big", SignedKeys(num_rows, 1 << 30));
+    sm_manager_->create_index("big", {"id"}, context_.get());
+    const std::vector<AggExpr> aggs = {{AGG_MAX, {"big", "id"}, "MAX(id)"}};
+    auto time_max = [&](AbstractExecutor *exec) {
+        auto start = std::chrono::steady_clock::now();
+        auto rows = RunBatch(exec);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_EQ(rows.size(), 1u);
+        EXPECT_EQ(*reinterpret_cast<const int *>(rows[0].data()), num_rows - 1);
+        return secs;
+    };
+    IndexMinMaxExecutor index_max(sm_manager_.get(), "big", aggs, {{"id"}}, context_.get());
+    HashAggregateExecutor scan_max(sm_manager_.get(), Scan("big"), {}, aggs);
+    double index_secs = time_max(&index_max);
+    double scan_secs = time_max(&scan_max);
+    printf("[ bench    ] max over %d rows: index %9.3f ms, scan + aggregate %9.3f ms\n", num_rows,
+           index_secs * 1000, scan_secs * 1000);
+}
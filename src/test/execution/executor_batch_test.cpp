@@ -0,0 +1,272 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_index_scan.h"
+#include "execution/executor_nestedloop_join.h"
+#include "execution/executor_projection.h"
+#include "execution/executor_seq_scan.h"
+
+const std::string TEST_DB_NAME = "ExecutorBatchTest_db";  // 以数据库名作为根目录
+
+/** 每个测试点创建一个新的数据库，表t(id int, grp int, val float, name char(16))中有key_num条记录，
+ * id依次为0..key_num-1，grp = id % 100，val = id / 2.0，name为"name" + id % 1000 */
+class ExecutorBatchTest : public ::testing::Test {
+   public:
+    static constexpr int key_num = 100000;
+
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get());
+
+        if (sm_manager_->is_dir(TEST_DB_NAME)) {
+            sm_manager_->drop_db(TEST_DB_NAME);
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        sm_manager_->create_table("t", {{"id", TYPE_INT, 4}, {"grp", TYPE_INT, 4}, {"val", TYPE_FLOAT, 4},
+                                        {"name", TYPE_STRING, 16}}, context_.get());
+        auto fh = sm_manager_->fhs_.at("t").get();
+        char buf[28] = {};
+        for (int i = 0; i < key_num; i++) {
+            *reinterpret_cast<int *>(buf) = i;
+            *reinterpret_cast<int *>(buf + 4) = i % 100;
+            *reinterpret_cast<float *>(buf + 8) = i / 2.0f;
+            memset(buf + 12, 0, 16);
+            snprintf(buf + 12, 16, "name%d", i % 1000);
+            fh->insert_record(buf, context_.get());
+        }
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+        sm_manager_->drop_db(TEST_DB_NAME);
+    }
+
+    static Condition MakeCond(const std::string &col_name, CompOp op, Value val, int len) {
+        Condition cond{.lhs_col = {"t", col_name}, .op = op, .is_rhs_val = true};
+        cond.rhs_val = std::move(val);
+        cond.rhs_val.init_raw(len);
+        return cond;
+    }
+
+    static Value IntValue(int v) {
+        Value val;
+        val.set_int(v);
+        return val;
+    }
+
+    static Value StrValue(const std::string &v) {
+        Value val;
+        val.set_str(v);
+        return val;
+    }
+
+    // 逐元组执行，返回排序后的结果
+    static std::vector<std::string> RunTuple(AbstractExecutor *exec) {
+        std::vector<std::string> rows;
+        for (exec->beginTuple(); !exec->is_end(); exec->nextTuple()) {
+            auto rec = exec->Next();
+            rows.emplace_back(rec->data, exec->tupleLen());
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    // 批量执行，返回排序后的结果
+    static std::vector<std::string> RunBatch(AbstractExecutor *exec) {
+        std::vector<std::string> rows;
+        DataChunk chunk;
+        for (exec->beginBatch(); exec->NextBatch(chunk);) {
+            EXPECT_GT(chunk.count(), 0);
+            EXPECT_LE(chunk.count(), CHUNK_CAPACITY);
+            for (size_t i = 0; i < chunk.count(); i++) {
+                rows.emplace_back(chunk.row(i), exec->tupleLen());
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+};
+
+/* 只实现逐元组接口的算子，用来检查NextBatch的默认实现 */
+class ValuesExecutor : public AbstractExecutor {
+   private:
+    std::vector<ColMeta> cols_;
+    int num_;
+    int pos_ = 0;
+
+   public:
+    explicit ValuesExecutor(int num) : num_(num) {
+        cols_ = {{.tab_name = "v", .name = "x", .type = TYPE_INT, .len = sizeof(int), .offset = 0, .index = false}};
+    }
+
+    size_t tupleLen() const override { return sizeof(int); }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    void beginTuple() override { pos_ = 0; }
+
+    void nextTuple() override { pos_++; }
+
+    bool is_end() const override { return pos_ >= num_; }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    std::unique_ptr<RmRecord> Next() override {
+        auto rec = std::make_unique<RmRecord>(sizeof(int));
+        *reinterpret_cast<int *>(rec->data) = pos_;
+        return rec;
+    }
+};
+
+/**
+ * @brief 默认的NextBatch把逐元组接口适配成批量接口：每个chunk最多CHUNK_CAPACITY个元组，元组顺序不变
+ */
+TEST_F(ExecutorBatchTest, AdaptorTest) {
+    const int num = CHUNK_CAPACITY * 2 + 7;
+    ValuesExecutor exec(num);
+    DataChunk chunk;
+    std::vector<size_t> counts;
+    int expected = 0;
+    for (exec.beginBatch(); exec.NextBatch(chunk);) {
+        counts.push_back(chunk.count());
+        for (size_t i = 0; i < chunk.count(); i++) {
+            ASSERT_EQ(*reinterpret_cast<const int *>(chunk.row(i)), expected++);
+        }
+    }
+    EXPECT_EQ(counts, (std::vector<size_t>{CHUNK_CAPACITY, CHUNK_CAPACITY, 7}));
+    EXPECT_FALSE(exec.NextBatch(chunk));
+    EXPECT_EQ(chunk.count(), 0);
+
+    // 投影的儿子节点没有原生批量实现时，同样通过默认实现批量执行
+    ProjectionExecutor proj(std::make_unique<ValuesExecutor>(num), {{"v", "x"}});
+    EXPECT_EQ(RunBatch(&proj).size(), num);
+}
+
+/**
+ * @brief scan-filter-project基准查询：同一个查询分别逐元组执行和批量执行，结果必须相同，并输出每秒处理的元组数
+ */
+TEST_F(ExecutorBatchTest, DISABLED_ScanFilterProjectBenchmark) {
+    sm_manager_->create_index("t", {"id"}, context_.get());
+    struct Query {
+        std::string name;
+        bool use_index;
+        std::vector<Condition> conds;
+        std::vector<TabCol> sel_cols;
+        size_t scanned_rows;   // 扫描经过的元组数，用来计算吞吐量
+        size_t expected_rows;  // 满足条件的元组数
+    };
+    std::vector<Query> queries = {
+        {"full scan", false, {}, {{"t", "id"}, {"t", "grp"}, {"t", "val"}, {"t", "name"}}, key_num, key_num},
+        {"grp = 7", false, {MakeCond("grp", OP_EQ, IntValue(7), 4)}, {{"t", "id"}}, key_num, key_num / 100},
+        {"grp < 50 and name <> 'name0'", false,
+         {MakeCond("grp", OP_LT, IntValue(50), 4), MakeCond("name", OP_NE, StrValue("name0"), 16)},
+         {{"t", "name"}, {"t", "id"}}, key_num, key_num / 2 - key_num / 1000},
+        {"index id >= 50000", true, {MakeCond("id", OP_GE, IntValue(50000), 4)}, {{"t", "val"}}, 50000, 50000},
+        {"index id < 30000 and grp = 3", true,
+         {MakeCond("id", OP_LT, IntValue(30000), 4), MakeCond("grp", OP_EQ, IntValue(3), 4)}, {{"t", "id"}}, 30000,
+         300},
+    };
+    const int rounds = 3;
+    for (auto &query : queries) {
+        SCOPED_TRACE(query.name);
+        auto make_plan = [&]() -> std::unique_ptr<AbstractExecutor> {
+            std::unique_ptr<AbstractExecutor> scan;
+            if (query.use_index) {
+                scan = std::make_unique<IndexScanExecutor>(sm_manager_.get(), "t", query.conds,
+                                                           std::vector<std::string>{"id"}, context_.get());
+            } else {
+                scan = std::make_unique<SeqScanExecutor>(sm_manager_.get(), "t", query.conds, context_.get());
+            }
+            return std::make_unique<ProjectionExecutor>(std::move(scan), query.sel_cols);
+        };
+        std::vector<std::string> tuple_rows;
+        std::vector<std::string> batch_rows;
+        double tuple_secs = 0;
+        double batch_secs = 0;
+        for (int round = 0; round < rounds; round++) {
+            auto start = std::chrono::steady_clock::now();
+            tuple_rows = RunTuple(make_plan().get());
+            auto mid = std::chrono::steady_clock::now();
+            batch_rows = RunBatch(make_plan().get());
+            auto end = std::chrono::steady_clock::now();
+            tuple_secs += std::chrono::duration<double>(mid - start).count();
+            batch_secs += std::chrono::duration<double>(end - mid).count();
+        }
+        ASSERT_EQ(tuple_rows.size(), query.expected_rows);
+        ASSERT_EQ(batch_rows, tuple_rows);
+        double scanned = static_cast<double>(query.scanned_rows) * rounds;
+        printf("[ bench    ] %-30s scanned %6zu  output %6zu  tuple %10.0f rows/s  batch %10.0f rows/s  %.2fx\n",
+               query.name.c_str(), query.scanned_rows, query.expected_rows, scanned / tuple_secs, scanned / batch_secs,
+               tuple_secs / batch_secs);
+    }
+}
+
+/**
+ * @brief 批量的nested loop join：连接结果跨越多个chunk时能从上次的位置继续，与逐个计算的结果相同
+ */
+TEST_F(ExecutorBatchTest, NestedLoopJoinTest) {
+    sm_manager_->create_table("s", {{"sid", TYPE_INT, 4}, {"sgrp", TYPE_INT, 4}}, context_.get());
+    auto fh = sm_manager_->fhs_.at("s").get();
+    const int s_num = 3000;
+    for (int i = 0; i < s_num; i++) {
+        int buf[2] = {i, i % 100};
+        fh->insert_record(reinterpret_cast<char *>(buf), context_.get());
+    }
+    // t.id < 2000 and t.grp = s.sgrp：t中每条记录匹配s中的30条
+    Condition join_cond{.lhs_col = {"t", "grp"}, .op = OP_EQ, .is_rhs_val = false, .rhs_col = {"s", "sgrp"}};
+    auto left = std::make_unique<SeqScanExecutor>(sm_manager_.get(), "t",
+                                                  std::vector<Condition>{MakeCond("id", OP_LT, IntValue(2000), 4)},
+                                                  context_.get());
+    auto right = std::make_unique<SeqScanExecutor>(sm_manager_.get(), "s", std::vector<Condition>{}, context_.get());
+    auto join = std::make_unique<NestedLoopJoinExecutor>(std::move(left), std::move(right),
+                                                         std::vector<Condition>{join_cond});
+    ProjectionExecutor proj(std::move(join), {{"t", "id"}, {"s", "sid"}});
+    auto rows = RunBatch(&proj);
+    ASSERT_EQ(rows.size(), 2000 * s_num / 100);
+    for (auto &row : rows) {
+        int id = *reinterpret_cast<const int *>(row.data());
+        int sid = *reinterpret_cast<const int *>(row.data() + sizeof(int));
+        ASSERT_LT(id, 2000);
+        ASSERT_EQ(id % 100, sid % 100);
+    }
+    EXPECT_EQ(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // 右表为空时结果为空
+    sm_manager_->create_table("e", {{"eid", TYPE_INT, 4}}, context_.get());
+    NestedLoopJoinExecutor empty_join(
+        std::make_unique<SeqScanExecutor>(sm_manager_.get(), "t", std::vector<Condition>{}, context_.get()),
+        std::make_unique<SeqScanExecutor>(sm_manager_.get(), "e", std::vector<Condition>{}, context_.get()), {});
+    EXPECT_TRUE(RunBatch(&empty_join).empty());
+}
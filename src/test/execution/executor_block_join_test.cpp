@@ -0,0 +1,91 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <chrono>
+#include <cstdio>
+
+#include "execution/executor_block_nestedloop_join.h"
+#include "join_test_util.h"
+
+class ExecutorBlockJoinTest : public JoinTest {
+   public:
+    ExecutorBlockJoinTest() : JoinTest("ExecutorBlockJoinTest_db") {}
+};
+
+/**
+ * @brief 与nested loop join的结果相同：只有非等值条件、等值与非等值条件混合，
+ * 块的大小为一个chunk、不是chunk的整数倍（一个chunk分在两块中）和整个左表，以及任意一边为空
+ */
+TEST_F(ExecutorBlockJoinTest, MatchesNestedLoopTest) {
+    // 左表略多于一个chunk，块的大小至少为一个chunk，因此左表也分在多块中
+    const size_t left_rows = CHUNK_CAPACITY + 300;
+    CreateTable("l", UniformKeys(left_rows, 300));
+    CreateTable("r", UniformKeys(200, 400));
+    const size_t left_len = 20;
+    const std::vector<std::vector<Condition>> cases = {
+        {JoinCond("l", "k", OP_LT, "r", "k"), JoinCond("r", "id", OP_LE, "l", "id")},
+        {JoinCond("l", "f", OP_GE, "r", "f"), JoinCond("l", "s", OP_NE, "r", "s"), JoinCond("l", "id", OP_GT, "r", "k")},
+        {JoinCond("r", "k", OP_EQ, "l", "k"), JoinCond("l", "id", OP_LT, "r", "id")},
+    };
+    for (size_t c = 0; c < cases.size(); c++) {
+        // 参照结果对不同的块大小都相同，只计算一次
+        NestedLoopJoinExecutor nlj(Scan("l"), Scan("r"), cases[c]);
+        auto expected = RunBatch(&nlj);
+        ASSERT_FALSE(expected.empty());
+        for (size_t block_rows : {CHUNK_CAPACITY, CHUNK_CAPACITY + 100, left_rows}) {
+            SCOPED_TRACE("case " + std::to_string(c) + " block " + std::to_string(block_rows));
+            BlockNestedLoopJoinExecutor block_join(Scan("l"), Scan("r"), cases[c], block_rows * left_len);
+            EXPECT_EQ(RunBatch(&block_join), expected);
+            EXPECT_EQ(RunTuple(&block_join), expected);
+        }
+    }
+
+    CreateTable("e", {});
+    for (bool swap : {false, true}) {
+        BlockNestedLoopJoinExecutor block_join(Scan(swap ? "e" : "l"), Scan(swap ? "l" : "e"),
+                                               {JoinCond(swap ? "e" : "l", "k", OP_LT, swap ? "l" : "e", "k")});
+        EXPECT_TRUE(RunBatch(&block_join).empty());
+        EXPECT_TRUE(RunTuple(&block_join).empty());
+    }
+}
+
+/**
+ * @brief join基准测试：非等值连接时比较块嵌套循环连接与逐元组的nested loop join（每个左表元组扫描一遍右表），
+ * 输出每秒检查的元组对数
+ */
+TEST_F(ExecutorBlockJoinTest, DISABLED_JoinBenchmark) {
+    const int right_rows = 2000;
+    CreateTable("r", UniformKeys(right_rows, 100000));
+    int table_no = 0;
+    for (int left_rows : {100, 1000, 4000}) {
+        std::string left = "l" + std::to_string(table_no++);
+        CreateTable(left, UniformKeys(left_rows, 100000));
+        // 选择率约为1/4
+        std::vector<Condition> conds = {JoinCond(left, "k", OP_GT, "r", "k"), JoinCond(left, "id", OP_LT, "r", "id")};
+
+        auto start = std::chrono::steady_clock::now();
+        BlockNestedLoopJoinExecutor block_join(Scan(left), Scan("r"), conds);
+        size_t num_rows = CountBatch(&block_join);
+        double block_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        NestedLoopJoinExecutor nlj(Scan(left), Scan("r"), conds);
+        size_t tuple_rows = 0;
+        for (nlj.beginTuple(); !nlj.is_end(); nlj.nextTuple()) {
+            tuple_rows++;
+        }
+        EXPECT_EQ(tuple_rows, num_rows);
+        double tuple_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double pairs = static_cast<double>(left_rows) * right_rows;
+        printf("[ bench    ] %5d x %5d output %7zu  block join %8.2f ms %12.0f pairs/s  tuple nlj %9.2f ms\n",
+               left_rows, right_rows, num_rows, block_secs * 1000, pairs / block_secs, tuple_secs * 1000);
+    }
+}
@@ -0,0 +1,154 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+#include "execution/executor_hash_join.h"
+#include "join_test_util.h"
+
+class ExecutorHashJoinTest : public JoinTest {
+   public:
+    ExecutorHashJoinTest() : JoinTest("ExecutorHashJoinTest_db") {}
+
+    // 十分之一的元组集中在100个热点key上，其余均匀分布
+    std::vector<int> SkewedKeys(int num, int domain) {
+        std::vector<int> keys = UniformKeys(num, domain);
+        for (auto &key : keys) {
+            if (rng_() % 10 == 0) {
+                key = static_cast<int>(rng_() % 100);
+            }
+        }
+        return keys;
+    }
+};
+
+/**
+ * @brief 各种连接条件下hash join与nested loop join的结果相同：int、float（含+0和-0）、字符串key，
+ * 多个key，带非等值条件，以及左右两边分别作为build端
+ */
+TEST_F(ExecutorHashJoinTest, MatchesNestedLoopTest) {
+    CreateTable("l", SkewedKeys(3000, 500));
+    CreateTable("r", UniformKeys(1200, 600));
+    std::vector<std::vector<Condition>> cond_sets = {
+        {JoinCond("l", "k", OP_EQ, "r", "k")},
+        {JoinCond("r", "f", OP_EQ, "l", "f")},
+        {JoinCond("l", "s", OP_EQ, "r", "s"), JoinCond("l", "id", OP_LT, "r", "id")},
+        {JoinCond("l", "k", OP_EQ, "r", "k"), JoinCond("r", "s", OP_EQ, "l", "s"),
+         JoinCond("l", "id", OP_GE, "r", "id")},
+    };
+    for (size_t i = 0; i < cond_sets.size(); i++) {
+        for (bool swap : {false, true}) {
+            SCOPED_TRACE("conds " + std::to_string(i) + (swap ? " swapped" : ""));
+            std::string left = swap ? "r" : "l";
+            std::string right = swap ? "l" : "r";
+            HashJoinExecutor hash_join(sm_manager_.get(), Scan(left), Scan(right), cond_sets[i]);
+            ExpectMatchesNestedLoop(&hash_join, Scan(left), Scan(right), cond_sets[i]);
+        }
+    }
+
+    // 两边的chunk数相同，同时取完：build端之外已经取出的chunk全部由build阶段留下
+    CreateTable("m", UniformKeys(2900, 500));
+    HashJoinExecutor hash_join(sm_manager_.get(), Scan("l"), Scan("m"), {JoinCond("l", "k", OP_EQ, "m", "k")});
+    ExpectMatchesNestedLoop(&hash_join, Scan("l"), Scan("m"), {JoinCond("l", "k", OP_EQ, "m", "k")});
+
+    // 任意一边为空时结果为空
+    CreateTable("e", {});
+    for (bool swap : {false, true}) {
+        HashJoinExecutor hash_join(sm_manager_.get(), swap ? Scan("e") : Scan("l"), swap ? Scan("l") : Scan("e"),
+                                   {JoinCond(swap ? "e" : "l", "k", OP_EQ, swap ? "l" : "e", "k")});
+        EXPECT_TRUE(RunBatch(&hash_join).empty());
+        EXPECT_TRUE(RunTuple(&hash_join).empty());
+    }
+
+    // 没有两边字段的等值条件时不能使用hash join
+    EXPECT_THROW(HashJoinExecutor(sm_manager_.get(), Scan("l"), Scan("r"), {JoinCond("l", "k", OP_LT, "r", "k")}),
+                 InternalError);
+}
+
+/**
+ * @brief 内存上限很小时把输入分区写到磁盘上，结果与nested loop join相同：
+ * 分区0留在内存中、分区0也写出、多层分区、大量重复key超过最大分区层数；连接结束后临时文件都被删除
+ */
+TEST_F(ExecutorHashJoinTest, SpillTest) {
+    CreateTable("l", SkewedKeys(3000, 500));
+    CreateTable("r", UniformKeys(1200, 600));
+    std::vector<int> same_keys(2000, 7);
+    CreateTable("d", same_keys);
+    struct Case {
+        std::string left;
+        std::string right;
+        std::vector<Condition> conds;
+    };
+    const std::vector<Case> cases = {
+        {"l", "r", {JoinCond("l", "k", OP_EQ, "r", "k")}},
+        {"r", "l", {JoinCond("l", "s", OP_EQ, "r", "s"), JoinCond("l", "id", OP_LT, "r", "id")}},
+        {"d", "l", {JoinCond("d", "k", OP_EQ, "l", "k")}},
+    };
+    for (auto &c : cases) {
+        NestedLoopJoinExecutor nlj(Scan(c.left), Scan(c.right), c.conds);
+        auto expected = RunBatch(&nlj);
+        for (size_t mem_budget : {1 << 20, 32 << 10, 4 << 10, 256}) {
+            SCOPED_TRACE(c.left + " join " + c.right + " budget " + std::to_string(mem_budget));
+            HashJoinExecutor hash_join(sm_manager_.get(), Scan(c.left), Scan(c.right), c.conds, mem_budget);
+            ASSERT_EQ(RunBatch(&hash_join), expected);
+            ASSERT_EQ(RunTuple(&hash_join), expected);
+        }
+    }
+    for (auto &entry : std::filesystem::directory_iterator(".")) {
+        EXPECT_NE(entry.path().extension(), ".tmp") << entry.path();
+    }
+}
+
+/**
+ * @brief join基准测试：不同大小、均匀和倾斜的key分布、不同的内存上限，输出每秒处理的输入元组数；
+ * 小表上同时给出nested loop join的耗时
+ */
+TEST_F(ExecutorHashJoinTest, DISABLED_JoinBenchmark) {
+    struct Case {
+        int left_rows;
+        int right_rows;
+        bool skewed;
+        size_t mem_budget;
+    };
+    const std::vector<Case> cases = {
+        {1000, 10000, false, QUERY_MEMORY_BUDGET},    {1000, 10000, true, QUERY_MEMORY_BUDGET},
+        {10000, 100000, false, QUERY_MEMORY_BUDGET},  {10000, 100000, true, QUERY_MEMORY_BUDGET},
+        {100000, 100000, false, QUERY_MEMORY_BUDGET}, {100000, 100000, true, QUERY_MEMORY_BUDGET},
+        {100000, 100000, false, 1 << 20},             {100000, 100000, true, 1 << 20},
+    };
+    int table_no = 0;
+    for (auto &c : cases) {
+        std::string left = "l" + std::to_string(table_no);
+        std::string right = "r" + std::to_string(table_no++);
+        int domain = std::max(c.left_rows, c.right_rows);
+        CreateTable(left, c.skewed ? SkewedKeys(c.left_rows, domain) : UniformKeys(c.left_rows, domain));
+        CreateTable(right, c.skewed ? SkewedKeys(c.right_rows, domain) : UniformKeys(c.right_rows, domain));
+        std::vector<Condition> conds = {JoinCond(left, "k", OP_EQ, right, "k")};
+
+        auto start = std::chrono::steady_clock::now();
+        HashJoinExecutor hash_join(sm_manager_.get(), Scan(left), Scan(right), conds, c.mem_budget);
+        size_t num_rows = CountBatch(&hash_join);
+        double hash_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double input_rows = c.left_rows + c.right_rows;
+        printf("[ bench    ] %6d x %6d %-8s budget %5zuMB output %8zu  hash join %8.1f ms %12.0f rows/s",
+               c.left_rows, c.right_rows, c.skewed ? "skewed" : "uniform", c.mem_budget >> 20, num_rows,
+               hash_secs * 1000, input_rows / hash_secs);
+        if (c.left_rows <= 1000) {
+            start = std::chrono::steady_clock::now();
+            NestedLoopJoinExecutor nlj(Scan(left), Scan(right), conds);
+            EXPECT_EQ(CountBatch(&nlj), num_rows);
+            double nlj_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("  nested loop %8.1f ms", nlj_secs * 1000);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,102 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <chrono>
+#include <cstdio>
+
+#include "execution/executor_hash_join.h"
+#include "execution/executor_index_nestedloop_join.h"
+#include "join_test_util.h"
+
+/** 每张表在(k)、(f)和(s, id)上建立B+树索引，(k)和(s, id)上打开Bloom filter */
+class ExecutorIndexJoinTest : public JoinTest {
+   public:
+    ExecutorIndexJoinTest() : JoinTest("ExecutorIndexJoinTest_db") {}
+
+    void CreateTable(const std::string &tab_name, const std::vector<int> &keys) {
+        JoinTest::CreateTable(tab_name, keys);
+        sm_manager_->create_index(tab_name, {"k"}, context_.get());
+        sm_manager_->create_index(tab_name, {"f"}, context_.get());
+        sm_manager_->create_index(tab_name, {"s", "id"}, context_.get());
+        sm_manager_->set_index_bloom(tab_name, {"k"}, true, context_.get());
+        sm_manager_->set_index_bloom(tab_name, {"s", "id"}, true, context_.get());
+    }
+
+    static Condition ValueCond(const std::string &tab, const std::string &col, CompOp op, int val) {
+        Condition cond{.lhs_col = {tab, col}, .op = op, .is_rhs_val = true};
+        cond.rhs_val.set_int(val);
+        cond.rhs_val.init_raw(sizeof(int));
+        return cond;
+    }
+};
+
+/**
+ * @brief 与nested loop join的结果相同：单字段索引、float（含+0和-0）、复合索引的前缀和完整key（经过Bloom filter），
+ * 内表上的条件，外表中有大量在内表中不存在的key
+ */
+TEST_F(ExecutorIndexJoinTest, MatchesNestedLoopTest) {
+    CreateTable("o", UniformKeys(300, 800));
+    CreateTable("i", UniformKeys(5000, 500));
+    struct Case {
+        std::vector<std::string> index_col_names;
+        std::vector<Condition> inner_conds;
+        std::vector<Condition> conds;
+    };
+    const std::vector<Case> cases = {
+        {{"k"}, {}, {JoinCond("o", "k", OP_EQ, "i", "k")}},
+        {{"f"}, {}, {JoinCond("i", "f", OP_EQ, "o", "f"), JoinCond("o", "id", OP_LT, "i", "id")}},
+        {{"s", "id"}, {ValueCond("i", "k", OP_GT, 100)}, {JoinCond("o", "s", OP_EQ, "i", "s")}},
+        {{"s", "id"}, {}, {JoinCond("o", "s", OP_EQ, "i", "s"), JoinCond("i", "id", OP_EQ, "o", "id")}},
+    };
+    for (size_t c = 0; c < cases.size(); c++) {
+        SCOPED_TRACE("case " + std::to_string(c));
+        auto &test_case = cases[c];
+        IndexNestedLoopJoinExecutor index_join(sm_manager_.get(), Scan("o"), "i", test_case.inner_conds,
+                                               test_case.index_col_names, test_case.conds, context_.get());
+        ExpectMatchesNestedLoop(&index_join, Scan("o"), Scan("i", test_case.inner_conds), test_case.conds);
+    }
+
+    CreateTable("e", {});
+    IndexNestedLoopJoinExecutor empty_join(sm_manager_.get(), Scan("e"), "i", {}, {"k"},
+                                           {JoinCond("e", "k", OP_EQ, "i", "k")}, context_.get());
+    EXPECT_TRUE(RunBatch(&empty_join).empty());
+
+    // 索引的第一个字段上没有等值连接条件
+    EXPECT_THROW(IndexNestedLoopJoinExecutor(sm_manager_.get(), Scan("o"), "i", {}, {"s", "id"},
+                                             {JoinCond("o", "id", OP_EQ, "i", "id")}, context_.get()),
+                 InternalError);
+}
+
+/**
+ * @brief join基准测试：外表大小不同时比较index nested loop join与hash join，输出每秒处理的外表元组数
+ */
+TEST_F(ExecutorIndexJoinTest, DISABLED_JoinBenchmark) {
+    const int inner_rows = 100000;
+    CreateTable("i", UniformKeys(inner_rows, inner_rows));
+    int table_no = 0;
+    for (int outer_rows : {10, 100, 1000, 10000, 100000}) {
+        std::string outer = "o" + std::to_string(table_no++);
+        CreateTable(outer, UniformKeys(outer_rows, inner_rows * 2));
+        std::vector<Condition> conds = {JoinCond(outer, "k", OP_EQ, "i", "k")};
+
+        auto start = std::chrono::steady_clock::now();
+        IndexNestedLoopJoinExecutor index_join(sm_manager_.get(), Scan(outer), "i", {}, {"k"}, conds, context_.get());
+        size_t num_rows = CountBatch(&index_join);
+        double index_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        HashJoinExecutor hash_join(sm_manager_.get(), Scan(outer), Scan("i"), conds);
+        EXPECT_EQ(CountBatch(&hash_join), num_rows);
+        double hash_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("[ bench    ] %6d x %6d output %6zu  index join %8.2f ms %12.0f rows/s  hash join %8.2f ms\n",
+               outer_rows, inner_rows, num_rows, index_secs * 1000, outer_rows / index_secs, hash_secs * 1000);
+    }
+}
@@ -0,0 +1,116 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <chrono>
+#include <cstdio>
+
+#include "execution/executor_hash_join.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_merge_join.h"
+#include "join_test_util.h"
+
+/** 每张表在(k)、(f)和(s, id)上建立B+树索引 */
+class ExecutorMergeJoinTest : public JoinTest {
+   public:
+    ExecutorMergeJoinTest() : JoinTest("ExecutorMergeJoinTest_db") {}
+
+    void CreateTable(const std::string &tab_name, const std::vector<int> &keys) {
+        JoinTest::CreateTable(tab_name, keys);
+        sm_manager_->create_index(tab_name, {"k"}, context_.get());
+        sm_manager_->create_index(tab_name, {"f"}, context_.get());
+        sm_manager_->create_index(tab_name, {"s", "id"}, context_.get());
+    }
+
+    // 在index_col_names上的全范围索引扫描，按索引的顺序输出
+    std::unique_ptr<AbstractExecutor> OrderedScan(const std::string &tab_name,
+                                                  const std::vector<std::string> &index_col_names) {
+        return std::make_unique<IndexScanExecutor>(sm_manager_.get(), tab_name, std::vector<Condition>{},
+                                                   index_col_names, context_.get());
+    }
+};
+
+/**
+ * @brief 两边都有大量重复key时merge join与nested loop join的结果相同：int、float（含+0和-0）、
+ * 复合索引第一个字段上的字符串key，带非等值条件，以及任意一边为空
+ */
+TEST_F(ExecutorMergeJoinTest, MatchesNestedLoopTest) {
+    CreateTable("l", UniformKeys(3000, 300));
+    CreateTable("r", UniformKeys(1200, 400));
+    struct Case {
+        std::string key;
+        std::vector<std::string> index_col_names;
+        std::vector<Condition> conds;
+    };
+    const std::vector<Case> cases = {
+        {"k", {"k"}, {JoinCond("l", "k", OP_EQ, "r", "k")}},
+        {"f", {"f"}, {JoinCond("r", "f", OP_EQ, "l", "f"), JoinCond("l", "id", OP_LT, "r", "id")}},
+        {"s", {"s", "id"}, {JoinCond("l", "s", OP_EQ, "r", "s"), JoinCond("l", "k", OP_GE, "r", "k")}},
+    };
+    for (auto &c : cases) {
+        for (bool swap : {false, true}) {
+            SCOPED_TRACE("key " + c.key + (swap ? " swapped" : ""));
+            std::string left = swap ? "r" : "l";
+            std::string right = swap ? "l" : "r";
+            MergeJoinExecutor merge_join(OrderedScan(left, c.index_col_names), OrderedScan(right, c.index_col_names),
+                                         c.conds);
+            ExpectMatchesNestedLoop(&merge_join, Scan(left), Scan(right), c.conds);
+        }
+    }
+
+    CreateTable("e", {});
+    for (bool swap : {false, true}) {
+        MergeJoinExecutor merge_join(OrderedScan(swap ? "e" : "l", {"k"}), OrderedScan(swap ? "l" : "e", {"k"}),
+                                     {JoinCond(swap ? "e" : "l", "k", OP_EQ, swap ? "l" : "e", "k")});
+        EXPECT_TRUE(RunBatch(&merge_join).empty());
+        EXPECT_TRUE(RunTuple(&merge_join).empty());
+    }
+
+    // 没有两边字段的等值条件时不能使用merge join
+    EXPECT_THROW(MergeJoinExecutor(OrderedScan("l", {"k"}), OrderedScan("r", {"k"}),
+                                   {JoinCond("l", "k", OP_LT, "r", "k")}),
+                 InternalError);
+}
+
+/**
+ * @brief join基准测试：两张表都在连接字段上有索引时，比较索引扫描上的merge join与顺序扫描上的hash join，
+ * 输出每秒处理的输入元组数
+ */
+TEST_F(ExecutorMergeJoinTest, DISABLED_JoinBenchmark) {
+    struct Case {
+        int left_rows;
+        int right_rows;
+        int domain;
+    };
+    const std::vector<Case> cases = {{10000, 100000, 100000}, {100000, 100000, 100000}, {100000, 100000, 1000}};
+    int table_no = 0;
+    for (auto &c : cases) {
+        std::string left = "l" + std::to_string(table_no);
+        std::string right = "r" + std::to_string(table_no++);
+        CreateTable(left, UniformKeys(c.left_rows, c.domain));
+        CreateTable(right, UniformKeys(c.right_rows, c.domain));
+        std::vector<Condition> conds = {JoinCond(left, "k", OP_EQ, right, "k")};
+        double input_rows = c.left_rows + c.right_rows;
+
+        auto start = std::chrono::steady_clock::now();
+        MergeJoinExecutor merge_join(OrderedScan(left, {"k"}), OrderedScan(right, {"k"}), conds);
+        size_t num_rows = CountBatch(&merge_join);
+        double merge_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        HashJoinExecutor hash_join(sm_manager_.get(), Scan(left), Scan(right), conds);
+        EXPECT_EQ(CountBatch(&hash_join), num_rows);
+        double hash_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("[ bench    ] %6d x %6d domain %6d output %9zu  merge join %8.1f ms %12.0f rows/s"
+               "  hash join %8.1f ms %12.0f rows/s\n",
+               c.left_rows, c.right_rows, c.domain, num_rows, merge_secs * 1000, input_rows / merge_secs,
+               hash_secs * 1000, input_rows / hash_secs);
+    }
+}
@@ -0,0 +1,216 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <chrono>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_parallel_seq_scan.h"
+#include "execution/executor_projection.h"
+#include "execution/executor_seq_scan.h"
+
+const std::string TEST_DB_NAME = "ExecutorParallelScanTest_db";  // 以数据库名作为根目录
+
+/** 每个测试点创建一个新的数据库，表t(id int, grp int, val float, name char(16))中有key_num条记录，
+ * id依次为0..key_num-1，grp = id % 100，val = id / 2.0，name为"name" + id % 1000；
+ * 删除id % 7 == 0的记录，使页面中留有空的slot */
+class ExecutorParallelScanTest : public ::testing::Test {
+   public:
+    static constexpr int key_num = 100000;
+
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get());
+
+        if (sm_manager_->is_dir(TEST_DB_NAME)) {
+            sm_manager_->drop_db(TEST_DB_NAME);
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        CreateTable("t", key_num);
+        CreateTable("e", 0);
+        auto fh = sm_manager_->fhs_.at("t").get();
+        auto scan = Scan("t", {});
+        std::vector<Rid> rids;
+        for (scan->beginTuple(); !scan->is_end(); scan->nextTuple()) {
+            if (*reinterpret_cast<const int *>(scan->Next()->data) % 7 == 0) {
+                rids.push_back(scan->rid());
+            }
+        }
+        for (auto &rid : rids) {
+            fh->delete_record(rid, context_.get());
+        }
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+        sm_manager_->drop_db(TEST_DB_NAME);
+    }
+
+    void CreateTable(const std::string &tab_name, int num) {
+        sm_manager_->create_table(tab_name, {{"id", TYPE_INT, 4}, {"grp", TYPE_INT, 4}, {"val", TYPE_FLOAT, 4},
+                                             {"name", TYPE_STRING, 16}}, context_.get());
+        auto fh = sm_manager_->fhs_.at(tab_name).get();
+        char buf[28] = {};
+        for (int i = 0; i < num; i++) {
+            *reinterpret_cast<int *>(buf) = i;
+            *reinterpret_cast<int *>(buf + 4) = i % 100;
+            *reinterpret_cast<float *>(buf + 8) = i / 2.0f;
+            memset(buf + 12, 0, 16);
+            snprintf(buf + 12, 16, "name%d", i % 1000);
+            fh->insert_record(buf, context_.get());
+        }
+    }
+
+    std::unique_ptr<AbstractExecutor> Scan(const std::string &tab_name, std::vector<Condition> conds) {
+        return std::make_unique<SeqScanExecutor>(sm_manager_.get(), tab_name, std::move(conds), context_.get());
+    }
+
+    static Condition MakeCond(const std::string &col_name, CompOp op, Value val, int len) {
+        Condition cond{.lhs_col = {"t", col_name}, .op = op, .is_rhs_val = true};
+        cond.rhs_val = std::move(val);
+        cond.rhs_val.init_raw(len);
+        return cond;
+    }
+
+    static Value IntValue(int v) {
+        Value val;
+        val.set_int(v);
+        return val;
+    }
+
+    // 批量执行，返回按输出顺序排列的元组和rid
+    static std::vector<std::pair<std::string, Rid>> RunBatch(AbstractExecutor *exec) {
+        std::vector<std::pair<std::string, Rid>> rows;
+        DataChunk chunk;
+        for (exec->beginBatch(); exec->NextBatch(chunk);) {
+            EXPECT_GT(chunk.count(), 0);
+            for (size_t i = 0; i < chunk.count(); i++) {
+                rows.emplace_back(std::string(chunk.row(i), exec->tupleLen()), chunk.rid(i));
+            }
+        }
+        return rows;
+    }
+
+    // 逐元组执行，返回按输出顺序排列的元组和rid
+    static std::vector<std::pair<std::string, Rid>> RunTuple(AbstractExecutor *exec) {
+        std::vector<std::pair<std::string, Rid>> rows;
+        for (exec->beginTuple(); !exec->is_end(); exec->nextTuple()) {
+            rows.emplace_back(std::string(exec->Next()->data, exec->tupleLen()), exec->rid());
+        }
+        return rows;
+    }
+};
+
+/**
+ * @brief 并行扫描的结果与顺序扫描完全相同（包括顺序和rid）：不同的线程数，有无条件，有无投影，批量和逐元组执行，以及空表
+ */
+TEST_F(ExecutorParallelScanTest, ParallelSeqScanTest) {
+    const std::vector<std::vector<Condition>> conds_list = {
+        {},
+        {MakeCond("grp", OP_LT, IntValue(10), 4)},
+        {MakeCond("id", OP_GE, IntValue(key_num / 3), 4), MakeCond("id", OP_LT, IntValue(key_num / 3 + 50), 4)},
+        {MakeCond("id", OP_LT, IntValue(0), 4)},
+    };
+    const std::vector<std::vector<TabCol>> sel_cols_list = {{}, {{"t", "name"}, {"t", "id"}}};
+    for (size_t c = 0; c < conds_list.size(); c++) {
+        for (auto &sel_cols : sel_cols_list) {
+            std::unique_ptr<AbstractExecutor> expected_exec = Scan("t", conds_list[c]);
+            if (!sel_cols.empty()) {
+                expected_exec = std::make_unique<ProjectionExecutor>(std::move(expected_exec), sel_cols);
+            }
+            auto expected = RunBatch(expected_exec.get());
+            for (size_t num_workers : {1, 2, 3, 8}) {
+                SCOPED_TRACE("conds " + std::to_string(c) + " cols " + std::to_string(sel_cols.size()) + " workers " +
+                             std::to_string(num_workers));
+                ParallelSeqScanExecutor scan(sm_manager_.get(), "t", conds_list[c], sel_cols, context_.get(),
+                                             num_workers);
+                EXPECT_EQ(scan.tupleLen(), expected_exec->tupleLen());
+                for (bool batch : {true, false}) {
+                    auto rows = batch ? RunBatch(&scan) : RunTuple(&scan);
+                    ASSERT_EQ(rows.size(), expected.size());
+                    for (size_t i = 0; i < rows.size(); i++) {
+                        ASSERT_EQ(rows[i].first, expected[i].first);
+                        ASSERT_EQ(rows[i].second, expected[i].second);
+                    }
+                }
+            }
+        }
+    }
+    ParallelSeqScanExecutor empty(sm_manager_.get(), "e", {}, {}, context_.get(), 4);
+    EXPECT_TRUE(RunBatch(&empty).empty());
+    EXPECT_TRUE(RunTuple(&empty).empty());
+}
+
+/**
+ * @brief 只取一部分结果就重新开始扫描或者析构时，工作线程正确地停止
+ */
+TEST_F(ExecutorParallelScanTest, EarlyStopTest) {
+    auto expected = RunBatch(Scan("t", {}).get());
+    for (size_t num_workers : {1, 4}) {
+        ParallelSeqScanExecutor scan(sm_manager_.get(), "t", {}, {}, context_.get(), num_workers);
+        DataChunk chunk;
+        scan.beginBatch();
+        ASSERT_TRUE(scan.NextBatch(chunk));
+        EXPECT_EQ(std::string(chunk.row(0), scan.tupleLen()), expected[0].first);
+        EXPECT_EQ(RunBatch(&scan).size(), expected.size());
+        scan.beginBatch();
+        ASSERT_TRUE(scan.NextBatch(chunk));
+    }
+}
+
+/**
+ * @brief 并行扫描基准测试：在约2M条记录的表上分别用1..N个工作线程扫描，计算一个简单的条件并投影两个字段，
+ * 输出每秒扫描的记录数和相对单线程的加速比；N取CPU核数与4中较大的一个
+ */
+TEST_F(ExecutorParallelScanTest, DISABLED_ParallelSeqScanBenchmark) {
+    const int num_rows = 2000000;
+    CreateTable("big", num_rows);
+    Condition cond = MakeCond("grp", OP_LT, IntValue(50), 4);
+    cond.lhs_col.tab_name = "big";
+    const std::vector<TabCol> sel_cols = {{"big", "id"}, {"big", "val"}};
+    size_t max_workers = std::max<size_t>(ParallelSeqScanExecutor::default_workers(), 4);
+    double base_secs = 0;
+    for (size_t num_workers = 1; num_workers <= max_workers; num_workers++) {
+        ParallelSeqScanExecutor scan(sm_manager_.get(), "big", {cond}, sel_cols, context_.get(), num_workers);
+        auto start = std::chrono::steady_clock::now();
+        size_t count = 0;
+        DataChunk chunk;
+        for (scan.beginBatch(); scan.NextBatch(chunk);) {
+            count += chunk.count();
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_EQ(count, static_cast<size_t>(num_rows / 2));
+        if (num_workers == 1) {
+            base_secs = secs;
+        }
+        printf("[ bench    ] parallel scan %d rows with %2zu workers %9.2f ms %12.0f rows/s speedup %.2fx\n", num_rows,
+               num_workers, secs * 1000, num_rows / secs, base_secs / secs);
+    }
+}
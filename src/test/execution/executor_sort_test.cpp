@@ -0,0 +1,216 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "execution/execution_sort.h"
+#include "execution/executor_limit.h"
+#include "operator_test_util.h"
+
+class ExecutorSortTest : public OperatorTest {
+   public:
+    ExecutorSortTest() : OperatorTest("ExecutorSortTest_db") {}
+
+    /**
+     * @brief 按排序字段依次比较两个元组，返回负数、0或正数
+     */
+    static int CompareRows(const std::string &a, const std::string &b, const std::vector<ColMeta> &cols,
+                           const std::vector<TabCol> &sel_cols, const std::vector<bool> &is_descs) {
+        for (size_t i = 0; i < sel_cols.size(); i++) {
+            auto col = std::find_if(cols.begin(), cols.end(),
+                                    [&](const ColMeta &col) { return col.name == sel_cols[i].col_name; });
+            int cmp = ix_compare(a.data() + col->offset, b.data() + col->offset, col->type, col->len);
+            if (cmp != 0) {
+                return is_descs[i] ? -cmp : cmp;
+            }
+        }
+        return 0;
+    }
+};
+
+/**
+ * @brief 结果与输入是同一个多重集合，并且按排序字段有序：单个int、float（含+0、-0和负数）、字符串字段，
+ * 多个字段混合ASC和DESC；全部在内存中、写出多个run一次归并、run太多需要多趟归并，以及空输入
+ */
+TEST_F(ExecutorSortTest, SortOrderTest) {
+    CreateTable("t", SignedKeys(20000, 3000));
+    CreateTable("e", {});
+    struct Case {
+        std::vector<TabCol> sel_cols;
+        std::vector<bool> is_descs;
+    };
+    const std::vector<Case> cases = {
+        {{{"t", "k"}}, {false}},
+        {{{"t", "f"}}, {true}},
+        {{{"t", "s"}}, {false}},
+        {{{"t", "s"}, {"t", "k"}, {"t", "id"}}, {true, false, true}},
+        {{{"t", "f"}, {"t", "s"}}, {false, true}},
+    };
+    // 第二种内存上限下写出两个run一次归并，第三种下写出5个以上的run，每次只能归并两个
+    const std::vector<size_t> budgets = {QUERY_MEMORY_BUDGET, 128 * PAGE_SIZE, 40 * PAGE_SIZE};
+    auto input = RunBatch(Scan("t").get());
+    std::sort(input.begin(), input.end());
+    for (size_t c = 0; c < cases.size(); c++) {
+        for (size_t budget : budgets) {
+            SCOPED_TRACE("case " + std::to_string(c) + " budget " + std::to_string(budget));
+            SortExecutor sort(sm_manager_.get(), Scan("t"), cases[c].sel_cols, cases[c].is_descs, budget);
+            for (bool batch : {true, false}) {
+                auto rows = batch ? RunBatch(&sort) : RunTuple(&sort);
+                ASSERT_EQ(rows.size(), input.size());
+                for (size_t i = 1; i < rows.size(); i++) {
+                    ASSERT_LE(CompareRows(rows[i - 1], rows[i], sort.cols(), cases[c].sel_cols, cases[c].is_descs), 0)
+                        << "row " << i;
+                }
+                std::sort(rows.begin(), rows.end());
+                ASSERT_EQ(rows, input);
+            }
+        }
+        SortExecutor empty_sort(sm_manager_.get(), Scan("e"), {{"e", "k"}}, {false}, budgets.back());
+        EXPECT_TRUE(RunBatch(&empty_sort).empty());
+        EXPECT_TRUE(RunTuple(&empty_sort).empty());
+    }
+}
+
+/**
+ * @brief 排序基准测试：默认内存上限下对10M个元组按不同类型的字段排序（需要写出run再归并），输出每秒排序的元组数
+ */
+TEST_F(ExecutorSortTest, DISABLED_SortBenchmark) {
+    const size_t num_rows = 10000000;
+    struct Case {
+        std::string name;
+        std::vector<TabCol> sel_cols;
+        std::vector<bool> is_descs;
+    };
+    const std::vector<Case> cases = {
+        {"int", {{"g", "k"}}, {false}},
+        {"float desc", {{"g", "f"}}, {true}},
+        {"char(16)", {{"g", "s"}}, {false}},
+        {"char(16), int desc", {{"g", "s"}, {"g", "id"}}, {false, true}},
+    };
+    for (const auto &c : cases) {
+        SortExecutor sort(sm_manager_.get(), std::make_unique<GeneratorExecutor>(num_rows, 1 << 30), c.sel_cols,
+                          c.is_descs);
+        auto start = std::chrono::steady_clock::now();
+        size_t count = 0;
+        DataChunk chunk;
+        std::string prev;
+        for (sort.beginBatch(); sort.NextBatch(chunk);) {
+            count += chunk.count();
+            std::string last(chunk.row(chunk.count() - 1), sort.tupleLen());
+            if (!prev.empty()) {
+                ASSERT_LE(CompareRows(prev, std::string(chunk.row(0), sort.tupleLen()), sort.cols(), c.sel_cols,
+                                      c.is_descs),
+                          0);
+            }
+            prev = std::move(last);
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_EQ(count, num_rows);
+        printf("[ bench    ] sort %zu rows by %-20s %9.2f ms %12.0f rows/s\n", num_rows, c.name.c_str(),
+               secs * 1000, num_rows / secs);
+    }
+}
+
+/**
+ * @brief Top-N排序的结果与完整排序后截取的结果相同：N小于、等于、大于输入的元组数，带OFFSET，LIMIT 0，
+ * 以及大量相等的key（只比较排序字段）
+ */
+TEST_F(ExecutorSortTest, TopNTest) {
+    CreateTable("t", SignedKeys(5000, 300));
+    struct Case {
+        std::vector<TabCol> sel_cols;
+        std::vector<bool> is_descs;
+    };
+    const std::vector<Case> cases = {
+        {{{"t", "k"}}, {true}},
+        {{{"t", "s"}, {"t", "f"}}, {false, true}},
+        {{{"t", "f"}, {"t", "id"}}, {false, false}},
+    };
+    const std::vector<std::pair<size_t, size_t>> limits = {{20, 0}, {20, 100}, {1, 4999}, {5000, 0}, {100, 4950},
+                                                           {8000, 10}, {0, 10}};
+    for (size_t c = 0; c < cases.size(); c++) {
+        SortExecutor sort(sm_manager_.get(), Scan("t"), cases[c].sel_cols, cases[c].is_descs);
+        auto sorted = RunBatch(&sort);
+        for (auto [limit, offset] : limits) {
+            SCOPED_TRACE("case " + std::to_string(c) + " limit " + std::to_string(limit) + " offset " +
+                         std::to_string(offset));
+            TopNExecutor top_n(Scan("t"), cases[c].sel_cols, cases[c].is_descs, limit, offset);
+            size_t begin = std::min(offset, sorted.size());
+            size_t end = limit == 0 ? begin : std::min(offset + limit, sorted.size());
+            for (bool batch : {true, false}) {
+                auto rows = batch ? RunBatch(&top_n) : RunTuple(&top_n);
+                ASSERT_EQ(rows.size(), end - begin);
+                for (size_t i = 0; i < rows.size(); i++) {
+                    ASSERT_EQ(CompareRows(rows[i], sorted[begin + i], top_n.cols(), cases[c].sel_cols,
+                                          cases[c].is_descs),
+                              0)
+                        << "row " << i;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief LIMIT/OFFSET与完整结果的一段相同，并且输出够之后不再向儿子节点取元组
+ */
+TEST_F(ExecutorSortTest, LimitTest) {
+    CreateTable("t", SignedKeys(5000, 300));
+    auto all = RunBatch(Scan("t").get());
+    for (auto [limit, offset] : std::vector<std::pair<size_t, size_t>>{{10, 0}, {10, 1500}, {3000, 1000}, {10, 4995},
+                                                                       {10, 6000}, {0, 0}}) {
+        SCOPED_TRACE("limit " + std::to_string(limit) + " offset " + std::to_string(offset));
+        LimitExecutor exec(Scan("t"), limit, offset);
+        size_t begin = std::min(offset, all.size());
+        std::vector<std::string> expected(all.begin() + begin, all.begin() + std::min(begin + limit, all.size()));
+        EXPECT_EQ(RunBatch(&exec), expected);
+        EXPECT_EQ(RunTuple(&exec), expected);
+    }
+
+    auto generator = std::make_unique<GeneratorExecutor>(1000000, 100);
+    auto source = generator.get();
+    LimitExecutor exec(std::move(generator), 20, 10);
+    EXPECT_EQ(RunBatch(&exec).size(), 20);
+    EXPECT_LE(source->produced(), CHUNK_CAPACITY);
+}
+
+/**
+ * @brief ORDER BY ... LIMIT基准测试：从10M个元组中取前20个，比较Top-N排序与完整的外部排序
+ */
+TEST_F(ExecutorSortTest, DISABLED_TopNBenchmark) {
+    const size_t num_rows = 10000000;
+    const std::vector<TabCol> sel_cols = {{"g", "k"}};
+    const std::vector<bool> is_descs = {true};
+
+    auto start = std::chrono::steady_clock::now();
+    TopNExecutor top_n(std::make_unique<GeneratorExecutor>(num_rows, 1 << 30), sel_cols, is_descs, 20, 0);
+    auto top_rows = RunBatch(&top_n);
+    double top_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    LimitExecutor sort_limit(
+        std::make_unique<SortExecutor>(sm_manager_.get(), std::make_unique<GeneratorExecutor>(num_rows, 1 << 30),
+                                       sel_cols, is_descs),
+        20, 0);
+    auto sort_rows = RunBatch(&sort_limit);
+    double sort_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(top_rows.size(), 20);
+    ASSERT_EQ(sort_rows.size(), 20);
+    for (size_t i = 0; i < top_rows.size(); i++) {
+        EXPECT_EQ(CompareRows(top_rows[i], sort_rows[i], top_n.cols(), sel_cols, is_descs), 0);
+    }
+    printf("[ bench    ] top 20 of %zu rows  top-n %9.2f ms %12.0f rows/s  full sort %9.2f ms\n", num_rows,
+           top_secs * 1000, num_rows / top_secs, sort_secs * 1000);
+}
@@ -0,0 +1,142 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_nestedloop_join.h"
+#include "execution/executor_seq_scan.h"
+
+/** 各种join算子测试共用的fixture：每个测试点创建一个新的数据库，由测试点自己生成表；
+ * 表的字段都是(id int, k int, f float, s char(8))，id依次编号，k由测试点给出，f = k / 2.0，s为"s" + k % 50。
+ * 子类在构造函数中给出数据库名，需要索引时在自己的CreateTable中建立 */
+class JoinTest : public ::testing::Test {
+   public:
+    std::string db_name_;  // 以数据库名作为根目录
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    std::mt19937 rng_{20231018};
+
+   public:
+    explicit JoinTest(std::string db_name) : db_name_(std::move(db_name)) {}
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get());
+
+        if (sm_manager_->is_dir(db_name_)) {
+            sm_manager_->drop_db(db_name_);
+        }
+        sm_manager_->create_db(db_name_);
+        sm_manager_->open_db(db_name_);
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+        sm_manager_->drop_db(db_name_);
+    }
+
+    void CreateTable(const std::string &tab_name, const std::vector<int> &keys) {
+        sm_manager_->create_table(tab_name, {{"id", TYPE_INT, 4}, {"k", TYPE_INT, 4}, {"f", TYPE_FLOAT, 4},
+                                             {"s", TYPE_STRING, 8}}, context_.get());
+        auto fh = sm_manager_->fhs_.at(tab_name).get();
+        char buf[20];
+        for (size_t i = 0; i < keys.size(); i++) {
+            memset(buf, 0, sizeof(buf));
+            *reinterpret_cast<int *>(buf) = static_cast<int>(i);
+            *reinterpret_cast<int *>(buf + 4) = keys[i];
+            // k为0时奇数行存-0，检查+0和-0能够连接
+            *reinterpret_cast<float *>(buf + 8) = keys[i] == 0 && i % 2 == 1 ? -0.0f : keys[i] / 2.0f;
+            snprintf(buf + 12, 8, "s%d", keys[i] % 50);
+            fh->insert_record(buf, context_.get());
+        }
+    }
+
+    // 取值在[0, domain)内均匀分布的key
+    std::vector<int> UniformKeys(int num, int domain) {
+        std::vector<int> keys(num);
+        for (auto &key : keys) {
+            key = static_cast<int>(rng_() % domain);
+        }
+        return keys;
+    }
+
+    std::unique_ptr<AbstractExecutor> Scan(const std::string &tab_name, const std::vector<Condition> &conds = {}) {
+        return std::make_unique<SeqScanExecutor>(sm_manager_.get(), tab_name, conds, context_.get());
+    }
+
+    static Condition JoinCond(const std::string &lhs_tab, const std::string &lhs_col, CompOp op,
+                              const std::string &rhs_tab, const std::string &rhs_col) {
+        return Condition{.lhs_col = {lhs_tab, lhs_col}, .op = op, .is_rhs_val = false, .rhs_col = {rhs_tab, rhs_col}};
+    }
+
+    // 批量执行，返回排序后的结果
+    static std::vector<std::string> RunBatch(AbstractExecutor *exec) {
+        std::vector<std::string> rows;
+        DataChunk chunk;
+        for (exec->beginBatch(); exec->NextBatch(chunk);) {
+            for (size_t i = 0; i < chunk.count(); i++) {
+                rows.emplace_back(chunk.row(i), exec->tupleLen());
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    // 逐元组执行，返回排序后的结果
+    static std::vector<std::string> RunTuple(AbstractExecutor *exec) {
+        std::vector<std::string> rows;
+        for (exec->beginTuple(); !exec->is_end(); exec->nextTuple()) {
+            rows.emplace_back(exec->Next()->data, exec->tupleLen());
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    // 执行到结束，只统计输出的元组数
+    static size_t CountBatch(AbstractExecutor *exec) {
+        size_t num_rows = 0;
+        DataChunk chunk;
+        for (exec->beginBatch(); exec->NextBatch(chunk);) {
+            num_rows += chunk.count();
+        }
+        return num_rows;
+    }
+
+    /**
+     * @brief 以nested loop join的结果为参照，检查join批量执行和逐元组执行的结果都与之相同；参照结果不能为空
+     */
+    static void ExpectMatchesNestedLoop(AbstractExecutor *join, std::unique_ptr<AbstractExecutor> left,
+                                        std::unique_ptr<AbstractExecutor> right, const std::vector<Condition> &conds) {
+        NestedLoopJoinExecutor nlj(std::move(left), std::move(right), conds);
+        auto expected = RunBatch(&nlj);
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(RunBatch(join), expected);
+        EXPECT_EQ(RunTuple(join), expected);
+    }
+};
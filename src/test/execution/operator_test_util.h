@@ -0,0 +1,165 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdio>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_seq_scan.h"
+
+/**
+ * 在内存中生成元组的儿子节点，用于不经过表的大数据量测试
+ * 元组的字段为(id int, k int, f float, s char(16))，id依次编号，k在[0, domain)内均匀分布，f = k / 2.0 - 1000，
+ * s为"s" + k的十进制表示
+ */
+class GeneratorExecutor : public AbstractExecutor {
+   private:
+    size_t num_rows_;
+    int domain_;
+    std::vector<ColMeta> cols_;
+    std::mt19937 rng_;
+    size_t next_ = 0;
+
+   public:
+    GeneratorExecutor(size_t num_rows, int domain) : num_rows_(num_rows), domain_(domain) {
+        cols_ = {{"g", "id", TYPE_INT, 4, 0, false},
+                 {"g", "k", TYPE_INT, 4, 4, false},
+                 {"g", "f", TYPE_FLOAT, 4, 8, false},
+                 {"g", "s", TYPE_STRING, 16, 12, false}};
+    }
+
+    void beginBatch() override {
+        rng_.seed(20231018);
+        next_ = 0;
+    }
+
+    bool NextBatch(DataChunk &chunk) override {
+        chunk.init(tupleLen());
+        for (; next_ < num_rows_ && !chunk.is_full(); next_++) {
+            char *rec = chunk.append();
+            int k = static_cast<int>(rng_() % domain_);
+            memset(rec, 0, tupleLen());
+            *reinterpret_cast<int *>(rec) = static_cast<int>(next_);
+            *reinterpret_cast<int *>(rec + 4) = k;
+            *reinterpret_cast<float *>(rec + 8) = k / 2.0f - 1000;
+            snprintf(rec + 12, 16, "s%d", k);
+        }
+        return chunk.count() > 0;
+    }
+
+    std::unique_ptr<RmRecord> Next() override { return nullptr; }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    size_t tupleLen() const override { return 28; }
+
+    // 已经产生的元组数
+    size_t produced() const { return next_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+};
+
+/** 排序、聚集等单输入算子测试共用的fixture：每个测试点创建一个新的数据库，由测试点自己生成表；
+ * 表的字段都是(id int, k int, f float, s char(8))，id依次编号，k由测试点给出，f = k / 2.0，s为"s" + k % 50。
+ * 子类在构造函数中给出数据库名 */
+class OperatorTest : public ::testing::Test {
+   public:
+    std::string db_name_;  // 以数据库名作为根目录
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    std::mt19937 rng_{20231018};
+
+   public:
+    explicit OperatorTest(std::string db_name) : db_name_(std::move(db_name)) {}
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get());
+
+        if (sm_manager_->is_dir(db_name_)) {
+            sm_manager_->drop_db(db_name_);
+        }
+        sm_manager_->create_db(db_name_);
+        sm_manager_->open_db(db_name_);
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+        sm_manager_->drop_db(db_name_);
+    }
+
+    void CreateTable(const std::string &tab_name, const std::vector<int> &keys) {
+        sm_manager_->create_table(tab_name, {{"id", TYPE_INT, 4}, {"k", TYPE_INT, 4}, {"f", TYPE_FLOAT, 4},
+                                             {"s", TYPE_STRING, 8}}, context_.get());
+        auto fh = sm_manager_->fhs_.at(tab_name).get();
+        char buf[20];
+        for (size_t i = 0; i < keys.size(); i++) {
+            memset(buf, 0, sizeof(buf));
+            *reinterpret_cast<int *>(buf) = static_cast<int>(i);
+            *reinterpret_cast<int *>(buf + 4) = keys[i];
+            // k为0时奇数行存-0，检查+0和-0相等
+            *reinterpret_cast<float *>(buf + 8) = keys[i] == 0 && i % 2 == 1 ? -0.0f : keys[i] / 2.0f;
+            snprintf(buf + 12, 8, "s%d", keys[i] % 50);
+            fh->insert_record(buf, context_.get());
+        }
+    }
+
+    // 取值在[-domain, domain)内均匀分布的key
+    std::vector<int> SignedKeys(int num, int domain) {
+        std::vector<int> keys(num);
+        for (auto &key : keys) {
+            key = static_cast<int>(rng_() % (2 * domain)) - domain;
+        }
+        return keys;
+    }
+
+    std::unique_ptr<AbstractExecutor> Scan(const std::string &tab_name) {
+        return std::make_unique<SeqScanExecutor>(sm_manager_.get(), tab_name, std::vector<Condition>{},
+                                                 context_.get());
+    }
+
+    // 批量执行，按输出的顺序返回结果
+    static std::vector<std::string> RunBatch(AbstractExecutor *exec) {
+        std::vector<std::string> rows;
+        DataChunk chunk;
+        for (exec->beginBatch(); exec->NextBatch(chunk);) {
+            for (size_t i = 0; i < chunk.count(); i++) {
+                rows.emplace_back(chunk.row(i), exec->tupleLen());
+            }
+        }
+        return rows;
+    }
+
+    // 逐元组执行，按输出的顺序返回结果
+    static std::vector<std::string> RunTuple(AbstractExecutor *exec) {
+        std::vector<std::string> rows;
+        for (exec->beginTuple(); !exec->is_end(); exec->nextTuple()) {
+            rows.emplace_back(exec->Next()->data, exec->tupleLen());
+        }
+        return rows;
+    }
+};
@@ -0,0 +1,215 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BLinkTreeTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";          // 测试文件名的前缀
+const std::vector<ColMeta> TEST_COLS = {{.tab_name = TEST_FILE_NAME,
+                                         .name = "col1",
+                                         .type = TYPE_INT,
+                                         .len = sizeof(int),
+                                         .offset = 0,
+                                         .index = true}};
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后在此目录下创建和打开B-link树索引文件"table1_col1.idx" */
+class BLinkTreeTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, TEST_COLS, INDEX_BLINK);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COLS);
+        ASSERT_EQ(ih_->file_hdr_->index_type_, INDEX_BLINK);
+    }
+
+    void TearDown() override {
+        ix_manager_->close_index(ih_.get());
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    // 检查每一层的right link与high key是否首尾相接，并且结点内的key都小于自己的high key
+    void CheckLevels() {
+        IxNodeHandle leftmost = ih_->fetch_node(ih_->file_hdr_->root_page_);
+        while (true) {
+            IxNodeHandle node = leftmost;
+            buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+            while (true) {
+                for (int i = 0; i < node.get_size(); i++) {
+                    if (node.has_high_key()) {
+                        EXPECT_LT(*(int *)node.get_key(i), *(int *)node.get_high_key());
+                    }
+                }
+                if (node.get_right_link() == IX_NO_PAGE) {
+                    EXPECT_FALSE(node.has_high_key());
+                    break;
+                }
+                IxNodeHandle right = ih_->fetch_node(node.get_right_link());
+                buffer_pool_manager_->unpin_page(right.get_page_id(), false);
+                EXPECT_TRUE(node.has_high_key());
+                if (right.get_size() > 0) {
+                    EXPECT_LE(*(int *)node.get_high_key(), *(int *)right.get_key(0));
+                }
+                node = right;
+            }
+            if (leftmost.is_leaf_page()) {
+                break;
+            }
+            leftmost = ih_->fetch_node(leftmost.value_at(0));
+        }
+    }
+};
+
+/**
+ * @brief 顺序插入与随机插入后，点查、范围扫描以及每层的right link链都应正确
+ */
+TEST_F(BLinkTreeTest, InsertTest) {
+    const int scale = 20000;
+    std::vector<int> keys;
+    for (int key = 1; key <= scale; key++) {
+        keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+
+    for (int key : keys) {
+        Rid rid = {.page_no = 0, .slot_no = key};
+        ih_->insert_entry((const char *)&key, rid, txn_.get());
+    }
+    CheckLevels();
+
+    for (int key = 1; key <= scale; key++) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih_->get_value((const char *)&key, &result, txn_.get()));
+        ASSERT_EQ(result.size(), 1);
+        EXPECT_EQ(result[0].slot_no, key);
+    }
+
+    int current_key = 1;
+    IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+    while (!scan.is_end()) {
+        EXPECT_EQ(scan.rid().slot_no, current_key);
+        current_key++;
+        scan.next();
+    }
+    EXPECT_EQ(current_key, scale + 1);
+}
+
+/**
+ * @brief B-link树删除时不合并结点，删除后剩余的key仍然可以被找到，扫描需要跳过空的叶子
+ */
+TEST_F(BLinkTreeTest, DeleteTest) {
+    const int scale = 10000;
+    for (int key = 1; key <= scale; key++) {
+        Rid rid = {.page_no = 0, .slot_no = key};
+        ih_->insert_entry((const char *)&key, rid, txn_.get());
+    }
+    // 删除前半部分（产生大量空叶子）以及所有的奇数
+    for (int key = 1; key <= scale; key++) {
+        if (key <= scale / 2 || key % 2 == 1) {
+            ih_->delete_entry((const char *)&key, txn_.get());
+        }
+    }
+    CheckLevels();
+
+    for (int key = 1; key <= scale; key++) {
+        std::vector<Rid> result;
+        bool expected = key > scale / 2 && key % 2 == 0;
+        EXPECT_EQ(ih_->get_value((const char *)&key, &result, txn_.get()), expected);
+    }
+
+    int current_key = scale / 2 + 2;
+    IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+    while (!scan.is_end()) {
+        EXPECT_EQ(scan.rid().slot_no, current_key);
+        current_key += 2;
+        scan.next();
+    }
+    EXPECT_EQ(current_key, scale + 2);
+}
+
+/**
+ * @brief 一个写者不断插入（触发分裂），多个读者同时点查已经插入完成的key，读者不应该漏掉任何一个key
+ */
+TEST_F(BLinkTreeTest, ConcurrentReadDuringSplitTest) {
+    const int scale = 20000;
+    const int reader_num = 4;
+    std::vector<int> keys;
+    for (int key = 1; key <= scale; key++) {
+        keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+
+    std::atomic<int> inserted{0};
+    std::atomic<int> missed{0};
+    std::thread writer([&]() {
+        Transaction txn(1);
+        for (int i = 0; i < scale; i++) {
+            Rid rid = {.page_no = 0, .slot_no = keys[i]};
+            ih_->insert_entry((const char *)&keys[i], rid, &txn);
+            inserted.store(i + 1, std::memory_order_release);
+        }
+    });
+    std::vector<std::thread> readers;
+    for (int r = 0; r < reader_num; r++) {
+        readers.emplace_back([&, r]() {
+            Transaction txn(2 + r);
+            std::default_random_engine rng(r);
+            while (inserted.load(std::memory_order_acquire) < scale) {
+                int n = inserted.load(std::memory_order_acquire);
+                if (n == 0) {
+                    continue;
+                }
+                int key = keys[rng() % n];
+                std::vector<Rid> result;
+                if (!ih_->get_value((const char *)&key, &result, &txn) || result[0].slot_no != key) {
+                    missed++;
+                }
+            }
+        });
+    }
+    writer.join();
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(missed.load(), 0);
+    CheckLevels();
+}
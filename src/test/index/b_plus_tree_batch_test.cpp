@@ -0,0 +1,191 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeBatchTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";               // 测试文件名的前缀
+
+using Entries = std::vector<std::pair<std::vector<char>, Rid>>;
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后由测试点自己决定索引类型、字段类型以及是否唯一，创建索引文件 */
+class BPlusTreeBatchTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    ColMeta col_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void OpenIndex(IndexType index_type, ColType col_type, bool unique) {
+        int len = col_type == TYPE_STRING ? 64 : sizeof(int);
+        col_ = {.tab_name = TEST_FILE_NAME, .name = "col1", .type = col_type, .len = len, .offset = 0, .index = true};
+        ix_manager_->create_index(TEST_FILE_NAME, {col_}, index_type, unique);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, std::vector<ColMeta>{col_});
+    }
+
+    std::vector<char> MakeKey(int i) const {
+        std::vector<char> key(col_.len, 0);
+        if (col_.type == TYPE_STRING) {
+            snprintf(key.data(), key.size(), "customer-%08d", i);
+        } else {
+            memcpy(key.data(), &i, sizeof(int));
+        }
+        return key;
+    }
+
+    // 用get_value逐个检查key_num个key对应的rid与expected一致，B+树还要检查全表扫描的顺序
+    void Check(const std::set<std::pair<int, std::pair<int, int>>> &expected, int key_num) {
+        for (int i = 0; i < key_num; i++) {
+            std::vector<Rid> result;
+            ih_->get_value(MakeKey(i).data(), &result, txn_.get());
+            std::vector<Rid> rids;
+            for (auto it = expected.lower_bound({i, {INT_MIN, INT_MIN}}); it != expected.end() && it->first == i;
+                 ++it) {
+                rids.push_back(Rid{it->second.first, it->second.second});
+            }
+            ASSERT_EQ(result, rids) << "key " << i;
+        }
+        if (ih_->is_hash()) {
+            return;
+        }
+        IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+        auto it = expected.begin();
+        while (!scan.is_end()) {
+            ASSERT_NE(it, expected.end());
+            EXPECT_EQ(memcmp(scan.key(), MakeKey(it->first).data(), col_.len), 0);
+            EXPECT_EQ(scan.rid(), (Rid{it->second.first, it->second.second}));
+            ++it;
+            scan.next();
+        }
+        EXPECT_EQ(it, expected.end());
+    }
+
+    /**
+     * @brief 分多批随机插入、删除键值对，与std::set的结果对比；唯一索引中重复的key使整批插入都不生效
+     */
+    void RandomTest(IndexType index_type, ColType col_type, bool unique) {
+        OpenIndex(index_type, col_type, unique);
+        const int key_num = 20000;
+        const int dup_num = unique ? 1 : 3;
+        const int batch_size = 2500;
+        std::vector<std::pair<int, int>> all;
+        for (int i = 0; i < key_num; i++) {
+            for (int slot = 0; slot < dup_num; slot++) {
+                all.emplace_back(i, slot);
+            }
+        }
+        std::default_random_engine rng(index_type * 10 + col_type * 2 + unique);
+        std::shuffle(all.begin(), all.end(), rng);
+        auto make_batch = [&](size_t begin, size_t end) {
+            Entries batch;
+            for (size_t n = begin; n < end; n++) {
+                batch.emplace_back(MakeKey(all[n].first), Rid{all[n].first, all[n].second});
+            }
+            return batch;
+        };
+
+        std::set<std::pair<int, std::pair<int, int>>> expected;
+        for (size_t begin = 0; begin < all.size(); begin += batch_size) {
+            size_t end = std::min(all.size(), begin + batch_size);
+            ih_->insert_entries(make_batch(begin, end), txn_.get());
+            for (size_t n = begin; n < end; n++) {
+                expected.insert({all[n].first, {all[n].first, all[n].second}});
+            }
+        }
+        Check(expected, key_num);
+
+        if (unique) {
+            // 批内和批外的重复key都使整批插入失败，已经插入的部分被撤销
+            Entries batch = {{MakeKey(key_num), Rid{key_num, 0}}, {MakeKey(key_num), Rid{key_num, 1}}};
+            EXPECT_THROW(ih_->insert_entries(batch, txn_.get()), DuplicateKeyError);
+            batch = {{MakeKey(key_num + 1), Rid{key_num + 1, 0}},
+                     {MakeKey(key_num / 2), Rid{-1, -1}},
+                     {MakeKey(key_num + 2), Rid{key_num + 2, 0}}};
+            EXPECT_THROW(ih_->insert_entries(batch, txn_.get()), DuplicateKeyError);
+            Check(expected, key_num + 3);
+        }
+
+        // 分批删除大约3/4的键值对，同时删除一些不存在的键值对
+        std::shuffle(all.begin(), all.end(), rng);
+        size_t delete_num = all.size() * 3 / 4;
+        for (size_t begin = 0; begin < delete_num; begin += batch_size) {
+            size_t end = std::min(delete_num, begin + batch_size);
+            Entries batch = make_batch(begin, end);
+            batch.emplace_back(MakeKey(key_num + 5), Rid{0, 0});
+            EXPECT_EQ(ih_->delete_entries(batch, txn_.get()), static_cast<int>(end - begin));
+            for (size_t n = begin; n < end; n++) {
+                expected.erase({all[n].first, {all[n].first, all[n].second}});
+            }
+        }
+        Check(expected, key_num);
+
+        // 删除剩余的键值对之后，索引仍然可以继续批量插入
+        EXPECT_EQ(ih_->delete_entries(make_batch(delete_num, all.size()), txn_.get()),
+                  static_cast<int>(all.size() - delete_num));
+        expected.clear();
+        Check(expected, key_num);
+        ih_->insert_entries(make_batch(0, batch_size), txn_.get());
+        for (size_t n = 0; n < static_cast<size_t>(batch_size); n++) {
+            expected.insert({all[n].first, {all[n].first, all[n].second}});
+        }
+        Check(expected, key_num);
+    }
+};
+
+TEST_F(BPlusTreeBatchTest, BTreeUniqueTest) { RandomTest(INDEX_BTREE, TYPE_INT, true); }
+
+TEST_F(BPlusTreeBatchTest, BTreeDuplicateTest) { RandomTest(INDEX_BTREE, TYPE_INT, false); }
+
+TEST_F(BPlusTreeBatchTest, CompressedTest) { RandomTest(INDEX_BTREE, TYPE_STRING, false); }
+
+TEST_F(BPlusTreeBatchTest, BLinkTreeTest) { RandomTest(INDEX_BLINK, TYPE_INT, true); }
+
+TEST_F(BPlusTreeBatchTest, HashTest) { RandomTest(INDEX_HASH, TYPE_INT, true); }
@@ -0,0 +1,221 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <atomic>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeBloomTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";               // 测试文件名的前缀
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后由测试点自己决定索引类型以及是否唯一，在INT字段上创建索引文件 */
+class BPlusTreeBloomTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    std::vector<ColMeta> cols_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        CloseIndex();
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void OpenIndex(IndexType index_type, bool unique) {
+        CloseIndex();
+        cols_ = {{.tab_name = TEST_FILE_NAME, .name = "col1", .type = TYPE_INT, .len = sizeof(int), .offset = 0,
+                  .index = true}};
+        if (ix_manager_->exists(TEST_FILE_NAME, cols_)) {
+            ix_manager_->destroy_index(TEST_FILE_NAME, cols_);
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, cols_, index_type, unique);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    }
+
+    void CloseIndex() {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+            ih_.reset();
+        }
+    }
+
+    bool GetValue(int key) {
+        std::vector<Rid> rids;
+        return ih_->get_value(reinterpret_cast<const char *>(&key), &rids, txn_.get());
+    }
+
+    void Insert(int key) { ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, txn_.get()); }
+
+    bool Delete(int key) { return ih_->delete_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, txn_.get()); }
+};
+
+/**
+ * @brief 单独测试filter：加入的key总是返回true，没有加入的key误判率接近预期；浮点数的+0和-0视为相同的key
+ */
+TEST_F(BPlusTreeBloomTest, FilterTest) {
+    const int key_num = 20000;
+    IxBloomFilter filter({TYPE_INT}, {sizeof(int)}, key_num);
+    for (int i = 0; i < key_num; i++) {
+        filter.add(reinterpret_cast<const char *>(&i));
+    }
+    EXPECT_EQ(filter.num_added(), key_num);
+    EXPECT_GE(filter.num_bits(), key_num * IX_BLOOM_BITS_PER_KEY);
+    EXPECT_FALSE(filter.is_stale());
+    for (int i = 0; i < key_num; i++) {
+        ASSERT_TRUE(filter.may_contain(reinterpret_cast<const char *>(&i))) << "key " << i;
+    }
+    int false_positives = 0;
+    for (int i = key_num; i < 2 * key_num; i++) {
+        false_positives += filter.may_contain(reinterpret_cast<const char *>(&i));
+    }
+    // 每个key 10 bit时标准Bloom filter的误判率约为1%，分块之后略高
+    EXPECT_LT(false_positives, key_num * 3 / 100);
+
+    filter.note_removed(key_num / 2 + 1);
+    EXPECT_TRUE(filter.is_stale());
+
+    IxBloomFilter float_filter({TYPE_FLOAT}, {sizeof(float)}, 0);
+    float negative_zero = -0.0f;
+    float zero = 0.0f;
+    float_filter.add(reinterpret_cast<const char *>(&negative_zero));
+    EXPECT_TRUE(float_filter.may_contain(reinterpret_cast<const char *>(&zero)));
+}
+
+/**
+ * @brief 各种索引上启用filter之后，不存在的key大部分由filter直接排除，存在的key总能找到；
+ * 删除过半的key之后filter重新构建，关闭filter之后不再计数，启用的设置在重新打开索引后保持
+ */
+TEST_F(BPlusTreeBloomTest, NegativeLookupTest) {
+    struct Case {
+        IndexType index_type;
+        bool unique;
+    };
+    const int key_num = 5000;
+    for (auto [index_type, unique] : {Case{INDEX_BTREE, true}, Case{INDEX_BTREE, false}, Case{INDEX_BLINK, false},
+                                      Case{INDEX_HASH, true}, Case{INDEX_HASH, false}}) {
+        SCOPED_TRACE("index_type " + indextype2str(index_type) + (unique ? " unique" : ""));
+        OpenIndex(index_type, unique);
+        EXPECT_FALSE(ih_->has_bloom());
+        EXPECT_TRUE(ih_->may_contain(reinterpret_cast<const char *>(&key_num)));
+        EXPECT_EQ(ih_->get_bloom_stats().lookups, 0);
+
+        // 先插入一半的偶数，启用filter，再插入另一半：filter首次查找时按两倍的key数量构建，之后的插入直接加入filter
+        for (int i = 0; i < key_num; i += 2) {
+            Insert(i * 2);
+        }
+        ih_->set_bloom(true);
+        EXPECT_TRUE(GetValue(0));
+        for (int i = 1; i < key_num; i += 2) {
+            Insert(i * 2);
+        }
+        for (int i = 0; i < key_num; i++) {
+            ASSERT_TRUE(GetValue(i * 2)) << "key " << i * 2;
+            GetValue(i * 2 + 1);
+        }
+        IxBloomStats stats = ih_->get_bloom_stats();
+        EXPECT_TRUE(stats.enabled);
+        EXPECT_EQ(stats.rebuilds, 1);
+        EXPECT_EQ(stats.num_keys, key_num);
+        EXPECT_EQ(stats.lookups, 2 * key_num + 1);
+        EXPECT_EQ(stats.negatives + stats.false_positives, key_num);
+        EXPECT_LT(stats.false_positives, key_num * 3 / 100);
+
+        // 删除过半的key之后，下一次查找重新构建filter
+        for (int i = 0; i < key_num * 3 / 4; i++) {
+            ASSERT_TRUE(Delete(i * 2));
+        }
+        EXPECT_FALSE(GetValue(0));
+        EXPECT_TRUE(GetValue((key_num - 1) * 2));
+        stats = ih_->get_bloom_stats();
+        EXPECT_EQ(stats.rebuilds, 2);
+        EXPECT_EQ(stats.num_keys, key_num - key_num * 3 / 4);
+
+        // 设置写回文件头，重新打开后仍然启用，计数重新开始
+        CloseIndex();
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+        EXPECT_TRUE(ih_->has_bloom());
+        EXPECT_TRUE(GetValue((key_num - 1) * 2));
+        EXPECT_EQ(ih_->get_bloom_stats().lookups, 1);
+
+        ih_->set_bloom(false);
+        EXPECT_FALSE(GetValue(1));
+        stats = ih_->get_bloom_stats();
+        EXPECT_FALSE(stats.enabled);
+        EXPECT_EQ(stats.lookups, 1);
+        EXPECT_EQ(stats.num_bits, 0);
+    }
+}
+
+/**
+ * @brief 插入、删除与查找并发执行，并且删除不断使filter过时而重新构建：插入返回之后，这个key总能通过filter找到
+ */
+TEST_F(BPlusTreeBloomTest, ConcurrentTest) {
+    for (IndexType index_type : {INDEX_BTREE, INDEX_HASH}) {
+        SCOPED_TRACE("index_type " + indextype2str(index_type));
+        OpenIndex(index_type, true);
+        ih_->set_bloom(true);
+        const int thread_num = 4;
+        const int key_num = 2000;
+        std::atomic<int> missing{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; t++) {
+            threads.emplace_back([&, t]() {
+                Transaction txn(t + 1);
+                for (int i = 0; i < key_num; i++) {
+                    int key = i * thread_num + t;
+                    ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, &txn);
+                    std::vector<Rid> rids;
+                    missing += !ih_->get_value(reinterpret_cast<const char *>(&key), &rids, &txn);
+                    // 删除五分之三刚插入的key，删除数量超过插入数量的一半，filter会多次过时
+                    if (i % 5 < 3) {
+                        ih_->delete_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, &txn);
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        EXPECT_EQ(missing, 0);
+        for (int key = 0; key < key_num * thread_num; key++) {
+            ASSERT_EQ(GetValue(key), key / thread_num % 5 >= 3) << "key " << key;
+        }
+        EXPECT_GT(ih_->get_bloom_stats().rebuilds, 1);
+    }
+}
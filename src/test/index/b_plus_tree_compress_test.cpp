@@ -0,0 +1,198 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeCompressTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                  // 测试文件名的前缀
+const int TEST_COL_LEN = 64;                                  // 字符串字段的长度
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后由测试点自己决定索引类型以及是否唯一，在CHAR(64)字段上创建索引文件"table1_col1.idx" */
+class BPlusTreeCompressTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    std::vector<ColMeta> cols_ = {{.tab_name = TEST_FILE_NAME,
+                                   .name = "col1",
+                                   .type = TYPE_STRING,
+                                   .len = TEST_COL_LEN,
+                                   .offset = 0,
+                                   .index = true}};
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void OpenIndex(IndexType index_type, bool unique) {
+        ix_manager_->create_index(TEST_FILE_NAME, cols_, index_type, unique);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+        ASSERT_TRUE(ih_->file_hdr_->compressed_);
+    }
+
+    // 定长的字符串key，末尾填充0
+    static std::string MakeKey(int i) {
+        char buf[TEST_COL_LEN] = {};
+        snprintf(buf, sizeof(buf), "customer-%08d", i);
+        return std::string(buf, TEST_COL_LEN);
+    }
+
+    int TreeHeight() {
+        int height = 1;
+        IxNodeHandle node = ih_->fetch_node(ih_->file_hdr_->root_page_);
+        while (!node.is_leaf_page()) {
+            page_id_t child = node.value_at(0);
+            buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+            node = ih_->fetch_node(child);
+            height++;
+        }
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+        return height;
+    }
+
+    // 全表扫描索引，检查key和rid的顺序与expected完全一致
+    void CheckScan(const std::set<std::pair<std::string, std::pair<int, int>>> &expected) {
+        IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+        auto it = expected.begin();
+        while (!scan.is_end()) {
+            ASSERT_NE(it, expected.end());
+            EXPECT_EQ(memcmp(scan.key(), it->first.data(), TEST_COL_LEN), 0);
+            EXPECT_EQ(scan.rid(), (Rid{it->second.first, it->second.second}));
+            ++it;
+            scan.next();
+        }
+        EXPECT_EQ(it, expected.end());
+    }
+
+    /**
+     * @brief 随机插入和删除有长公共前缀的字符串key，与std::set的结果对比，最后删除所有key再重新插入
+     */
+    void RandomTest(IndexType index_type, bool unique) {
+        OpenIndex(index_type, unique);
+        const int key_num = 20000;
+        const int dup_num = unique ? 1 : 3;
+        std::set<std::pair<std::string, std::pair<int, int>>> expected;
+        std::vector<std::pair<int, int>> entries;
+        for (int i = 0; i < key_num; i++) {
+            for (int slot = 0; slot < dup_num; slot++) {
+                entries.emplace_back(i, slot);
+            }
+        }
+        std::default_random_engine rng(unique ? 1 : 2);
+        std::shuffle(entries.begin(), entries.end(), rng);
+        for (auto &[i, slot] : entries) {
+            std::string key = MakeKey(i);
+            ih_->insert_entry(key.data(), Rid{i, slot}, txn_.get());
+            expected.insert({key, {i, slot}});
+        }
+        CheckScan(expected);
+        if (unique) {
+            std::string key = MakeKey(key_num / 2);
+            EXPECT_THROW(ih_->insert_entry(key.data(), Rid{-1, -1}, txn_.get()), DuplicateKeyError);
+        }
+
+        // 删除大约3/4的键值对，使结点发生合并和重分配
+        std::shuffle(entries.begin(), entries.end(), rng);
+        for (size_t n = 0; n < entries.size() * 3 / 4; n++) {
+            auto [i, slot] = entries[n];
+            std::string key = MakeKey(i);
+            ASSERT_TRUE(ih_->delete_entry(key.data(), Rid{i, slot}, txn_.get()));
+            expected.erase({key, {i, slot}});
+        }
+        CheckScan(expected);
+        for (int i = 0; i < key_num; i += 97) {
+            std::string key = MakeKey(i);
+            std::vector<Rid> result;
+            ih_->get_value(key.data(), &result, txn_.get());
+            auto lower = expected.lower_bound({key, {INT_MIN, INT_MIN}});
+            auto upper = expected.upper_bound({key, {INT_MAX, INT_MAX}});
+            ASSERT_EQ(result.size(), static_cast<size_t>(std::distance(lower, upper)));
+        }
+
+        // 删除剩余的键值对之后，树仍然可以继续插入
+        for (size_t n = entries.size() * 3 / 4; n < entries.size(); n++) {
+            auto [i, slot] = entries[n];
+            ASSERT_TRUE(ih_->delete_entry(MakeKey(i).data(), Rid{i, slot}, txn_.get()));
+        }
+        expected.clear();
+        CheckScan(expected);
+        for (int i = 0; i < 1000; i++) {
+            std::string key = MakeKey(i);
+            ih_->insert_entry(key.data(), Rid{i, 0}, txn_.get());
+            expected.insert({key, {i, 0}});
+        }
+        CheckScan(expected);
+    }
+};
+
+TEST_F(BPlusTreeCompressTest, BTreeUniqueTest) { RandomTest(INDEX_BTREE, true); }
+
+TEST_F(BPlusTreeCompressTest, BTreeDuplicateTest) { RandomTest(INDEX_BTREE, false); }
+
+TEST_F(BPlusTreeCompressTest, BLinkTreeTest) { RandomTest(INDEX_BLINK, false); }
+
+/**
+ * @brief 压缩格式的叶子能放下的键值对远多于定长格式的btree_order，树也更矮
+ */
+TEST_F(BPlusTreeCompressTest, FanoutTest) {
+    OpenIndex(INDEX_BTREE, true);
+    const int key_num = 100000;
+    for (int i = 0; i < key_num; i++) {
+        ih_->insert_entry(MakeKey(i).data(), Rid{i, 0}, txn_.get());
+    }
+    // 顺序插入时分裂出的左结点只有一半是满的，定长格式平均每个叶子约btree_order/2个键值对
+    int legacy_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (TEST_COL_LEN + sizeof(Rid)) - 1);
+    int leaf_num = 0;
+    for (page_id_t page_no = ih_->file_hdr_->first_leaf_; page_no != IX_LEAF_HEADER_PAGE;) {
+        IxNodeHandle leaf = ih_->fetch_node(page_no);
+        page_no = leaf.get_next_leaf();
+        buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+        leaf_num++;
+    }
+    EXPECT_GT(key_num / leaf_num, legacy_order);
+    EXPECT_LE(TreeHeight(), 3);
+}
@@ -0,0 +1,307 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeRebuildTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                 // 测试文件名的前缀
+const int TEST_STRING_LEN = 32;                              // 字符串字段的长度，字符串索引使用压缩格式的结点
+
+using Entries = std::vector<std::pair<std::vector<char>, Rid>>;
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 每个测试点可以在INT或CHAR(32)字段上创建多个索引，ihs_[0]是原索引，ihs_[1]是重建得到的新索引 */
+class BPlusTreeRebuildTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::vector<std::unique_ptr<IxIndexHandle>> ihs_;
+    std::unique_ptr<Transaction> txn_;
+    ColType col_type_ = TYPE_INT;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        for (auto &ih : ihs_) {
+            ix_manager_->close_index(ih.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    std::vector<ColMeta> Cols() const {
+        int len = col_type_ == TYPE_INT ? sizeof(int) : TEST_STRING_LEN;
+        return {{.tab_name = TEST_FILE_NAME, .name = "col1", .type = col_type_, .len = len, .offset = 0,
+                 .index = true}};
+    }
+
+    // 依次创建并打开table1_col1.idx、table1.rebuild_col1.idx，与SmManager::rebuild_index使用的文件名相同
+    IxIndexHandle *OpenIndex(IndexType index_type, bool unique) {
+        std::string filename = ihs_.empty() ? TEST_FILE_NAME : ix_manager_->get_rebuild_filename(TEST_FILE_NAME);
+        ix_manager_->create_index(filename, Cols(), index_type, unique);
+        ihs_.push_back(ix_manager_->open_index(filename, Cols()));
+        return ihs_.back().get();
+    }
+
+    std::vector<char> MakeKey(int i) const {
+        if (col_type_ == TYPE_INT) {
+            return std::vector<char>(reinterpret_cast<const char *>(&i), reinterpret_cast<const char *>(&i) + sizeof(i));
+        }
+        std::vector<char> key(TEST_STRING_LEN);
+        snprintf(key.data(), key.size(), "order-line-%08d", i);
+        return key;
+    }
+
+    Entries MakeEntries(const std::vector<int> &values) const {
+        Entries entries;
+        for (int value : values) {
+            entries.emplace_back(MakeKey(value), Rid{value, value % 7});
+        }
+        return entries;
+    }
+
+    // 按叶子链表顺序读出索引中的全部键值对，同时检查叶子数量与统计信息一致
+    Entries Scan(IxIndexHandle *ih) {
+        Entries result;
+        int key_len = ih->file_hdr_->key_len();
+        int leaves = 0;
+        for (page_id_t page_no = ih->file_hdr_->first_leaf_; page_no != IX_LEAF_HEADER_PAGE; leaves++) {
+            IxNodeHandle leaf = ih->fetch_node(page_no);
+            std::vector<char> key(ih->file_hdr_->col_tot_len_);
+            for (int i = 0; i < leaf.get_size(); i++) {
+                leaf.copy_key(i, key.data());
+                result.emplace_back(std::vector<char>(key.begin(), key.begin() + key_len), *leaf.get_rid(i));
+            }
+            page_no = leaf.get_next_leaf();
+            buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+        }
+        EXPECT_EQ(leaves, ih->get_stats().num_leaves_);
+        return result;
+    }
+
+    // 检查索引中恰好是expected中的键值对：逐个get_value，B+树还要按顺序扫描
+    void CheckContent(IxIndexHandle *ih, const std::vector<int> &expected) {
+        for (int value : expected) {
+            std::vector<Rid> rids;
+            ASSERT_TRUE(ih->get_value(MakeKey(value).data(), &rids, txn_.get())) << "key " << value;
+            ASSERT_EQ(rids, std::vector<Rid>{(Rid{value, value % 7})});
+        }
+        EXPECT_EQ(ih->get_stats().num_keys_, static_cast<int64_t>(expected.size()));
+        if (ih->is_hash()) {
+            return;
+        }
+        Entries sorted = MakeEntries(expected);
+        int len = Cols()[0].len;
+        std::sort(sorted.begin(), sorted.end(), [&](const auto &a, const auto &b) {
+            return ix_compare(a.first.data(), b.first.data(), col_type_, len) < 0;
+        });
+        EXPECT_EQ(Scan(ih), sorted);
+    }
+};
+
+/**
+ * @brief 各种格式的索引批量装载之后内容正确，叶子按填充率装满，并且之后可以正常插入和删除（引起分裂与合并）
+ */
+TEST_F(BPlusTreeRebuildTest, BulkLoadTest) {
+    struct Case {
+        ColType col_type;
+        IndexType index_type;
+        bool unique;
+    };
+    const int key_num = 20000;
+    const std::vector<Case> cases = {Case{TYPE_INT, INDEX_BTREE, true},     Case{TYPE_INT, INDEX_BTREE, false},
+                                     Case{TYPE_INT, INDEX_BLINK, false},    Case{TYPE_STRING, INDEX_BTREE, true},
+                                     Case{TYPE_STRING, INDEX_BLINK, false}, Case{TYPE_INT, INDEX_HASH, true}};
+    for (auto [col_type, index_type, unique] : cases) {
+        SCOPED_TRACE("col_type " + coltype2str(col_type) + ", index_type " + indextype2str(index_type));
+        col_type_ = col_type;
+        IxIndexHandle *ih = OpenIndex(index_type, unique);
+        std::vector<int> values(key_num);
+        for (int i = 0; i < key_num; i++) {
+            values[i] = i;
+        }
+        std::shuffle(values.begin(), values.end(), std::default_random_engine(key_num));
+        ih->bulk_load(MakeEntries(values));
+        CheckContent(ih, values);
+
+        if (index_type != INDEX_HASH) {
+            IxFileHdr stats = ih->get_stats();
+            EXPECT_GE(stats.height_, 2);
+            if (!ih->is_compressed()) {
+                double fill = static_cast<double>(stats.num_keys_) / stats.num_leaves_ / stats.btree_order_;
+                EXPECT_NEAR(fill, IX_BULK_LOAD_FILL_FACTOR, 0.02);
+            }
+        }
+
+        // 装载之后在末尾追加、在中间插入，再删除一大半
+        for (int i = key_num; i < key_num + 2000; i++) {
+            values.push_back(i);
+            ih->insert_entry(MakeKey(i).data(), Rid{i, i % 7}, txn_.get());
+        }
+        for (int i = 0; i < 3000; i++) {
+            int value = -1 - i;
+            values.push_back(value);
+            ih->insert_entry(MakeKey(value).data(), Rid{value, value % 7}, txn_.get());
+        }
+        std::shuffle(values.begin(), values.end(), std::default_random_engine(1));
+        size_t delete_num = values.size() * 2 / 3;
+        for (size_t i = 0; i < delete_num; i++) {
+            ASSERT_TRUE(ih->delete_entry(MakeKey(values.back()).data(), Rid{values.back(), values.back() % 7},
+                                         txn_.get()));
+            values.pop_back();
+        }
+        CheckContent(ih, values);
+
+        ix_manager_->close_index(ih);
+        ix_manager_->destroy_index(TEST_FILE_NAME, Cols());
+        ihs_.clear();
+    }
+}
+
+/**
+ * @brief 大量删除之后重建：新索引的叶子数量回到按填充率装满时的水平，并替换原来的索引文件
+ */
+TEST_F(BPlusTreeRebuildTest, CompactAfterDeleteTest) {
+    const int key_num = 30000;
+    IxIndexHandle *old_ih = OpenIndex(INDEX_BTREE, false);
+    std::vector<int> values(key_num);
+    for (int i = 0; i < key_num; i++) {
+        values[i] = i;
+    }
+    std::shuffle(values.begin(), values.end(), std::default_random_engine(2));
+    for (int value : values) {
+        old_ih->insert_entry(MakeKey(value).data(), Rid{value, value % 7}, txn_.get());
+    }
+    for (int i = 0; i < key_num * 3 / 4; i++) {
+        ASSERT_TRUE(old_ih->delete_entry(MakeKey(values.back()).data(), Rid{values.back(), values.back() % 7},
+                                         txn_.get()));
+        values.pop_back();
+    }
+    int old_leaves = old_ih->get_stats().num_leaves_;
+    int old_pages = old_ih->file_hdr_->num_pages_;
+
+    IxIndexHandle *new_ih = OpenIndex(INDEX_BTREE, false);
+    new_ih->bulk_load(Scan(old_ih));
+    CheckContent(new_ih, values);
+    int new_leaves = new_ih->get_stats().num_leaves_;
+    int order = new_ih->file_hdr_->btree_order_;
+    EXPECT_EQ(new_leaves, (static_cast<int>(values.size()) + static_cast<int>(order * IX_BULK_LOAD_FILL_FACTOR) - 1) /
+                              static_cast<int>(order * IX_BULK_LOAD_FILL_FACTOR));
+    EXPECT_LT(new_leaves, old_leaves);
+    EXPECT_LT(new_ih->file_hdr_->num_pages_, old_pages / 2);
+
+    // 与SmManager::rebuild_index相同的替换过程
+    for (auto &ih : ihs_) {
+        ix_manager_->close_index(ih.get());
+    }
+    ihs_.clear();
+    ix_manager_->replace_with_rebuilt(TEST_FILE_NAME, Cols());
+    EXPECT_FALSE(ix_manager_->exists(ix_manager_->get_rebuild_filename(TEST_FILE_NAME), Cols()));
+    ihs_.push_back(ix_manager_->open_index(TEST_FILE_NAME, Cols()));
+    EXPECT_EQ(ihs_[0]->get_stats().num_leaves_, new_leaves);
+    CheckContent(ihs_[0].get(), values);
+}
+
+/**
+ * @brief 在线重建：开始记录修改之后读到的快照可能已经包含部分修改，也可能包含插入时因为key重复而被拒绝的记录，
+ * 同步记录下来的key之后，新索引与原索引的内容相同
+ */
+TEST_F(BPlusTreeRebuildTest, CaptureAndSyncTest) {
+    for (IndexType index_type : {INDEX_BTREE, INDEX_HASH}) {
+        for (bool unique : {true, false}) {
+            SCOPED_TRACE("index_type " + indextype2str(index_type) + ", unique " + std::to_string(unique));
+            IxIndexHandle *old_ih = OpenIndex(index_type, unique);
+            std::set<int> current;
+            for (int i = 0; i < 5000; i++) {
+                old_ih->insert_entry(MakeKey(i).data(), Rid{i, i % 7}, txn_.get());
+                current.insert(i);
+            }
+
+            old_ih->start_capture();
+            Entries snapshot = MakeEntries(std::vector<int>(current.begin(), current.end()));
+            // 快照读到了之后被删除的key
+            for (int i = 0; i < 1000; i++) {
+                ASSERT_TRUE(old_ih->delete_entry(MakeKey(i).data(), Rid{i, i % 7}, txn_.get()));
+                current.erase(i);
+            }
+            // 唯一索引中快照还读到了一条插入时因为key重复而被拒绝的记录，装载时可能保留它而丢掉已有的键值对
+            if (unique) {
+                EXPECT_THROW(old_ih->insert_entry(MakeKey(2000).data(), Rid{-1, -1}, txn_.get()), DuplicateKeyError);
+                snapshot.insert(snapshot.begin(), {MakeKey(2000), Rid{-1, -1}});
+            }
+
+            IxIndexHandle *new_ih = OpenIndex(index_type, unique);
+            new_ih->bulk_load(snapshot);
+            // 装载之后继续修改：插入新的key，批量删除并重新插入已有的key
+            for (int i = 5000; i < 6000; i++) {
+                old_ih->insert_entry(MakeKey(i).data(), Rid{i, i % 7}, txn_.get());
+                current.insert(i);
+            }
+            EXPECT_EQ(old_ih->delete_entries(MakeEntries({1000, 1001, 1002}), txn_.get()), 3);
+            old_ih->insert_entries(MakeEntries({1000, 1001}), txn_.get());
+            current.erase(1002);
+            new_ih->sync_keys(old_ih, old_ih->take_changed_keys(), txn_.get());
+            EXPECT_TRUE(old_ih->take_changed_keys().empty());
+
+            old_ih->insert_entry(MakeKey(7000).data(), Rid{7000, 7000 % 7}, txn_.get());
+            current.insert(7000);
+            auto keys = old_ih->take_changed_keys();
+            EXPECT_EQ(keys.size(), 1);
+            new_ih->sync_keys(old_ih, keys, txn_.get());
+            new_ih->sync_keys(old_ih, keys, txn_.get());  // 同步多次的结果相同
+
+            // 停止记录之后的修改不再记录
+            old_ih->stop_capture();
+            old_ih->delete_entry(MakeKey(7000).data(), Rid{7000, 7000 % 7}, txn_.get());
+            old_ih->start_capture();
+            EXPECT_TRUE(old_ih->take_changed_keys().empty());
+            old_ih->stop_capture();
+            old_ih->insert_entry(MakeKey(7000).data(), Rid{7000, 7000 % 7}, txn_.get());
+
+            std::vector<int> expected(current.begin(), current.end());
+            CheckContent(old_ih, expected);
+            CheckContent(new_ih, expected);
+
+            for (auto &ih : ihs_) {
+                ix_manager_->close_index(ih.get());
+            }
+            ihs_.clear();
+            ix_manager_->destroy_index(TEST_FILE_NAME, Cols());
+            ix_manager_->destroy_index(ix_manager_->get_rebuild_filename(TEST_FILE_NAME), Cols());
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeReopenTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                // 测试文件名的前缀
+const std::vector<ColMeta> TEST_COLS = {{.tab_name = TEST_FILE_NAME,
+                                         .name = "col1",
+                                         .type = TYPE_INT,
+                                         .len = sizeof(int),
+                                         .offset = 0,
+                                         .index = true}};
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 每次OpenStorage()都新建DiskManager和BufferPoolManager，模拟重新启动之后打开索引 */
+class BPlusTreeReopenTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        OpenStorage();
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void OpenStorage() {
+        ix_manager_.reset();
+        buffer_pool_manager_.reset();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+    }
+
+    void InsertKeys(int begin, int end) {
+        std::vector<int> keys;
+        for (int i = begin; i < end; i++) {
+            keys.push_back(i);
+        }
+        std::shuffle(keys.begin(), keys.end(), std::default_random_engine(begin));
+        for (int key : keys) {
+            ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{key, key}, txn_.get());
+        }
+    }
+
+    void CheckKeys(int key_num) {
+        for (int i = 0; i < key_num; i++) {
+            std::vector<Rid> result;
+            ASSERT_TRUE(ih_->get_value(reinterpret_cast<const char *>(&i), &result, txn_.get())) << "key " << i;
+            ASSERT_EQ(result, std::vector<Rid>{(Rid{i, i})});
+        }
+        if (ih_->is_hash()) {
+            return;
+        }
+        IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+        int expected = 0;
+        for (; !scan.is_end(); scan.next()) {
+            ASSERT_EQ(*reinterpret_cast<const int *>(scan.key()), expected);
+            expected++;
+        }
+        EXPECT_EQ(expected, key_num);
+    }
+};
+
+/**
+ * @brief 重新启动后打开索引，新结点从文件头记录的num_pages_开始分配，不会覆盖已有的结点
+ */
+TEST_F(BPlusTreeReopenTest, AllocateAfterReopenTest) {
+    const int key_num = 20000;
+    ix_manager_->create_index(TEST_FILE_NAME, TEST_COLS, INDEX_BTREE, true);
+    ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COLS);
+    InsertKeys(0, key_num);
+    int num_pages = ih_->file_hdr_->num_pages_;
+    ix_manager_->close_index(ih_.get());
+    ih_.reset();
+
+    OpenStorage();
+    ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COLS);
+    EXPECT_EQ(ih_->file_hdr_->num_pages_, num_pages);
+    EXPECT_EQ(disk_manager_->get_fd2pageno(ih_->fd_), num_pages);
+    InsertKeys(key_num, 2 * key_num);
+    CheckKeys(2 * key_num);
+}
+
+/**
+ * @brief 文件头随缓冲池刷盘：不调用close_index，只刷出缓冲池中的页面，重新打开后根结点和叶子链表仍然正确
+ */
+TEST_F(BPlusTreeReopenTest, FlushWithoutCloseTest) {
+    const int key_num = 20000;
+    for (IndexType index_type : {INDEX_BTREE, INDEX_HASH}) {
+        ix_manager_->create_index(TEST_FILE_NAME, TEST_COLS, index_type, true);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COLS);
+        InsertKeys(0, key_num);
+        page_id_t root_page = ih_->file_hdr_->root_page_;
+        page_id_t last_leaf = ih_->file_hdr_->last_leaf_;
+        int num_pages = ih_->file_hdr_->num_pages_;
+        buffer_pool_manager_->flush_all_pages(ih_->fd_);
+        disk_manager_->close_file(ih_->fd_);
+        ih_.reset();
+
+        OpenStorage();
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COLS);
+        EXPECT_EQ(ih_->file_hdr_->root_page_, root_page);
+        EXPECT_EQ(ih_->file_hdr_->last_leaf_, last_leaf);
+        EXPECT_EQ(ih_->file_hdr_->num_pages_, num_pages);
+        CheckKeys(key_num);
+
+        ix_manager_->close_index(ih_.get());
+        ih_.reset();
+        ix_manager_->destroy_index(TEST_FILE_NAME, TEST_COLS);
+    }
+}
@@ -0,0 +1,131 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeScanTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";              // 测试文件名的前缀
+const std::vector<ColMeta> TEST_COLS = {{.tab_name = TEST_FILE_NAME,
+                                         .name = "col1",
+                                         .type = TYPE_INT,
+                                         .len = sizeof(int),
+                                         .offset = 0,
+                                         .index = true}};
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后在此目录下创建和打开B+树索引文件"table1_col1.idx" */
+class BPlusTreeScanTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, TEST_COLS, INDEX_BTREE);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COLS);
+    }
+
+    void TearDown() override {
+        ix_manager_->close_index(ih_.get());
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+};
+
+/**
+ * @brief 一个写者在中间的key范围内反复插入、删除奇数key（触发分裂、重分配和合并），多个读者同时用IxScan全表扫描，
+ * 每次扫描都应按顺序看到所有不变的偶数key。写者修改兄弟叶子时与扫描的latch coupling按同样的顺序加锁，不会死锁
+ */
+TEST_F(BPlusTreeScanTest, ConcurrentScanDuringSplitAndMergeTest) {
+    const int stable_num = 20000;  // 偶数key 0, 2, ..., 2 * (stable_num - 1)
+    const int reader_num = 4;
+    const int rounds = 3;
+    Transaction txn(0);
+    for (int i = 0; i < stable_num; i++) {
+        int key = 2 * i;
+        ih_->insert_entry((const char *)&key, Rid{.page_no = 0, .slot_no = key}, &txn);
+    }
+    // 写者只改动中间一段，第一个和最后一个叶子保持不变，扫描的起止位置在扫描期间一直有效
+    std::vector<int> volatile_keys;
+    for (int key = stable_num / 2 + 1; key < stable_num * 3 / 2; key += 2) {
+        volatile_keys.push_back(key);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> scans{0};
+    std::thread writer([&]() {
+        Transaction txn(1);
+        std::default_random_engine rng(1);
+        for (int r = 0; r < rounds; r++) {
+            std::shuffle(volatile_keys.begin(), volatile_keys.end(), rng);
+            for (int key : volatile_keys) {
+                ih_->insert_entry((const char *)&key, Rid{.page_no = 0, .slot_no = key}, &txn);
+            }
+            std::shuffle(volatile_keys.begin(), volatile_keys.end(), rng);
+            for (int key : volatile_keys) {
+                EXPECT_TRUE(ih_->delete_entry((const char *)&key, Rid{.page_no = 0, .slot_no = key}, &txn));
+            }
+        }
+        done.store(true);
+    });
+    std::vector<std::thread> readers;
+    for (int r = 0; r < reader_num; r++) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                int prev = -1;
+                int stable_seen = 0;
+                for (IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+                     !scan.is_end(); scan.next()) {
+                    int key = *(const int *)scan.key();
+                    ASSERT_GT(key, prev);
+                    ASSERT_EQ(scan.rid().slot_no, key);
+                    if (key % 2 == 0) {
+                        ASSERT_EQ(key, 2 * stable_seen);
+                        stable_seen++;
+                    }
+                    prev = key;
+                }
+                ASSERT_EQ(stable_seen, stable_num);
+                scans++;
+            }
+        });
+    }
+    writer.join();
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_GT(scans.load(), 0);
+}
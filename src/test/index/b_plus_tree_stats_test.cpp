@@ -0,0 +1,234 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeStatsTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";               // 测试文件名的前缀
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后由测试点自己决定索引类型以及是否唯一，在INT字段上创建索引文件 */
+class BPlusTreeStatsTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    std::vector<ColMeta> cols_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void OpenIndex(IndexType index_type, bool unique) {
+        cols_ = {{.tab_name = TEST_FILE_NAME, .name = "col1", .type = TYPE_INT, .len = sizeof(int), .offset = 0,
+                  .index = true}};
+        ix_manager_->create_index(TEST_FILE_NAME, cols_, index_type, unique);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    }
+
+    void ReopenIndex() {
+        ix_manager_->close_index(ih_.get());
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    }
+
+    // 沿叶子链表数出实际的叶子数量，并从根结点沿最左的孩子数出树的高度
+    std::pair<int, int> CountLeavesAndHeight() {
+        int leaves = 0;
+        for (page_id_t page_no = ih_->file_hdr_->first_leaf_; page_no != IX_LEAF_HEADER_PAGE; leaves++) {
+            IxNodeHandle leaf = ih_->fetch_node(page_no);
+            page_no = leaf.get_next_leaf();
+            buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+        }
+        int height = 1;
+        IxNodeHandle node = ih_->fetch_node(ih_->file_hdr_->root_page_);
+        while (!node.is_leaf_page()) {
+            IxNodeHandle child = ih_->fetch_node(node.value_at(0));
+            buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+            node = child;
+            height++;
+        }
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+        return {leaves, height};
+    }
+
+    double Selectivity(const int *lower, bool lower_inclusive, const int *upper, bool upper_inclusive) {
+        return ih_->estimate_selectivity(reinterpret_cast<const char *>(lower), lower_inclusive,
+                                         reinterpret_cast<const char *>(upper), upper_inclusive);
+    }
+};
+
+/**
+ * @brief 键值对数量、叶子数量和高度随插入、删除（含批量操作）以及结点的分裂合并维护，并在重新打开后保持
+ */
+TEST_F(BPlusTreeStatsTest, MaintainCountersTest) {
+    OpenIndex(INDEX_BTREE, false);
+    const int key_num = 30000;
+    std::vector<int> keys(key_num);
+    for (int i = 0; i < key_num; i++) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(1));
+    for (int i = 0; i < key_num / 2; i++) {
+        ih_->insert_entry(reinterpret_cast<const char *>(&keys[i]), Rid{keys[i], 0}, txn_.get());
+    }
+    std::vector<std::pair<std::vector<char>, Rid>> batch;
+    for (int i = key_num / 2; i < key_num; i++) {
+        const char *key = reinterpret_cast<const char *>(&keys[i]);
+        batch.emplace_back(std::vector<char>(key, key + sizeof(int)), Rid{keys[i], 0});
+    }
+    ih_->insert_entries(batch, txn_.get());
+
+    auto [leaves, height] = CountLeavesAndHeight();
+    EXPECT_EQ(ih_->get_stats().num_keys_, key_num);
+    EXPECT_EQ(ih_->get_stats().num_leaves_, leaves);
+    EXPECT_EQ(ih_->get_stats().height_, height);
+    EXPECT_GE(height, 3);
+
+    // 删除大部分键值对，结点合并之后叶子数量和高度随之减少
+    for (int i = 0; i < key_num / 2; i++) {
+        ASSERT_TRUE(ih_->delete_entry(reinterpret_cast<const char *>(&keys[i]), Rid{keys[i], 0}, txn_.get()));
+    }
+    batch.resize(batch.size() - 100);
+    EXPECT_EQ(ih_->delete_entries(batch, txn_.get()), static_cast<int>(batch.size()));
+    std::tie(leaves, height) = CountLeavesAndHeight();
+    EXPECT_EQ(ih_->get_stats().num_keys_, 100);
+    EXPECT_EQ(ih_->get_stats().num_leaves_, leaves);
+    EXPECT_EQ(ih_->get_stats().height_, height);
+    EXPECT_LE(height, 2);
+
+    ReopenIndex();
+    EXPECT_EQ(ih_->get_stats().num_keys_, 100);
+    EXPECT_EQ(ih_->get_stats().num_leaves_, leaves);
+    EXPECT_EQ(ih_->get_stats().height_, height);
+}
+
+/**
+ * @brief 叶子较少时ANALYZE INDEX扫描全部叶子，不同取值数量是精确的，直方图和选择率估计与实际分布一致
+ */
+TEST_F(BPlusTreeStatsTest, AnalyzeFullScanTest) {
+    OpenIndex(INDEX_BTREE, false);
+    // 0到99每个取值重复20次，共2000个键值对
+    for (int i = 0; i < 2000; i++) {
+        int key = i % 100;
+        ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{i, 0}, txn_.get());
+    }
+    int ten = 10;
+    EXPECT_DOUBLE_EQ(Selectivity(&ten, true, &ten, true), 0.1);  // 没有统计信息时的默认值
+
+    ih_->analyze();
+    ReopenIndex();
+    IxFileHdr stats = ih_->get_stats();
+    EXPECT_TRUE(stats.analyzed_);
+    EXPECT_EQ(stats.num_keys_, 2000);
+    EXPECT_EQ(stats.distinct_keys_, 100);
+    EXPECT_EQ(stats.num_hist_buckets_, IX_HIST_MAX_BUCKETS);
+    EXPECT_GT(stats.avg_fill_, 0.4);
+    ASSERT_EQ(stats.hist_bounds_.size(), (IX_HIST_MAX_BUCKETS + 1) * sizeof(int));
+    const int *bounds = reinterpret_cast<const int *>(stats.hist_bounds_.data());
+    EXPECT_EQ(bounds[0], 0);
+    EXPECT_EQ(bounds[IX_HIST_MAX_BUCKETS], 99);
+    EXPECT_TRUE(std::is_sorted(bounds, bounds + IX_HIST_MAX_BUCKETS + 1));
+
+    int low = 20;
+    int high = 59;
+    EXPECT_NEAR(Selectivity(&ten, true, &ten, true), 0.01, 0.005);
+    EXPECT_NEAR(Selectivity(&low, true, &high, true), 0.4, 0.05);
+    EXPECT_NEAR(Selectivity(&low, false, nullptr, false), 0.79, 0.05);
+    EXPECT_NEAR(Selectivity(nullptr, false, &low, false), 0.2, 0.05);
+    int out_of_range = 1000;
+    EXPECT_DOUBLE_EQ(Selectivity(&out_of_range, true, &out_of_range, true), 0);
+}
+
+/**
+ * @brief 叶子较多时ANALYZE INDEX只采样部分叶子，估计值与实际值相差不大
+ */
+TEST_F(BPlusTreeStatsTest, AnalyzeSampleTest) {
+    OpenIndex(INDEX_BTREE, true);
+    const int key_num = 100000;
+    std::vector<int> keys(key_num);
+    for (int i = 0; i < key_num; i++) {
+        keys[i] = i * 2;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(2));
+    for (int key : keys) {
+        ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, txn_.get());
+    }
+    ASSERT_GT(ih_->get_stats().num_leaves_, 2 * IX_ANALYZE_SAMPLE_PAGES);
+
+    ih_->analyze();
+    IxFileHdr stats = ih_->get_stats();
+    EXPECT_EQ(stats.num_keys_, key_num);
+    EXPECT_EQ(stats.distinct_keys_, key_num);  // 唯一索引相邻的key总是不同
+    EXPECT_EQ(stats.num_hist_buckets_, IX_HIST_MAX_BUCKETS);
+
+    int low = key_num / 2;
+    int high = key_num;
+    // 样本来自64个叶子，同一叶子中的key是相邻的，误差按64个独立样本估计约为0.055
+    EXPECT_NEAR(Selectivity(&low, true, &high, false), 0.25, 0.2);
+    EXPECT_NEAR(Selectivity(nullptr, false, &low, false), 0.25, 0.2);
+    EXPECT_DOUBLE_EQ(Selectivity(&low, true, &low, true), 1.0 / key_num);
+}
+
+/**
+ * @brief 哈希索引的ANALYZE INDEX：读出全部的桶得到桶页面数量和不同key的数量
+ */
+TEST_F(BPlusTreeStatsTest, AnalyzeHashTest) {
+    OpenIndex(INDEX_HASH, false);
+    for (int i = 0; i < 5000; i++) {
+        int key = i % 1000;
+        ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{i, 0}, txn_.get());
+    }
+    EXPECT_EQ(ih_->get_stats().num_keys_, 5000);
+    int key = 0;
+    ASSERT_TRUE(ih_->delete_entry(reinterpret_cast<const char *>(&key), Rid{0, 0}, txn_.get()));
+    EXPECT_EQ(ih_->get_stats().num_keys_, 4999);
+
+    ih_->analyze();
+    IxFileHdr stats = ih_->get_stats();
+    EXPECT_EQ(stats.num_keys_, 4999);
+    EXPECT_EQ(stats.distinct_keys_, 1000);
+    EXPECT_GE(stats.num_leaves_, 4999 / ih_->hash_table_->get_bucket_capacity());
+    EXPECT_GT(stats.avg_fill_, 0);
+    EXPECT_LE(stats.avg_fill_, 1);
+    EXPECT_NEAR(Selectivity(&key, true, &key, true), 0.001, 0.0005);
+}
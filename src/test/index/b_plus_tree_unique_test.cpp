@@ -0,0 +1,160 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeUniqueTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                // 测试文件名的前缀
+const std::vector<ColMeta> TEST_COLS = {{.tab_name = TEST_FILE_NAME,
+                                         .name = "col1",
+                                         .type = TYPE_INT,
+                                         .len = sizeof(int),
+                                         .offset = 0,
+                                         .index = true}};
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后由测试点自己决定以唯一或非唯一的方式创建索引文件"table1_col1.idx" */
+class BPlusTreeUniqueTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void OpenIndex(bool unique) {
+        ix_manager_->create_index(TEST_FILE_NAME, TEST_COLS, INDEX_BTREE, unique);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COLS);
+        ASSERT_EQ(ih_->is_unique(), unique);
+    }
+};
+
+/**
+ * @brief 非唯一索引：同一个key的多个rid都能被找到（跨越多个叶子），并且可以按(key, rid)精确删除其中一项
+ */
+TEST_F(BPlusTreeUniqueTest, DuplicateKeyTest) {
+    OpenIndex(false);
+    const int key_num = 100;
+    const int dup_num = 50;
+    std::vector<Rid> entries;
+    for (int key = 0; key < key_num; key++) {
+        for (int slot = 0; slot < dup_num; slot++) {
+            entries.push_back(Rid{key, slot});
+        }
+    }
+    std::shuffle(entries.begin(), entries.end(), std::default_random_engine{});
+    for (auto &rid : entries) {
+        ih_->insert_entry((const char *)&rid.page_no, rid, txn_.get());
+    }
+
+    for (int key = 0; key < key_num; key++) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih_->get_value((const char *)&key, &result, txn_.get()));
+        ASSERT_EQ(result.size(), dup_num);
+        for (int slot = 0; slot < dup_num; slot++) {
+            EXPECT_EQ(result[slot], (Rid{key, slot}));
+        }
+    }
+
+    // 删除每个key下slot为偶数的项，删除不存在的(key, rid)应该返回false
+    for (int key = 0; key < key_num; key++) {
+        for (int slot = 0; slot < dup_num; slot += 2) {
+            EXPECT_TRUE(ih_->delete_entry((const char *)&key, Rid{key, slot}, txn_.get()));
+        }
+        EXPECT_FALSE(ih_->delete_entry((const char *)&key, Rid{key, 0}, txn_.get()));
+    }
+
+    for (int key = 0; key < key_num; key++) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih_->get_value((const char *)&key, &result, txn_.get()));
+        ASSERT_EQ(result.size(), dup_num / 2);
+        for (size_t i = 0; i < result.size(); i++) {
+            EXPECT_EQ(result[i], (Rid{key, static_cast<int>(2 * i + 1)}));
+        }
+    }
+
+    // [lower_bound(k), upper_bound(k))恰好覆盖key为k的所有项
+    int key = key_num / 2;
+    int count = 0;
+    IxScan scan(ih_.get(), ih_->lower_bound((const char *)&key), ih_->upper_bound((const char *)&key),
+                buffer_pool_manager_.get());
+    while (!scan.is_end()) {
+        EXPECT_EQ(scan.rid().page_no, key);
+        count++;
+        scan.next();
+    }
+    EXPECT_EQ(count, dup_num / 2);
+}
+
+/**
+ * @brief 唯一索引：插入重复key时抛出DuplicateKeyError且索引不变，删除之后可以重新插入
+ */
+TEST_F(BPlusTreeUniqueTest, UniqueKeyTest) {
+    OpenIndex(true);
+    const int scale = 5000;
+    for (int key = 0; key < scale; key++) {
+        ih_->insert_entry((const char *)&key, Rid{0, key}, txn_.get());
+    }
+    for (int key = 0; key < scale; key += 7) {
+        EXPECT_THROW(ih_->insert_entry((const char *)&key, Rid{1, key}, txn_.get()), DuplicateKeyError);
+    }
+
+    for (int key = 0; key < scale; key++) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih_->get_value((const char *)&key, &result, txn_.get()));
+        ASSERT_EQ(result.size(), 1);
+        EXPECT_EQ(result[0], (Rid{0, key}));
+    }
+
+    // 唯一索引中rid不参与比较，rid不匹配时不能删除
+    int key = scale / 2;
+    EXPECT_FALSE(ih_->delete_entry((const char *)&key, Rid{1, key}, txn_.get()));
+    EXPECT_TRUE(ih_->delete_entry((const char *)&key, Rid{0, key}, txn_.get()));
+    ih_->insert_entry((const char *)&key, Rid{1, key}, txn_.get());
+    std::vector<Rid> result;
+    ASSERT_TRUE(ih_->get_value((const char *)&key, &result, txn_.get()));
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], (Rid{1, key}));
+}
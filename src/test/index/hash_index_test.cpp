@@ -0,0 +1,171 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "HashIndexTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";          // 测试文件名的前缀
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME
+ * 然后由测试点自己决定字段以及是否唯一，创建哈希索引文件 */
+class HashIndexTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    std::vector<ColMeta> cols_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(500, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+        }
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    void OpenIndex(ColType type, int len, bool unique) {
+        cols_ = {{.tab_name = TEST_FILE_NAME, .name = "col1", .type = type, .len = len, .offset = 0, .index = true}};
+        ix_manager_->create_index(TEST_FILE_NAME, cols_, INDEX_HASH, unique);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+        ASSERT_TRUE(ih_->is_hash());
+    }
+
+    void ReopenIndex() {
+        ix_manager_->close_index(ih_.get());
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    }
+
+    std::vector<Rid> Lookup(const char *key) {
+        std::vector<Rid> result;
+        ih_->get_value(key, &result, txn_.get());
+        return result;
+    }
+};
+
+/**
+ * @brief 唯一INT索引：随机插入、重复key、查找、删除，并在关闭重新打开后结果不变
+ */
+TEST_F(HashIndexTest, UniqueIntTest) {
+    OpenIndex(TYPE_INT, sizeof(int), true);
+    const int key_num = 50000;
+    std::vector<int> keys(key_num);
+    for (int i = 0; i < key_num; i++) {
+        keys[i] = i * 7 - key_num;
+    }
+    std::default_random_engine rng(1);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (int key : keys) {
+        ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, txn_.get());
+    }
+    // 桶的容量约为PAGE_SIZE / 12，50000个key至少需要64个桶
+    EXPECT_GE(ih_->hash_table_->get_global_depth(), 6);
+    int key = keys[key_num / 2];
+    EXPECT_THROW(ih_->insert_entry(reinterpret_cast<const char *>(&key), Rid{-1, -1}, txn_.get()),
+                 DuplicateKeyError);
+
+    ReopenIndex();
+    for (int key : keys) {
+        auto result = Lookup(reinterpret_cast<const char *>(&key));
+        ASSERT_EQ(result.size(), 1u);
+        EXPECT_EQ(result[0], (Rid{key, 0}));
+    }
+    int missing = keys[0] + 1;  // 相邻的key相差7
+    EXPECT_TRUE(Lookup(reinterpret_cast<const char *>(&missing)).empty());
+
+    for (int i = 0; i < key_num; i += 2) {
+        ASSERT_TRUE(ih_->delete_entry(reinterpret_cast<const char *>(&keys[i]), Rid{keys[i], 0}, txn_.get()));
+    }
+    EXPECT_FALSE(ih_->delete_entry(reinterpret_cast<const char *>(&keys[0]), Rid{keys[0], 0}, txn_.get()));
+    for (int i = 0; i < key_num; i++) {
+        EXPECT_EQ(Lookup(reinterpret_cast<const char *>(&keys[i])).size(), i % 2 == 0 ? 0u : 1u);
+    }
+    // 删除之后可以重新插入
+    ih_->insert_entry(reinterpret_cast<const char *>(&keys[0]), Rid{1, 1}, txn_.get());
+    EXPECT_EQ(Lookup(reinterpret_cast<const char *>(&keys[0])), std::vector<Rid>{(Rid{1, 1})});
+}
+
+/**
+ * @brief 非唯一CHAR索引：少量key各有大量重复，同一个key的键值对超过一个桶时链接溢出页面
+ */
+TEST_F(HashIndexTest, DuplicateStringTest) {
+    const int col_len = 32;
+    OpenIndex(TYPE_STRING, col_len, false);
+    auto make_key = [](int i) {
+        char buf[col_len] = {};
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        return std::string(buf, col_len);
+    };
+    const int key_num = 20;
+    const int dup_num = 1000;
+    std::vector<std::pair<int, int>> entries;
+    for (int i = 0; i < key_num; i++) {
+        for (int slot = 0; slot < dup_num; slot++) {
+            entries.emplace_back(i, slot);
+        }
+    }
+    std::default_random_engine rng(2);
+    std::shuffle(entries.begin(), entries.end(), rng);
+    std::map<int, std::vector<Rid>> expected;
+    for (auto &[i, slot] : entries) {
+        ih_->insert_entry(make_key(i).data(), Rid{i, slot}, txn_.get());
+        expected[i].push_back(Rid{i, slot});
+    }
+    // 重复的key不会使全局深度无限增长
+    EXPECT_LE(ih_->hash_table_->get_global_depth(), 10);
+
+    ReopenIndex();
+    for (int i = 0; i < key_num; i++) {
+        auto &rids = expected[i];
+        std::sort(rids.begin(), rids.end(), [](const Rid &a, const Rid &b) {
+            return std::make_pair(a.page_no, a.slot_no) < std::make_pair(b.page_no, b.slot_no);
+        });
+        EXPECT_EQ(Lookup(make_key(i).data()), rids);
+    }
+    EXPECT_TRUE(Lookup(make_key(key_num).data()).empty());
+
+    // 删除一半的重复项
+    for (int i = 0; i < key_num; i++) {
+        for (int slot = 0; slot < dup_num; slot += 2) {
+            ASSERT_TRUE(ih_->delete_entry(make_key(i).data(), Rid{i, slot}, txn_.get()));
+        }
+        EXPECT_EQ(Lookup(make_key(i).data()).size(), static_cast<size_t>(dup_num / 2));
+    }
+}
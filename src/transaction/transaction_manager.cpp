@@ -61,6 +61,7 @@ void TransactionManager::commit(Transaction* txn, LogManager* log_manager) {
     }
     lock_set->clear();
 
+    lock_manager_->release_gap_locks(txn->get_transaction_id());
     log_manager->flush_log_to_disk();
 
     txn->set_state(TransactionState::COMMITTED);
@@ -82,18 +83,39 @@ void TransactionManager::abort(Transaction* txn, LogManager* log_manager) {
     auto write_set = txn->get_write_set();
     while (!write_set->empty()) {
         WriteRecord* write_record = write_set->back();  // 从后往前回滚
-        auto fh = sm_manager_->fhs_.at(write_record->GetTableName()).get();
-
+        auto &tab_name = write_record->GetTableName();
+        auto fh = sm_manager_->fhs_.at(tab_name).get();
+        auto &rid = write_record->GetRid();
+        auto &indexes = sm_manager_->db_.get_table(tab_name).indexes;
+        auto get_ih = [&](const IndexMeta &index) {
+            return sm_manager_->get_index_handle(tab_name, index.cols);
+        };
+
+        // 索引项与记录一起回滚
         switch (write_record->GetWriteType()) {
             case WType::INSERT_TUPLE:
-                fh->delete_record(write_record->GetRid(), nullptr);
+                for (auto &index : indexes) {
+                    get_ih(index)->delete_entry(index.get_key(write_record->GetRecord().data).data(), rid, txn);
+                }
+                fh->delete_record(rid, nullptr);
                 break;
             case WType::DELETE_TUPLE:
-                fh->insert_record(write_record->GetRid(), write_record->GetRecord().data);
+                fh->insert_record(rid, write_record->GetRecord().data);
+                for (auto &index : indexes) {
+                    get_ih(index)->insert_entry(index.get_key(write_record->GetRecord().data).data(), rid, txn);
+                }
                 break;
-            case WType::UPDATE_TUPLE:
-                fh->update_record(write_record->GetRid(), write_record->GetRecord().data, nullptr);
+            case WType::UPDATE_TUPLE: {
+                auto current = fh->get_record(rid, nullptr);
+                for (auto &index : indexes) {
+                    get_ih(index)->delete_entry(index.get_key(current->data).data(), rid, txn);
+                }
+                fh->update_record(rid, write_record->GetRecord().data, nullptr);
+                for (auto &index : indexes) {
+                    get_ih(index)->insert_entry(index.get_key(write_record->GetRecord().data).data(), rid, txn);
+                }
                 break;
+            }
         }
 
         delete write_record;